@@ -1,36 +1,129 @@
 import type { Request, Response } from 'express';
 import type { Logger } from 'winston';
+import type { FirmwareManifestStore } from '../services/code-generation/FirmwareManifest';
+import { findBoardTarget, resolveBoardTargets } from '../services/connection/BoardTargets';
 
 export class ArduinoStatusController {
-  constructor(private logger: Logger) {}
+  // 最近一次完整状态；固件返回304时复用，轮询稳态只传输几十字节
+  private cachedStatus: { host: string; etag: string; data: any; fetchedAt: number } | null = null;
+
+  constructor(
+    private logger: Logger,
+    private firmwareManifest?: FirmwareManifestStore
+  ) {}
+
+  /**
+   * 获取设备运行计数（开启时间、占空比加权开启时间、切换次数）
+   * GET /api/arduino/metrics?board=<id>
+   */
+  getMetrics = async (req: Request, res: Response): Promise<void> => {
+    const target = this.resolveTarget(req, res);
+    if (!target) return;
+    const { boardId, host } = target;
+    try {
+      const controller = new AbortController();
+      const timeoutMs = Number(process.env.ARDUINO_STATUS_TIMEOUT_MS || 3000);
+      const timeout = setTimeout(() => controller.abort(), timeoutMs);
+      const r = await fetch(`http://${host}/api/metrics`, { signal: controller.signal });
+      clearTimeout(timeout);
+
+      if (!r.ok) {
+        throw new Error(`HTTP ${r.status} ${r.statusText}`);
+      }
+
+      const data: any = await r.json();
+      const uptimeMs = Number(data?.up) || 0;
+      const deviceOrder = this.firmwareManifest?.getBoard(boardId)?.deviceOrder ?? [];
+      const rows: number[][] = Array.isArray(data?.m) ? data.m : [];
+
+      // 固件按设备表顺序返回紧凑数组，这里还原为设备ID
+      const devices = rows.map((row, index) => ({
+        deviceId: deviceOrder[index] ?? `#${index}`,
+        onTimeMs: row[0],
+        dutyOnTimeMs: row[1],
+        switchCount: row[2],
+        lastChangeAgoMs: row[3] > 0 ? Math.max(0, uptimeMs - row[3]) : null
+      }));
+
+      res.json({
+        success: true,
+        board: boardId,
+        uptimeMs,
+        devices
+      });
+    } catch (error: any) {
+      if (error?.name !== 'AbortError') {
+        this.logger.warn('Failed to get Arduino metrics:', error);
+      }
+      res.status(502).json({
+        success: false,
+        error: 'Failed to get Arduino metrics'
+      });
+    }
+  };
 
   /**
    * 获取Arduino状态（通过WiFi HTTP直连）
-   * GET /api/arduino/status
+   * GET /api/arduino/status?board=<id>
    */
   getStatus = async (req: Request, res: Response): Promise<void> => {
-    const host = (process.env.ARDUINO_HOST || req.query.host || '192.168.4.1') as string;
+    const target = this.resolveTarget(req, res);
+    if (!target) return;
+    const { boardId, host } = target;
     const url = `http://${host}/api/status`;
     const start = Date.now();
     try {
       const controller = new AbortController();
       const timeoutMs = Number(process.env.ARDUINO_STATUS_TIMEOUT_MS || 3000);
       const timeout = setTimeout(() => controller.abort(), timeoutMs);
-      const r = await fetch(url, { signal: controller.signal });
+      const cached = this.cachedStatus?.host === host ? this.cachedStatus : null;
+      const r = await fetch(url, {
+        signal: controller.signal,
+        headers: cached ? { 'If-None-Match': cached.etag } : undefined
+      });
       clearTimeout(timeout);
 
-      if (!r.ok) {
-        throw new Error(`HTTP ${r.status} ${r.statusText}`);
+      let data: any;
+      let uptimeSec: number | undefined;
+      const notModified = r.status === 304 && cached !== null;
+
+      if (notModified) {
+        // 状态未变化：沿用缓存，运行时间按本地经过时间推算
+        data = cached.data;
+        uptimeSec = typeof data?.uptimeSec === 'number'
+          ? data.uptimeSec + Math.floor((Date.now() - cached.fetchedAt) / 1000)
+          : undefined;
+      } else {
+        if (!r.ok) {
+          throw new Error(`HTTP ${r.status} ${r.statusText}`);
+        }
+
+        data = await r.json();
+        uptimeSec = typeof data?.uptimeSec === 'number' ? data.uptimeSec : undefined;
+
+        const etag = r.headers.get('etag');
+        this.cachedStatus = etag ? { host, etag, data, fetchedAt: Date.now() } : null;
       }
 
-      const data: any = await r.json();
       const responseTime = Date.now() - start;
 
+      // 固件上报的清单哈希：与最近生成的清单一致时调度器才使用位掩码寻址
+      const manifestHash = typeof data?.manifestHash === 'number' ? data.manifestHash : undefined;
+      this.firmwareManifest?.reportBoardHash(boardId, manifestHash);
+      const expectedHash = this.firmwareManifest?.getBoard(boardId)?.hash;
+
       res.json({
         success: true,
+        board: boardId,
         online: data?.status === 'online',
         devices: typeof data?.devices === 'number' ? data.devices : undefined,
-        uptimeSec: typeof data?.uptimeSec === 'number' ? data.uptimeSec : undefined,
+        uptimeSec,
+        version: typeof data?.version === 'number' ? data.version : undefined,
+        notModified,
+        boot: data?.boot && typeof data.boot === 'object' ? data.boot : undefined,
+        lateBatches: typeof data?.lateBatches === 'number' ? data.lateBatches : undefined,
+        manifestHash,
+        manifestMatches: expectedHash !== undefined ? manifestHash === expectedHash : undefined,
         responseTime
       });
     } catch (error: any) {
@@ -40,10 +133,33 @@ export class ArduinoStatusController {
       } else {
         this.logger.warn('Failed to get Arduino status:', error);
       }
+      this.cachedStatus = null;
       res.json({
         success: true,
+        board: boardId,
         online: false
       });
     }
   };
+
+  /**
+   * 查询的控制板：?board= 指定控制板（未知时返回404），否则为主控制板；?host= 仍可直接指定地址
+   */
+  private resolveTarget(req: Request, res: Response): { boardId: string; host: string } | null {
+    if (typeof req.query.board === 'string') {
+      const target = findBoardTarget(this.firmwareManifest, req.query.board);
+      if (!target) {
+        res.status(404).json({
+          success: false,
+          error: `Unknown board: ${req.query.board}`
+        });
+        return null;
+      }
+      return { boardId: target.boardId, host: target.host };
+    }
+
+    const primary = resolveBoardTargets(this.firmwareManifest)[0];
+    const host = (process.env.ARDUINO_HOST || req.query.host || primary.host) as string;
+    return { boardId: primary.boardId, host };
+  }
 }
@@ -0,0 +1,81 @@
+import { Request, Response } from 'express';
+import { Logger } from 'winston';
+import { ControlLoopService } from '../services/ControlLoopService';
+import type { ControlLoopPatch } from '../services/ControlLoopService';
+
+/**
+ * 闭环控制控制器
+ */
+export class ControlLoopController {
+  constructor(
+    private controlLoopService: ControlLoopService,
+    private logger: Logger
+  ) {}
+
+  /**
+   * 获取所有控制回路
+   * GET /api/control-loops
+   */
+  getLoops = async (_req: Request, res: Response): Promise<void> => {
+    try {
+      const loops = await this.controlLoopService.getLoops();
+      res.json({
+        success: true,
+        data: loops
+      });
+    } catch (error) {
+      this.logger.error('Failed to get control loops:', error);
+      res.status(500).json({
+        success: false,
+        error: 'Failed to get control loops'
+      });
+    }
+  };
+
+  /**
+   * 修改设定值、增益、输出范围或启停
+   * PATCH /api/control-loops/:id
+   */
+  updateLoop = async (req: Request, res: Response): Promise<void> => {
+    try {
+      const { id } = req.params;
+      const patch: ControlLoopPatch = {};
+
+      for (const field of ['setpoint', 'kp', 'ki', 'kd', 'outputMin', 'outputMax'] as const) {
+        if (req.body[field] === undefined) continue;
+        if (typeof req.body[field] !== 'number' || !Number.isFinite(req.body[field])) {
+          res.status(400).json({
+            success: false,
+            error: `${field} must be a number`
+          });
+          return;
+        }
+        patch[field] = req.body[field];
+      }
+      if (req.body.enabled !== undefined) {
+        patch.enabled = Boolean(req.body.enabled);
+      }
+
+      if (Object.keys(patch).length === 0) {
+        res.status(400).json({
+          success: false,
+          error: 'No control loop parameters provided'
+        });
+        return;
+      }
+
+      const result = await this.controlLoopService.updateLoop(id, patch);
+      res.json({
+        success: true,
+        data: result.loop,
+        applied: result.applied
+      });
+    } catch (error) {
+      this.logger.error('Failed to update control loop:', error);
+      res.status(400).json({
+        success: false,
+        error: error instanceof Error ? error.message : 'Failed to update control loop'
+      });
+    }
+  };
+}
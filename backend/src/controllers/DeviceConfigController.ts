@@ -2,6 +2,7 @@ import { Request, Response } from 'express';
 import { Logger } from 'winston';
 import { DeviceConfigService } from '../services/DeviceConfigService';
 import { ArduinoCodeGenerationService } from '../services/code-generation/CodeGenerationService';
+import { FirmwareManifestStore } from '../services/code-generation/FirmwareManifest';
 import type { DeviceConfig } from '../types/device';
 import fs from 'fs/promises';
 import path from 'path';
@@ -15,7 +16,8 @@ export class DeviceConfigController {
 
   constructor(
     private deviceConfigService: DeviceConfigService,
-    private logger: Logger
+    private logger: Logger,
+    private firmwareManifest?: FirmwareManifestStore
   ) {
     this.codeGenerator = new ArduinoCodeGenerationService(logger);
   }
@@ -229,8 +231,8 @@ export class DeviceConfigController {
 
     if (!config.type) {
       errors.push('Device type is required');
-    } else if (!['pump', 'valve'].includes(config.type)) {
-      errors.push('Device type must be "pump" or "valve"');
+    } else if (!['pwm', 'digital', 'sensor'].includes(config.type)) {
+      errors.push('Device type must be "pwm", "digital" or "sensor"');
     }
 
     if (config.pin === undefined || config.pin === null) {
@@ -250,6 +252,17 @@ export class DeviceConfigController {
       }
     }
 
+    // 传感器特定验证
+    if (config.type === 'sensor') {
+      if (!config.sensor || !(config.sensor.sampleRateHz > 0)) {
+        errors.push('Sensor sample rate must be greater than 0');
+      }
+
+      if (config.sensor && !(config.sensor.windowSamples >= 1)) {
+        errors.push('Sensor window must contain at least 1 sample');
+      }
+    }
+
     return {
       isValid: errors.length === 0,
       errors
@@ -346,7 +359,7 @@ export class DeviceConfigController {
       this.logger.info('Generating Arduino code...');
 
       // 使用前端传递的设备配置，而不是后端存储的配置
-      const { devices: frontendDevices, wifiConfig: frontendWifiConfig } = req.body;
+      const { devices: frontendDevices, wifiConfig: frontendWifiConfig, controlLoops: frontendControlLoops, boards: frontendBoards } = req.body;
 
       if (!frontendDevices || !Array.isArray(frontendDevices) || frontendDevices.length === 0) {
         res.status(400).json({
@@ -362,25 +375,56 @@ export class DeviceConfigController {
       // WiFi配置优先级：前端传入 > 配置文件 > 默认
       const wifiConfig = await this.getWifiConfig(frontendWifiConfig);
 
-      // 生成Arduino代码
-      const result = await this.codeGenerator.generateCode(devicesWithArduinoIds, wifiConfig);
+      // 控制回路：前端传入 > 已保存的配置
+      const controlLoops = Array.isArray(frontendControlLoops)
+        ? frontendControlLoops
+        : await this.deviceConfigService.getControlLoops();
 
-      this.logger.info(`Arduino code generated successfully for ${devicesWithArduinoIds.length} devices`);
+      // 控制板：前端传入 > 已保存的配置；设备未指定 boardId 时全部在主控制板上
+      const boards = Array.isArray(frontendBoards)
+        ? frontendBoards
+        : await this.deviceConfigService.getBoards();
+
+      // 每个控制板生成一份固件，主控制板在前
+      const results = await this.codeGenerator.generateFirmware(devicesWithArduinoIds, wifiConfig, controlLoops, boards);
+      const primary = results[0];
+
+      // 记录各控制板的设备表与分组位掩码，调度器据此拆分批次并发送分组命令
+      await this.firmwareManifest?.update(results.map(r => r.metadata), primary.generatedAt);
+
+      this.logger.info(`Arduino code generated successfully for ${devicesWithArduinoIds.length} devices on ${results.length} board(s)`);
+
+      const prefix = (result: typeof primary, message: string) => results.length > 1 ? `[${result.metadata.boardId}] ${message}` : message;
 
       res.json({
         success: true,
         data: {
-          code: result.code,
+          code: primary.code,
           deviceCount: devicesWithArduinoIds.length,
-          generatedAt: result.generatedAt.toISOString(),
-          devices: devicesWithArduinoIds.map(d => ({
+          generatedAt: primary.generatedAt.toISOString(),
+          devices: devicesWithArduinoIds.map((d: DeviceConfig) => ({
             id: d.id,
             name: d.name,
             type: d.type,
-            pin: d.pin
+            pin: d.pin,
+            groupId: d.groupId,
+            boardId: d.boardId
           })),
-          metadata: result.metadata,
-          validation: result.validation
+          metadata: primary.metadata,
+          validation: {
+            isValid: results.every(r => r.validation.isValid),
+            errors: results.flatMap(r => r.validation.errors.map(message => prefix(r, message))),
+            warnings: results.flatMap(r => r.validation.warnings.map(message => prefix(r, message)))
+          },
+          boards: results.map(r => ({
+            boardId: r.metadata.boardId,
+            host: r.metadata.boardHost,
+            wifiMode: r.metadata.wifiMode,
+            deviceCount: r.metadata.deviceCount,
+            code: r.code,
+            metadata: r.metadata,
+            validation: r.validation
+          }))
         }
       });
 
@@ -388,7 +432,8 @@ export class DeviceConfigController {
       this.logger.error('Failed to generate Arduino code:', error);
       res.status(500).json({
         success: false,
-        error: 'Failed to generate Arduino code'
+        error: 'Failed to generate Arduino code',
+        message: error instanceof Error ? error.message : 'Unknown error'
       });
     }
   };
@@ -434,6 +479,7 @@ export class DeviceConfigController {
   private generateArduinoIds(devices: DeviceConfig[]): DeviceConfig[] {
     const pwmCount = { count: 0 };
     const digitalCount = { count: 0 };
+    const sensorCount = { count: 0 };
 
     return devices.map(device => {
       let arduinoId: string;
@@ -441,6 +487,9 @@ export class DeviceConfigController {
       if (device.type === 'pwm') {
         pwmCount.count++;
         arduinoId = `device_pwm_${pwmCount.count}`;
+      } else if (device.type === 'sensor') {
+        sensorCount.count++;
+        arduinoId = `device_sensor_${sensorCount.count}`;
       } else {
         digitalCount.count++;
         arduinoId = `device_digital_${digitalCount.count}`;
@@ -0,0 +1,113 @@
+import { Request, Response } from 'express';
+import { Logger } from 'winston';
+import { SensorDataService, SensorBatch } from '../services/SensorDataService';
+
+/**
+ * 传感器数据控制器
+ * 接收固件批量上传的采样窗口，并提供查询
+ */
+export class SensorDataController {
+  constructor(
+    private sensorDataService: SensorDataService,
+    private logger: Logger
+  ) {}
+
+  /**
+   * 接收固件上传的窗口批次
+   * POST /api/sensors/batch
+   */
+  receiveBatch = async (req: Request, res: Response): Promise<void> => {
+    try {
+      const batch = req.body as SensorBatch;
+
+      if (typeof batch?.up !== 'number' || !Array.isArray(batch.s)) {
+        res.status(400).json({
+          success: false,
+          error: 'Invalid sensor batch: expected {up, ov, s}'
+        });
+        return;
+      }
+
+      const valid = batch.s.every(channel =>
+        typeof channel?.id === 'string' &&
+        Array.isArray(channel.d) &&
+        channel.d.every(window => Array.isArray(window) && window.length === 4)
+      );
+      if (!valid) {
+        res.status(400).json({
+          success: false,
+          error: 'Invalid sensor windows: expected [startMs, min, max, mean]'
+        });
+        return;
+      }
+
+      const accepted = await this.sensorDataService.ingestBatch({ ...batch, ov: batch.ov ?? 0 });
+
+      res.json({
+        success: true,
+        accepted
+      });
+
+    } catch (error) {
+      this.logger.error('Failed to receive sensor batch:', error);
+      res.status(500).json({
+        success: false,
+        error: 'Failed to process sensor batch'
+      });
+    }
+  };
+
+  /**
+   * 获取所有传感器及最新窗口
+   * GET /api/sensors
+   */
+  getSensors = async (_req: Request, res: Response): Promise<void> => {
+    try {
+      const stats = await this.sensorDataService.getStats();
+      res.json({
+        success: true,
+        data: stats
+      });
+    } catch (error) {
+      this.logger.error('Failed to get sensors:', error);
+      res.status(500).json({
+        success: false,
+        error: 'Failed to get sensors'
+      });
+    }
+  };
+
+  /**
+   * 按时间范围查询窗口
+   * GET /api/sensors/:sensorId/windows?from=&to=&limit=
+   */
+  getWindows = async (req: Request, res: Response): Promise<void> => {
+    try {
+      const { sensorId } = req.params;
+      const from = req.query.from ? parseInt(req.query.from as string) : 0;
+      const to = req.query.to ? parseInt(req.query.to as string) : Date.now();
+      const limit = req.query.limit ? Math.min(parseInt(req.query.limit as string), 10000) : 1000;
+
+      if (isNaN(from) || isNaN(to) || isNaN(limit) || limit <= 0) {
+        res.status(400).json({
+          success: false,
+          error: 'Invalid query: from, to and limit must be numbers'
+        });
+        return;
+      }
+
+      const windows = this.sensorDataService.getWindows(sensorId, from, to, limit);
+      res.json({
+        success: true,
+        data: windows,
+        count: windows.length
+      });
+    } catch (error) {
+      this.logger.error('Failed to get sensor windows:', error);
+      res.status(500).json({
+        success: false,
+        error: 'Failed to get sensor windows'
+      });
+    }
+  };
+}
@@ -1,6 +1,7 @@
 import { Request, Response } from 'express';
 import { Logger } from 'winston';
-import { TaskExecutionService } from '../services/TaskExecutionService';
+import { TaskExecutionHost } from '../services/TaskExecutionHost';
+import { checkTaskSize } from '../services/scheduling/TaskCompiler';
 import type { Task, Step, TaskAction, DelayAction, ParallelLoop, SubStep } from '../types/task';
 
 /**
@@ -9,21 +10,20 @@ import type { Task, Step, TaskAction, DelayAction, ParallelLoop, SubStep } from
  */
 export class TaskExecutionController {
   constructor(
-    private taskExecutionService: TaskExecutionService,
+    private taskExecutionService: TaskExecutionHost,
     private logger: Logger,
     private unifiedLogService?: any // 临时类型，避免循环依赖
   ) {}
 
   /**
-   * 开始执行任务
+   * 开始执行任务（可与其他任务同时执行）
    * POST /api/task-execution/start
    */
   startTask = async (req: Request, res: Response): Promise<void> => {
     try {
-      const { task, estimatedDuration }: { task: Task, estimatedDuration?: number } = req.body;
+      const { task, estimatedDuration, priority }: { task: Task, estimatedDuration?: number, priority?: number } = req.body;
       
-      this.logger.info(`Received task execution request: ${task.name}`);
-      this.logger.info(`Task details: ${JSON.stringify(task, null, 2)}`);
+      this.logger.info(`Received task execution request: ${task?.name}`);
       
       // 验证任务结构
       if (!task || !task.id || !task.name || !Array.isArray(task.steps)) {
@@ -35,35 +35,38 @@ export class TaskExecutionController {
         return;
       }
 
-      // 检查是否有任务正在执行
-      const status = this.taskExecutionService.getScheduleStatus();
-      if (status.isRunning) {
+      // 对时间精度进行规范化（四舍五入到100ms = 0.1s）
+      const normalizedTask = this.normalizeTaskPrecision(task);
+      if (this.rejectOversizedTask(normalizedTask, res)) return;
+
+      // 开始执行任务（调度在工作线程中运行）；设备被同级或更高优先级的任务占用时拒绝
+      const { admission, status } = await this.taskExecutionService.executeTask(
+        normalizedTask,
+        estimatedDuration,
+        Number.isFinite(priority) ? Number(priority) : 0
+      );
+
+      if (!admission.admitted) {
         res.status(409).json({
           success: false,
-          error: 'Task already running',
-          message: 'Please stop the current task before starting a new one',
+          error: 'Device conflict',
+          message: `Devices in use by tasks with equal or higher priority: ${admission.conflicts.map(c => `${c.deviceId} (${c.taskName})`).join(', ')}`,
+          conflicts: admission.conflicts,
           currentStatus: status
         });
         return;
       }
 
-      // 对时间精度进行规范化（四舍五入到100ms = 0.1s）
-      const normalizedTask = this.normalizeTaskPrecision(task);
+      this.logger.info(`Task execution started successfully: ${task.name} (${admission.executionId}), ${status.tasks.length} tasks running`);
 
-      // 开始执行任务
-      await this.taskExecutionService.executeTask(normalizedTask, estimatedDuration);
-      
-      const newStatus = this.taskExecutionService.getScheduleStatus();
-      
-      this.logger.info(`Task execution started successfully: ${task.name}`);
-      this.logger.info(`Task has ${newStatus.totalSteps} steps, currently on step ${newStatus.currentStep}`);
-      
       res.json({
         success: true,
         message: 'Task execution started',
         taskId: task.id,
         taskName: task.name,
-        status: newStatus
+        executionId: admission.executionId,
+        preempted: admission.preempted,
+        status
       });
 
     } catch (error) {
@@ -78,13 +81,36 @@ export class TaskExecutionController {
 
   /**
    * 停止任务执行
-   * POST /api/task-execution/stop
+   * POST /api/task-execution/stop  {executionId?}
+   * 指定 executionId 时只停止该任务并关闭它驱动的设备，否则停止所有任务并急停
    */
   stopTask = async (req: Request, res: Response): Promise<void> => {
     try {
-      this.logger.info('Received task stop request');
-      
-      const statusBefore = this.taskExecutionService.getScheduleStatus();
+      const executionId: string | undefined = req.body?.executionId;
+      this.logger.info(`Received task stop request${executionId ? ` for ${executionId}` : ''}`);
+
+      if (executionId) {
+        const { stopped, status } = await this.taskExecutionService.stopTask(executionId);
+        if (!stopped) {
+          res.status(404).json({
+            success: false,
+            error: 'Task not running',
+            message: `No running task with execution id ${executionId}`,
+            status
+          });
+          return;
+        }
+
+        res.json({
+          success: true,
+          message: 'Task execution stopped',
+          executionId,
+          status
+        });
+        return;
+      }
+
+      const statusBefore = await this.taskExecutionService.getScheduleStatus();
       
       if (!statusBefore.isRunning) {
         res.status(400).json({
@@ -96,10 +122,10 @@ export class TaskExecutionController {
         return;
       }
 
-      // 停止执行
-      this.taskExecutionService.stopExecution();
+      // 停止执行并让Arduino立即关闭所有输出
+      const emergencyStop = await this.taskExecutionService.emergencyStop();
       
-      const statusAfter = this.taskExecutionService.getScheduleStatus();
+      const statusAfter = await this.taskExecutionService.getScheduleStatus();
       
       this.logger.info('Task execution stopped successfully');
       this.logger.info(`Task was on step ${statusBefore.currentStep}/${statusBefore.totalSteps} when stopped`);
@@ -109,7 +135,8 @@ export class TaskExecutionController {
         message: 'Task execution stopped',
         currentStep: statusAfter.currentStep,
         totalSteps: statusAfter.totalSteps,
-        status: statusAfter
+        status: statusAfter,
+        emergencyStop
       });
 
     } catch (error) {
@@ -122,13 +149,40 @@ export class TaskExecutionController {
     }
   };
 
+  /**
+   * 急停（无论是否有任务在执行都会发送）
+   * POST /api/task-execution/estop
+   */
+  emergencyStop = async (req: Request, res: Response): Promise<void> => {
+    try {
+      const result = await this.taskExecutionService.emergencyStop();
+
+      this.logger.warn(`Emergency stop ${result.acknowledged ? 'acknowledged' : 'not acknowledged'} via ${result.via} in ${result.latencyMs}ms`);
+
+      res.status(result.acknowledged ? 200 : 504).json({
+        success: result.acknowledged,
+        message: result.acknowledged ? 'Emergency stop acknowledged' : 'Emergency stop not acknowledged by Arduino',
+        emergencyStop: result,
+        status: await this.taskExecutionService.getScheduleStatus()
+      });
+
+    } catch (error) {
+      this.logger.error('Failed to send emergency stop:', error);
+      res.status(500).json({
+        success: false,
+        error: 'Failed to send emergency stop',
+        message: error instanceof Error ? error.message : 'Unknown error'
+      });
+    }
+  };
+
   /**
    * 获取执行状态
    * GET /api/task-execution/status
    */
   getStatus = async (req: Request, res: Response): Promise<void> => {
     try {
-      const status = this.taskExecutionService.getScheduleStatus();
+      const status = await this.taskExecutionService.getScheduleStatus();
       
       // 删除状态查询日志，避免频繁输出
       
@@ -148,6 +202,50 @@ export class TaskExecutionController {
     }
   };
 
+  /**
+   * 编译任务时间线（不执行）
+   * POST /api/task-execution/compile
+   */
+  compileTask = async (req: Request, res: Response): Promise<void> => {
+    try {
+      const { task }: { task: Task } = req.body;
+
+      if (!task || !task.id || !task.name || !Array.isArray(task.steps)) {
+        res.status(400).json({
+          success: false,
+          error: 'Invalid task structure',
+          message: 'Task must have id, name, and steps array'
+        });
+        return;
+      }
+
+      const normalizedTask = this.normalizeTaskPrecision(task);
+      if (this.rejectOversizedTask(normalizedTask, res)) return;
+
+      const compiled = this.taskExecutionService.previewTimeline(normalizedTask);
+
+      res.json({
+        success: true,
+        timeline: {
+          taskId: compiled.taskId,
+          durationMs: compiled.durationMs,
+          eventCount: compiled.events.length,
+          events: compiled.events.map(({ action, ...event }) => event),
+          barriers: compiled.barriers,
+          occupancy: compiled.occupancy
+        }
+      });
+
+    } catch (error) {
+      this.logger.error('Failed to compile task:', error);
+      res.status(500).json({
+        success: false,
+        error: 'Failed to compile task',
+        message: error instanceof Error ? error.message : 'Unknown error'
+      });
+    }
+  };
+
   /**
    * 获取执行历史/日志
    * GET /api/task-execution/logs
@@ -160,7 +258,9 @@ export class TaskExecutionController {
         level,
         source,
         category,
-        search
+        search,
+        startTime,
+        endTime
       } = req.query;
 
       // 删除日志查询日志，避免频繁输出
@@ -187,14 +287,16 @@ export class TaskExecutionController {
         return;
       }
 
-      // 从统一日志服务获取日志
-      const result = this.unifiedLogService.getLogs({
+      // 从统一日志服务获取日志（超出内存中最近日志的范围时从日志文件读取）
+      const result = await this.unifiedLogService.queryLogs({
         limit: Number(limit),
         offset: Number(offset),
         level: level as string,
         source: source as string,
         category: category as string,
-        search: search as string
+        search: search as string,
+        startTime: startTime !== undefined ? Number(startTime) : undefined,
+        endTime: endTime !== undefined ? Number(endTime) : undefined
       });
 
       res.json({
@@ -218,7 +320,7 @@ export class TaskExecutionController {
    */
   healthCheck = async (req: Request, res: Response): Promise<void> => {
     try {
-      const status = this.taskExecutionService.getScheduleStatus();
+      const status = await this.taskExecutionService.getScheduleStatus();
       
       res.json({
         success: true,
@@ -240,6 +342,21 @@ export class TaskExecutionController {
       });
     }
   };
+
+  /**
+   * 循环展开后的事件数超过上限时返回400（在展开前按任务结构计算）
+   */
+  private rejectOversizedTask(task: Task, res: Response): boolean {
+    const sizeError = checkTaskSize(task);
+    if (!sizeError) return false;
+
+    res.status(400).json({
+      success: false,
+      error: 'Task too large',
+      message: sizeError
+    });
+    return true;
+  }
 }
 
 // =============== 辅助：统一时间精度到0.1s（100ms） ===============
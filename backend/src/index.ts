@@ -9,19 +9,26 @@ import path from 'path';
 import { DeviceControlService } from './services/DeviceControlService';
 import { RealtimeCommunicationService } from './services/RealtimeCommunicationService';
 import { DeviceConfigService } from './services/DeviceConfigService';
-import { TaskExecutionService } from './services/TaskExecutionService';
+import { TaskExecutionHost } from './services/TaskExecutionHost';
 import { UnifiedLogService } from './services/UnifiedLogService';
+import { SensorDataService } from './services/SensorDataService';
+import { ControlLoopService } from './services/ControlLoopService';
 import { DeviceController } from './controllers/DeviceController';
 import { DeviceConfigController } from './controllers/DeviceConfigController';
 import { TaskExecutionController } from './controllers/TaskExecutionController';
 import { ArduinoLogController } from './controllers/ArduinoLogController';
+import { SensorDataController } from './controllers/SensorDataController';
+import { ControlLoopController } from './controllers/ControlLoopController';
 import { createDeviceRoutes } from './routes/deviceRoutes';
 import { createArduinoStatusRoutes } from './routes/arduinoStatusRoutes';
 import { ArduinoStatusController } from './controllers/ArduinoStatusController';
 import { createDeviceConfigRoutes } from './routes/deviceConfigRoutes';
 import { createTaskExecutionRoutes } from './routes/taskExecutionRoutes';
 import { createArduinoLogRoutes } from './routes/arduinoLogRoutes';
+import { createSensorRoutes } from './routes/sensorRoutes';
+import { createControlLoopRoutes } from './routes/controlLoopRoutes';
 import { createMDNSService } from './services/network/MDNSService';
+import { FirmwareManifestStore } from './services/code-generation/FirmwareManifest';
 import { smartPortSelection, killProcessOnPort } from './utils/portUtils';
 
 
@@ -71,7 +78,7 @@ const server = createServer(app);
 // 中间件
 app.use(cors({
   origin: process.env.CORS_ORIGIN || "*",
-  methods: ["GET", "POST", "PUT", "DELETE"],
+  methods: ["GET", "POST", "PUT", "PATCH", "DELETE"],
   allowedHeaders: ["Content-Type", "Authorization"]
 }));
 
@@ -92,6 +99,9 @@ app.use((req, res, next) => {
 
 
 
+// 进程退出前需要关闭的资源
+const shutdownHooks: (() => Promise<void>)[] = [];
+
 // 初始化服务
 async function initializeServices(): Promise<void> {
   try {
@@ -105,25 +115,41 @@ async function initializeServices(): Promise<void> {
     const devices = await deviceConfigService.getAllConfigs();
     logger.info(`Loaded configuration for ${devices.length} devices`);
 
-    // 初始化设备控制服务
+    // 初始化设备控制服务（传感器不可控制，单独由传感器数据服务处理）
     const deviceControlService = new DeviceControlService(logger);
-    await deviceControlService.initialize(devices);
-
-    // 初始化实时通信服务
-    const realtimeService = new RealtimeCommunicationService(server, deviceControlService, logger);
+    await deviceControlService.initialize(devices.filter(d => d.type !== 'sensor'));
 
     // 初始化统一日志服务
     const unifiedLogService = new UnifiedLogService(logger);
+    await unifiedLogService.initialize();
+    shutdownHooks.push(() => unifiedLogService.close());
+
+    // 初始化实时通信服务（含日志订阅推送）
+    const realtimeService = new RealtimeCommunicationService(server, deviceControlService, logger, unifiedLogService);
+
+    // 初始化传感器数据服务
+    const sensorDataService = new SensorDataService(deviceConfigService, logger);
+
+    // 加载固件清单（设备表顺序与分组位掩码）
+    const firmwareManifest = new FirmwareManifestStore(logger);
+    await firmwareManifest.load();
+
+    // 初始化闭环控制服务（回路在固件中运行，这里只下发参数）
+    const controlLoopService = new ControlLoopService(deviceConfigService, firmwareManifest, logger);
 
-    // 初始化任务执行服务
-    const taskExecutionService = new TaskExecutionService(logger, unifiedLogService);
+    // 初始化任务执行服务（调度在独立工作线程中运行）
+    const taskExecutionHost = new TaskExecutionHost(logger, unifiedLogService, firmwareManifest, deviceControlService);
+    taskExecutionHost.start();
+    shutdownHooks.push(() => taskExecutionHost.shutdown());
 
     // 初始化控制器
     const deviceController = new DeviceController(deviceControlService, logger);
-    const deviceConfigController = new DeviceConfigController(deviceConfigService, logger);
-    const taskExecutionController = new TaskExecutionController(taskExecutionService, logger, unifiedLogService);
+    const deviceConfigController = new DeviceConfigController(deviceConfigService, logger, firmwareManifest);
+    const taskExecutionController = new TaskExecutionController(taskExecutionHost, logger, unifiedLogService);
     const arduinoLogController = new ArduinoLogController(unifiedLogService, logger);
-    const arduinoStatusController = new ArduinoStatusController(logger);
+    const arduinoStatusController = new ArduinoStatusController(logger, firmwareManifest);
+    const sensorDataController = new SensorDataController(sensorDataService, logger);
+    const controlLoopController = new ControlLoopController(controlLoopService, logger);
 
     // 设置路由
     app.use('/api/devices', createDeviceRoutes(deviceController));
@@ -131,6 +157,8 @@ async function initializeServices(): Promise<void> {
     app.use('/api/task-execution', createTaskExecutionRoutes(taskExecutionController));
     app.use('/api/arduino-logs', createArduinoLogRoutes(arduinoLogController));
     app.use('/api/arduino', createArduinoStatusRoutes(arduinoStatusController));
+    app.use('/api/sensors', createSensorRoutes(sensorDataController));
+    app.use('/api/control-loops', createControlLoopRoutes(controlLoopController));
 
     // 静态文件服务 - 提供前端文件
     const frontendDistPath = path.join(__dirname, '../../frontend/dist');
@@ -292,17 +320,21 @@ async function startServer(): Promise<void> {
 // 优雅关闭处理
 process.on('SIGTERM', () => {
   logger.info('SIGTERM received, shutting down gracefully');
+  // 等待关闭钩子（如写入缓冲的日志）完成后再退出
+  const hooksDone = Promise.allSettled(shutdownHooks.map(hook => hook()));
   server.close(() => {
     logger.info('Server closed');
-    process.exit(0);
+    hooksDone.then(() => process.exit(0));
   });
 });
 
 process.on('SIGINT', () => {
   logger.info('SIGINT received, shutting down gracefully');
+  // 等待关闭钩子（如写入缓冲的日志）完成后再退出
+  const hooksDone = Promise.allSettled(shutdownHooks.map(hook => hook()));
   server.close(() => {
     logger.info('Server closed');
-    process.exit(0);
+    hooksDone.then(() => process.exit(0));
   });
 });
 
@@ -4,6 +4,7 @@ import { ArduinoStatusController } from '../controllers/ArduinoStatusController'
 export function createArduinoStatusRoutes(controller: ArduinoStatusController): Router {
   const router = Router();
   router.get('/status', (req, res) => controller.getStatus(req, res));
+  router.get('/metrics', (req, res) => controller.getMetrics(req, res));
   return router;
 }
 
@@ -0,0 +1,17 @@
+import { Router } from 'express';
+import { ControlLoopController } from '../controllers/ControlLoopController';
+
+/**
+ * 创建闭环控制路由
+ */
+export function createControlLoopRoutes(controller: ControlLoopController): Router {
+  const router = Router();
+
+  // 获取所有控制回路
+  router.get('/', (req, res) => controller.getLoops(req, res));
+
+  // 修改回路参数并下发到固件
+  router.patch('/:id', (req, res) => controller.updateLoop(req, res));
+
+  return router;
+}
@@ -0,0 +1,20 @@
+import { Router } from 'express';
+import { SensorDataController } from '../controllers/SensorDataController';
+
+/**
+ * 创建传感器数据路由
+ */
+export function createSensorRoutes(controller: SensorDataController): Router {
+  const router = Router();
+
+  // 接收固件批量上传的窗口
+  router.post('/batch', (req, res) => controller.receiveBatch(req, res));
+
+  // 传感器列表及最新窗口
+  router.get('/', (req, res) => controller.getSensors(req, res));
+
+  // 按时间范围查询窗口
+  router.get('/:sensorId/windows', (req, res) => controller.getWindows(req, res));
+
+  return router;
+}
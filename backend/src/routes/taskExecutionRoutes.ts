@@ -13,9 +13,15 @@ export function createTaskExecutionRoutes(controller: TaskExecutionController):
   // 停止任务执行
   router.post('/stop', (req, res) => controller.stopTask(req, res));
 
+  // 急停（关闭所有输出）
+  router.post('/estop', (req, res) => controller.emergencyStop(req, res));
+
   // 获取执行状态
   router.get('/status', (req, res) => controller.getStatus(req, res));
 
+  // 编译任务时间线（预览，不执行）
+  router.post('/compile', (req, res) => controller.compileTask(req, res));
+
   // 获取执行日志
   router.get('/logs', (req, res) => controller.getLogs(req, res));
 
@@ -0,0 +1,147 @@
+import { Logger } from 'winston';
+import type { ControlLoopConfig } from '../types/device';
+import { DeviceConfigService } from './DeviceConfigService';
+import { FirmwareManifestStore } from './code-generation/FirmwareManifest';
+import { encodeControlLoop, getDeviceMaxDuty } from './code-generation/ControlLoopCodec';
+import { findBoardTarget, resolveBoardTargets } from './connection/BoardTargets';
+
+/**
+ * 可在运行时修改的回路参数（频率与传感器/输出绑定需要重新生成固件）
+ */
+export type ControlLoopPatch = Partial<Pick<ControlLoopConfig,
+  'setpoint' | 'kp' | 'ki' | 'kd' | 'outputMin' | 'outputMax' | 'enabled'>>;
+
+export interface ControlLoopStatus extends ControlLoopConfig {
+  firmwareIndex: number;  // 固件回路表索引，-1 表示当前固件中没有此回路
+}
+
+/**
+ * 闭环控制服务
+ * 回路在固件中本地运行；这里只保存参数并通过命令协议下发设定值、增益与启停
+ */
+export class ControlLoopService {
+  constructor(
+    private deviceConfigService: DeviceConfigService,
+    private firmwareManifest: FirmwareManifestStore,
+    private logger: Logger
+  ) {}
+
+  async getLoops(): Promise<ControlLoopStatus[]> {
+    const loops = await this.deviceConfigService.getControlLoops();
+    return loops.map(loop => ({
+      ...loop,
+      firmwareIndex: this.firmwareManifest.getControlLoopIndex(loop.id)
+    }));
+  }
+
+  /**
+   * 修改回路参数：设定值与增益保存为下次生成固件的初始值，回路已在固件中时立即下发
+   */
+  async updateLoop(id: string, patch: ControlLoopPatch): Promise<{ loop: ControlLoopConfig; applied: boolean }> {
+    const existing = await this.deviceConfigService.getControlLoopById(id);
+    if (!existing) {
+      throw new Error(`Control loop '${id}' not found`);
+    }
+
+    const sensor = await this.deviceConfigService.getConfigById(existing.sensorId);
+    if (!sensor || sensor.type !== 'sensor') {
+      throw new Error(`Sensor '${existing.sensorId}' of control loop '${id}' not found`);
+    }
+
+    const output = await this.deviceConfigService.getConfigById(existing.outputId);
+    if (!output || output.type !== 'pwm') {
+      throw new Error(`Output '${existing.outputId}' of control loop '${id}' must be a PWM device`);
+    }
+
+    const loop: ControlLoopConfig = { ...existing, ...patch };
+    // 超出定点范围或输出范围超出输出设备的占空比上限时抛出
+    const params = encodeControlLoop(loop, sensor, getDeviceMaxDuty(output));
+
+    const loopIndex = this.firmwareManifest.getControlLoopIndex(id);
+    let applied = false;
+    if (loopIndex >= 0) {
+      const command: Record<string, unknown> = { act: 'loop', lp: loopIndex };
+      if (patch.setpoint !== undefined) command.sp = params.setpoint;
+      if (patch.kp !== undefined || patch.ki !== undefined || patch.kd !== undefined) {
+        command.kp = params.kp;
+        command.ki = params.ki;
+        command.kd = params.kd;
+      }
+      if (patch.outputMin !== undefined || patch.outputMax !== undefined) {
+        command.lo = params.outputMin;
+        command.hi = params.outputMax;
+      }
+      if (patch.enabled !== undefined) command.en = patch.enabled ? 1 : 0;
+
+      applied = await this.sendToArduino(command, this.firmwareManifest.getControlLoopBoard(id));
+    } else {
+      this.logger.warn(`Control loop ${id} is not in the current firmware, regenerate firmware to apply`);
+    }
+
+    // 运行时启停不改变上电默认状态
+    await this.deviceConfigService.saveControlLoop({ ...loop, enabled: existing.enabled });
+    return { loop, applied };
+  }
+
+  /**
+   * 发往回路所在的控制板（回路的传感器与输出在同一控制板上）
+   * 回路按固件回路表索引寻址：控制板上报的清单哈希与清单不一致时不发送
+   */
+  private async sendToArduino(command: Record<string, unknown>, boardId: string | null): Promise<boolean> {
+    const target = (boardId && findBoardTarget(this.firmwareManifest, boardId)) || resolveBoardTargets(this.firmwareManifest)[0];
+
+    if (!this.firmwareManifest.isBoardVerified(target.boardId)) {
+      await this.queryManifestHash(target.baseUrl, target.boardId);
+      if (!this.firmwareManifest.isBoardVerified(target.boardId)) {
+        this.logger.warn(`Board ${target.boardId} does not run the current firmware manifest, control loop command not sent; flash the generated firmware`);
+        return false;
+      }
+    }
+
+    const controller = new AbortController();
+    const timeoutId = setTimeout(() => controller.abort(), 5000);
+
+    try {
+      const response = await fetch(`${target.baseUrl}/api/commands`, {
+        method: 'POST',
+        headers: {
+          'Content-Type': 'application/json',
+          'Accept': 'application/json'
+        },
+        body: JSON.stringify({ id: `loop_${Date.now()}`, ts: Date.now(), cmds: [command] }),
+        signal: controller.signal
+      });
+
+      if (!response.ok) {
+        throw new Error(`Arduino HTTP ${response.status}: ${response.statusText}`);
+      }
+
+      const result = await response.json();
+      this.firmwareManifest.reportBoardHash(target.boardId, result?.state?.mh);
+      return Number(result?.executed) > 0;
+    } catch (error) {
+      this.logger.error('Failed to send control loop command:', error);
+      return false;
+    } finally {
+      clearTimeout(timeoutId);
+    }
+  }
+
+  /**
+   * 从 /api/status 取得控制板的清单哈希（尚未从命令确认中得到时）
+   */
+  private async queryManifestHash(baseUrl: string, boardId: string): Promise<void> {
+    const controller = new AbortController();
+    const timeoutId = setTimeout(() => controller.abort(), 3000);
+    try {
+      const response = await fetch(`${baseUrl}/api/status`, { signal: controller.signal });
+      if (!response.ok) return;
+      const status = await response.json();
+      this.firmwareManifest.reportBoardHash(boardId, status?.manifestHash);
+    } catch (error) {
+      this.logger.debug(`Failed to query manifest hash of board ${boardId}: ${error instanceof Error ? error.message : String(error)}`);
+    } finally {
+      clearTimeout(timeoutId);
+    }
+  }
+}
@@ -1,7 +1,8 @@
 import fs from 'fs/promises';
 import path from 'path';
 import { Logger } from 'winston';
-import type { DeviceConfig } from '../types/device';
+import type { DeviceConfig, ControlLoopConfig, BoardConfig } from '../types/device';
+import { DEFAULT_BOARD_ID } from './code-generation/FirmwareManifest';
 
 /**
  * 设备配置服务
@@ -10,6 +11,8 @@ import type { DeviceConfig } from '../types/device';
 export class DeviceConfigService {
   private configFilePath: string;
   private configs: Map<string, DeviceConfig> = new Map();
+  private controlLoops: Map<string, ControlLoopConfig> = new Map();
+  private boards: BoardConfig[] = [];
 
   constructor(
     private logger: Logger,
@@ -46,6 +49,15 @@ export class DeviceConfigService {
           this.configs.set(device.id, device);
         });
       }
+
+      this.controlLoops.clear();
+      if (Array.isArray(configData.controlLoops)) {
+        configData.controlLoops.forEach((loop: ControlLoopConfig) => {
+          this.controlLoops.set(loop.id, loop);
+        });
+      }
+
+      this.boards = Array.isArray(configData.boards) ? configData.boards : [];
     } catch (error) {
       if ((error as NodeJS.ErrnoException).code === 'ENOENT') {
         this.logger.warn('Device config file not found, starting with empty configuration');
@@ -65,6 +77,8 @@ export class DeviceConfigService {
       const configData = {
         boardType: "Arduino UNO R4 WiFi",
         devices: Array.from(this.configs.values()),
+        controlLoops: Array.from(this.controlLoops.values()),
+        ...(this.boards.length > 0 ? { boards: this.boards } : {}),
         wifiConfig: {
           ssid: "FishControl_WiFi",
           password: "fish2025"
@@ -108,7 +122,7 @@ export class DeviceConfigService {
     }
 
     // 检查引脚是否已被占用
-    const existingPin = Array.from(this.configs.values()).find(c => c.pin === config.pin);
+    const existingPin = Array.from(this.configs.values()).find(c => c.pin === config.pin && this.sameBoard(c, config));
     if (existingPin) {
       throw new Error(`Pin ${config.pin} is already used by device '${existingPin.id}'`);
     }
@@ -137,7 +151,7 @@ export class DeviceConfigService {
     }
 
     // 检查引脚是否被其他设备占用
-    const existingPin = Array.from(this.configs.values()).find(c => c.pin === config.pin && c.id !== id);
+    const existingPin = Array.from(this.configs.values()).find(c => c.pin === config.pin && c.id !== id && this.sameBoard(c, config));
     if (existingPin) {
       throw new Error(`Pin ${config.pin} is already used by device '${existingPin.id}'`);
     }
@@ -178,7 +192,7 @@ export class DeviceConfigService {
     const timestamp = new Date().toISOString();
 
     // 验证所有配置
-    const usedPins = new Set<number>();
+    const usedPins = new Set<string>();
     const usedIds = new Set<string>();
 
     for (const config of configs) {
@@ -188,11 +202,12 @@ export class DeviceConfigService {
       }
       usedIds.add(config.id);
 
-      // 检查引脚重复
-      if (usedPins.has(config.pin)) {
+      // 检查引脚重复（同一控制板内）
+      const pinKey = `${config.boardId || DEFAULT_BOARD_ID}:${config.pin}`;
+      if (usedPins.has(pinKey)) {
         throw new Error(`Duplicate pin in import: ${config.pin}`);
       }
-      usedPins.add(config.pin);
+      usedPins.add(pinKey);
 
       // 检查与现有配置的冲突
       const existingConfig = this.configs.get(config.id);
@@ -200,7 +215,7 @@ export class DeviceConfigService {
         throw new Error(`Device ID '${config.id}' already exists`);
       }
 
-      const existingPin = Array.from(this.configs.values()).find(c => c.pin === config.pin);
+      const existingPin = Array.from(this.configs.values()).find(c => c.pin === config.pin && this.sameBoard(c, config));
       if (existingPin) {
         throw new Error(`Pin ${config.pin} is already used by device '${existingPin.id}'`);
       }
@@ -225,11 +240,11 @@ export class DeviceConfigService {
   }
 
   /**
-   * 检查引脚是否可用
+   * 检查引脚是否可用（引脚按控制板区分）
    */
-  async isPinAvailable(pin: number, excludeDeviceId?: string): Promise<boolean> {
+  async isPinAvailable(pin: number, excludeDeviceId?: string, boardId: string = DEFAULT_BOARD_ID): Promise<boolean> {
     const existingDevice = Array.from(this.configs.values()).find(
-      config => config.pin === pin && config.id !== excludeDeviceId
+      config => config.pin === pin && config.id !== excludeDeviceId && this.sameBoard(config, { boardId })
     );
     return !existingDevice;
   }
@@ -244,19 +259,55 @@ export class DeviceConfigService {
   /**
    * 获取已使用的引脚列表
    */
-  async getUsedPins(): Promise<number[]> {
-    return Array.from(this.configs.values()).map(config => config.pin);
+  async getUsedPins(boardId: string = DEFAULT_BOARD_ID): Promise<number[]> {
+    return Array.from(this.configs.values()).filter(config => this.sameBoard(config, { boardId })).map(config => config.pin);
+  }
+
+  /**
+   * 获取控制板配置（config/devices.json 的 boards，第一个为主控制板）
+   */
+  async getBoards(): Promise<BoardConfig[]> {
+    return this.boards;
+  }
+
+  private sameBoard(a: Pick<DeviceConfig, 'boardId'>, b: Pick<DeviceConfig, 'boardId'>): boolean {
+    return (a.boardId || DEFAULT_BOARD_ID) === (b.boardId || DEFAULT_BOARD_ID);
   }
 
   /**
    * 根据类型获取设备配置
    */
-  async getConfigsByType(type: 'pwm' | 'digital'): Promise<DeviceConfig[]> {
+  async getConfigsByType(type: DeviceConfig['type']): Promise<DeviceConfig[]> {
     return Array.from(this.configs.values()).filter(config => config.type === type);
   }
 
 
 
+  /**
+   * 获取所有闭环控制回路配置
+   */
+  async getControlLoops(): Promise<ControlLoopConfig[]> {
+    return Array.from(this.controlLoops.values());
+  }
+
+  /**
+   * 根据ID获取闭环控制回路配置
+   */
+  async getControlLoopById(id: string): Promise<ControlLoopConfig | undefined> {
+    return this.controlLoops.get(id);
+  }
+
+  /**
+   * 创建或更新闭环控制回路配置（保存为下次生成固件时的初始参数）
+   */
+  async saveControlLoop(loop: ControlLoopConfig): Promise<ControlLoopConfig> {
+    this.controlLoops.set(loop.id, loop);
+    await this.saveConfigs();
+
+    this.logger.info(`Saved control loop configuration: ${loop.id}`);
+    return loop;
+  }
+
   /**
    * 获取配置统计信息
    */
@@ -1,6 +1,7 @@
 import { EventEmitter } from 'events';
 import winston from 'winston';
 import { DeviceConfig, DeviceCommand, DeviceState } from '../types/device';
+import type { FirmwareStateSnapshot } from '../types/device';
 import { DeviceStateManager } from './device/DeviceStateManager';
 import { CommandProcessor } from './device/CommandProcessor';
 import { ConflictDetector } from './device/ConflictDetector';
@@ -107,6 +108,13 @@ export class DeviceControlService extends EventEmitter {
     return this.stateManager.getAllDeviceConfigs();
   }
 
+  /**
+   * 用固件确认中的状态快照更新设备状态
+   */
+  applyFirmwareSnapshot(snapshot: FirmwareStateSnapshot, deviceOrder: string[]): boolean {
+    return this.stateManager.applyFirmwareSnapshot(snapshot, deviceOrder);
+  }
+
   /**
    * 设置设备在线状态
    */
@@ -4,6 +4,9 @@ import { DeviceControlService } from './DeviceControlService';
 import { SocketConnectionManager } from './realtime/SocketConnectionManager';
 import { MessageBroadcaster } from './realtime/MessageBroadcaster';
 import { ClientSessionManager } from './realtime/ClientSessionManager';
+import { LogSubscriptionManager } from './realtime/LogSubscriptionManager';
+import type { LogSubscriptionStats } from './realtime/LogSubscriptionManager';
+import type { UnifiedLogService } from './UnifiedLogService';
 import { DeviceState, DeviceCommand } from '../types/device';
 
 /**
@@ -22,11 +25,13 @@ export class RealtimeCommunicationService {
   private connectionManager: SocketConnectionManager;
   private messageBroadcaster: MessageBroadcaster;
   private sessionManager: ClientSessionManager;
+  private logSubscriptions: LogSubscriptionManager | null = null;
 
   constructor(
     httpServer: HttpServer,
     deviceControlService: DeviceControlService,
-    logger: winston.Logger
+    logger: winston.Logger,
+    logService?: UnifiedLogService
   ) {
     this.logger = logger;
     this.deviceControlService = deviceControlService;
@@ -35,6 +40,9 @@ export class RealtimeCommunicationService {
     this.connectionManager = new SocketConnectionManager(httpServer, logger);
     this.messageBroadcaster = new MessageBroadcaster(this.connectionManager, logger);
     this.sessionManager = new ClientSessionManager(this.connectionManager, logger);
+    if (logService) {
+      this.logSubscriptions = new LogSubscriptionManager(this.connectionManager, logService, logger);
+    }
 
     this.setupEventHandlers();
   }
@@ -48,6 +56,7 @@ export class RealtimeCommunicationService {
     this.connectionManager.start();
     this.messageBroadcaster.start();
     this.sessionManager.start();
+    this.logSubscriptions?.start();
     
     this.logger.info('Realtime Communication Service started');
   }
@@ -58,6 +67,7 @@ export class RealtimeCommunicationService {
   stop(): void {
     this.logger.info('Stopping Realtime Communication Service');
     
+    this.logSubscriptions?.stop();
     this.sessionManager.stop();
     this.messageBroadcaster.stop();
     this.connectionManager.stop();
@@ -86,6 +96,13 @@ export class RealtimeCommunicationService {
     return this.connectionManager.getConnectedClients();
   }
 
+  /**
+   * 获取日志订阅统计
+   */
+  getLogSubscriptionStats(): LogSubscriptionStats | null {
+    return this.logSubscriptions?.getStats() ?? null;
+  }
+
   /**
    * 启动非活跃连接清理
    */
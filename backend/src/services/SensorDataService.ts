@@ -0,0 +1,182 @@
+import { Logger } from 'winston';
+import { EventEmitter } from 'events';
+import type { DeviceConfig, SensorWindow } from '../types/device';
+import { DeviceConfigService } from './DeviceConfigService';
+
+/**
+ * 固件上传的传感器批次
+ * {"up":运行ms,"ov":丢弃窗口数,"s":[{"id":"sensor","d":[[起始ms,min,max,mean],...]}]}
+ */
+export interface SensorBatch {
+  up: number;
+  ov: number;
+  s: Array<{
+    id: string;
+    d: Array<[number, number, number, number]>;
+  }>;
+}
+
+export interface SensorStats {
+  sensorId: string;
+  unit?: string;
+  stored: number;
+  latest?: SensorWindow;
+}
+
+/**
+ * 环形缓冲：写满后覆盖最旧的窗口，窗口按时间顺序写入
+ */
+class SensorWindowRing {
+  private items: SensorWindow[] = [];
+  private head = 0; // 写满后下一个被覆盖的位置（即最旧的窗口）
+
+  constructor(private capacity: number) {}
+
+  push(window: SensorWindow): void {
+    if (this.items.length < this.capacity) {
+      this.items.push(window);
+    } else {
+      this.items[this.head] = window;
+      this.head = (this.head + 1) % this.capacity;
+    }
+  }
+
+  get size(): number {
+    return this.items.length;
+  }
+
+  get latest(): SensorWindow | undefined {
+    if (this.items.length === 0) return undefined;
+    return this.items[(this.head + this.items.length - 1) % this.items.length];
+  }
+
+  /**
+   * 按时间顺序返回 [from, to] 内的窗口，最多 limit 个（取最新的）
+   */
+  range(from: number, to: number, limit: number): SensorWindow[] {
+    const result: SensorWindow[] = [];
+    for (let i = this.items.length - 1; i >= 0 && result.length < limit; i--) {
+      const window = this.items[(this.head + i) % this.items.length];
+      if (window.timestamp < from) break;
+      if (window.timestamp <= to) result.push(window);
+    }
+    return result.reverse();
+  }
+}
+
+/**
+ * 传感器数据服务
+ * 接收固件批量上传的 min/max/mean 窗口，换算为物理量并按传感器保存在内存环形缓冲中
+ */
+export class SensorDataService extends EventEmitter {
+  private rings: Map<string, SensorWindowRing> = new Map();
+  private lastOverflows = 0;
+  private droppedWindows = 0;   // 固件端因缓冲区满丢弃的窗口累计
+  private unknownWindows = 0;   // 配置中不存在的传感器上传的窗口
+
+  constructor(
+    private deviceConfigService: DeviceConfigService,
+    private logger: Logger,
+    private maxWindowsPerSensor: number = 36000
+  ) {
+    super();
+  }
+
+  /**
+   * 处理一批窗口，返回接受的窗口数
+   */
+  async ingestBatch(batch: SensorBatch, receivedAt: number = Date.now()): Promise<number> {
+    const sensors = await this.getSensorConfigs();
+    this.trackOverflows(batch.ov);
+
+    const accepted: SensorWindow[] = [];
+    for (const channel of batch.s) {
+      const config = sensors.get(channel.id);
+      if (!config || !config.sensor) {
+        this.unknownWindows += channel.d.length;
+        continue;
+      }
+
+      const scale = config.sensor.scale ?? 1;
+      const offset = config.sensor.offset ?? 0;
+      const windowMs = config.sensor.windowSamples * 1000 / config.sensor.sampleRateHz;
+      const ring = this.getRing(channel.id);
+
+      for (const [startMs, min, max, mean] of channel.d) {
+        // 固件时间为 uint32 毫秒，按上传时刻换算为后端时钟
+        const age = (batch.up - startMs) >>> 0;
+        const window: SensorWindow = {
+          sensorId: channel.id,
+          timestamp: receivedAt - age,
+          windowMs,
+          min: min * scale + offset,
+          max: max * scale + offset,
+          mean: mean * scale + offset
+        };
+        ring.push(window);
+        accepted.push(window);
+      }
+    }
+
+    if (accepted.length > 0) {
+      this.emit('windows', accepted);
+    }
+
+    return accepted.length;
+  }
+
+  /**
+   * 查询某个传感器在时间范围内的窗口
+   */
+  getWindows(sensorId: string, from: number = 0, to: number = Date.now(), limit: number = 1000): SensorWindow[] {
+    const ring = this.rings.get(sensorId);
+    return ring ? ring.range(from, to, limit) : [];
+  }
+
+  /**
+   * 最新窗口（无数据返回undefined）
+   */
+  getLatest(sensorId: string): SensorWindow | undefined {
+    return this.rings.get(sensorId)?.latest;
+  }
+
+  async getStats(): Promise<{ sensors: SensorStats[]; droppedWindows: number; unknownWindows: number }> {
+    const sensors = await this.getSensorConfigs();
+    return {
+      sensors: Array.from(sensors.values()).map(config => ({
+        sensorId: config.id,
+        unit: config.sensor?.unit,
+        stored: this.rings.get(config.id)?.size ?? 0,
+        latest: this.getLatest(config.id)
+      })),
+      droppedWindows: this.droppedWindows,
+      unknownWindows: this.unknownWindows
+    };
+  }
+
+  private async getSensorConfigs(): Promise<Map<string, DeviceConfig>> {
+    const configs = await this.deviceConfigService.getConfigsByType('sensor');
+    return new Map(configs.map(config => [config.id, config]));
+  }
+
+  private getRing(sensorId: string): SensorWindowRing {
+    let ring = this.rings.get(sensorId);
+    if (!ring) {
+      ring = new SensorWindowRing(this.maxWindowsPerSensor);
+      this.rings.set(sensorId, ring);
+    }
+    return ring;
+  }
+
+  /**
+   * 固件的丢弃计数单调递增，变小说明固件重启
+   */
+  private trackOverflows(overflows: number): void {
+    if (overflows > this.lastOverflows) {
+      const delta = overflows - this.lastOverflows;
+      this.droppedWindows += delta;
+      this.logger.warn(`Firmware dropped ${delta} sensor windows (buffer full)`);
+    }
+    this.lastOverflows = overflows;
+  }
+}
@@ -0,0 +1,279 @@
+import path from 'path';
+import { Worker } from 'worker_threads';
+import { Logger } from 'winston';
+import { UnifiedLogService } from './UnifiedLogService';
+import { DeviceControlService } from './DeviceControlService';
+import { FirmwareManifestStore } from './code-generation/FirmwareManifest';
+import { BoardEmergencyStop } from './connection/EmergencyStopChannel';
+import { resolveBoardTargets } from './connection/BoardTargets';
+import type { EmergencyStopResult } from './connection/EmergencyStopChannel';
+import { EventLoopLagMonitor } from './scheduling/EventLoopLagMonitor';
+import type { EventLoopLagStats } from './scheduling/EventLoopLagMonitor';
+import type { AsyncLogSinkStats } from './logging/AsyncLogSink';
+import { compileTask } from './scheduling/TaskCompiler';
+import type { CompiledTask } from './scheduling/TaskCompiler';
+import type { ScheduleStatus, TaskAdmission } from './TaskExecutionService';
+import type { TaskWorkerData, TaskWorkerEvent, TaskWorkerRequest, WorkerStatusReply } from './scheduling/TaskExecutionWorker';
+import type { Task } from '../types/task';
+
+type WithoutId<T> = T extends { id: number } ? Omit<T, 'id'> : never;
+type WorkerCommand = WithoutId<TaskWorkerRequest>;
+
+/**
+ * 任务执行宿主（主线程）
+ * 任务调度在 TaskExecutionWorker 工作线程中运行，本类以消息控制工作线程，对控制器提供与原服务相同的操作
+ *
+ * 职责：
+ * - 启动/重启工作线程，同步固件清单
+ * - 把工作线程的日志、Arduino通信记录与固件状态快照写入主线程的服务
+ * - 工作线程无响应或异常退出时，直接从主线程发送急停
+ * - 汇总两个线程的事件循环延迟
+ */
+export class TaskExecutionHost {
+  private worker: Worker | null = null;
+  private pending: Map<number, PendingRequest> = new Map();
+  private nextRequestId = 1;
+  private shuttingDown = false;
+  private lagMonitor: EventLoopLagMonitor;
+  private fallbackStopChannel: BoardEmergencyStop;
+  private config: TaskExecutionHostConfig;
+
+  constructor(
+    private logger: Logger,
+    private logService: UnifiedLogService,
+    private firmwareManifest?: FirmwareManifestStore,
+    private deviceControlService?: DeviceControlService,
+    config: Partial<TaskExecutionHostConfig> = {}
+  ) {
+    this.config = { ...getDefaultTaskExecutionHostConfig(), ...config };
+    this.lagMonitor = new EventLoopLagMonitor(logger, 'main');
+    this.fallbackStopChannel = new BoardEmergencyStop(logger, () => resolveBoardTargets(this.firmwareManifest));
+  }
+
+  /**
+   * 启动工作线程与主线程的延迟监视
+   */
+  start(): void {
+    this.lagMonitor.start();
+    this.firmwareManifest?.onChange(manifest => this.worker?.postMessage({ type: 'manifest', manifest } satisfies TaskWorkerRequest));
+    this.spawnWorker();
+  }
+
+  /**
+   * 停止工作线程（进程退出时调用）
+   */
+  async shutdown(): Promise<void> {
+    this.shuttingDown = true;
+    this.lagMonitor.stop();
+    this.fallbackStopChannel.close();
+    await this.worker?.terminate();
+    this.worker = null;
+  }
+
+  /**
+   * 开始执行任务；与正在执行的任务有设备冲突时 admission.admitted 为false
+   */
+  async executeTask(task: Task, estimatedDuration?: number, priority?: number): Promise<{ admission: TaskAdmission; status: HostScheduleStatus }> {
+    const reply = await this.request<WorkerStatusReply>({ type: 'execute', task, estimatedDuration, priority });
+    return { admission: reply.admission!, status: this.withLag(reply) };
+  }
+
+  /**
+   * 停止单个任务并关闭它驱动的设备，返回是否找到该任务
+   */
+  async stopTask(executionId: string): Promise<{ stopped: boolean; status: HostScheduleStatus }> {
+    const reply = await this.request<WorkerStatusReply>({ type: 'stopTask', executionId });
+    return { stopped: reply.stopped === true, status: this.withLag(reply) };
+  }
+
+  async stopExecution(): Promise<HostScheduleStatus> {
+    const reply = await this.request<WorkerStatusReply>({ type: 'stop' });
+    return this.withLag(reply);
+  }
+
+  /**
+   * 急停：由工作线程发送；工作线程没有及时接收或处理失败时从主线程直接发送
+   */
+  async emergencyStop(): Promise<EmergencyStopResult> {
+    try {
+      return await this.request<EmergencyStopResult>({ type: 'estop' }, this.config.requestTimeoutMs, this.config.emergencyStopAcceptMs);
+    } catch (error) {
+      this.logger.error('Scheduler thread did not handle emergency stop, sending from main thread:', {
+        error: error instanceof Error ? error.message : String(error)
+      });
+      return this.sendFallbackStop();
+    }
+  }
+
+  async getScheduleStatus(): Promise<HostScheduleStatus> {
+    const reply = await this.request<WorkerStatusReply>({ type: 'status' });
+    return this.withLag(reply);
+  }
+
+  /**
+   * 编译任务时间线（纯计算，在主线程完成）
+   */
+  previewTimeline(task: Task): CompiledTask {
+    return compileTask(task);
+  }
+
+  private spawnWorker(): void {
+    // 开发环境（ts-node）直接加载 .ts，构建后加载 dist 中的 .js
+    const extension = path.extname(__filename);
+    const workerData: TaskWorkerData = {
+      manifest: this.firmwareManifest?.getManifest() ?? null,
+      logLevel: this.logger.level
+    };
+    const worker = new Worker(path.join(__dirname, 'scheduling', `TaskExecutionWorker${extension}`), {
+      workerData,
+      execArgv: extension === '.ts' ? ['--require', 'ts-node/register'] : undefined
+    });
+
+    worker.on('message', (event: TaskWorkerEvent) => this.handleWorkerEvent(event));
+    worker.on('error', error => this.logger.error('Scheduler thread error:', error));
+    worker.on('exit', code => {
+      this.worker = null;
+      this.rejectPending(new Error(`Scheduler thread exited with code ${code}`));
+      if (this.shuttingDown) return;
+
+      // 任务可能在执行中，先关闭所有输出再重启线程；延迟重启，避免启动即失败时反复重启
+      this.logger.error(`Scheduler thread exited unexpectedly (code ${code}), stopping outputs and restarting in ${this.config.restartDelayMs}ms`);
+      this.sendFallbackStop();
+      setTimeout(() => {
+        if (!this.shuttingDown && !this.worker) this.spawnWorker();
+      }, this.config.restartDelayMs).unref();
+    });
+
+    this.worker = worker;
+    this.logger.info('Task scheduler thread started');
+  }
+
+  private handleWorkerEvent(event: TaskWorkerEvent): void {
+    switch (event.type) {
+      case 'accepted': {
+        const request = this.pending.get(event.id);
+        if (request?.acceptTimer) {
+          clearTimeout(request.acceptTimer);
+          request.acceptTimer = undefined;
+        }
+        break;
+      }
+      case 'reply': {
+        const request = this.pending.get(event.id);
+        if (!request) return;
+        this.pending.delete(event.id);
+        clearTimeout(request.timer);
+        clearTimeout(request.acceptTimer);
+        if (event.error !== undefined) {
+          request.reject(new Error(event.error));
+        } else {
+          request.resolve(event.result);
+        }
+        break;
+      }
+      case 'log':
+        for (const entry of event.entries) {
+          this.logger.log({ ...entry, thread: 'scheduler' });
+        }
+        break;
+      case 'logService':
+        if (event.method === 'logTaskExecution') {
+          this.logService.logTaskExecution(event.args[0], event.args[1], event.args[2]);
+        } else {
+          this.logService.logArduino(event.args[0], event.args[1], event.args[2]);
+        }
+        break;
+      case 'snapshot':
+        this.deviceControlService?.applyFirmwareSnapshot(event.snapshot, event.deviceOrder);
+        break;
+    }
+  }
+
+  /**
+   * 发送控制消息并等待回复；给定 acceptTimeoutMs 时，工作线程还需在此时限内确认收到
+   */
+  private request<T>(command: WorkerCommand, timeoutMs = this.config.requestTimeoutMs, acceptTimeoutMs?: number): Promise<T> {
+    const worker = this.worker;
+    if (!worker) {
+      return Promise.reject(new Error('Scheduler thread is not running'));
+    }
+
+    const id = this.nextRequestId++;
+    return new Promise<T>((resolve, reject) => {
+      const fail = (message: string) => {
+        const request = this.pending.get(id);
+        if (!request) return;
+        this.pending.delete(id);
+        clearTimeout(request.timer);
+        clearTimeout(request.acceptTimer);
+        reject(new Error(message));
+      };
+
+      const timer = setTimeout(() => fail(`Scheduler thread did not reply to '${command.type}' within ${timeoutMs}ms`), timeoutMs);
+      const acceptTimer = acceptTimeoutMs !== undefined
+        ? setTimeout(() => fail(`Scheduler thread did not accept '${command.type}' within ${acceptTimeoutMs}ms`), acceptTimeoutMs)
+        : undefined;
+
+      this.pending.set(id, { resolve, reject, timer, acceptTimer });
+      worker.postMessage({ ...command, id });
+    });
+  }
+
+  private rejectPending(error: Error): void {
+    for (const request of this.pending.values()) {
+      clearTimeout(request.timer);
+      clearTimeout(request.acceptTimer);
+      request.reject(error);
+    }
+    this.pending.clear();
+  }
+
+  private async sendFallbackStop(): Promise<EmergencyStopResult> {
+    const result = await this.fallbackStopChannel.trigger();
+    this.logService.logArduino('send', `Emergency stop (main thread) ${result.acknowledged ? 'acknowledged' : 'NOT acknowledged'} via ${result.via}`, {
+      ...result,
+      responseTime: result.latencyMs
+    });
+    return result;
+  }
+
+  private withLag(reply: WorkerStatusReply): HostScheduleStatus {
+    return {
+      ...reply.status,
+      eventLoopLag: {
+        scheduler: reply.eventLoopLag,
+        main: this.lagMonitor.getStats()
+      },
+      schedulerLogSink: reply.logSink
+    };
+  }
+}
+
+function getDefaultTaskExecutionHostConfig(): TaskExecutionHostConfig {
+  return {
+    requestTimeoutMs: 5000,
+    emergencyStopAcceptMs: 50,
+    restartDelayMs: 1000
+  };
+}
+
+interface PendingRequest {
+  resolve: (value: any) => void;
+  reject: (error: Error) => void;
+  timer: NodeJS.Timeout;
+  acceptTimer?: NodeJS.Timeout;
+}
+
+export interface TaskExecutionHostConfig {
+  requestTimeoutMs: number;        // 控制消息的回复时限
+  emergencyStopAcceptMs: number;   // 工作线程超过此时限未接收急停时由主线程直接发送
+  restartDelayMs: number;          // 工作线程异常退出后的重启延迟
+}
+
+export type HostScheduleStatus = ScheduleStatus & {
+  eventLoopLag: {
+    scheduler: EventLoopLagStats;
+    main: EventLoopLagStats;
+  };
+  schedulerLogSink: AsyncLogSinkStats;   // 调度线程的日志队列（丢弃/溢出计数）
+};
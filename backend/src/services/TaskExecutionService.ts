@@ -1,295 +1,297 @@
 import { Logger } from 'winston';
-import { UnifiedLogService } from './UnifiedLogService';
-import type { Task, Step, TaskAction, DelayAction, ParallelLoop, SubStep } from '../types/task';
-
-// 延时状态
-interface DelayState {
-  endTime: number;
-  triggered: boolean;
-  actions: (TaskAction | DelayAction)[];
-  parallelLoops: ParallelLoop[];
-}
-
-// 循环状态
-interface LoopState {
-  iteration: number;        // 当前第几次迭代 (0-based)
-  subStep: number;         // 当前第几个子步骤 (0-based)
-  nextTime: number;        // 下次执行时间
-  subStepEndTime: number | null;  // 当前子步骤结束时间
-  totalIterations: number; // 总迭代次数
-  intervalMs: number;      // 循环间隔
-  loop: ParallelLoop;      // 循环定义
-}
-
-// 执行状态
+import type { UnifiedLogService } from './UnifiedLogService';
+import { BoardEmergencyStop } from './connection/EmergencyStopChannel';
+import { BoardDispatcher } from './connection/BoardDispatcher';
+import type { ArduinoCommand, ArduinoWaveform } from './connection/ArduinoCommandTransport';
+import type { EmergencyStopResult } from './connection/EmergencyStopChannel';
+import { FirmwareManifestStore } from './code-generation/FirmwareManifest';
+import type { DeviceControlService } from './DeviceControlService';
+import { DeadlineScheduler } from './scheduling/DeadlineScheduler';
+import type { FiredEvent } from './scheduling/DeadlineScheduler';
+import { DeviceArbiter } from './scheduling/DeviceArbiter';
+import type { DeviceConflict } from './scheduling/DeviceArbiter';
+import type { FirmwareStateSnapshot } from '../types/device';
+import type { Task, TaskAction, PwmProfile } from '../types/task';
+import { compileTask, findStepAt } from './scheduling/TaskCompiler';
+import type { CompiledTask } from './scheduling/TaskCompiler';
+
+// 执行状态（时间均为调度器单调时钟上的计划时间，ms）
 interface ExecutionState {
+  executionId: string;
   task: Task;
-  stepIndex: number;
-  stepStartTime: number;
-  delays: DelayState[];
-  loops: LoopState[];
-  directActionsExecuted: boolean; // 标记普通动作是否已执行
+  priority: number;
+  compiled: CompiledTask;         // 执行前编译的时间线
+  startTime: number;              // 任务开始的计划时刻
+  leadMs: number;                 // 事件提前触发的时间（多控制板对齐，单控制板为0）
+  cursor: number;                 // 下一个待执行事件在时间线中的位置
+  stepIndex: number;              // 最近执行事件所在步骤
   isCompleted: boolean;
+  hasPending: boolean;            // 本轮合并批次中是否有本任务的命令
+  pendingStep: number;            // 这些命令所属步骤
+  suppressedEvents: number;       // 设备被更高优先级任务驱动而跳过的事件
+  eventId: number | null;         // 调度器中本任务的下一个事件
+  timeoutTimer: NodeJS.Timeout | null;
 }
 
 /**
- * 任务执行服务 - 核心调度逻辑（状态机版本）
+ * 任务执行服务 - 核心调度逻辑（时间线版本）
+ * 任务执行前编译为按时间排序的事件时间线，运行时只按游标把到期事件交给截止时间调度器
+ * 多个任务可同时执行：准入时由设备仲裁器检查设备冲突，所有任务在同一轮到期的命令合并为一个批次发送
+ * 多控制板部署时批次按控制板拆分并行发送，事件提前触发，各控制板在计划时刻同时执行
  */
 export class TaskExecutionService {
-  private executionTimer: NodeJS.Timeout | null = null;
-  private taskTimeoutTimer: NodeJS.Timeout | null = null;
-  private isRunning = false;
-  private executionState: ExecutionState | null = null;
+  private scheduler: DeadlineScheduler;
+  private executions: Map<string, ExecutionState> = new Map();
+  private lastExecution: ExecutionState | null = null;
+  private arbiter = new DeviceArbiter();
+  private pendingCommands: TaskAction[] = [];  // 本轮到期事件产生的命令（所有任务），事件处理完后合并发送
+  private batchLatenessMs = 0;                 // 本轮事件的最大迟到量
+  private batchExecuteAt: number | null = null; // 本轮批次的计划执行时刻（仅多控制板）
+  private emergencyStopChannel: BoardEmergencyStop;
+  private dispatcher: BoardDispatcher;
 
   constructor(
     private logger: Logger,
-    private logService: UnifiedLogService
-  ) {}
+    private logService: TaskExecutionLogSink,
+    private firmwareManifest?: FirmwareManifestStore,
+    private deviceControlService?: Pick<DeviceControlService, 'applyFirmwareSnapshot'>
+  ) {
+    this.dispatcher = new BoardDispatcher(
+      logger,
+      logService,
+      commands => this.encodeCommands(commands),
+      (boardId, state) => this.applyAckSnapshot(boardId, state),
+      firmwareManifest
+    );
+    this.emergencyStopChannel = new BoardEmergencyStop(logger, () => this.dispatcher.getTargets());
+    this.scheduler = new DeadlineScheduler({}, () => this.flushCommands());
+  }
 
   /**
-   * 开始执行任务（状态机版本）
+   * 开始执行任务
+   * 与正在执行的任务共用设备时，只有优先级更高才会进入并接管这些设备，否则拒绝
    */
-  async executeTask(task: Task, estimatedDuration?: number): Promise<void> {
+  async executeTask(task: Task, estimatedDuration?: number, priority = 0): Promise<TaskAdmission> {
+    // 编译时间线，时间线中出现的设备即任务声明的设备
+    const compiled = compileTask(task);
+    const devices = Object.keys(compiled.occupancy);
+    const { conflicts, preempted } = this.arbiter.check(devices, priority);
+
+    if (conflicts.length > 0) {
+      this.logService.logTaskExecution('REJECT', `Task ${task.name} conflicts with running tasks`, {
+        taskId: task.id,
+        priority,
+        conflicts
+      });
+      return { admitted: false, conflicts };
+    }
+
     this.logService.logTaskExecution('START', `Starting task: ${task.name}`, {
       taskId: task.id,
-      stepCount: task.steps.length
+      stepCount: task.steps.length,
+      priority
     });
 
-    // 清理之前的调度
-    this.stopExecution();
+    // 没有其他任务在执行时重新统计迟到量
+    if (this.executions.size === 0) {
+      this.scheduler.resetLatenessStats();
+    }
+
+    // 急停后的第一个任务恢复命令发送
+    this.dispatcher.start();
+
+    // 多控制板：先探测各板时钟，任务在提前量之后开始，第一批事件也能按时刻对齐
+    const leadMs = this.dispatcher.getAlignmentLeadMs();
+    if (leadMs > 0) {
+      this.dispatcher.syncClocks();
+    }
 
-    // 初始化执行状态
-    const startTime = Date.now();
-    this.executionState = this.initializeExecutionState(task, startTime);
+    const executionId = this.generateExecutionId();
+    const state = this.initializeExecutionState(executionId, task, priority, compiled, this.scheduler.now() + leadMs, leadMs);
+    this.executions.set(executionId, state);
+    this.arbiter.claim(executionId, task.name, devices, priority);
 
-    // 使用前端传递的预计时长，如果没有则计算
-    const finalEstimatedDuration = estimatedDuration || this.calculateTaskDuration(task);
-    const timeoutDuration = finalEstimatedDuration + 30000; // 预计时间 + 30秒
+    for (const entry of preempted) {
+      this.logger.warn(`Device ${entry.deviceId} taken over from task ${entry.taskName} (priority ${entry.priority}) by ${task.name} (priority ${priority})`);
+    }
+
+    const timeoutDuration = compiled.durationMs + 30000; // 时间线总时长 + 30秒
 
-    this.logService.logTaskExecution('SCHEDULE', `Initialized task execution state`, {
+    this.logService.logTaskExecution('SCHEDULE', `Compiled task timeline`, {
       taskId: task.id,
+      executionId,
       stepCount: task.steps.length,
-      startTime: new Date(startTime).toISOString(),
-      estimatedDuration: `${Math.round(finalEstimatedDuration/1000)}s`,
+      eventCount: compiled.events.length,
+      devices,
+      startTime: new Date().toISOString(),
+      duration: `${Math.round(compiled.durationMs/1000)}s`,
+      ...(estimatedDuration !== undefined && { estimatedDuration: `${Math.round(estimatedDuration/1000)}s` }),
       timeoutDuration: `${Math.round(timeoutDuration/1000)}s`
     });
 
-    // 开始调度循环
-    this.startScheduler();
-
-    // 设置任务超时保护（预计时间 + 30秒）
-    this.taskTimeoutTimer = setTimeout(() => {
-      this.logger.warn(`Task execution timeout after ${Math.round(timeoutDuration/1000)}s, stopping...`);
-      this.stopExecution();
+    // 设置任务超时保护（时间线总时长 + 30秒）
+    state.timeoutTimer = setTimeout(() => {
+      this.logger.warn(`Task ${task.name} execution timeout after ${Math.round(timeoutDuration/1000)}s, stopping...`);
+      this.stopTask(executionId);
     }, timeoutDuration);
 
-    this.logger.info(`Task execution started with state machine approach`);
+    // 安排第一批事件
+    this.scheduleNextBatch(state);
+
+    this.logger.info(`Task execution started with compiled timeline (${compiled.events.length} events, ${compiled.durationMs}ms, ${this.executions.size} running)`);
+    return { admitted: true, executionId, preempted };
   }
 
   /**
-   * 计算任务预计时长（毫秒）- 简化版本
+   * 编译任务时间线（不执行），用于预览与校验
    */
-  private calculateTaskDuration(task: Task): number {
-    // 简化计算：假设每个步骤平均5秒，每个循环额外加时间
-    let totalDuration = 0;
-
-    task.steps.forEach(step => {
-      // 基础步骤时间：5秒
-      let stepDuration = 5000;
-
-      // 每个动作额外加1秒
-      stepDuration += step.actions.length * 1000;
-
-      // 每个循环根据迭代次数计算
-      step.parallelLoops.forEach(loop => {
-        const iterations = (loop as any).iterations || 1;
-        const interval = (loop as any).interval || 1000;
-        stepDuration += iterations * interval;
-      });
+  previewTimeline(task: Task): CompiledTask {
+    return compileTask(task);
+  }
 
-      totalDuration += stepDuration;
-    });
+  /**
+   * 停止单个任务：停止调度并关闭它当前驱动的设备，其他任务不受影响
+   */
+  stopTask(executionId: string): boolean {
+    const state = this.executions.get(executionId);
+    if (!state) return false;
+
+    const ownedDevices = this.arbiter.ownedDevices(executionId);
+    this.endExecution(state);
+
+    // 关闭命令与本轮其他任务的命令一起发送；设备回到其他任务时由其后续事件接管
+    for (const deviceId of ownedDevices) {
+      const actionType = state.compiled.events.find(event => event.deviceId === deviceId)?.actionType ?? 'power';
+      this.pendingCommands.push({
+        id: `stop_${executionId}_${deviceId}`,
+        deviceId,
+        actionType,
+        value: actionType === 'power' ? 0 : false,
+        duration: 0,
+        name: 'stop'
+      });
+    }
+    this.flushCommands();
 
-    // 最小5秒，最大30分钟
-    return Math.max(5000, Math.min(totalDuration, 30 * 60 * 1000));
+    this.logger.info(`Task ${state.task.name} stopped, released ${ownedDevices.length} devices`);
+    return true;
   }
 
   /**
-   * 停止执行
+   * 停止所有任务的调度
    */
   stopExecution(): void {
-    if (this.executionTimer) {
-      clearInterval(this.executionTimer);
-      this.executionTimer = null;
-    }
-    if (this.taskTimeoutTimer) {
-      clearTimeout(this.taskTimeoutTimer);
-      this.taskTimeoutTimer = null;
+    for (const state of [...this.executions.values()]) {
+      this.endExecution(state);
     }
-    this.isRunning = false;
+    this.scheduler.clear();
+    this.pendingCommands = [];
+    this.batchLatenessMs = 0;
+    this.batchExecuteAt = null;
     this.logger.info('Task execution stopped');
   }
 
-
-
   /**
-   * 启动调度器 - 每100ms检查一次（状态机版本）
+   * 急停：停止所有任务的调度并立即让Arduino关闭所有输出、取消固件上的定时任务
    */
-  private startScheduler(): void {
-    this.isRunning = true;
-
-    this.executionTimer = setInterval(() => {
-      if (!this.executionState || this.executionState.isCompleted) {
-        this.logger.info('Task completed, stopping scheduler');
-        this.stopExecution();
-        return;
-      }
-
-      const now = Date.now();
-      const commandsToExecute: TaskAction[] = [];
-
-      // 检查普通动作是否需要执行（只在步骤开始时执行一次）
-      this.checkDirectActions(now, commandsToExecute);
-
-      // 检查延时是否到期
-      this.checkDelays(now, commandsToExecute);
+  async emergencyStop(): Promise<EmergencyStopResult> {
+    this.stopExecution();
 
-      // 检查循环是否该执行
-      this.checkLoops(now, commandsToExecute);
+    // 尚未发出的命令不再发送、在途批次的结果不再处理，避免急停后输出被重新打开
+    const clearedCommands = this.dispatcher.clear();
+    if (clearedCommands > 0) {
+      this.logger.warn(`Emergency stop discarded ${clearedCommands} queued commands`);
+    }
 
-      // 批量执行命令
-      if (commandsToExecute.length > 0) {
-        this.executeCommands(commandsToExecute, now);
-      }
+    const result = await this.emergencyStopChannel.trigger();
 
-      // 检查当前步骤是否完成
-      this.checkStepCompletion(now);
+    this.logService.logArduino('send', `Emergency stop ${result.acknowledged ? 'acknowledged' : 'NOT acknowledged'} via ${result.via}`, {
+      ...result,
+      responseTime: result.latencyMs
+    });
 
-    }, 100); // 每100ms检查一次
+    return result;
   }
 
-
-
   /**
-   * 发送命令到Arduino
+   * 应用命令确认中的状态快照 {v, up, dm, d: [[值, 激活, 剩余ms], ...]}，d 按该控制板的设备表顺序
    */
-  private async sendToArduino(payload: ArduinoPayload): Promise<void> {
-    const startTime = Date.now();
-
-    try {
-      // 记录发送日志
-      this.logService.logArduino('send', `Sending ${payload.cmds.length} commands to Arduino`, {
-        commandCount: payload.cmds.length,
-        commands: payload.cmds.map(cmd => `${cmd.dev}:${cmd.act}=${cmd.val}`),
-        timestamp: payload.ts,
-        commandId: payload.id
-      });
-
-      // 实际的HTTP请求到Arduino，带超时控制
-      const controller = new AbortController();
-      const timeoutId = setTimeout(() => controller.abort(), 5000);
-
-      const baseUrl = process.env.ARDUINO_BASE_URL || 'http://192.168.4.1';
-      const response = await fetch(`${baseUrl}/api/commands`, {
-        method: 'POST',
-        headers: {
-          'Content-Type': 'application/json',
-          'Accept': 'application/json'
-        },
-        body: JSON.stringify(payload),
-        signal: controller.signal
-      });
-
-      clearTimeout(timeoutId);
-
-      const responseTime = Date.now() - startTime;
-
-      if (!response.ok) {
-        throw new Error(`Arduino HTTP ${response.status}: ${response.statusText}`);
-      }
-
-      const result = await response.json();
-
-      // 记录接收日志
-      this.logService.logArduino('receive', `Arduino responded successfully`, {
-        responseTime,
-        result,
-        status: response.status
-      });
-
-      // 同时记录到控制台
-      this.logger.info('Arduino commands sent successfully:', {
-        commandCount: payload.cmds.length,
-        responseTime: `${responseTime}ms`,
-        status: response.status,
-        commandId: payload.id
-      });
-
-    } catch (error) {
-      const responseTime = Date.now() - startTime;
-
-      // 记录错误日志
-      this.logService.logArduino('send', `Arduino communication failed`, {
-        error: error instanceof Error ? error.message : String(error),
-        responseTime,
-        payload,
-        isTimeout: error instanceof Error && error.name === 'AbortError'
-      });
-
-      // 同时记录到控制台，便于调试
-      this.logger.error('Arduino communication failed:', {
-        error: error instanceof Error ? error.message : String(error),
-        responseTime,
-        isTimeout: error instanceof Error && error.name === 'AbortError',
-        payload: {
-          timestamp: payload.ts,
-          commandCount: payload.cmds.length,
-          commandId: payload.id
-        }
-      });
+  private applyAckSnapshot(boardId: string, state: any): void {
+    const deviceOrder = this.firmwareManifest?.getBoard(boardId)?.deviceOrder;
+    if (!state || !Array.isArray(state.d) || !deviceOrder || !this.deviceControlService) return;
+
+    const snapshot: FirmwareStateSnapshot = {
+      boardId,
+      version: Number(state.v) || 0,
+      uptimeMs: Number(state.up) || 0,
+      dutyMax: Number(state.dm) || 255,
+      devices: state.d.map((entry: number[]) => ({
+        value: Number(entry[0]) || 0,
+        isActive: entry[1] === 1,
+        remainingMs: Number(entry[2]) || 0
+      }))
+    };
 
-      // 不抛出错误，继续执行其他命令
-    }
+    this.deviceControlService.applyFirmwareSnapshot(snapshot, deviceOrder);
   }
 
   /**
-   * 获取调度状态（状态机版本）
+   * 获取调度状态（含事件迟到统计与各控制板的命令传输统计）
+   * 顶层字段描述最早开始且仍在执行的任务（没有时为最近结束的任务），tasks 列出所有正在执行的任务
    */
   getScheduleStatus() {
-    if (!this.executionState) {
-      return {
-        isRunning: this.isRunning,
+    const running = [...this.executions.values()];
+    const primary = running[0] ?? this.lastExecution;
+
+    return {
+      isRunning: running.length > 0,
+      ...(primary ? this.describeExecution(primary) : {
+        executionId: null,
+        taskName: null,
+        priority: 0,
         totalSteps: 0,
         currentStep: 0,
-        activeLoops: 0,
-        pendingDelays: 0,
+        totalEvents: 0,
+        pendingEvents: 0,
+        suppressedEvents: 0,
+        elapsedMs: 0,
+        durationMs: 0,
         isCompleted: true
-      };
-    }
-
-    const activeLoops = this.executionState.loops.filter(loop =>
-      loop.iteration < loop.totalIterations
-    ).length;
+      }),
+      tasks: running.map(state => ({ ...this.describeExecution(state), devices: this.arbiter.ownedDevices(state.executionId) })),
+      deviceOwners: this.arbiter.getOwners(),
+      lateness: this.scheduler.getLatenessStats(),
+      alignmentLeadMs: this.dispatcher.getAlignmentLeadMs(),
+      boards: this.dispatcher.getStats()
+    };
+  }
 
-    const pendingDelays = this.executionState.delays.filter(delay =>
-      !delay.triggered
-    ).length;
+  private describeExecution(state: ExecutionState) {
+    const { task, compiled, startTime, cursor, isCompleted } = state;
+    const elapsedMs = isCompleted
+      ? compiled.durationMs
+      : Math.min(compiled.durationMs, Math.max(0, Math.round(this.scheduler.now() - startTime)));
 
     return {
-      isRunning: this.isRunning,
-      totalSteps: this.executionState.task.steps.length,
-      currentStep: this.executionState.stepIndex + 1,
-      activeLoops,
-      pendingDelays,
-      isCompleted: this.executionState.isCompleted
+      executionId: state.executionId as string | null,
+      taskName: task.name as string | null,
+      priority: state.priority,
+      totalSteps: task.steps.length,
+      currentStep: task.steps.length > 0 ? findStepAt(compiled, elapsedMs) + 1 : 0,
+      totalEvents: compiled.events.length,
+      pendingEvents: compiled.events.length - cursor,
+      suppressedEvents: state.suppressedEvents,
+      elapsedMs,
+      durationMs: compiled.durationMs,
+      isCompleted
     };
   }
 
   /**
-   * 生成命令ID
+   * 生成执行ID
    */
-  private generateCommandId(): string {
-    return `cmd_${Date.now()}_${Math.random().toString(36).substring(2, 9)}`;
+  private generateExecutionId(): string {
+    return `exec_${Date.now()}_${Math.random().toString(36).substring(2, 9)}`;
   }
 
   /**
@@ -306,201 +308,116 @@ export class TaskExecutionService {
   /**
    * 初始化执行状态
    */
-  private initializeExecutionState(task: Task, startTime: number): ExecutionState {
-    const firstStep = task.steps[0];
-    if (!firstStep) {
-      return {
-        task,
-        stepIndex: 0,
-        stepStartTime: startTime,
-        delays: [],
-        loops: [],
-        directActionsExecuted: false,
-        isCompleted: true
-      };
-    }
-
+  private initializeExecutionState(executionId: string, task: Task, priority: number, compiled: CompiledTask, startTime: number, leadMs: number): ExecutionState {
     return {
+      executionId,
       task,
+      priority,
+      compiled,
+      startTime,
+      leadMs,
+      cursor: 0,
       stepIndex: 0,
-      stepStartTime: startTime,
-      delays: this.initializeDelayStates(firstStep, startTime),
-      loops: this.initializeLoopStates(firstStep, startTime),
-      directActionsExecuted: false,
-      isCompleted: false
+      isCompleted: false,
+      hasPending: false,
+      pendingStep: 0,
+      suppressedEvents: 0,
+      eventId: null,
+      timeoutTimer: null
     };
   }
 
   /**
-   * 初始化延时状态
+   * 安排游标处的下一批事件（提前 leadMs 触发）；时间线走完后在任务结束时刻安排完成事件
+   * 任一时刻调度器中每个任务只有一个事件
    */
-  private initializeDelayStates(step: Step, stepStartTime: number): DelayState[] {
-    const delayStates: DelayState[] = [];
-
-    for (const action of step.actions) {
-      if ('type' in action && action.type === 'delay') {
-        const delayAction = action as DelayAction;
-        delayStates.push({
-          endTime: stepStartTime + delayAction.delayMs,
-          triggered: false,
-          actions: delayAction.actions,
-          parallelLoops: delayAction.parallelLoops
-        });
-      }
-    }
+  private scheduleNextBatch(state: ExecutionState): void {
+    const { events, durationMs } = state.compiled;
+    const next = events[state.cursor];
 
-    return delayStates;
+    state.eventId = next
+      ? this.scheduler.schedule(state.startTime + next.offsetMs - state.leadMs, event => this.runBatch(state, event), 'timeline')
+      : this.scheduler.schedule(state.startTime + durationMs, event => this.completeTimeline(state, event), 'complete');
   }
 
   /**
-   * 初始化循环状态
+   * 记录事件迟到量与计划执行时刻；任务已结束时返回false
    */
-  private initializeLoopStates(step: Step, stepStartTime: number): LoopState[] {
-    const loopStates: LoopState[] = [];
-
-    for (const loop of step.parallelLoops) {
-      loopStates.push({
-        iteration: 0,
-        subStep: 0,
-        nextTime: stepStartTime,
-        subStepEndTime: null,
-        totalIterations: loop.iterations,
-        intervalMs: loop.intervalMs,
-        loop: loop
-      });
-    }
+  private beginEvent(state: ExecutionState, event: FiredEvent): boolean {
+    state.eventId = null;
+    if (state.isCompleted) return false;
 
-    return loopStates;
+    this.batchLatenessMs = Math.max(this.batchLatenessMs, event.latenessMs);
+    if (state.leadMs > 0) {
+      this.batchExecuteAt = Math.max(this.batchExecuteAt ?? -Infinity, event.dueAt + state.leadMs);
+    }
+    return true;
   }
 
   /**
-   * 检查普通动作是否需要执行
+   * 执行同一时刻、同一步骤的所有事件
+   * 跨步骤时先单独发送上一步骤的命令，保持步骤之间的顺序；设备由其他任务驱动时跳过
    */
-  private checkDirectActions(now: number, commandsToExecute: TaskAction[]): void {
-    if (!this.executionState || this.executionState.directActionsExecuted) return;
+  private runBatch(state: ExecutionState, event: FiredEvent): void {
+    if (!this.beginEvent(state, event)) return;
 
-    const currentStep = this.executionState.task.steps[this.executionState.stepIndex];
-    if (!currentStep) return;
+    const { events } = state.compiled;
+    const { offsetMs, stepIndex } = events[state.cursor];
 
-    // 收集步骤中的普通动作（非延时、非循环）
-    for (const action of currentStep.actions) {
-      if (!('type' in action)) {
-        // 这是普通动作
-        commandsToExecute.push(action as TaskAction);
-      }
+    if (state.hasPending && state.pendingStep !== stepIndex) {
+      this.flushCommands();
     }
-
-    // 标记普通动作已执行
-    if (commandsToExecute.length > 0) {
-      this.executionState.directActionsExecuted = true;
-      this.logger.info(`[SCHEDULER] Executing ${commandsToExecute.length} direct actions`);
+    if (stepIndex !== state.stepIndex) {
+      state.stepIndex = stepIndex;
+      this.logger.info(`[${state.task.name}] Advanced to step ${stepIndex + 1}: ${state.task.steps[stepIndex].name}`);
     }
-  }
 
-  /**
-   * 检查延时是否到期
-   */
-  private checkDelays(now: number, commandsToExecute: TaskAction[]): void {
-    if (!this.executionState) return;
-
-    for (const delayState of this.executionState.delays) {
-      if (!delayState.triggered && now >= delayState.endTime) {
-        delayState.triggered = true;
-
-        // 执行延时内的直接动作
-        for (const action of delayState.actions) {
-          if (!('type' in action)) {
-            commandsToExecute.push(action as TaskAction);
-          }
-        }
-
-        // 初始化延时内的循环
-        for (const loop of delayState.parallelLoops) {
-          this.executionState.loops.push({
-            iteration: 0,
-            subStep: 0,
-            nextTime: now,
-            subStepEndTime: null,
-            totalIterations: loop.iterations,
-            intervalMs: loop.intervalMs,
-            loop: loop
-          });
-        }
+    state.pendingStep = stepIndex;
+    while (state.cursor < events.length && events[state.cursor].offsetMs === offsetMs && events[state.cursor].stepIndex === stepIndex) {
+      const timelineEvent = events[state.cursor++];
+      if (!this.arbiter.owns(state.executionId, timelineEvent.deviceId)) {
+        state.suppressedEvents++;
+        continue;
       }
+      this.pendingCommands.push(timelineEvent.action);
+      state.hasPending = true;
     }
+
+    this.scheduleNextBatch(state);
   }
 
   /**
-   * 检查循环是否该执行
+   * 时间线结束：发送剩余命令并完成任务
    */
-  private checkLoops(now: number, commandsToExecute: TaskAction[]): void {
-    if (!this.executionState) return;
-
-    for (const loopState of this.executionState.loops) {
-      // 检查是否该执行下一个子步骤
-      if (now >= loopState.nextTime && loopState.iteration < loopState.totalIterations) {
-
-        // 如果有子步骤正在执行，检查是否完成
-        if (loopState.subStepEndTime !== null && now < loopState.subStepEndTime) {
-          // 子步骤还在执行中，跳过
-          continue;
-        }
-
-        const currentSubStep = loopState.loop.subSteps[loopState.subStep];
-
-        if (currentSubStep) {
-          // 收集当前子步骤的所有动作
-          for (const action of currentSubStep.actions) {
-            if (!('type' in action)) {
-              commandsToExecute.push(action as TaskAction);
-            }
-          }
-
-          // 计算子步骤结束时间
-          const durations = currentSubStep.actions.map(action =>
-            ('type' in action) ? 0 : (action as TaskAction).duration
-          );
-          const maxDuration = durations.length > 0 ? Math.max(...durations) : 0;
-          loopState.subStepEndTime = now + maxDuration;
-
-          this.logger.info(`[SCHEDULER] Loop ${loopState.iteration + 1}/${loopState.totalIterations}, SubStep ${loopState.subStep + 1}/${loopState.loop.subSteps.length}, Duration: ${maxDuration}ms`);
-        }
-
-        // 推进循环状态
-        this.advanceLoopState(loopState, now);
-      }
-    }
+  private completeTimeline(state: ExecutionState, event: FiredEvent): void {
+    if (!this.beginEvent(state, event)) return;
+
+    this.flushCommands();
+    this.finishExecution(state);
   }
 
   /**
-   * 推进循环状态
+   * 发送本轮事件产生的命令（调度器每轮触发结束后调用），所有任务的命令合并为一个批次
    */
-  private advanceLoopState(loopState: LoopState, now: number): void {
-    loopState.subStep++;
-
-    // 如果当前循环的所有子步骤都完成了
-    if (loopState.subStep >= loopState.loop.subSteps.length) {
-      loopState.iteration++;
-      loopState.subStep = 0;
-
-      // 如果还有更多迭代，设置下次执行时间为当前子步骤完成后 + 间隔
-      if (loopState.iteration < loopState.totalIterations) {
-        // 等待当前子步骤完成，然后加上循环间隔
-        const nextIterationTime = (loopState.subStepEndTime || now) + loopState.intervalMs;
-        loopState.nextTime = nextIterationTime;
-
-        this.logger.info(`[SCHEDULER] Loop iteration ${loopState.iteration} completed, next iteration at ${new Date(nextIterationTime).toLocaleTimeString()}`);
-      }
-    } else {
-      // 继续下一个子步骤，等待当前子步骤完成
-      loopState.nextTime = loopState.subStepEndTime || now;
+  private flushCommands(): void {
+    for (const state of this.executions.values()) {
+      state.hasPending = false;
     }
+    if (this.pendingCommands.length === 0) return;
+
+    const commands = this.pendingCommands;
+    const latenessMs = this.batchLatenessMs;
+    const executeAt = this.batchExecuteAt;
+    this.pendingCommands = [];
+    this.batchLatenessMs = 0;
+    this.batchExecuteAt = null;
+    this.executeCommands(commands, Date.now(), latenessMs, executeAt);
   }
 
   /**
-   * 执行命令（状态机版本）
+   * 执行命令
    */
-  private executeCommands(commands: TaskAction[], timestamp: number): void {
+  private executeCommands(commands: TaskAction[], timestamp: number, latenessMs: number, executeAt: number | null): void {
     // 按设备分组，处理同设备的冲突
     const deviceCommands = new Map<string, TaskAction>();
 
@@ -514,92 +431,128 @@ export class TaskExecutionService {
 
     const finalCommands = Array.from(deviceCommands.values());
 
-    // 生成命令ID
-    const commandId = this.generateCommandId();
-
-    // 构造Arduino期望的压缩格式
-    const arduinoPayload = {
-      id: commandId,
-      ts: timestamp,
-      cmds: finalCommands.map(cmd => ({
-        dev: cmd.deviceId,
-        act: this.mapActionType(cmd.actionType),
-        val: cmd.value,
-        dur: cmd.duration
-      }))
-    };
-
-    // 发送到Arduino
-    this.sendToArduino(arduinoPayload);
-
-    // 详细日志
-    this.logger.info(`[SCHEDULER] ${new Date(timestamp).toISOString()}`);
-    this.logger.info(`  - Executing ${finalCommands.length} commands`);
-    finalCommands.forEach(cmd => {
-      this.logger.info(`  - ${cmd.deviceId}: ${cmd.actionType}=${cmd.value} (${cmd.duration}ms)`);
-    });
+    // 按控制板拆分后交给各自的传输层按顺序发送；链路慢时同设备的排队命令被新命令覆盖
+    this.dispatcher.dispatch(finalCommands, timestamp, executeAt);
+
+    // 每轮一条结构化记录，只在开启 debug 时构建
+    if (this.logger.isDebugEnabled()) {
+      this.logger.debug('[SCHEDULER] Executing commands', {
+        timestamp,
+        latenessMs,
+        commands: finalCommands.map(cmd => ({
+          deviceId: cmd.deviceId,
+          actionType: cmd.actionType,
+          value: cmd.value,
+          duration: cmd.duration
+        }))
+      });
+    }
   }
 
   /**
-   * 检查步骤完成状态
+   * 编码命令（同一控制板）：动作/值/时长相同的多个设备合并为一条位掩码命令 {msk, act, val, dur}
+   * 没有固件清单、设备不在清单中或控制板尚未上报一致的清单哈希时回退为逐设备命令 {dev, act, val, dur}
+   * 带波形配置的PWM动作附加 prf，由固件本地生成占空比
    */
-  private checkStepCompletion(now: number): void {
-    if (!this.executionState) return;
-
-    const currentStep = this.executionState.task.steps[this.executionState.stepIndex];
-    if (!currentStep) {
-      this.executionState.isCompleted = true;
-      return;
+  private encodeCommands(commands: TaskAction[]): ArduinoCommand[] {
+    const buckets = new Map<string, TaskAction[]>();
+    for (const cmd of commands) {
+      const profileKey = cmd.profile
+        ? `${cmd.profile.shape}:${cmd.profile.periodMs}:${cmd.profile.amplitude}:${cmd.profile.offset}:${cmd.profile.cycles}`
+        : '';
+      const key = `${cmd.actionType}|${cmd.value}|${cmd.duration}|${profileKey}`;
+      const bucket = buckets.get(key);
+      if (bucket) {
+        bucket.push(cmd);
+      } else {
+        buckets.set(key, [cmd]);
+      }
     }
 
-    // 检查所有延时是否都已触发
-    const allDelaysTriggered = this.executionState.delays.every(delay => delay.triggered);
-
-    // 检查所有循环是否都已完成
-    const allLoopsCompleted = this.executionState.loops.every(loop =>
-      loop.iteration >= loop.totalIterations
-    );
+    const encoded: ArduinoCommand[] = [];
+    for (const bucket of buckets.values()) {
+      const { actionType, value, duration, profile } = bucket[0];
+      const prf = profile ? this.encodeProfile(profile) : undefined;
+      const mask = bucket.length > 1 && this.canUseDeviceMask(bucket[0].deviceId)
+        ? this.firmwareManifest!.getDeviceMask(bucket.map(cmd => cmd.deviceId))
+        : null;
+
+      if (mask !== null) {
+        encoded.push({ msk: mask, act: this.mapActionType(actionType), val: value, dur: duration, ...(prf && { prf }) });
+        continue;
+      }
 
-    // 如果当前步骤完成，推进到下一步骤
-    if (allDelaysTriggered && allLoopsCompleted) {
-      this.advanceToNextStep(now);
+      for (const cmd of bucket) {
+        encoded.push({ dev: cmd.deviceId, act: this.mapActionType(cmd.actionType), val: cmd.value, dur: cmd.duration, ...(prf && { prf }) });
+      }
     }
+
+    return encoded;
   }
 
   /**
-   * 推进到下一步骤
+   * 位掩码按固件设备表索引寻址，只在控制板运行的固件与清单一致时使用
    */
-  private advanceToNextStep(now: number): void {
-    if (!this.executionState) return;
-
-    this.executionState.stepIndex++;
+  private canUseDeviceMask(deviceId: string): boolean {
+    const boardId = this.firmwareManifest?.getBoardOf(deviceId);
+    return !!boardId && this.firmwareManifest!.isBoardVerified(boardId);
+  }
 
-    if (this.executionState.stepIndex >= this.executionState.task.steps.length) {
-      // 任务完成
-      this.executionState.isCompleted = true;
-      this.logger.info('Task execution completed');
-      return;
-    }
+  /**
+   * 编码波形配置为固件紧凑格式 {s, p, a, o, n}
+   * s: 0=线性斜坡 1=缓动斜坡 2=方波 3=正弦
+   */
+  private encodeProfile(profile: PwmProfile): ArduinoWaveform {
+    const shapes: PwmProfile['shape'][] = ['ramp', 'ease', 'square', 'sine'];
+    return {
+      s: Math.max(0, shapes.indexOf(profile.shape)),
+      p: Math.max(1, Math.round(profile.periodMs)),
+      a: profile.amplitude,
+      o: profile.offset,
+      n: profile.cycles
+    };
+  }
 
-    // 初始化新步骤
-    const nextStep = this.executionState.task.steps[this.executionState.stepIndex];
-    this.executionState.stepStartTime = now;
-    this.executionState.delays = this.initializeDelayStates(nextStep, now);
-    this.executionState.loops = this.initializeLoopStates(nextStep, now);
+  /**
+   * 任务完成：释放设备并停止超时保护
+   */
+  private finishExecution(state: ExecutionState): void {
+    this.endExecution(state);
+
+    const lateness = this.scheduler.getLatenessStats();
+    this.logger.info(`Task ${state.task.name} execution completed`, lateness);
+    this.logService.logTaskExecution('COMPLETE', 'Task execution completed', {
+      taskId: state.task.id,
+      executionId: state.executionId,
+      suppressedEvents: state.suppressedEvents,
+      lateness
+    });
+  }
 
-    this.logger.info(`Advanced to step ${this.executionState.stepIndex + 1}: ${nextStep.name}`);
+  /**
+   * 结束任务：取消其调度事件与超时保护，释放设备
+   */
+  private endExecution(state: ExecutionState): void {
+    state.isCompleted = true;
+    if (state.eventId !== null) {
+      this.scheduler.cancel(state.eventId);
+      state.eventId = null;
+    }
+    if (state.timeoutTimer) {
+      clearTimeout(state.timeoutTimer);
+      state.timeoutTimer = null;
+    }
+    this.arbiter.release(state.executionId);
+    this.executions.delete(state.executionId);
+    this.lastExecution = state;
   }
 }
 
-// ==================== 类型定义 ====================
-
-interface ArduinoPayload {
-  id: string;
-  ts: number;
-  cmds: Array<{
-    dev: string;
-    act: string;
-    val: any;
-    dur: number;
-  }>;
-}
+// 在调度线程中运行时，日志与设备状态更新经消息转发回主线程
+export type TaskExecutionLogSink = Pick<UnifiedLogService, 'logTaskExecution' | 'logArduino'>;
+
+export type ScheduleStatus = ReturnType<TaskExecutionService['getScheduleStatus']>;
+
+export type TaskAdmission =
+  | { admitted: true; executionId: string; preempted: DeviceConflict[] }
+  | { admitted: false; conflicts: DeviceConflict[] };
@@ -1,44 +1,78 @@
 import { Logger } from 'winston';
 import { EventEmitter } from 'events';
+import { LogStore } from './logging/LogStore';
+import { LogSegmentStore } from './logging/LogSegmentStore';
+import type { LogSegmentStoreConfig, LogSegmentStoreStats } from './logging/LogSegmentStore';
+import { AsyncLogSink } from './logging/AsyncLogSink';
+import type { AsyncLogSinkStats } from './logging/AsyncLogSink';
 
 /**
  * 统一日志服务
  * 收集来自后端、Arduino、前端的所有日志
+ * 最近的日志保存在内存环形存储中，全部日志追加写入分段文件，更早的查询从文件读取
+ * 写入 Winston（控制台与文件）由异步批量输出在后台进行，记录日志的调用方只付出入队的开销
  */
 export class UnifiedLogService extends EventEmitter {
-  private logs: LogEntry[] = [];
-  private maxLogs = 10000; // 最多保存10000条日志
+  private maxLogs = 10000; // 最多保存10000条日志，超出时覆盖最旧的
+  private store = new LogStore(this.maxLogs);
+  private segments: LogSegmentStore;
+  private winstonSink: AsyncLogSink<LogEntry>;
   private sources = new Set<string>();
+  private epoch = `${Date.now().toString(36)}${Math.random().toString(36).substring(2, 6)}`; // 序号所属的实例，重启后序号重新开始
 
-  constructor(private logger: Logger) {
+  constructor(private logger: Logger, storageConfig: Partial<LogSegmentStoreConfig> = {}) {
     super();
+    this.segments = new LogSegmentStore(logger, storageConfig);
+    this.winstonSink = new AsyncLogSink(entries => entries.forEach(entry => this.writeToWinston(entry)));
     this.sources.add('backend');
     this.sources.add('arduino');
     this.sources.add('frontend');
   }
 
+  /**
+   * 打开日志文件，把最近的日志恢复到内存（重启后仍可查看）
+   */
+  async initialize(): Promise<void> {
+    try {
+      await this.segments.open();
+      const history = await this.segments.readRecent(this.maxLogs);
+
+      // 恢复期间产生的日志排在历史之后
+      const current = this.store.query({}, 0, this.maxLogs).logs.reverse();
+      this.store.clear();
+      [...history, ...current].forEach(entry => { entry.seq = this.store.append(entry); });
+      this.logger.info(`Restored ${history.length} log entries from disk`);
+    } catch (error) {
+      this.logger.warn('Failed to open log storage, logs are kept in memory only:', error);
+    }
+  }
+
+  /**
+   * 写入缓冲的日志（进程退出前调用）
+   */
+  async close(): Promise<void> {
+    this.winstonSink.flush();
+    await this.segments.close();
+  }
+
   /**
    * 添加日志条目
    */
-  addLog(entry: Omit<LogEntry, 'id' | 'timestamp'>): void {
+  addLog(entry: Omit<LogEntry, 'id' | 'timestamp' | 'seq'>): void {
     const logEntry: LogEntry = {
       id: this.generateLogId(),
       timestamp: Date.now(),
       ...entry
     };
 
-    this.logs.unshift(logEntry); // 新日志在前面
-
-    // 限制日志数量
-    if (this.logs.length > this.maxLogs) {
-      this.logs = this.logs.slice(0, this.maxLogs);
-    }
+    logEntry.seq = this.store.append(logEntry);
+    this.segments.append(logEntry);
 
     // 广播新日志
     this.emit('newLog', logEntry);
 
-    // 同时写入Winston日志
-    this.writeToWinston(logEntry);
+    // 同时写入Winston日志（后台批量）
+    this.winstonSink.enqueue(logEntry, logEntry.level === 'error' || logEntry.level === 'warn');
   }
 
   /**
@@ -117,42 +151,12 @@ export class UnifiedLogService extends EventEmitter {
       search
     } = options;
 
-    let filteredLogs = [...this.logs];
-
-    // 按级别过滤
-    if (level) {
-      filteredLogs = filteredLogs.filter(log => log.level === level);
-    }
-
-    // 按来源过滤
-    if (source) {
-      filteredLogs = filteredLogs.filter(log => log.source === source);
-    }
-
-    // 按分类过滤
-    if (category) {
-      filteredLogs = filteredLogs.filter(log => log.category === category);
-    }
-
-    // 按时间范围过滤
-    if (startTime) {
-      filteredLogs = filteredLogs.filter(log => log.timestamp >= startTime);
-    }
-    if (endTime) {
-      filteredLogs = filteredLogs.filter(log => log.timestamp <= endTime);
-    }
-
-    // 按关键词搜索
-    if (search) {
-      const searchLower = search.toLowerCase();
-      filteredLogs = filteredLogs.filter(log => 
-        log.message.toLowerCase().includes(searchLower) ||
-        (log.meta && JSON.stringify(log.meta).toLowerCase().includes(searchLower))
-      );
-    }
-
-    const total = filteredLogs.length;
-    const paginatedLogs = filteredLogs.slice(offset, offset + limit);
+    // 按级别/来源/分类索引与时间范围定位，新日志在前
+    const { logs: paginatedLogs, total } = this.store.query(
+      { level, source, category, startTime, endTime, search },
+      offset,
+      limit
+    );
 
     return {
       logs: paginatedLogs,
@@ -163,6 +167,59 @@ export class UnifiedLogService extends EventEmitter {
     };
   }
 
+  /**
+   * 查询日志：内存覆盖查询范围时直接返回，否则（起始时间早于内存中最旧的日志，或翻页超出内存中的匹配）从文件读取
+   * 第一页的匹配不足 limit 条时仍由内存回答；内存已淘汰过日志时 hasMore 为 true，继续翻页即读取文件
+   */
+  async queryLogs(options: GetLogsOptions = {}): Promise<LogQueryResult> {
+    const memory = this.getLogs(options);
+    const { limit = 100, offset = 0, startTime } = options;
+    const oldest = this.store.oldestTimestamp();
+    const beforeMemory = startTime !== undefined && (oldest === null || startTime < oldest);
+    const pastMemory = this.store.isFull && offset > 0 && offset + limit > memory.total;
+
+    if (!beforeMemory && !pastMemory) {
+      return { ...memory, hasMore: memory.hasMore || this.store.isFull, storage: 'memory' };
+    }
+
+    try {
+      const { logs, total, truncated } = await this.segments.query(options, offset, limit);
+      return {
+        logs,
+        total,
+        limit,
+        offset,
+        hasMore: offset + limit < total || truncated,
+        storage: 'disk',
+        ...(truncated && { truncated })
+      };
+    } catch (error) {
+      this.logger.warn('Failed to query logs from disk:', error);
+      return { ...memory, storage: 'memory' };
+    }
+  }
+
+  /**
+   * 日志流当前位置：实例标识与最新一条的序号
+   */
+  getStreamPosition(): { epoch: string; seq: number } {
+    return { epoch: this.epoch, seq: this.store.lastSeq };
+  }
+
+  /**
+   * 序号大于 seq 的内存日志（旧的在前）；其中有日志已被淘汰或清空时返回null
+   */
+  getLogsSince(seq: number): LogEntry[] | null {
+    return this.store.since(seq);
+  }
+
+  /**
+   * 最近满足条件的内存日志，新日志在前
+   */
+  findRecentLogs(predicate: (entry: LogEntry) => boolean, limit: number): LogEntry[] {
+    return this.store.findRecent(predicate, limit);
+  }
+
   /**
    * 获取日志统计
    */
@@ -171,26 +228,17 @@ export class UnifiedLogService extends EventEmitter {
     const oneHourAgo = now - 60 * 60 * 1000;
     const oneDayAgo = now - 24 * 60 * 60 * 1000;
 
-    const recentLogs = this.logs.filter(log => log.timestamp >= oneHourAgo);
-    const dailyLogs = this.logs.filter(log => log.timestamp >= oneDayAgo);
-
-    const levelCounts = this.logs.reduce((acc, log) => {
-      acc[log.level] = (acc[log.level] || 0) + 1;
-      return acc;
-    }, {} as Record<LogLevel, number>);
-
-    const sourceCounts = this.logs.reduce((acc, log) => {
-      acc[log.source] = (acc[log.source] || 0) + 1;
-      return acc;
-    }, {} as Record<string, number>);
-
+    // 计数由索引维护，时间窗口二分查找
     return {
-      total: this.logs.length,
-      recentCount: recentLogs.length,
-      dailyCount: dailyLogs.length,
-      levelCounts,
-      sourceCounts,
-      sources: Array.from(this.sources)
+      total: this.store.size,
+      recentCount: this.store.countSince(oneHourAgo),
+      dailyCount: this.store.countSince(oneDayAgo),
+      levelCounts: this.store.countBy('level') as Record<LogLevel, number>,
+      sourceCounts: this.store.countBy('source'),
+      sources: Array.from(this.sources),
+      indexedTokens: this.store.indexedTokens,
+      winston: this.winstonSink.getStats(),
+      storage: this.segments.getStats()
     };
   }
 
@@ -198,8 +246,8 @@ export class UnifiedLogService extends EventEmitter {
    * 清空日志
    */
   clearLogs(): void {
-    const count = this.logs.length;
-    this.logs = [];
+    const count = this.store.clear();
+    this.segments.clear().catch(error => this.logger.warn('Failed to delete log files:', error));
     this.logger.info(`Cleared ${count} log entries`);
     this.emit('logsCleared', count);
   }
@@ -244,6 +292,7 @@ export class UnifiedLogService extends EventEmitter {
 
 export interface LogEntry {
   id: string;
+  seq?: number;        // 内存中的写入序号，日志流据此续传
   timestamp: number;
   source: 'backend' | 'arduino' | 'frontend';
   level: LogLevel;
@@ -270,7 +319,7 @@ export interface GetLogsOptions {
   category?: LogCategory;
   startTime?: number;
   endTime?: number;
-  search?: string;
+  search?: string;        // 关键词：空格分隔的词前缀均须匹配，`字段:值` 限定 meta 字段或 level/source/category
 }
 
 export interface LogQueryResult {
@@ -279,6 +328,8 @@ export interface LogQueryResult {
   limit: number;
   offset: number;
   hasMore: boolean;
+  storage?: 'memory' | 'disk';   // 结果来自内存中的最近日志或日志文件
+  truncated?: boolean;           // 文件查询达到读取量上限，total 只统计已读取的段
 }
 
 export interface LogStats {
@@ -288,4 +339,7 @@ export interface LogStats {
   levelCounts: Record<LogLevel, number>;
   sourceCounts: Record<string, number>;
   sources: string[];
+  indexedTokens: number;   // 全文索引中的词数
+  winston: AsyncLogSinkStats;
+  storage: LogSegmentStoreStats;
 }
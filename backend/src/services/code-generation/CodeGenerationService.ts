@@ -1,5 +1,7 @@
 import { Logger } from 'winston';
-import type { DeviceConfig } from '../../types/device';
+import type { DeviceConfig, ControlLoopConfig, BoardConfig } from '../../types/device';
+import { encodeControlLoop, getDeviceMaxDuty, PID_FRACTION_BITS } from './ControlLoopCodec';
+import { DEFAULT_BOARD_ID, DEFAULT_BOARD_HOST, computeManifestHash, formatManifestHash } from './FirmwareManifest';
 
 /**
  * 代码生成服务抽象基类
@@ -45,21 +47,99 @@ export abstract class CodeGenerationService {
  * Arduino代码生成服务
  */
 export class ArduinoCodeGenerationService extends CodeGenerationService {
-  private readonly VALID_PWM_PINS = [3, 5, 6, 9, 10, 11];
   private readonly BOARD_TYPE = 'Arduino UNO R4 WiFi';
+  private readonly MAX_MASK_DEVICES = 32; // 分组位掩码为 uint32_t
+  private readonly FIRMWARE_LIBRARY = 'MantaControl';
+  private readonly FIRMWARE_CONFIG_FORMAT = 1;     // 与 MantaControl 的 MANTA_CONFIG_FORMAT 一致
+
+  // UNO R4 WiFi 引脚 -> GPT定时器输出；同一定时器的A/B输出共用周期（频率）
+  private readonly PWM_TIMER_OUTPUTS: Record<number, { timer: number; output: 'A' | 'B' }> = {
+    2: { timer: 1, output: 'B' },
+    3: { timer: 1, output: 'A' },
+    4: { timer: 0, output: 'B' },
+    5: { timer: 0, output: 'A' },
+    6: { timer: 3, output: 'A' },
+    7: { timer: 3, output: 'B' },
+    8: { timer: 7, output: 'A' },
+    9: { timer: 7, output: 'B' },
+    10: { timer: 2, output: 'A' },
+    11: { timer: 6, output: 'A' },
+    12: { timer: 6, output: 'B' },
+    13: { timer: 2, output: 'B' }
+  };
+  private readonly PWM_TIMER_CLOCK_HZ = 48000000;
+  private readonly PWM_DUTY_BITS = 12;            // 占空比分辨率（analogWrite默认仅8位）
+  private readonly PWM_DEFAULT_FREQUENCY = 490;   // 与 analogWrite 默认频率一致
+  private readonly PWM_MIN_FREQUENCY = 10;
+  private readonly PWM_MAX_FREQUENCY = 40000;
+
+  // 传感器：UNO R4 的 A0-A5 对应引脚 14-19，14位ADC
+  private readonly VALID_ADC_PINS = [14, 15, 16, 17, 18, 19];
+  private readonly SENSOR_MAX_CHANNELS = 6;
+  private readonly SENSOR_MAX_RATE_HZ = 10000;    // 所有通道合计，analogRead约20us/次
+  private readonly SENSOR_MIN_WINDOW_MS = 10;
+  private readonly SENSOR_MAX_ID_LENGTH = 32;      // 上传缓冲按此预留每通道头部空间
+  private readonly MAX_CONTROL_LOOPS = 8;
+
+  // 多控制板：主控制板创建热点（192.168.4.1），其他控制板以固定IP加入；后端电脑通常获得 192.168.4.2
+  private readonly BACKEND_HOST = '192.168.4.2';
+  private readonly STATION_HOST_PREFIX = '192.168.4.';
+  private readonly STATION_HOST_START = 10;          // 未配置地址的从站控制板从 .10 起自动分配
+  private readonly BOARD_ID_PATTERN = /^[A-Za-z0-9_-]{1,16}$/;
+
+  /**
+   * 按设备的 boardId 拆分配置，每个控制板生成一份固件，主控制板在前
+   * 单控制板（所有设备都没有 boardId）时结果与 generateCode 相同
+   */
+  async generateFirmware(
+    devices: DeviceConfig[],
+    wifiConfig: WifiConfig,
+    controlLoops: ControlLoopConfig[] = [],
+    boards: BoardConfig[] = []
+  ): Promise<GeneratedCode[]> {
+    const layout = this.resolveBoards(devices, boards);
+    const errors = this.validateBoardLayout(devices, controlLoops, layout);
+    if (errors.length > 0) {
+      throw new Error(`配置验证失败: ${errors.join(', ')}`);
+    }
+
+    const results: GeneratedCode[] = [];
+    for (const board of layout) {
+      const boardDevices = devices.filter(d => this.getBoardId(d) === board.id);
+      const boardLoops = controlLoops.filter(loop => this.getBoardId(devices.find(d => d.id === loop.outputId)) === board.id);
+      try {
+        results.push(await this.generateCode(boardDevices, wifiConfig, boardLoops, board));
+      } catch (error) {
+        throw layout.length > 1 ? new Error(`控制板 ${board.id}: ${(error as Error).message}`) : error;
+      }
+    }
+    return results;
+  }
 
-  async generateCode(devices: DeviceConfig[], wifiConfig: WifiConfig): Promise<GeneratedCode> {
-    this.logger.info(`Generating Arduino code for ${devices.length} devices`);
+  async generateCode(
+    devices: DeviceConfig[],
+    wifiConfig: WifiConfig,
+    controlLoops: ControlLoopConfig[] = [],
+    board: ResolvedBoard = { id: DEFAULT_BOARD_ID, host: DEFAULT_BOARD_HOST, wifiMode: 'ap' }
+  ): Promise<GeneratedCode> {
+    this.logger.info(`Generating Arduino code for board ${board.id}: ${devices.length} devices, ${controlLoops.length} control loops`);
 
     // 验证配置
-    const validation = this.validateArduinoConfig(devices);
+    const validation = this.validateArduinoConfig(devices, controlLoops);
     if (!validation.isValid) {
       throw new Error(`配置验证失败: ${validation.errors.join(', ')}`);
     }
 
+    // 寻址相关的表顺序，其哈希写入固件，后端据此确认控制板运行的是这份固件
+    const outputs = this.getOutputDevices(devices);
+    const deviceOrder = outputs.map(d => d.id);
+    const groupMasks = Object.fromEntries(this.buildGroupMasks(outputs).map(g => [g.id, g.mask]));
+    const loopOrder = controlLoops.map(l => l.id);
+    const manifestHash = computeManifestHash({ deviceOrder, groupMasks, controlLoops: loopOrder });
+
     // 生成代码
-    const code = this.buildArduinoCode(devices, wifiConfig);
-    
+    const code = this.buildArduinoCode(devices, wifiConfig, controlLoops, board, manifestHash);
+
     return {
       code,
       language: 'cpp',
@@ -69,656 +149,527 @@ export class ArduinoCodeGenerationService extends CodeGenerationService {
         deviceCount: devices.length,
         pwmDevices: devices.filter(d => d.type === 'pwm').length,
         digitalDevices: devices.filter(d => d.type === 'digital').length,
+        sensorDevices: devices.filter(d => d.type === 'sensor').length,
         usedPins: devices.map(d => d.pin).sort((a, b) => a - b),
         wifiConfig: {
           ssid: wifiConfig.ssid,
           hasPassword: !!wifiConfig.password
-        }
+        },
+        deviceOrder,
+        groupMasks,
+        controlLoops: loopOrder,
+        manifestHash,
+        firmwareLibrary: this.FIRMWARE_LIBRARY,
+        boardId: board.id,
+        boardHost: board.host,
+        wifiMode: board.wifiMode
       },
       validation
     };
   }
 
+  private getBoardId(device: DeviceConfig | undefined): string {
+    return device?.boardId || DEFAULT_BOARD_ID;
+  }
+
   /**
-   * 验证Arduino特定配置
+   * 确定控制板列表：已配置的控制板按配置顺序，其后为设备引用但未配置的控制板；没有设备的控制板不生成固件
+   * 第一个为主控制板（创建热点），其余为从站，未配置地址时自动分配
    */
-  private validateArduinoConfig(devices: DeviceConfig[]): ValidationResult {
-    const baseValidation = this.validateDevices(devices);
-    const warnings = [...baseValidation.warnings];
+  private resolveBoards(devices: DeviceConfig[], boards: BoardConfig[]): ResolvedBoard[] {
+    const used = [...new Set(devices.map(d => this.getBoardId(d)))];
+    const configured = boards.filter(b => used.includes(b.id));
+    const order = [
+      ...configured.map(b => b.id),
+      ...used.filter(id => !configured.some(b => b.id === id))
+    ];
+    // 未配置时 main 为主控制板
+    if (configured.length === 0 && order.includes(DEFAULT_BOARD_ID)) {
+      order.splice(order.indexOf(DEFAULT_BOARD_ID), 1);
+      order.unshift(DEFAULT_BOARD_ID);
+    }
 
-    // Arduino特定验证
-    devices.forEach(device => {
-      if (device.type === 'pwm' && !this.VALID_PWM_PINS.includes(device.pin)) {
-        warnings.push(`引脚 ${device.pin} 可能不支持PWM (${device.name})`);
+    const takenHosts = new Set(boards.map(b => b.host).filter((host): host is string => !!host));
+    let nextHost = this.STATION_HOST_START;
+
+    return order.map((id, index) => {
+      const config = boards.find(b => b.id === id);
+      if (index === 0) {
+        return { id, name: config?.name, host: DEFAULT_BOARD_HOST, wifiMode: 'ap' };
       }
-    });
 
-    return {
-      ...baseValidation,
-      warnings
-    };
+      let host = config?.host;
+      while (!host) {
+        const candidate = `${this.STATION_HOST_PREFIX}${nextHost++}`;
+        if (!takenHosts.has(candidate)) host = candidate;
+      }
+      takenHosts.add(host);
+      return { id, name: config?.name, host, wifiMode: 'station' };
+    });
   }
 
   /**
-   * 构建Arduino代码
+   * 验证控制板ID、从站地址，以及控制回路的传感器与输出在同一控制板上
    */
-  private buildArduinoCode(devices: DeviceConfig[], wifiConfig: WifiConfig): string {
-    const sections = [
-      this.generateHeader(devices),
-      this.generateIncludes(),
-      this.generateWifiConfig(wifiConfig),
-      this.generateDeviceConfig(devices),
-      this.generateDeviceState(devices),
-      this.generateGlobalVariables(),
-      this.generateSetupFunction(devices),
-      this.generateLoopFunction(),
-      this.generateDeviceFunctions(devices),
-      this.generateHttpHandlers(devices),
-      this.generateUtilityFunctions(devices)
-    ];
-
-    return sections.join('\n\n');
-  }
+  private validateBoardLayout(devices: DeviceConfig[], controlLoops: ControlLoopConfig[], layout: ResolvedBoard[]): string[] {
+    const errors: string[] = [];
+    const hosts = new Map<string, string>();
 
-  private generateHeader(devices: DeviceConfig[]): string {
-    return `/**
- * FishControl 自动生成代码
- * ${this.BOARD_TYPE}专用
- * 
- * 设备配置：
-${devices.map(d => ` * - ${d.name} (${d.id}): 引脚${d.pin} ${d.type.toUpperCase()}`).join('\n')}
- * 
- * 生成时间: ${new Date().toISOString()}
- * 代码生成器版本: 2.0.0
- */`;
-  }
+    layout.forEach(board => {
+      if (!this.BOARD_ID_PATTERN.test(board.id)) {
+        errors.push(`控制板ID ${board.id} 只能包含字母、数字、_ 与 -（最多16个字符）`);
+      }
+      if (board.wifiMode === 'station') {
+        if (!/^\d{1,3}(\.\d{1,3}){3}$/.test(board.host) || board.host.split('.').some(part => Number(part) > 255)) {
+          errors.push(`控制板 ${board.id} 的地址 ${board.host} 不是有效的IPv4地址`);
+        } else if (!board.host.startsWith(this.STATION_HOST_PREFIX)) {
+          errors.push(`控制板 ${board.id} 的地址 ${board.host} 不在主控制板热点网段 ${this.STATION_HOST_PREFIX}0/24 内`);
+        } else if (board.host === DEFAULT_BOARD_HOST || board.host === this.BACKEND_HOST) {
+          errors.push(`控制板 ${board.id} 的地址 ${board.host} 已被${board.host === DEFAULT_BOARD_HOST ? '主控制板' : '后端电脑'}使用`);
+        }
+      }
+      const owner = hosts.get(board.host);
+      if (owner) {
+        errors.push(`控制板 ${board.id} 与 ${owner} 使用同一地址 ${board.host}`);
+      }
+      hosts.set(board.host, board.id);
+    });
 
-  private generateIncludes(): string {
-    return `#include <WiFiS3.h>
-#include <ArduinoJson.h>
+    controlLoops.forEach(loop => {
+      const sensor = devices.find(d => d.id === loop.sensorId);
+      const output = devices.find(d => d.id === loop.outputId);
+      if (sensor && output && this.getBoardId(sensor) !== this.getBoardId(output)) {
+        errors.push(`控制回路 ${loop.name} 的传感器 (${this.getBoardId(sensor)}) 与输出 (${this.getBoardId(output)}) 不在同一控制板上`);
+      }
+    });
 
-// 确保使用正确的库版本
-// WiFiS3: Arduino UNO R4 WiFi专用
-// ArduinoJson: 版本6.x或更高`;
+    return errors;
   }
 
-  private generateWifiConfig(wifiConfig: WifiConfig): string {
-    return `// ==================== WiFi配置 ====================
-const char* ssid = "${wifiConfig.ssid}";
-const char* pass = "${wifiConfig.password}";`;
-  }
+  /**
+   * 验证Arduino特定配置
+   */
+  private validateArduinoConfig(devices: DeviceConfig[], controlLoops: ControlLoopConfig[]): ValidationResult {
+    const baseValidation = this.validateDevices(devices);
+    const warnings = [...baseValidation.warnings];
 
-  private generateDeviceConfig(devices: DeviceConfig[]): string {
-    const sanitizeIdentifier = (id: string) => {
-      // 转为大写，非字母数字转换为下划线，首字符非字母则前缀DEV_
-      let ident = id.toUpperCase().replace(/[^A-Z0-9]/g, '_');
-      if (!/^[A-Z_]/.test(ident)) ident = 'DEV_' + ident;
-      return ident;
-    };
+    // Arduino特定验证
+    const errors = [...baseValidation.errors];
+    const outputs = this.getOutputDevices(devices);
+    if (outputs.length === 0) {
+      errors.push('至少需要配置一个输出设备');
+    }
+    if (outputs.length > this.MAX_MASK_DEVICES) {
+      errors.push(`设备数量 ${outputs.length} 超过分组位掩码上限 ${this.MAX_MASK_DEVICES}`);
+    }
 
-    const constants = devices.map((device, index) => {
-      const constName = sanitizeIdentifier(device.id) + '_PIN';
-      return `const int ${constName} = ${device.pin};   // ${device.name} (device${index + 1})`;
-    }).join('\n');
+    this.validatePwmTimers(devices, errors, warnings);
+    this.validateSensors(devices, errors, warnings);
+    this.validateControlLoops(devices, controlLoops, errors);
 
-    return `// ==================== 设备配置 ====================
-// 设备数量: ${devices.length}
-${constants}`;
+    return {
+      isValid: errors.length === 0,
+      errors,
+      warnings
+    };
   }
 
-  private generateDeviceState(devices: DeviceConfig[]): string {
-    return `// ==================== 设备状态结构 ====================
-struct DeviceState {
-  int currentValue;    // 当前值（PWM: 0-255, 数字: 0/1）
-  bool isActive;       // 是否激活
-  unsigned long endTime; // 结束时间（定时任务用）
-};
-
-DeviceState devices[${devices.length}];
-const char* deviceNames[] = {${devices.map(d => `"${d.id}"`).join(', ')}};
-const int devicePins[] = {${devices.map(d => d.pin).join(', ')}};
-const bool isPWM[] = {${devices.map(d => d.type === 'pwm' ? 'true' : 'false').join(', ')}};`;
-  }
+  /**
+   * 验证PWM频率、功率上限以及引脚/定时器冲突
+   */
+  private validatePwmTimers(devices: DeviceConfig[], errors: string[], warnings: string[]): void {
+    const outputOwners = new Map<string, DeviceConfig>();
+    const timerFrequencies = new Map<number, { frequency: number; device: DeviceConfig }>();
+    const maxFullResolutionHz = this.PWM_TIMER_CLOCK_HZ / 2 ** this.PWM_DUTY_BITS;
+
+    devices.filter(d => d.type === 'pwm').forEach(device => {
+      const frequency = this.getPwmFrequency(device);
+      if (frequency < this.PWM_MIN_FREQUENCY || frequency > this.PWM_MAX_FREQUENCY) {
+        errors.push(`${device.name} 的PWM频率 ${frequency}Hz 超出范围 ${this.PWM_MIN_FREQUENCY}-${this.PWM_MAX_FREQUENCY}Hz`);
+      } else if (frequency > maxFullResolutionHz) {
+        warnings.push(`${device.name} 的PWM频率 ${frequency}Hz 高于 ${Math.floor(maxFullResolutionHz)}Hz，占空比分辨率将低于${this.PWM_DUTY_BITS}位`);
+      }
 
-  private generateGlobalVariables(): string {
-    return `// ==================== 全局变量 ====================
-WiFiServer server(80);
-unsigned long lastStatusCheck = 0;
-const unsigned long STATUS_INTERVAL = 1000; // 1秒检查一次定时任务
-
-// ==================== WiFi日志器 ====================
-class WiFiLogger {
-  private:
-    String lastLog = "";
-    bool hasPendingLog = false;
-    unsigned long lastSendTime = 0;
-    const unsigned long MIN_SEND_INTERVAL = 1000; // 最小发送间隔1秒
-
-  public:
-    void log(String level, String message, String category = "system") {
-      // 只发送重要日志，避免过度发送
-      if (level == "error" || level == "warn") {
-        sendLogImmediately(level, message, category);
-      } else {
-        // info和debug日志有频率限制
-        unsigned long now = millis();
-        if (now - lastSendTime >= MIN_SEND_INTERVAL) {
-          sendLogImmediately(level, message, category);
-          lastSendTime = now;
-        }
+      if (device.maxPower !== undefined && (device.maxPower <= 0 || device.maxPower > 100)) {
+        errors.push(`${device.name} 的最大功率 ${device.maxPower}% 必须在1-100之间`);
       }
-    }
 
-    void sendLogImmediately(String level, String message, String category) {
-      // 清理消息中的控制字符
-      String cleanMessage = cleanJsonString(message);
-
-      // 构造JSON日志
-      String jsonLog = "{\\"timestamp\\":" + String(millis()) +
-                      ",\\"level\\":\\"" + level +
-                      "\\",\\"message\\":\\"" + cleanMessage +
-                      "\\",\\"category\\":\\"" + category + "\\"}";
-
-      // 发送到后端
-      WiFiClient client;
-      if (client.connect("192.168.4.2", 8080)) {
-        client.println("POST /api/arduino-logs HTTP/1.1");
-        client.println("Host: 192.168.4.2:8080");
-        client.println("Content-Type: application/json");
-        client.println("Connection: close");
-        client.print("Content-Length: ");
-        client.println(jsonLog.length());
-        client.println();
-        client.print(jsonLog);
-        client.flush(); // 确保数据发送完成
-        delay(10);      // 给服务器时间处理
-        client.stop();
-      } else {
-        // 连接失败，保存最后一条日志用于重试
-        lastLog = jsonLog;
-        hasPendingLog = true;
+      const timerOutput = this.PWM_TIMER_OUTPUTS[device.pin];
+      if (!timerOutput) {
+        errors.push(`引脚 ${device.pin} 没有可用的PWM定时器 (${device.name})`);
+        return;
       }
-    }
 
-    // 清理JSON字符串中的控制字符
-    String cleanJsonString(String input) {
-      String result = "";
-      for (int i = 0; i < input.length(); i++) {
-        char c = input.charAt(i);
-        // 过滤控制字符，保留可打印字符
-        if (c >= 32 && c <= 126) {
-          // 转义JSON特殊字符
-          if (c == '"') {
-            result += "\\\\\\"";
-          } else if (c == '\\\\') {
-            result += "\\\\\\\\";
-          } else {
-            result += c;
-          }
-        } else if (c == '\\n') {
-          result += "\\\\n";
-        } else if (c == '\\r') {
-          result += "\\\\r";
-        } else if (c == '\\t') {
-          result += "\\\\t";
-        }
-        // 其他控制字符直接忽略
+      // 同一定时器输出只能驱动一个引脚
+      const outputKey = `GPT${timerOutput.timer}${timerOutput.output}`;
+      const owner = outputOwners.get(outputKey);
+      if (owner) {
+        errors.push(`${device.name} (引脚${device.pin}) 与 ${owner.name} (引脚${owner.pin}) 共用定时器输出 ${outputKey}`);
+      } else {
+        outputOwners.set(outputKey, device);
       }
-      return result;
-    }
 
-    void retryLastLog() {
-      if (hasPendingLog && lastLog.length() > 0) {
-        WiFiClient client;
-        if (client.connect("192.168.4.2", 8080)) {
-          client.println("POST /api/arduino-logs HTTP/1.1");
-          client.println("Host: 192.168.4.2:8080");
-          client.println("Content-Type: application/json");
-          client.println("Connection: close");
-          client.print("Content-Length: ");
-          client.println(lastLog.length());
-          client.println();
-          client.print(lastLog);
-          client.flush(); // 确保数据发送完成
-          delay(10);      // 给服务器时间处理
-          client.stop();
-
-          // 重试成功，清除待发送日志
-          hasPendingLog = false;
-          lastLog = "";
-        }
+      // 同一定时器的两个输出必须使用相同频率
+      const timerUser = timerFrequencies.get(timerOutput.timer);
+      if (timerUser && timerUser.frequency !== frequency) {
+        errors.push(`${device.name} (${frequency}Hz) 与 ${timerUser.device.name} (${timerUser.frequency}Hz) 共用定时器 GPT${timerOutput.timer}，频率必须一致`);
+      } else if (!timerUser) {
+        timerFrequencies.set(timerOutput.timer, { frequency, device });
       }
+    });
+  }
+
+  /**
+   * 验证传感器通道：ADC引脚、采样率、窗口长度以及总采样负载
+   */
+  private validateSensors(devices: DeviceConfig[], errors: string[], warnings: string[]): void {
+    const sensors = devices.filter(d => d.type === 'sensor');
+    if (sensors.length > this.SENSOR_MAX_CHANNELS) {
+      errors.push(`传感器数量 ${sensors.length} 超过上限 ${this.SENSOR_MAX_CHANNELS}`);
     }
-};
 
-WiFiLogger wifiLogger;`;
-  }
+    let totalRate = 0;
+    sensors.forEach(device => {
+      if (!this.VALID_ADC_PINS.includes(device.pin)) {
+        errors.push(`引脚 ${device.pin} 不是ADC引脚 (${device.name})，可用 A0-A5 (14-19)`);
+      }
 
-  private generateSetupFunction(devices: DeviceConfig[]): string {
-    return `void setup() {
-  // 初始化串口
-  Serial.begin(115200);
-  while (!Serial) delay(10);
-  
-  Serial.println("=================================");
-  Serial.println("FishControl 自动生成版本启动中...");
-  Serial.println("设备数量: ${devices.length}");
-  Serial.println("=================================");
-  
-  // 初始化设备引脚
-  initializeDevices();
-  
-  // 初始化WiFi热点
-  initializeWiFi();
-  
-  // 启动HTTP服务器
-  server.begin();
-  Serial.print("HTTP服务器已启动，IP地址: ");
-  Serial.println(WiFi.localIP());
-  Serial.println("API端点: http://192.168.4.1/api/commands");
-  Serial.println("其他设备可连接WiFi热点来控制系统");
-  Serial.println("=================================");
-}`;
-  }
+      if (device.id.length > this.SENSOR_MAX_ID_LENGTH) {
+        errors.push(`传感器ID ${device.id} 超过 ${this.SENSOR_MAX_ID_LENGTH} 个字符`);
+      }
 
-  private generateLoopFunction(): string {
-    return `void loop() {
-  // 处理HTTP请求
-  handleHTTPRequests();
+      const sensor = device.sensor;
+      if (!sensor) {
+        errors.push(`${device.name} 缺少传感器采样配置`);
+        return;
+      }
 
-  // 检查定时任务
-  checkTimedTasks();
+      if (sensor.sampleRateHz < 1 || sensor.sampleRateHz > this.SENSOR_MAX_RATE_HZ) {
+        errors.push(`${device.name} 的采样率 ${sensor.sampleRateHz}Hz 超出范围 1-${this.SENSOR_MAX_RATE_HZ}Hz`);
+      }
+      if (!Number.isInteger(sensor.windowSamples) || sensor.windowSamples < 1 || sensor.windowSamples > 65535) {
+        errors.push(`${device.name} 的窗口样本数 ${sensor.windowSamples} 必须为1-65535的整数`);
+      } else if (sensor.windowSamples * 1000 / sensor.sampleRateHz < this.SENSOR_MIN_WINDOW_MS) {
+        warnings.push(`${device.name} 的窗口短于 ${this.SENSOR_MIN_WINDOW_MS}ms，上传频繁时可能丢窗口`);
+      }
+      totalRate += sensor.sampleRateHz;
+    });
 
-  // 重试失败的日志发送
-  wifiLogger.retryLastLog();
+    if (totalRate > this.SENSOR_MAX_RATE_HZ) {
+      errors.push(`传感器总采样率 ${totalRate}Hz 超过 ${this.SENSOR_MAX_RATE_HZ}Hz（采样在定时器中断中完成）`);
+    }
 
-  delay(10); // 短暂延迟
-}`;
+    // 各通道以最高采样率为基准分频，非整除时实际采样率会偏离配置
+    const timerHz = this.getSensorTimerHz(sensors);
+    sensors.forEach(device => {
+      if (!device.sensor || device.sensor.sampleRateHz <= 0) return;
+      const divider = this.getSensorDivider(device, timerHz);
+      const actualHz = timerHz / divider;
+      if (Math.abs(actualHz - device.sensor.sampleRateHz) > 0.01) {
+        warnings.push(`${device.name} 的实际采样率为 ${actualHz.toFixed(1)}Hz（定时器 ${timerHz}Hz 分频 ${divider}）`);
+      }
+    });
   }
 
-  private generateDeviceFunctions(devices: DeviceConfig[]): string {
-    return `/**
- * 初始化设备引脚
- */
-void initializeDevices() {
-  Serial.println("初始化设备引脚...");
-  
-  for (int i = 0; i < ${devices.length}; i++) {
-    pinMode(devicePins[i], OUTPUT);
-    devices[i].currentValue = 0;
-    devices[i].isActive = false;
-    devices[i].endTime = 0;
-    
-    // 设置初始状态为关闭
-    if (isPWM[i]) {
-      analogWrite(devicePins[i], 0);
-    } else {
-      digitalWrite(devicePins[i], LOW);
+  /**
+   * 验证闭环控制回路：传感器 -> PWM设备，频率与采样定时器匹配，参数可编码为定点数
+   */
+  private validateControlLoops(devices: DeviceConfig[], controlLoops: ControlLoopConfig[], errors: string[]): void {
+    if (controlLoops.length > this.MAX_CONTROL_LOOPS) {
+      errors.push(`控制回路数量 ${controlLoops.length} 超过上限 ${this.MAX_CONTROL_LOOPS}`);
     }
-    
-    Serial.print("设备 ");
-    Serial.print(deviceNames[i]);
-    Serial.print(" (引脚 ");
-    Serial.print(devicePins[i]);
-    Serial.print(") 初始化完成 - ");
-    Serial.println(isPWM[i] ? "PWM模式" : "数字模式");
-  }
-}`;
-  }
 
-  private generateHttpHandlers(devices: DeviceConfig[]): string {
-    return `// ==================== HTTP处理函数 ====================
+    const sensors = devices.filter(d => d.type === 'sensor');
+    const timerHz = this.getSensorTimerHz(sensors);
+    const usedOutputs = new Map<string, string>();
 
-/**
- * 处理HTTP请求
- */
-void handleHTTPRequests() {
-  WiFiClient client = server.available();
-  if (!client) return;
-
-  String request = "";
-  unsigned long timeout = millis() + 3000; // 3秒超时
-  int contentLength = 0;
-  bool headersComplete = false;
-
-  // 读取请求头
-  while (client.connected() && millis() < timeout && !headersComplete) {
-    if (client.available()) {
-      String line = client.readStringUntil('\\n');
-      request += line + "\\n";
-
-      // 检查Content-Length（不区分大小写）
-      String lowerLine = line;
-      lowerLine.toLowerCase();
-      if (lowerLine.startsWith("content-length:")) {
-        String lengthStr = line.substring(line.indexOf(':') + 1);
-        lengthStr.trim();
-        contentLength = lengthStr.toInt();
+    controlLoops.forEach(loop => {
+      const sensor = sensors.find(d => d.id === loop.sensorId);
+      const output = devices.find(d => d.id === loop.outputId);
+
+      if (!sensor || !sensor.sensor) {
+        errors.push(`控制回路 ${loop.name} 的传感器 ${loop.sensorId} 不存在`);
+        return;
+      }
+      if (!output || output.type !== 'pwm') {
+        errors.push(`控制回路 ${loop.name} 的输出 ${loop.outputId} 必须是PWM设备`);
+        return;
       }
 
-      // 检查是否读取完成
-      if (line.length() == 1 && line[0] == '\\r') {
-        headersComplete = true;
+      const owner = usedOutputs.get(loop.outputId);
+      if (owner) {
+        errors.push(`控制回路 ${loop.name} 与 ${owner} 驱动同一输出 ${output.name}`);
       }
-    }
-  }
+      usedOutputs.set(loop.outputId, loop.name);
 
-  // 如果是POST请求，继续读取请求体
-  if (headersComplete && contentLength > 0 && request.indexOf("POST") >= 0) {
-    String body = "";
-    int bytesRead = 0;
-    unsigned long bodyTimeout = millis() + 2000; // 2秒超时
-
-    while (client.connected() && millis() < bodyTimeout && bytesRead < contentLength) {
-      if (client.available()) {
-        char c = client.read();
-        body += c;
-        bytesRead++;
+      if (!(loop.rateHz > 0) || loop.rateHz > sensor.sensor.sampleRateHz) {
+        errors.push(`控制回路 ${loop.name} 的频率 ${loop.rateHz}Hz 必须在 1-${sensor.sensor.sampleRateHz}Hz（传感器采样率）之间`);
+        return;
+      }
+      if (!Number.isInteger(timerHz / loop.rateHz)) {
+        errors.push(`控制回路 ${loop.name} 的频率 ${loop.rateHz}Hz 必须整除采样定时器频率 ${timerHz}Hz`);
+        return;
       }
-      delay(1); // 小延时，给Arduino时间处理
-    }
 
-    request += body;
+      // 输出范围与增益由编码时检查
+      try {
+        encodeControlLoop(loop, sensor, getDeviceMaxDuty(output));
+      } catch (error) {
+        errors.push((error as Error).message);
+      }
+    });
   }
 
-  // 解析请求
-  if (request.indexOf("POST /api/commands") >= 0) {
-    // 删除：不记录每次HTTP请求，太频繁
-    handleBatchCommands(client, request);
-  } else if (request.indexOf("GET /api/status") >= 0) {
-    handleStatusQuery(client);
-  } else if (request.indexOf("OPTIONS") >= 0) {
-    handleCORSPreflight(client);
-  } else {
-    wifiLogger.log("warn", "Unknown request: " + request.substring(0, 30), "http");
-    send404(client);
+  /**
+   * 输出设备（参与设备表、位掩码与命令协议），传感器单独成表
+   */
+  private getOutputDevices(devices: DeviceConfig[]): DeviceConfig[] {
+    return devices.filter(d => d.type !== 'sensor');
   }
 
-  client.stop();
-}
-
-/**
- * 处理批量命令
- */
-void handleBatchCommands(WiFiClient& client, String& request) {
-  // 发送CORS头
-  sendCORSHeaders(client);
-
-  // 提取JSON数据
-  int jsonStart = request.indexOf("{");
-  if (jsonStart == -1) {
-    Serial.println("错误: 请求中没有找到JSON数据");
-    Serial.println("请求内容: " + request);
-    sendError(client, 400, "No JSON found");
-    return;
+  private getSensorTimerHz(sensors: DeviceConfig[]): number {
+    return Math.max(1, ...sensors.map(d => d.sensor?.sampleRateHz ?? 1));
   }
 
-  String jsonData = request.substring(jsonStart);
-  // 不打印完整JSON以降低串口与内存压力
-
-  // 解析JSON
-  StaticJsonDocument<1536> doc; // 固定内存占用，避免堆碎片
-  DeserializationError error = deserializeJson(doc, jsonData);
-
-  if (error) {
-    String errorMsg = "JSON解析失败: " + String(error.c_str());
-    Serial.println(errorMsg);
-    Serial.println("原始JSON: " + jsonData);
-    Serial.println("JSON前50字符: " + jsonData.substring(0, min(50, jsonData.length())));
-    wifiLogger.log("error", errorMsg, "json_parse");
-    sendError(client, 400, "JSON Parse Error");
-    return;
+  private getSensorDivider(device: DeviceConfig, timerHz: number): number {
+    return Math.max(1, Math.round(timerHz / (device.sensor?.sampleRateHz ?? timerHz)));
   }
 
-  // 执行命令 - 适配后端格式 {id, ts, cmds: [{dev, act, val, dur}]}
-  String commandId = doc["id"];
-  unsigned long timestamp = doc["ts"];
-  JsonArray commands = doc["cmds"];
-  int executedCount = 0;
-
-  Serial.print("收到批处理命令 ID: ");
-  Serial.print(commandId);
-  Serial.print(", 时间戳: ");
-  Serial.print(timestamp);
-  Serial.print(", 命令数: ");
-  Serial.println(commands.size());
-
-  for (JsonObject cmd : commands) {
-    String device = cmd["dev"];      // 后端格式：dev
-    String action = cmd["act"];      // 后端格式：act
-    int value = cmd["val"];          // 后端格式：val
-    int duration = cmd["dur"];       // 后端格式：dur
-
-    // 映射设备ID和动作类型
-    String mappedDevice = mapDeviceId(device);
-    String mappedAction = mapActionType(action);
-
-    if (executeDeviceCommand(mappedDevice, mappedAction, value, duration)) {
-      executedCount++;
-    }
+  private getPwmFrequency(device: DeviceConfig): number {
+    return device.pwmFrequency ?? this.PWM_DEFAULT_FREQUENCY;
   }
 
-  // 返回结果
-  client.println("HTTP/1.1 200 OK");
-  client.println("Content-Type: application/json");
-  client.println("Connection: close");
-  client.println();
-  client.print("{\\"success\\": true, \\"executed\\": ");
-  client.print(executedCount);
-  client.println("}");
-
-  String resultMsg = "执行了 " + String(executedCount) + " 个命令";
-  Serial.println(resultMsg);
-  // 删除：不记录每次命令执行结果，太频繁
-}
+  /**
+   * 计算分组位掩码
+   * 第i位对应设备表中的第i个设备；"all" 覆盖全部设备
+   */
+  private buildGroupMasks(devices: DeviceConfig[]): DeviceGroupMask[] {
+    const groups = new Map<string, DeviceGroupMask>();
+    groups.set('all', { id: 'all', mask: 0, members: [] });
+
+    devices.forEach((device, index) => {
+      const bit = 2 ** index; // 避免 1 << 31 变为负数
+      const all = groups.get('all')!;
+      all.mask += bit;
+      all.members.push(device.id);
+
+      if (device.groupId && device.groupId !== 'all') {
+        const group = groups.get(device.groupId) || { id: device.groupId, mask: 0, members: [] };
+        group.mask += bit;
+        group.members.push(device.id);
+        groups.set(device.groupId, group);
+      }
+    });
 
-/**
- * 处理状态查询
- */
-void handleStatusQuery(WiFiClient& client) {
-  // CORS
-  client.println("HTTP/1.1 200 OK");
-  client.println("Content-Type: application/json");
-  client.println("Access-Control-Allow-Origin: *");
-  client.println("Access-Control-Allow-Methods: GET, POST, OPTIONS");
-  client.println("Access-Control-Allow-Headers: Content-Type");
-  client.println("Connection: close");
-  client.println();
-
-  unsigned long uptime = millis() / 1000; // seconds
-  client.print("{\\"status\\": \\"online\\", \\"devices\\": ");
-  client.print(${devices.length});
-  client.print(", \\"uptimeSec\\": ");
-  client.print(uptime);
-  client.println("}");
-}
+    return Array.from(groups.values());
+  }
 
-/**
- * 处理CORS预检请求
- */
-void handleCORSPreflight(WiFiClient& client) {
-  client.println("HTTP/1.1 200 OK");
-  client.println("Access-Control-Allow-Origin: *");
-  client.println("Access-Control-Allow-Methods: GET, POST, OPTIONS");
-  client.println("Access-Control-Allow-Headers: Content-Type");
-  client.println("Connection: close");
-  client.println();
-}
+  /**
+   * 构建Arduino草图
+   * 固件逻辑在 MantaControl 库中（firmware/MantaControl），草图只包含本次配置的设备表
+   */
+  private buildArduinoCode(
+    devices: DeviceConfig[],
+    wifiConfig: WifiConfig,
+    controlLoops: ControlLoopConfig[],
+    board: ResolvedBoard,
+    manifestHash: number
+  ): string {
+    // 设备表只包含输出设备；传感器通道与控制回路单独成表
+    const outputs = this.getOutputDevices(devices);
+    const sensors = devices.filter(d => d.type === 'sensor');
 
-/**
- * 发送404错误
- */
-void send404(WiFiClient& client) {
-  client.println("HTTP/1.1 404 Not Found");
-  client.println("Content-Type: text/plain");
-  client.println("Connection: close");
-  client.println();
-  client.println("404 Not Found");
-}
+    const sections = [
+      this.generateHeader(devices, board),
+      this.generateIncludes(),
+      this.generateConfigMacros(outputs, sensors, controlLoops, board, manifestHash),
+      this.generateConfigTables(outputs, sensors, controlLoops, wifiConfig, board),
+      this.generateEntryPoints()
+    ];
 
-/**
- * 发送错误响应
- */
-void sendError(WiFiClient& client, int code, String message) {
-  client.print("HTTP/1.1 ");
-  client.print(code);
-  client.println(" Error");
-  client.println("Content-Type: application/json");
-  client.println("Connection: close");
-  client.println();
-  client.print("{\\"error\\": \\"");
-  client.print(message);
-  client.println("\\"}");
-}
+    return sections.filter(section => section.length > 0).join('\n\n');
+  }
 
-/**
- * 发送CORS头
- */
-void sendCORSHeaders(WiFiClient& client) {
-  client.println("Access-Control-Allow-Origin: *");
-  client.println("Access-Control-Allow-Methods: GET, POST, OPTIONS");
-  client.println("Access-Control-Allow-Headers: Content-Type");
-}`;
+  private generateHeader(devices: DeviceConfig[], board: ResolvedBoard): string {
+    const role = board.wifiMode === 'ap' ? '主控制板，创建WiFi热点' : `从站控制板，以 ${board.host} 加入主控制板热点`;
+    return `/**
+ * FishControl 自动生成代码
+ * ${this.BOARD_TYPE}专用，需要安装 ${this.FIRMWARE_LIBRARY} 库（仓库 firmware/${this.FIRMWARE_LIBRARY} 目录）
+ * 
+ * 控制板: ${board.id}${board.name ? ` (${board.name})` : ''} - ${role}
+ * 
+ * 设备配置：
+${devices.map(d => ` * - ${d.name} (${d.id}): 引脚${d.pin} ${d.type.toUpperCase()}`).join('\n')}
+ * 
+ * 生成时间: ${new Date().toISOString()}
+ * 代码生成器版本: 3.0.0
+ */`;
   }
 
-  private generateUtilityFunctions(devices: DeviceConfig[]): string {
-    return `// ==================== 工具函数 ====================
+  private generateIncludes(): string {
+    return `// 设备表类型与 PwmOut（R4 核心自带，可按引脚配置硬件PWM频率）
+#include <MantaConfig.h>
 
-/**
- * 初始化WiFi热点
- */
-void initializeWiFi() {
-  Serial.println("正在创建WiFi热点...");
+// 依赖：WiFiS3（UNO R4 WiFi专用）、ArduinoJson 6.x或更高`;
+  }
 
-  // 创建WiFi热点
-  WiFi.beginAP(ssid, pass);
+  /**
+   * 表长度宏：库按这些宏确定静态数组大小并裁剪未使用的功能
+   */
+  private generateConfigMacros(
+    outputs: DeviceConfig[],
+    sensors: DeviceConfig[],
+    controlLoops: ControlLoopConfig[],
+    board: ResolvedBoard,
+    manifestHash: number
+  ): string {
+    const lines = [
+      `#define MANTA_SKETCH_FORMAT ${this.FIRMWARE_CONFIG_FORMAT}`,
+      `#define MANTA_BOARD_ID "${board.id}"`,
+      `#define MANTA_MANIFEST_HASH ${formatManifestHash(manifestHash)}UL  // 设备表/分组/回路顺序的哈希，上报给后端核对`,
+      ...(board.wifiMode === 'station' ? ['#define MANTA_WIFI_STATION 1'] : []),
+      `#define MANTA_DEVICE_COUNT ${outputs.length}`,
+      `#define MANTA_GROUP_COUNT ${this.buildGroupMasks(outputs).length}`,
+      `#define MANTA_SENSOR_COUNT ${sensors.length}`
+    ];
+    if (sensors.length > 0) {
+      lines.push(`#define MANTA_SENSOR_TIMER_HZ ${this.getSensorTimerHz(sensors)}.0f  // 最高采样率，其他通道分频`);
+    }
+    lines.push(`#define MANTA_CONTROL_LOOP_COUNT ${controlLoops.length}`);
 
-  // 等待热点启动
-  while (WiFi.status() != WL_AP_LISTENING) {
-    delay(500);
-    Serial.print(".");
+    return `// ==================== 配置规模 ====================
+${lines.join('\n')}`;
   }
 
-  Serial.println();
-  Serial.println("WiFi热点已创建");
-  Serial.print("热点名称: ");
-  Serial.println(ssid);
-  Serial.print("IP地址: ");
-  Serial.println(WiFi.localIP());
-  Serial.println("其他设备可以连接此热点来控制Arduino");
-}
+  private generateConfigTables(outputs: DeviceConfig[], sensors: DeviceConfig[], controlLoops: ControlLoopConfig[], wifiConfig: WifiConfig, board: ResolvedBoard): string {
+    const tables = [
+      this.generateWifiConfig(wifiConfig, board),
+      this.generateDeviceTable(outputs),
+      this.generatePwmOutputs(outputs),
+      this.generateGroupMasks(outputs),
+      this.generateSensorTable(sensors),
+      this.generateControlLoops(sensors, outputs, controlLoops)
+    ];
 
-/**
- * 映射设备ID：后端格式 -> Arduino格式
- */
-String mapDeviceId(String backendId) {
-  // 前后端统一使用配置页的设备ID，保持一致即可
-  return backendId;
-}
+    return `namespace manta {
+namespace config {
 
-/**
- * 映射动作类型：后端格式 -> Arduino格式
- */
-String mapActionType(String backendAction) {
-  if (backendAction == "setPwr") return "power";
-  if (backendAction == "setSt") return "state";
+${tables.filter(table => table.length > 0).join('\n\n')}
 
-  // 如果没有映射，返回原始动作
-  return backendAction;
-}
+}  // namespace config
+}  // namespace manta`;
+  }
 
-/**
- * 执行设备命令
- */
-bool executeDeviceCommand(String deviceId, String action, int value, int duration) {
-  // 查找设备索引
-  int deviceIndex = -1;
-  for (int i = 0; i < ${devices.length}; i++) {
-    if (String(deviceNames[i]) == deviceId) {
-      deviceIndex = i;
-      break;
+  private generateWifiConfig(wifiConfig: WifiConfig, board: ResolvedBoard): string {
+    const lines = [
+      `const char* const WIFI_SSID = "${wifiConfig.ssid}";`,
+      `const char* const WIFI_PASS = "${wifiConfig.password}";`
+    ];
+    if (board.wifiMode === 'station') {
+      lines.push(`const uint8_t STATION_IP[4] = {${board.host.split('.').join(', ')}};  // 加入主控制板热点使用的固定IP`);
     }
-  }
 
-  if (deviceIndex == -1) {
-    String errorMsg = "未知设备: " + deviceId;
-    Serial.println(errorMsg);
-    wifiLogger.log("error", errorMsg, "device_control");
-    return false;
+    return `// ==================== WiFi配置 ====================
+${lines.join('\n')}`;
   }
 
-  // 执行命令
-  if (action == "power" || action == "set_power") {
-    // PWM功率控制
-    if (isPWM[deviceIndex]) {
-      int pwmValue = map(value, 0, 100, 0, 255);
-      analogWrite(devicePins[deviceIndex], pwmValue);
-      devices[deviceIndex].currentValue = pwmValue;
-
-      String logMsg = "设备 " + deviceId + " PWM设置为 " + String(value) + "% (" + String(pwmValue) + "/255)";
-      Serial.println(logMsg);
-      wifiLogger.log("info", logMsg, "device_control");
-    } else {
-      Serial.print("设备 ");
-      Serial.print(deviceId);
-      Serial.println(" 不支持PWM控制");
-      return false;
-    }
-  } else if (action == "state" || action == "set_state") {
-    // 数字状态控制
-    bool state = (value > 0);
-    digitalWrite(devicePins[deviceIndex], state ? HIGH : LOW);
-    devices[deviceIndex].currentValue = state ? 1 : 0;
-
-    String logMsg = "设备 " + deviceId + " 状态设置为 " + (state ? "开启" : "关闭");
-    Serial.println(logMsg);
-    wifiLogger.log("info", logMsg, "device_control");
-  } else {
-    Serial.print("未知动作: ");
-    Serial.println(action);
-    return false;
+  /**
+   * 设备表：频率与功率上限在生成时确定
+   */
+  private generateDeviceTable(devices: DeviceConfig[]): string {
+    const rows = devices.map(device => {
+      const type = device.type === 'pwm' ? 'DEVICE_PWM' : 'DEVICE_DIGITAL';
+      const frequency = device.type === 'pwm' ? `${this.getPwmFrequency(device).toFixed(1)}f` : '0.0f';
+      const maxDuty = device.type === 'pwm' ? getDeviceMaxDuty(device) : 0;
+      return `  {"${device.id}", ${device.pin}, ${type}, ${frequency}, ${maxDuty}},  // ${device.name}`;
+    }).join('\n');
+
+    return `// ==================== 设备表 ====================
+// {设备ID, 引脚, 类型, PWM频率, 占空比上限(maxPower)}；顺序即命令协议中的设备索引
+const DeviceDescriptor DEVICES[MANTA_DEVICE_COUNT] = {
+${rows}
+};`;
   }
 
-  // 更新设备状态
-  devices[deviceIndex].isActive = (value > 0);
-
-  // 处理定时关闭
-  if (duration > 0 && value > 0) {
-    devices[deviceIndex].endTime = millis() + duration;
-    Serial.print("将在 ");
-    Serial.print(duration);
-    Serial.println("ms 后自动关闭");
-  } else {
-    devices[deviceIndex].endTime = 0;
+  private generatePwmOutputs(devices: DeviceConfig[]): string {
+    const outputs = devices
+      .map((device, index) => device.type === 'pwm'
+        ? `PwmOut pwmOut${index}(${device.pin}); // GPT${this.PWM_TIMER_OUTPUTS[device.pin].timer}${this.PWM_TIMER_OUTPUTS[device.pin].output}`
+        : null)
+      .filter(line => line !== null)
+      .join('\n');
+
+    return `// ==================== 硬件PWM ====================
+// 每个PWM设备独占一个GPT定时器输出
+${outputs}
+
+PwmOut* const PWM_OUTPUTS[MANTA_DEVICE_COUNT] = {${devices.map((d, i) => d.type === 'pwm' ? `&pwmOut${i}` : 'nullptr').join(', ')}};`;
   }
 
-  return true;
-}
+  private generateGroupMasks(devices: DeviceConfig[]): string {
+    const groups = this.buildGroupMasks(devices);
+    const hex = (mask: number) => '0x' + mask.toString(16).toUpperCase().padStart(8, '0') + 'UL';
 
-/**
- * 检查定时任务
- */
-void checkTimedTasks() {
-  unsigned long now = millis();
-
-  for (int i = 0; i < ${devices.length}; i++) {
-    if (devices[i].endTime > 0 && now >= devices[i].endTime) {
-      // 时间到，关闭设备
-      if (isPWM[i]) {
-        analogWrite(devicePins[i], 0);
-      } else {
-        digitalWrite(devicePins[i], LOW);
-      }
+    const rows = groups.map(g => `  {"${g.id}", ${hex(g.mask)}},  // ${g.members.join(', ')}`).join('\n');
 
-      devices[i].currentValue = 0;
-      devices[i].isActive = false;
-      devices[i].endTime = 0;
+    return `// ==================== 分组位掩码 ====================
+// 第i位对应 DEVICES[i]；命令 {msk, act, val, dur} 或 {grp, act, val, dur} 一次作用于整组
+const GroupDescriptor GROUPS[MANTA_GROUP_COUNT] = {
+${rows}
+};`;
+  }
 
-      String logMsg = "设备 " + String(deviceNames[i]) + " 定时关闭";
-      Serial.println(logMsg);
-      wifiLogger.log("info", logMsg, "timer_task");
-    }
+  /**
+   * 传感器表：定时器中断按各通道分频采样，汇总 min/max/mean 窗口后批量上传
+   */
+  private generateSensorTable(sensors: DeviceConfig[]): string {
+    if (sensors.length === 0) return '';
+
+    const timerHz = this.getSensorTimerHz(sensors);
+    const rows = sensors.map(d =>
+      `  {"${d.id}", ${d.pin}, ${this.getSensorDivider(d, timerHz)}, ${d.sensor!.windowSamples}},  // ${d.name}`
+    ).join('\n');
+
+    return `// ==================== 传感器 ====================
+// {传感器ID, 引脚, 分频, 窗口样本数}
+const SensorDescriptor SENSORS[MANTA_SENSOR_COUNT] = {
+${rows}
+};`;
+  }
+
+  /**
+   * 控制回路表：定点PID在采样中断中按分频运行并直接写PWM
+   */
+  private generateControlLoops(sensors: DeviceConfig[], outputs: DeviceConfig[], controlLoops: ControlLoopConfig[]): string {
+    if (controlLoops.length === 0) return '';
+
+    const timerHz = this.getSensorTimerHz(sensors);
+    const rows = controlLoops.map(loop => {
+      const sensorIndex = sensors.findIndex(d => d.id === loop.sensorId);
+      const outputIndex = outputs.findIndex(d => d.id === loop.outputId);
+      const p = encodeControlLoop(loop, sensors[sensorIndex], getDeviceMaxDuty(outputs[outputIndex]));
+      const divider = Math.round(timerHz / loop.rateHz);
+      return `  {"${loop.id}", ${sensorIndex}, ${outputIndex}, ${divider}, ${loop.enabled ? 'true' : 'false'}, ` +
+        `${p.setpoint}, ${p.kp}, ${p.ki}, ${p.kd}, ${p.outputMin}, ${p.outputMax}},  // ${loop.name}`;
+    }).join('\n');
+
+    return `// ==================== 闭环控制 ====================
+// 误差为ADC原始计数，输出为占空比计数，增益为Q${32 - PID_FRACTION_BITS}.${PID_FRACTION_BITS}定点数（ki已除以频率，kd已乘以频率）
+// {回路ID, 传感器索引, 输出索引, 分频, 上电启用, 设定值, kp, ki, kd, 下限, 上限}
+const ControlLoopDescriptor CONTROL_LOOPS[MANTA_CONTROL_LOOP_COUNT] = {
+${rows}
+};`;
   }
+
+  private generateEntryPoints(): string {
+    return `#include <${this.FIRMWARE_LIBRARY}.h>
+
+void setup() {
+  manta::setup();
+}
+
+void loop() {
+  manta::loop();
 }`;
   }
 }
@@ -739,11 +690,33 @@ export interface CodeMetadata {
   deviceCount: number;
   pwmDevices: number;
   digitalDevices: number;
+  sensorDevices: number;
   usedPins: number[];
   wifiConfig: {
     ssid: string;
     hasPassword: boolean;
   };
+  deviceOrder: string[];               // 固件设备表顺序（位掩码第i位 = deviceOrder[i]）
+  groupMasks: Record<string, number>;  // 分组ID -> 设备位掩码（含 "all"）
+  controlLoops: string[];              // 固件控制回路表顺序（命令中的 lp 索引）
+  manifestHash: number;                // 以上表顺序的哈希，写入固件的 MANTA_MANIFEST_HASH
+  firmwareLibrary: string;             // 草图依赖的固件库
+  boardId: string;                     // 控制板ID
+  boardHost: string;                   // 控制板IPv4地址
+  wifiMode: 'ap' | 'station';          // 创建热点（主控制板）或加入热点
+}
+
+export interface ResolvedBoard {
+  id: string;
+  name?: string;
+  host: string;
+  wifiMode: 'ap' | 'station';
+}
+
+export interface DeviceGroupMask {
+  id: string;
+  mask: number;
+  members: string[];
 }
 
 export interface ValidationResult {
@@ -0,0 +1,80 @@
+import type { ControlLoopConfig, DeviceConfig } from '../../types/device';
+
+/**
+ * 闭环控制参数编码
+ * 固件中的PID以定点数运行：误差为ADC原始计数，输出为PWM占空比计数，增益为Q16.16
+ * 这里把以物理量配置的设定值与增益换算为固件参数，生成器与运行时下发共用
+ */
+
+export const PID_FRACTION_BITS = 16;
+export const PWM_DUTY_MAX = 4095;     // 与生成器的 PWM_DUTY_BITS = 12 对应
+export const SENSOR_ADC_MAX = 16383;  // 14位ADC
+
+const INT32_MAX = 2 ** 31 - 1;
+
+/**
+ * 固件侧的回路参数
+ */
+export interface FirmwareLoopParams {
+  setpoint: number;   // ADC原始计数
+  kp: number;         // Q16.16，占空比计数/ADC计数
+  ki: number;         // Q16.16，每次执行累加
+  kd: number;         // Q16.16，乘以每次执行的测量变化量
+  outputMin: number;  // 占空比计数
+  outputMax: number;
+}
+
+/**
+ * 物理量设定值 -> ADC原始计数
+ */
+export function encodeSetpoint(setpoint: number, sensor: DeviceConfig): number {
+  const scale = sensor.sensor?.scale ?? 1;
+  const offset = sensor.sensor?.offset ?? 0;
+  const raw = Math.round((setpoint - offset) / scale);
+  return Math.max(0, Math.min(SENSOR_ADC_MAX, raw));
+}
+
+/**
+ * 输出设备的占空比上限：maxPower% 对应的占空比计数（固件设备表中的 maxDuty）
+ */
+export function getDeviceMaxDuty(device: DeviceConfig): number {
+  const maxPower = Math.min(100, Math.max(0, device.maxPower ?? 100));
+  return Math.round(PWM_DUTY_MAX * maxPower / 100);
+}
+
+/**
+ * 换算回路参数；增益超出定点范围或输出范围超出输出设备的占空比上限时抛出错误
+ * 未设置 outputMax 时取输出设备的上限
+ *
+ * kp: 输出% / 物理量单位，ki: 输出% / (物理量单位·s)，kd: 输出%·s / 物理量单位
+ */
+export function encodeControlLoop(loop: ControlLoopConfig, sensor: DeviceConfig, maxDuty: number = PWM_DUTY_MAX): FirmwareLoopParams {
+  const scale = sensor.sensor?.scale ?? 1;
+  // 每个ADC计数的误差对应的占空比计数
+  const countsPerCount = scale * PWM_DUTY_MAX / 100;
+
+  const toFixed = (gain: number, name: string): number => {
+    const fixed = Math.round(gain * countsPerCount * 2 ** PID_FRACTION_BITS);
+    if (!Number.isFinite(fixed) || Math.abs(fixed) > INT32_MAX) {
+      throw new Error(`控制回路 ${loop.id} 的 ${name} 超出定点数范围`);
+    }
+    return fixed;
+  };
+
+  // 固件会把超出范围的限值截断，这里直接拒绝，避免接口报告的范围与实际执行的不一致
+  const outputMin = Math.round((loop.outputMin ?? 0) * PWM_DUTY_MAX / 100);
+  const outputMax = loop.outputMax === undefined ? maxDuty : Math.round(loop.outputMax * PWM_DUTY_MAX / 100);
+  if (!(outputMin >= 0 && outputMin <= outputMax && outputMax <= maxDuty)) {
+    const maxPercent = Math.round(maxDuty * 1000 / PWM_DUTY_MAX) / 10;
+    throw new Error(`控制回路 ${loop.id} 的输出范围 ${loop.outputMin ?? 0}-${loop.outputMax ?? maxPercent}% 无效，必须在输出设备允许的 0-${maxPercent}% 之内`);
+  }
+
+  return {
+    setpoint: encodeSetpoint(loop.setpoint, sensor),
+    kp: toFixed(loop.kp, 'kp'),
+    ki: toFixed(loop.ki / loop.rateHz, 'ki'),
+    kd: toFixed(loop.kd * loop.rateHz, 'kd'),
+    outputMin,
+    outputMax
+  };
+}
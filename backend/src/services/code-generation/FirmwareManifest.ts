@@ -0,0 +1,261 @@
+import fs from 'fs/promises';
+import path from 'path';
+import { Logger } from 'winston';
+import type { CodeMetadata } from './CodeGenerationService';
+
+export const DEFAULT_BOARD_ID = 'main';
+export const DEFAULT_BOARD_HOST = '192.168.4.1';
+
+/**
+ * 固件清单存储
+ * 记录最近一次生成的各控制板固件的设备表顺序与分组位掩码，
+ * 供调度器按控制板拆分命令，并把同一控制板上同值的多设备命令编码为一条位掩码命令
+ *
+ * 清单在生成代码时更新，而不是在烧录时；每份固件带有清单哈希并在状态查询、命令确认与串口心跳中上报，
+ * 控制板上报的哈希与清单一致后才使用位掩码与索引寻址（isBoardVerified），否则按设备ID寻址或拒绝发送
+ */
+export class FirmwareManifestStore {
+  private manifestFilePath: string;
+  private manifest: FirmwareManifest | null = null;
+  private deviceSlots: Map<string, BoardSlot> = new Map();   // 设备ID -> 所在控制板与设备表索引
+  private loopSlots: Map<string, BoardSlot> = new Map();     // 回路ID -> 所在控制板与回路表索引
+  private reportedHashes: Map<string, number> = new Map();   // 控制板ID -> 固件上报的清单哈希
+  private warnedMismatches: Map<string, string> = new Map(); // 控制板ID -> 已告警的 上报哈希:清单哈希
+  private listeners: ((manifest: FirmwareManifest) => void)[] = [];
+
+  constructor(
+    private logger: Logger,
+    configDir: string = 'config'
+  ) {
+    this.manifestFilePath = path.join(configDir, 'firmware-manifest.json');
+  }
+
+  /**
+   * 从文件加载清单（不存在时保持为空，调度器回退为逐设备命令）
+   */
+  async load(): Promise<void> {
+    try {
+      const data = await fs.readFile(this.manifestFilePath, 'utf-8');
+      this.setManifest(normalizeManifest(JSON.parse(data)));
+      this.logger.info(`Loaded firmware manifest with ${this.deviceSlots.size} devices on ${this.manifest?.boards.length ?? 0} boards`);
+    } catch (error) {
+      if ((error as NodeJS.ErrnoException).code === 'ENOENT') {
+        this.logger.info('No firmware manifest found, group mask commands disabled until code is generated');
+      } else {
+        this.logger.warn('Failed to load firmware manifest:', error);
+      }
+    }
+  }
+
+  /**
+   * 根据代码生成结果（每个控制板一份，主控制板在前）更新并保存清单
+   */
+  async update(boards: CodeMetadata[], generatedAt: Date): Promise<void> {
+    const manifest: FirmwareManifest = {
+      generatedAt: generatedAt.toISOString(),
+      boards: boards.map(metadata => ({
+        id: metadata.boardId,
+        host: metadata.boardHost,
+        deviceOrder: metadata.deviceOrder,
+        groupMasks: metadata.groupMasks,
+        controlLoops: metadata.controlLoops,
+        hash: metadata.manifestHash
+      }))
+    };
+
+    this.setManifest(manifest);
+
+    try {
+      await fs.mkdir(path.dirname(this.manifestFilePath), { recursive: true });
+      await fs.writeFile(this.manifestFilePath, JSON.stringify(manifest, null, 2), 'utf-8');
+    } catch (error) {
+      this.logger.warn('Failed to save firmware manifest:', error);
+    }
+  }
+
+  /**
+   * 直接替换清单（不写文件），用于调度线程同步主线程的清单
+   */
+  replace(manifest: FirmwareManifest | null): void {
+    if (manifest) this.setManifest(normalizeManifest(manifest));
+  }
+
+  /**
+   * 订阅清单变化
+   */
+  onChange(listener: (manifest: FirmwareManifest) => void): void {
+    this.listeners.push(listener);
+  }
+
+  /**
+   * 获取当前清单
+   */
+  getManifest(): FirmwareManifest | null {
+    return this.manifest;
+  }
+
+  /**
+   * 所有控制板，主控制板在前；没有清单时为空
+   */
+  getBoards(): BoardManifest[] {
+    return this.manifest?.boards ?? [];
+  }
+
+  getBoard(boardId: string): BoardManifest | null {
+    return this.manifest?.boards.find(board => board.id === boardId) ?? null;
+  }
+
+  /**
+   * 设备所在的控制板，不在任何固件设备表中返回null
+   */
+  getBoardOf(deviceId: string): string | null {
+    return this.deviceSlots.get(deviceId)?.boardId ?? null;
+  }
+
+  /**
+   * 记录控制板上报的清单哈希；与清单不一致时告警（同一组合只告警一次）
+   * 没有上报哈希的旧固件不记录，保持未验证
+   */
+  reportBoardHash(boardId: string, hash: unknown): void {
+    if (typeof hash !== 'number' || !Number.isInteger(hash) || hash <= 0) return;
+    this.reportedHashes.set(boardId, hash);
+
+    const expected = this.getBoard(boardId)?.hash;
+    const mismatch = `${hash}:${expected}`;
+    if (expected !== undefined && hash !== expected && this.warnedMismatches.get(boardId) !== mismatch) {
+      this.warnedMismatches.set(boardId, mismatch);
+      this.logger.warn(`Board ${boardId} runs firmware with manifest ${formatManifestHash(hash)}, expected ${formatManifestHash(expected)}; flash the generated firmware. Using device id addressing until then`);
+    }
+  }
+
+  /**
+   * 控制板运行的固件与清单一致：可以使用位掩码与索引寻址
+   */
+  isBoardVerified(boardId: string): boolean {
+    const expected = this.getBoard(boardId)?.hash;
+    return expected !== undefined && this.reportedHashes.get(boardId) === expected;
+  }
+
+  /**
+   * 控制板上报的清单哈希，尚未上报时为null
+   */
+  getReportedHash(boardId: string): number | null {
+    return this.reportedHashes.get(boardId) ?? null;
+  }
+
+  /**
+   * 计算一组设备的位掩码；任一设备不在固件设备表中、或设备分属不同控制板则返回null
+   */
+  getDeviceMask(deviceIds: string[]): number | null {
+    let mask = 0;
+    let boardId: string | null = null;
+    for (const deviceId of deviceIds) {
+      const slot = this.deviceSlots.get(deviceId);
+      if (!slot || (boardId !== null && slot.boardId !== boardId)) return null;
+      boardId = slot.boardId;
+      mask += 2 ** slot.index;
+    }
+    return mask;
+  }
+
+  /**
+   * 获取设备在其控制板固件设备表中的索引，不存在返回-1
+   */
+  getDeviceIndex(deviceId: string): number {
+    return this.deviceSlots.get(deviceId)?.index ?? -1;
+  }
+
+  /**
+   * 获取控制回路在其控制板固件回路表中的索引，不存在返回-1
+   */
+  getControlLoopIndex(loopId: string): number {
+    return this.loopSlots.get(loopId)?.index ?? -1;
+  }
+
+  /**
+   * 控制回路所在的控制板，不存在返回null
+   */
+  getControlLoopBoard(loopId: string): string | null {
+    return this.loopSlots.get(loopId)?.boardId ?? null;
+  }
+
+  private setManifest(manifest: FirmwareManifest): void {
+    this.manifest = manifest;
+    this.deviceSlots.clear();
+    this.loopSlots.clear();
+    for (const board of manifest.boards) {
+      board.deviceOrder.forEach((deviceId, index) => this.deviceSlots.set(deviceId, { boardId: board.id, index }));
+      board.controlLoops.forEach((loopId, index) => this.loopSlots.set(loopId, { boardId: board.id, index }));
+    }
+    this.listeners.forEach(listener => listener(manifest));
+  }
+}
+
+/**
+ * 清单哈希：设备表顺序、分组位掩码与回路表顺序的 FNV-1a 32位哈希（不为0，0表示固件未定义）
+ * 生成器写入固件（MANTA_MANIFEST_HASH），固件上报后与清单比较
+ */
+export function computeManifestHash(board: Pick<BoardManifest, 'deviceOrder' | 'groupMasks' | 'controlLoops'>): number {
+  const groups = Object.entries(board.groupMasks)
+    .sort(([a], [b]) => (a < b ? -1 : a > b ? 1 : 0))
+    .map(([id, mask]) => `${id}=${mask}`);
+  const text = `${board.deviceOrder.join(',')}|${groups.join(',')}|${board.controlLoops.join(',')}`;
+
+  let hash = 0x811c9dc5;
+  for (const byte of Buffer.from(text, 'utf-8')) {
+    hash = Math.imul(hash ^ byte, 0x01000193) >>> 0;
+  }
+  return hash === 0 ? 1 : hash;
+}
+
+export function formatManifestHash(hash: number): string {
+  return `0x${hash.toString(16).padStart(8, '0')}`;
+}
+
+/**
+ * 单控制板版本的清单（设备表在顶层）转换为只有主控制板的清单；
+ * 没有哈希的旧清单按内容补算（对应的旧固件不上报哈希，仍为未验证）
+ */
+function normalizeManifest(raw: any): FirmwareManifest {
+  const withHash = (board: Omit<BoardManifest, 'hash'> & { hash?: number }): BoardManifest => ({
+    ...board,
+    hash: typeof board.hash === 'number' ? board.hash : computeManifestHash(board)
+  });
+
+  if (Array.isArray(raw?.boards)) {
+    return {
+      generatedAt: raw.generatedAt,
+      boards: raw.boards.map((board: BoardManifest) => withHash({ ...board, controlLoops: board.controlLoops ?? [] }))
+    };
+  }
+
+  return {
+    generatedAt: raw?.generatedAt ?? '',
+    boards: [withHash({
+      id: DEFAULT_BOARD_ID,
+      host: DEFAULT_BOARD_HOST,
+      deviceOrder: Array.isArray(raw?.deviceOrder) ? raw.deviceOrder : [],
+      groupMasks: raw?.groupMasks ?? {},
+      controlLoops: Array.isArray(raw?.controlLoops) ? raw.controlLoops : []
+    })]
+  };
+}
+
+interface BoardSlot {
+  boardId: string;
+  index: number;
+}
+
+export interface FirmwareManifest {
+  generatedAt: string;
+  boards: BoardManifest[];   // 主控制板在前
+}
+
+export interface BoardManifest {
+  id: string;
+  host: string;                        // 控制板IPv4地址
+  deviceOrder: string[];               // 固件设备表顺序（位掩码第i位 = deviceOrder[i]）
+  groupMasks: Record<string, number>;
+  controlLoops: string[];              // 固件控制回路表顺序
+  hash: number;                        // 清单哈希，与固件的 MANTA_MANIFEST_HASH 一致
+}
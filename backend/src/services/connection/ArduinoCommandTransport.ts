@@ -0,0 +1,486 @@
+import { Logger } from 'winston';
+import type { UnifiedLogService } from '../UnifiedLogService';
+import type { TaskAction } from '../../types/task';
+import { BoardClock, monotonicNow } from './BoardClock';
+import type { BoardClockStats } from './BoardClock';
+
+/**
+ * Arduino命令传输（每个控制板一个）
+ * 批处理命令经 POST /api/commands 按顺序发送，同时在途的请求数有上限
+ *
+ * 职责：
+ * - 批次按入队顺序发送，每个批次带会话 ss 与递增序号 sq，固件丢弃比已执行批次旧的批次
+ * - 链路慢时命令在队列中等待；同一设备的新命令覆盖队列中尚未发送的旧命令（后写者胜）
+ * - 队列超过上限时丢弃最旧的批次
+ * - 被固件判定过时的批次中，之后没有再发送过的设备命令重新入队
+ * - 急停后停止发送：丢弃队列、中止在途请求并忽略其结果，直到下一次 start() 以新会话重新开始
+ * - 由确认中的时间戳估计本板时钟；给定计划时刻的批次带上本板时钟上的执行时刻 at
+ * - 统计队列深度、合并/丢弃数量、请求往返延迟与定时批次的迟到量
+ */
+export class ArduinoCommandTransport {
+  private queue: QueuedBatch[] = [];
+  private inFlight = 0;
+  private sequence = 0;
+  private session = createSession();
+  private epoch = 0;                // 每次急停加一，之前发出的批次结果一律丢弃
+  private halted = false;           // 急停后到下一次 start() 之前不发送
+  private controllers: Set<AbortController> = new Set();  // 在途请求
+  private lastSequenceByDevice: Map<string, number> = new Map();  // 设备最近一次发送所在批次的序号
+  private config: ArduinoTransportConfig;
+  private counters = createTransportCounters();
+  private latency = createLatencyWindow();
+  private queueWait = createLatencyWindow();
+  private lateness = createLatencyWindow();
+  private clock = new BoardClock();
+
+  constructor(
+    private logger: Logger,
+    private logService: Pick<UnifiedLogService, 'logArduino'>,
+    private encode: (commands: TaskAction[]) => ArduinoCommand[],
+    private onAcknowledged?: (state: any) => void,
+    config: Partial<ArduinoTransportConfig> = {}
+  ) {
+    this.config = { ...getDefaultArduinoTransportConfig(), ...config };
+  }
+
+  /**
+   * 命令入队，不等待发送结果
+   * executeAt 为本地单调时钟上的计划执行时刻，本板时钟已估计时由固件等到该时刻执行
+   */
+  enqueue(commands: TaskAction[], timestamp: number, executeAt: number | null = null): void {
+    if (commands.length === 0) return;
+    if (this.halted) {
+      this.counters.clearedCommands += commands.length;
+      return;
+    }
+
+    this.coalesce(new Set(commands.map(cmd => cmd.deviceId)));
+    this.queue.push({ commands, timestamp, executeAt, enqueuedAt: Date.now() });
+
+    while (this.queue.length > this.config.maxQueueDepth) {
+      const dropped = this.queue.shift()!;
+      this.counters.droppedBatches++;
+      this.counters.droppedCommands += dropped.commands.length;
+      this.logger.warn(`Arduino command queue full (${this.config.maxQueueDepth}), dropped oldest batch of ${dropped.commands.length} commands`);
+    }
+
+    this.pump();
+  }
+
+  /**
+   * 急停时调用：丢弃所有尚未发送的命令并中止在途请求，直到 start() 之前不再发送
+   * 在途批次的结果（包括过时重发）被忽略；控制板上已收到的批次由固件的急停锁定拒绝
+   */
+  clear(): number {
+    const cleared = this.queue.reduce((total, batch) => total + batch.commands.length, 0);
+    this.queue = [];
+    this.counters.clearedCommands += cleared;
+
+    this.epoch++;
+    this.halted = true;
+    for (const controller of this.controllers) {
+      controller.abort();
+    }
+    return cleared;
+  }
+
+  /**
+   * 急停后恢复发送（任务开始时调用）；换用新会话，固件收到新会话的批次才解除急停锁定
+   */
+  start(): void {
+    if (!this.halted) return;
+    this.halted = false;
+    this.session = createSession(this.session);
+    this.logger.info(`Board ${this.config.boardId} command transport resumed with session ${this.session}`);
+    this.pump();
+  }
+
+  /**
+   * 发送空批次（不占用序号）探测本板时钟，任务开始前调用；确认中的状态快照同样交给 onAcknowledged
+   */
+  async probe(): Promise<boolean> {
+    const controller = new AbortController();
+    const timeoutId = setTimeout(() => controller.abort(), this.config.requestTimeoutMs);
+    const sentAt = monotonicNow();
+
+    try {
+      const response = await fetch(`${this.config.baseUrl}/api/commands`, {
+        method: 'POST',
+        headers: {
+          'Content-Type': 'application/json',
+          'Accept': 'application/json'
+        },
+        body: JSON.stringify({ id: `probe_${Date.now()}`, ts: Date.now(), ss: this.session, sq: 0, cmds: [] }),
+        signal: controller.signal
+      });
+      const receivedAt = monotonicNow();
+      if (!response.ok) return false;
+
+      const result = await response.json();
+      this.clock.addSample(sentAt, Number(result?.rx), Number(result?.state?.up), receivedAt);
+      this.counters.probes++;
+      this.onAcknowledged?.(result?.state);
+      return true;
+    } catch (error) {
+      this.logger.debug(`Clock probe to board ${this.config.boardId} failed: ${error instanceof Error ? error.message : String(error)}`);
+      return false;
+    } finally {
+      clearTimeout(timeoutId);
+    }
+  }
+
+  /**
+   * 传输统计
+   */
+  getStats(): ArduinoTransportStats {
+    return {
+      boardId: this.config.boardId,
+      baseUrl: this.config.baseUrl,
+      queueDepth: this.queue.length,
+      queuedCommands: this.queue.reduce((total, batch) => total + batch.commands.length, 0),
+      inFlight: this.inFlight,
+      maxInFlight: this.config.maxInFlight,
+      ...this.counters,
+      latency: summarizeLatency(this.latency),
+      queueWait: summarizeLatency(this.queueWait),
+      lateness: summarizeLatency(this.lateness),
+      clock: this.clock.getStats()
+    };
+  }
+
+  /**
+   * 同一设备只保留最新的命令：从尚未发送的批次中移除这些设备的旧命令，空批次整体移除
+   */
+  private coalesce(deviceIds: Set<string>): void {
+    if (this.queue.length === 0) return;
+
+    for (const batch of this.queue) {
+      const remaining = batch.commands.filter(cmd => !deviceIds.has(cmd.deviceId));
+      this.counters.coalescedCommands += batch.commands.length - remaining.length;
+      batch.commands = remaining;
+    }
+    this.queue = this.queue.filter(batch => batch.commands.length > 0);
+  }
+
+  /**
+   * 在途窗口未满时按顺序发出队首批次
+   */
+  private pump(): void {
+    while (!this.halted && this.inFlight < this.config.maxInFlight && this.queue.length > 0) {
+      const batch = this.queue.shift()!;
+      this.inFlight++;
+      this.send(batch).finally(() => {
+        this.inFlight--;
+        this.pump();
+      });
+    }
+  }
+
+  private async send(batch: QueuedBatch): Promise<void> {
+    const sequence = ++this.sequence;
+    const epoch = this.epoch;
+    const executeAt = batch.executeAt !== null ? this.clock.toBoardTime(batch.executeAt) : null;
+    const payload: ArduinoPayload = {
+      id: `cmd_${Date.now()}_${Math.random().toString(36).substring(2, 9)}`,
+      ts: batch.timestamp,
+      ss: this.session,
+      sq: sequence,
+      ...(executeAt !== null && { at: executeAt }),
+      cmds: this.encode(batch.commands)
+    };
+    if (batch.executeAt !== null && executeAt === null) {
+      this.counters.untimedBatches++;
+    }
+    for (const cmd of batch.commands) {
+      this.lastSequenceByDevice.set(cmd.deviceId, sequence);
+    }
+
+    const startTime = Date.now();
+    const sentAt = monotonicNow();
+    record(this.queueWait, startTime - batch.enqueuedAt);
+    this.counters.sent++;
+
+    this.logService.logArduino('send', `Sending ${payload.cmds.length} commands to Arduino`, {
+      boardId: this.config.boardId,
+      commandCount: payload.cmds.length,
+      commands: payload.cmds.map(cmd => `${cmd.dev ?? `mask:0x${cmd.msk?.toString(16)}`}:${cmd.act}=${cmd.val}`),
+      timestamp: payload.ts,
+      commandId: payload.id,
+      sequence
+    });
+
+    const controller = new AbortController();
+    const timeoutId = setTimeout(() => controller.abort(), this.config.requestTimeoutMs);
+    this.controllers.add(controller);
+
+    try {
+      const response = await fetch(`${this.config.baseUrl}/api/commands`, {
+        method: 'POST',
+        headers: {
+          'Content-Type': 'application/json',
+          'Accept': 'application/json'
+        },
+        body: JSON.stringify(payload),
+        signal: controller.signal
+      });
+      if (this.isSupersededByStop(epoch, sequence)) return;
+
+      const receivedAt = monotonicNow();
+      const responseTime = Date.now() - startTime;
+      record(this.latency, responseTime);
+
+      if (response.status === 409) {
+        // 控制板已急停（例如由其他通道触发）并锁定本会话，之后的批次同样会被拒绝，停止发送直到下一次 start()
+        this.counters.failed++;
+        this.logger.warn(`Board ${this.config.boardId} rejected batch #${sequence}: emergency stop latched, halting until the next task start`);
+        this.clear();
+        return;
+      }
+      if (!response.ok) {
+        throw new Error(`Arduino HTTP ${response.status}: ${response.statusText}`);
+      }
+
+      const result = await response.json();
+      if (this.isSupersededByStop(epoch, sequence)) return;
+
+      this.clock.addSample(sentAt, Number(result?.rx), Number(result?.state?.up), receivedAt);
+      if (typeof result?.late === 'number') {
+        record(this.lateness, result.late);
+        if (result.late > 0) this.counters.lateBatches++;
+      }
+
+      // 确认中携带设备状态快照，直接更新设备状态，无需额外轮询
+      this.onAcknowledged?.(result?.state);
+
+      if (result?.stale) {
+        this.counters.stale++;
+        this.requeueStale(batch, sequence);
+        return;
+      }
+
+      this.counters.acknowledged++;
+      this.logService.logArduino('receive', `Arduino responded successfully`, {
+        boardId: this.config.boardId,
+        responseTime,
+        result,
+        status: response.status
+      });
+      this.logger.info('Arduino commands sent successfully:', {
+        boardId: this.config.boardId,
+        commandCount: payload.cmds.length,
+        responseTime: `${responseTime}ms`,
+        status: response.status,
+        commandId: payload.id
+      });
+
+    } catch (error) {
+      if (this.isSupersededByStop(epoch, sequence)) return;
+
+      const responseTime = Date.now() - startTime;
+      this.counters.failed++;
+
+      this.logService.logArduino('send', `Arduino communication failed`, {
+        boardId: this.config.boardId,
+        error: error instanceof Error ? error.message : String(error),
+        responseTime,
+        payload,
+        isTimeout: error instanceof Error && error.name === 'AbortError'
+      });
+      this.logger.error('Arduino communication failed:', {
+        boardId: this.config.boardId,
+        error: error instanceof Error ? error.message : String(error),
+        responseTime,
+        isTimeout: error instanceof Error && error.name === 'AbortError',
+        payload: {
+          timestamp: payload.ts,
+          commandCount: payload.cmds.length,
+          commandId: payload.id
+        }
+      });
+
+      // 不抛出错误，继续发送后续批次
+    } finally {
+      clearTimeout(timeoutId);
+      this.controllers.delete(controller);
+    }
+  }
+
+  /**
+   * 批次发出后发生了急停：结果不再处理，也不重发
+   */
+  private isSupersededByStop(epoch: number, sequence: number): boolean {
+    if (epoch === this.epoch) return false;
+    this.counters.abortedBatches++;
+    this.logger.debug(`Board ${this.config.boardId} batch #${sequence} superseded by emergency stop, result ignored`);
+    return true;
+  }
+
+  /**
+   * 过时批次：之后已发送或已排队的设备命令更新，不再重发；其余命令放回队首
+   */
+  private requeueStale(batch: QueuedBatch, sequence: number): void {
+    const queuedDevices = new Set(this.queue.flatMap(queued => queued.commands.map(cmd => cmd.deviceId)));
+    const commands = batch.commands.filter(cmd =>
+      this.lastSequenceByDevice.get(cmd.deviceId) === sequence && !queuedDevices.has(cmd.deviceId)
+    );
+
+    this.logger.warn(`Board ${this.config.boardId} rejected stale batch #${sequence}, resending ${commands.length} of ${batch.commands.length} commands`);
+    if (commands.length === 0) return;
+
+    this.counters.resentCommands += commands.length;
+    this.queue.unshift({ ...batch, commands });
+  }
+}
+
+function createTransportCounters(): TransportCounters {
+  return {
+    sent: 0,
+    acknowledged: 0,
+    failed: 0,
+    stale: 0,
+    coalescedCommands: 0,
+    droppedBatches: 0,
+    droppedCommands: 0,
+    clearedCommands: 0,
+    resentCommands: 0,
+    abortedBatches: 0,
+    lateBatches: 0,
+    untimedBatches: 0,
+    probes: 0
+  };
+}
+
+/**
+ * 会话号（1..65535），与上一个会话不同
+ */
+function createSession(previous = 0): number {
+  const session = Math.floor(Math.random() * 0xFFFF) + 1;
+  return session === previous ? (session % 0xFFFF) + 1 : session;
+}
+
+function createLatencyWindow(): LatencyWindow {
+  return { count: 0, sum: 0, max: 0, last: 0, recent: [], recentIndex: 0 };
+}
+
+const LATENCY_WINDOW_SIZE = 256;
+
+function record(window: LatencyWindow, valueMs: number): void {
+  window.count++;
+  window.sum += valueMs;
+  window.last = valueMs;
+  if (valueMs > window.max) window.max = valueMs;
+
+  if (window.recent.length < LATENCY_WINDOW_SIZE) {
+    window.recent.push(valueMs);
+  } else {
+    window.recent[window.recentIndex] = valueMs;
+  }
+  window.recentIndex = (window.recentIndex + 1) % LATENCY_WINDOW_SIZE;
+}
+
+function summarizeLatency(window: LatencyWindow): LatencySummary {
+  const sorted = [...window.recent].sort((a, b) => a - b);
+  const p95 = sorted.length > 0 ? sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * 0.95))] : 0;
+  return {
+    lastMs: window.last,
+    meanMs: window.count > 0 ? Math.round(window.sum / window.count * 10) / 10 : 0,
+    p95Ms: p95,
+    maxMs: window.max
+  };
+}
+
+function getDefaultArduinoTransportConfig(): ArduinoTransportConfig {
+  return {
+    boardId: 'main',
+    baseUrl: process.env.ARDUINO_BASE_URL || 'http://192.168.4.1',
+    maxInFlight: Math.max(1, Number(process.env.ARDUINO_MAX_IN_FLIGHT || 2)),
+    maxQueueDepth: Math.max(1, Number(process.env.ARDUINO_MAX_QUEUE_DEPTH || 64)),
+    requestTimeoutMs: 5000
+  };
+}
+
+interface QueuedBatch {
+  commands: TaskAction[];
+  timestamp: number;      // 批次产生时间（写入 payload.ts）
+  executeAt: number | null;  // 计划执行时刻（本地单调时钟）
+  enqueuedAt: number;
+}
+
+interface TransportCounters {
+  sent: number;               // 已发出的批次
+  acknowledged: number;       // 固件已执行的批次
+  failed: number;             // 超时/网络错误/HTTP错误
+  stale: number;              // 固件判定过时的批次
+  coalescedCommands: number;  // 被同设备新命令覆盖的排队命令
+  droppedBatches: number;     // 队列满时丢弃的批次
+  droppedCommands: number;
+  clearedCommands: number;    // 急停时清空的排队命令
+  resentCommands: number;     // 过时批次中重新入队的命令
+  abortedBatches: number;     // 急停时在途、结果被忽略的批次
+  lateBatches: number;        // 到达控制板时已过执行时刻的定时批次
+  untimedBatches: number;     // 本板时钟尚未估计、未能定时的批次
+  probes: number;             // 时钟探测次数
+}
+
+interface LatencyWindow {
+  count: number;
+  sum: number;
+  max: number;
+  last: number;
+  recent: number[];
+  recentIndex: number;
+}
+
+export interface LatencySummary {
+  lastMs: number;
+  meanMs: number;
+  p95Ms: number;
+  maxMs: number;
+}
+
+export interface ArduinoTransportStats extends TransportCounters {
+  boardId: string;
+  baseUrl: string;
+  queueDepth: number;         // 排队批次数
+  queuedCommands: number;
+  inFlight: number;
+  maxInFlight: number;
+  latency: LatencySummary;    // 请求往返
+  queueWait: LatencySummary;  // 入队到发出
+  lateness: LatencySummary;   // 定时批次到达控制板时超过执行时刻的时间
+  clock: BoardClockStats;
+}
+
+export interface ArduinoTransportConfig {
+  boardId: string;
+  baseUrl: string;
+  maxInFlight: number;        // 同时在途的请求数上限
+  maxQueueDepth: number;      // 排队批次数上限
+  requestTimeoutMs: number;
+}
+
+export interface ArduinoPayload {
+  id: string;
+  ts: number;
+  ss: number;     // 会话（后端每次启动与每次急停后不同）
+  sq: number;     // 会话内递增序号
+  at?: number;    // 执行时刻（控制板 millis()），多控制板部署时各板按此对齐
+  cmds: ArduinoCommand[];
+}
+
+export interface ArduinoCommand {
+  dev?: string;   // 单设备ID
+  msk?: number;   // 设备位掩码（第i位 = 固件设备表第i个设备）
+  act: string;
+  val: any;
+  dur: number;
+  prf?: ArduinoWaveform;  // PWM波形配置
+}
+
+export interface ArduinoWaveform {
+  s: number;  // 波形
+  p: number;  // 周期(ms)
+  a: number;  // 幅值(%)
+  o: number;  // 基准值(%)
+  n: number;  // 周期数，0为持续
+}
@@ -0,0 +1,78 @@
+/**
+ * 控制板时钟估计
+ * 由命令往返的四个时间戳（本地发送、板上收到 rx、板上回复 up、本地收到）按NTP方式估计本板 millis() 与本地单调时钟的偏移，
+ * 取最近若干样本中往返最短的一个，把本地计划时刻换算为板上的执行时刻
+ */
+export class BoardClock {
+  private samples: ClockSample[] = [];
+  private lastBoardMs: number | null = null;
+
+  constructor(private maxSamples = 16) {}
+
+  /**
+   * 记录一次往返；板上时间倒退视为重启（或 millis() 回绕），丢弃旧样本
+   */
+  addSample(sentAt: number, boardReceivedMs: number, boardRepliedMs: number, receivedAt: number): void {
+    if (!Number.isFinite(boardReceivedMs) || !Number.isFinite(boardRepliedMs) || boardRepliedMs < boardReceivedMs) return;
+
+    if (this.lastBoardMs !== null && boardRepliedMs < this.lastBoardMs) {
+      this.samples = [];
+    }
+    this.lastBoardMs = boardRepliedMs;
+
+    // 板上处理时间（含定时批次的等待）不计入往返
+    const rttMs = Math.max(0, (receivedAt - sentAt) - (boardRepliedMs - boardReceivedMs));
+    const offsetMs = ((boardReceivedMs - sentAt) + (boardRepliedMs - receivedAt)) / 2;
+
+    this.samples.push({ offsetMs, rttMs });
+    if (this.samples.length > this.maxSamples) {
+      this.samples.shift();
+    }
+  }
+
+  /**
+   * 本地单调时钟时刻对应的板上 millis()（32位回绕），尚无样本时返回null
+   */
+  toBoardTime(localMs: number): number | null {
+    const best = this.best();
+    if (!best) return null;
+    return Math.round(localMs + best.offsetMs) >>> 0;
+  }
+
+  getStats(): BoardClockStats {
+    const best = this.best();
+    return {
+      synced: best !== null,
+      offsetMs: best ? Math.round(best.offsetMs * 10) / 10 : null,
+      uncertaintyMs: best ? Math.round(best.rttMs / 2 * 10) / 10 : null,
+      samples: this.samples.length
+    };
+  }
+
+  private best(): ClockSample | null {
+    let best: ClockSample | null = null;
+    for (const sample of this.samples) {
+      if (!best || sample.rttMs < best.rttMs) best = sample;
+    }
+    return best;
+  }
+}
+
+/**
+ * 与调度器相同的单调时钟（ms）
+ */
+export function monotonicNow(): number {
+  return Number(process.hrtime.bigint()) / 1e6;
+}
+
+interface ClockSample {
+  offsetMs: number;   // 板上时间 - 本地时间
+  rttMs: number;      // 网络往返（不含板上处理）
+}
+
+export interface BoardClockStats {
+  synced: boolean;
+  offsetMs: number | null;
+  uncertaintyMs: number | null;   // 往返的一半，偏移误差上限
+  samples: number;
+}
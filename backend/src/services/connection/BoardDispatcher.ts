@@ -0,0 +1,144 @@
+import { Logger } from 'winston';
+import type { UnifiedLogService } from '../UnifiedLogService';
+import type { FirmwareManifestStore } from '../code-generation/FirmwareManifest';
+import { ArduinoCommandTransport } from './ArduinoCommandTransport';
+import type { ArduinoCommand, ArduinoTransportStats } from './ArduinoCommandTransport';
+import { resolveBoardTargets } from './BoardTargets';
+import type { BoardTarget } from './BoardTargets';
+import type { TaskAction } from '../../types/task';
+
+/**
+ * 多控制板命令分发
+ * 每个控制板一个命令传输；每轮批次按设备所在控制板拆分，同一时刻向各控制板并行发出
+ *
+ * 跨控制板对齐：多控制板部署时调度器提前 alignmentLeadMs 触发事件，
+ * 各控制板的批次带上换算到本板时钟的同一执行时刻，由固件等到该时刻执行
+ */
+export class BoardDispatcher {
+  private transports: Map<string, ArduinoCommandTransport> = new Map();
+  private targets: BoardTarget[] = [];
+  private config: BoardDispatcherConfig;
+
+  constructor(
+    private logger: Logger,
+    private logService: Pick<UnifiedLogService, 'logArduino'>,
+    private encode: (commands: TaskAction[]) => ArduinoCommand[],
+    private onAcknowledged: (boardId: string, state: any) => void,
+    private firmwareManifest?: FirmwareManifestStore,
+    config: Partial<BoardDispatcherConfig> = {}
+  ) {
+    this.config = { ...getDefaultBoardDispatcherConfig(), ...config };
+    this.refresh();
+    this.firmwareManifest?.onChange(() => this.refresh());
+  }
+
+  /**
+   * 按控制板拆分命令并发送；不在固件清单中的设备发往主控制板
+   * executeAt 为本地单调时钟上的计划执行时刻（单控制板时为null，收到即执行）
+   */
+  dispatch(commands: TaskAction[], timestamp: number, executeAt: number | null): void {
+    const primary = this.targets[0].boardId;
+    const byBoard = new Map<string, TaskAction[]>();
+    for (const cmd of commands) {
+      const boardId = this.firmwareManifest?.getBoardOf(cmd.deviceId) ?? primary;
+      const bucket = byBoard.get(boardId);
+      if (bucket) {
+        bucket.push(cmd);
+      } else {
+        byBoard.set(boardId, [cmd]);
+      }
+    }
+
+    for (const [boardId, boardCommands] of byBoard) {
+      const transport = this.transports.get(boardId) ?? this.transports.get(primary)!;
+      transport.enqueue(boardCommands, timestamp, executeAt);
+    }
+  }
+
+  /**
+   * 跨控制板对齐所需的提前量，单控制板时为0
+   */
+  getAlignmentLeadMs(): number {
+    return this.targets.length > 1 ? this.config.alignmentLeadMs : 0;
+  }
+
+  /**
+   * 探测各控制板时钟（任务开始时调用，不等待结果）
+   */
+  syncClocks(): void {
+    for (const transport of this.transports.values()) {
+      transport.probe();
+    }
+  }
+
+  /**
+   * 急停后恢复各控制板的命令发送（任务开始时调用）
+   */
+  start(): void {
+    for (const transport of this.transports.values()) {
+      transport.start();
+    }
+  }
+
+  /**
+   * 急停：丢弃所有控制板尚未发送的命令并中止在途请求，返回丢弃数量；start() 之前不再发送
+   */
+  clear(): number {
+    let cleared = 0;
+    for (const transport of this.transports.values()) {
+      cleared += transport.clear();
+    }
+    return cleared;
+  }
+
+  getTargets(): BoardTarget[] {
+    return this.targets;
+  }
+
+  getStats(): ArduinoTransportStats[] {
+    return [...this.transports.values()].map(transport => transport.getStats());
+  }
+
+  /**
+   * 按固件清单重建控制板列表；地址未变的控制板保留原传输（序号、队列与时钟估计）
+   */
+  private refresh(): void {
+    const targets = resolveBoardTargets(this.firmwareManifest);
+    const transports = new Map<string, ArduinoCommandTransport>();
+
+    for (const target of targets) {
+      const existing = this.transports.get(target.boardId);
+      if (existing && existing.getStats().baseUrl === target.baseUrl) {
+        transports.set(target.boardId, existing);
+        continue;
+      }
+      transports.set(target.boardId, new ArduinoCommandTransport(
+        this.logger,
+        this.logService,
+        this.encode,
+        state => {
+          // 确认中的清单哈希与清单一致后，该控制板的命令才编码为位掩码
+          this.firmwareManifest?.reportBoardHash(target.boardId, state?.mh);
+          this.onAcknowledged(target.boardId, state);
+        },
+        { boardId: target.boardId, baseUrl: target.baseUrl }
+      ));
+    }
+
+    this.targets = targets;
+    this.transports = transports;
+    if (targets.length > 1) {
+      this.logger.info(`Dispatching commands to ${targets.length} boards: ${targets.map(t => `${t.boardId}@${t.baseUrl}`).join(', ')}`);
+    }
+  }
+}
+
+function getDefaultBoardDispatcherConfig(): BoardDispatcherConfig {
+  return {
+    alignmentLeadMs: Math.max(0, Number(process.env.ARDUINO_ALIGN_LEAD_MS || 50))
+  };
+}
+
+export interface BoardDispatcherConfig {
+  alignmentLeadMs: number;   // 多控制板时事件提前触发的时间，需覆盖命令往返与排队
+}
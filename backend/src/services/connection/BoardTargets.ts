@@ -0,0 +1,42 @@
+import type { FirmwareManifestStore } from '../code-generation/FirmwareManifest';
+import { DEFAULT_BOARD_ID, DEFAULT_BOARD_HOST } from '../code-generation/FirmwareManifest';
+
+/**
+ * 控制板地址
+ * 地址来自固件清单（生成固件时确定）；主控制板可由 ARDUINO_BASE_URL / ARDUINO_HOST 覆盖，
+ * 没有清单时只有一个地址由环境变量决定的主控制板
+ */
+export function resolveBoardTargets(manifest?: FirmwareManifestStore): BoardTarget[] {
+  const boards = manifest?.getBoards() ?? [];
+  if (boards.length === 0) {
+    return [primaryTarget(DEFAULT_BOARD_ID, DEFAULT_BOARD_HOST)];
+  }
+
+  return boards.map((board, index) => index === 0
+    ? primaryTarget(board.id, board.host)
+    : { boardId: board.id, host: board.host, baseUrl: `http://${board.host}` });
+}
+
+/**
+ * 查找控制板地址，未知控制板返回null
+ */
+export function findBoardTarget(manifest: FirmwareManifestStore | undefined, boardId: string): BoardTarget | null {
+  return resolveBoardTargets(manifest).find(target => target.boardId === boardId) ?? null;
+}
+
+function primaryTarget(boardId: string, host: string): BoardTarget {
+  const baseUrl = process.env.ARDUINO_BASE_URL || `http://${host}`;
+  let resolvedHost = host;
+  try {
+    resolvedHost = process.env.ARDUINO_HOST || new URL(baseUrl).hostname;
+  } catch {
+    // 非法URL时使用清单中的地址
+  }
+  return { boardId, host: resolvedHost, baseUrl };
+}
+
+export interface BoardTarget {
+  boardId: string;
+  host: string;      // UDP急停与状态查询
+  baseUrl: string;   // HTTP命令
+}
@@ -2,6 +2,7 @@ import winston from 'winston';
 import { SerialConnectionManager, SerialConfig } from './SerialConnectionManager';
 import { WiFiConnectionManager, WiFiConnectionConfig } from './WiFiConnectionManager';
 import { ConnectionConfig } from '../../types/device';
+import { FirmwareManifestStore } from '../code-generation/FirmwareManifest';
 
 /**
  * 连接管理器工厂
@@ -14,9 +15,11 @@ import { ConnectionConfig } from '../../types/device';
  */
 export class ConnectionManagerFactory {
   private logger: winston.Logger;
+  private firmwareManifest?: FirmwareManifestStore;
 
-  constructor(logger: winston.Logger) {
+  constructor(logger: winston.Logger, firmwareManifest?: FirmwareManifestStore) {
     this.logger = logger;
+    this.firmwareManifest = firmwareManifest;
   }
 
   /**
@@ -28,7 +31,7 @@ export class ConnectionManagerFactory {
         if (!config.serial) {
           throw new Error('Serial configuration is required for serial connection');
         }
-        return new SerialConnectionManager(config.serial, this.logger);
+        return new SerialConnectionManager(config.serial, this.logger, this.firmwareManifest);
 
       case 'wifi':
         if (!config.wifi) {
@@ -45,7 +48,7 @@ export class ConnectionManagerFactory {
    * 创建自动切换连接管理器
    */
   createAutoSwitchManager(configs: ConnectionConfig[]): AutoSwitchConnectionManager {
-    return new AutoSwitchConnectionManager(configs, this.logger);
+    return new AutoSwitchConnectionManager(configs, this.logger, this.firmwareManifest);
   }
 }
 
@@ -73,10 +76,10 @@ export class AutoSwitchConnectionManager {
   private currentConfigIndex = 0;
   private factory: ConnectionManagerFactory;
 
-  constructor(configs: ConnectionConfig[], logger: winston.Logger) {
+  constructor(configs: ConnectionConfig[], logger: winston.Logger, firmwareManifest?: FirmwareManifestStore) {
     this.configs = configs;
     this.logger = logger;
-    this.factory = new ConnectionManagerFactory(logger);
+    this.factory = new ConnectionManagerFactory(logger, firmwareManifest);
   }
 
   /**
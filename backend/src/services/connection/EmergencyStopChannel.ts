@@ -0,0 +1,275 @@
+import dgram from 'dgram';
+import { Logger } from 'winston';
+import type { BoardTarget } from './BoardTargets';
+
+/**
+ * 急停通道
+ * 通过UDP数据报向固件发送急停，失败时回退到HTTP
+ *
+ * 职责：
+ * - 发送 "ESTOP:<seq>" 数据报并在预算内重发，直到收到 "ESTOP_ACK:<seq>"
+ * - 测量端到端延迟（发送 -> 固件关闭输出并确认）
+ * - UDP未确认时回退到 POST /api/estop
+ */
+export class EmergencyStopChannel {
+  private socket: dgram.Socket | null = null;
+  private sequence = 0;
+  private pendingAcks: Map<number, () => void> = new Map();
+  private config: EmergencyStopConfig;
+
+  constructor(
+    private logger: Logger,
+    config: Partial<EmergencyStopConfig> = {}
+  ) {
+    this.config = { ...getDefaultEmergencyStopConfig(), ...config };
+  }
+
+  /**
+   * 触发急停
+   */
+  async trigger(): Promise<EmergencyStopResult> {
+    const seq = ++this.sequence;
+    const startTime = process.hrtime.bigint();
+    const elapsedMs = () => Number(process.hrtime.bigint() - startTime) / 1e6;
+
+    const udpAttempts = await this.sendViaUdp(seq);
+    if (udpAttempts.acknowledged) {
+      return this.buildResult('udp', true, elapsedMs(), udpAttempts.attempts);
+    }
+
+    this.logger.warn(`Emergency stop datagram not acknowledged within ${this.config.latencyBudgetMs}ms, falling back to HTTP`);
+
+    const httpAcknowledged = await this.sendViaHttp();
+    return this.buildResult('http', httpAcknowledged, elapsedMs(), udpAttempts.attempts);
+  }
+
+  /**
+   * 关闭UDP套接字
+   */
+  close(): void {
+    if (this.socket) {
+      this.socket.close();
+      this.socket = null;
+    }
+    this.pendingAcks.clear();
+  }
+
+  /**
+   * 在延迟预算内重复发送数据报，直到收到确认
+   */
+  private async sendViaUdp(seq: number): Promise<{ acknowledged: boolean; attempts: number }> {
+    let socket: dgram.Socket;
+    try {
+      socket = this.getSocket();
+    } catch (error) {
+      this.logger.error('Failed to open emergency stop socket:', error);
+      return { acknowledged: false, attempts: 0 };
+    }
+
+    const message = Buffer.from(`ESTOP:${seq}`);
+    let attempts = 0;
+
+    const acknowledged = await new Promise<boolean>(resolve => {
+      const send = () => {
+        attempts++;
+        socket.send(message, this.config.port, this.config.host, (error) => {
+          if (error) {
+            this.logger.debug(`Emergency stop datagram send failed: ${error.message}`);
+          }
+        });
+      };
+
+      const retryTimer = setInterval(send, this.config.retryIntervalMs);
+      const budgetTimer = setTimeout(() => finish(false), this.config.latencyBudgetMs);
+      const finish = (result: boolean) => {
+        clearInterval(retryTimer);
+        clearTimeout(budgetTimer);
+        this.pendingAcks.delete(seq);
+        resolve(result);
+      };
+
+      this.pendingAcks.set(seq, () => finish(true));
+      send();
+    });
+
+    return { acknowledged, attempts };
+  }
+
+  /**
+   * HTTP备用路径
+   */
+  private async sendViaHttp(): Promise<boolean> {
+    const controller = new AbortController();
+    const timeoutId = setTimeout(() => controller.abort(), this.config.httpTimeoutMs);
+
+    try {
+      const response = await fetch(`${this.config.baseUrl}/api/estop`, {
+        method: 'POST',
+        signal: controller.signal
+      });
+      return response.ok;
+    } catch (error) {
+      this.logger.error('Emergency stop HTTP fallback failed:', {
+        error: error instanceof Error ? error.message : String(error),
+        isTimeout: error instanceof Error && error.name === 'AbortError'
+      });
+      return false;
+    } finally {
+      clearTimeout(timeoutId);
+    }
+  }
+
+  /**
+   * 获取（懒创建）UDP套接字
+   */
+  private getSocket(): dgram.Socket {
+    if (this.socket) return this.socket;
+
+    const socket = dgram.createSocket('udp4');
+    socket.on('message', (msg) => this.handleAck(msg.toString()));
+    socket.on('error', (error) => {
+      this.logger.error('Emergency stop socket error:', error);
+      this.close();
+    });
+    socket.unref(); // 不阻止进程退出
+
+    this.socket = socket;
+    return socket;
+  }
+
+  /**
+   * 处理固件确认 "ESTOP_ACK:<seq>"
+   */
+  private handleAck(message: string): void {
+    const match = /^ESTOP_ACK:(\d+)/.exec(message);
+    if (!match) return;
+
+    const resolve = this.pendingAcks.get(Number(match[1]));
+    if (resolve) resolve();
+  }
+
+  private buildResult(
+    via: 'udp' | 'http',
+    acknowledged: boolean,
+    latencyMs: number,
+    udpAttempts: number
+  ): EmergencyStopResult {
+    const result: EmergencyStopResult = {
+      acknowledged,
+      via,
+      latencyMs: Math.round(latencyMs * 100) / 100,
+      latencyBudgetMs: this.config.latencyBudgetMs,
+      withinBudget: acknowledged && latencyMs <= this.config.latencyBudgetMs,
+      udpAttempts
+    };
+
+    if (!result.withinBudget) {
+      this.logger.warn('Emergency stop exceeded latency budget', result);
+    }
+
+    return result;
+  }
+}
+
+/**
+ * 多控制板急停
+ * 向每个控制板的急停通道并行发送，全部确认才算确认；单控制板时与急停通道相同
+ */
+export class BoardEmergencyStop {
+  private channels: Map<string, EmergencyStopChannel> = new Map();
+
+  constructor(
+    private logger: Logger,
+    private getTargets: () => BoardTarget[]
+  ) {}
+
+  async trigger(): Promise<EmergencyStopResult> {
+    const targets = this.getTargets();
+    const results = await Promise.all(targets.map(async target => ({
+      boardId: target.boardId,
+      ...await this.channelFor(target).trigger()
+    })));
+
+    if (results.length === 1) {
+      const { boardId, ...result } = results[0];
+      return result;
+    }
+
+    const acknowledged = results.every(result => result.acknowledged);
+    const failed = results.filter(result => !result.acknowledged).map(result => result.boardId);
+    if (failed.length > 0) {
+      this.logger.error(`Emergency stop not acknowledged by boards: ${failed.join(', ')}`);
+    }
+
+    return {
+      acknowledged,
+      via: results.some(result => result.via === 'http') ? 'http' : 'udp',
+      latencyMs: Math.max(...results.map(result => result.latencyMs)),
+      latencyBudgetMs: results[0].latencyBudgetMs,
+      withinBudget: results.every(result => result.withinBudget),
+      udpAttempts: results.reduce((total, result) => total + result.udpAttempts, 0),
+      boards: results
+    };
+  }
+
+  close(): void {
+    for (const channel of this.channels.values()) {
+      channel.close();
+    }
+    this.channels.clear();
+  }
+
+  /**
+   * 每个控制板地址一个通道（各自的UDP套接字与序号）
+   */
+  private channelFor(target: BoardTarget): EmergencyStopChannel {
+    const key = `${target.boardId}|${target.host}|${target.baseUrl}`;
+    let channel = this.channels.get(key);
+    if (!channel) {
+      channel = new EmergencyStopChannel(this.logger, { host: target.host, baseUrl: target.baseUrl });
+      this.channels.set(key, channel);
+    }
+    return channel;
+  }
+}
+
+/**
+ * 从环境变量读取默认配置
+ */
+function getDefaultEmergencyStopConfig(): EmergencyStopConfig {
+  const baseUrl = process.env.ARDUINO_BASE_URL || 'http://192.168.4.1';
+  let host = process.env.ARDUINO_HOST || '192.168.4.1';
+  try {
+    host = process.env.ARDUINO_HOST || new URL(baseUrl).hostname;
+  } catch {
+    // 非法URL时使用默认主机
+  }
+
+  return {
+    host,
+    port: Number(process.env.ESTOP_UDP_PORT || 8888),
+    baseUrl,
+    latencyBudgetMs: Number(process.env.ESTOP_LATENCY_BUDGET_MS || 100),
+    retryIntervalMs: 20,
+    httpTimeoutMs: 1000
+  };
+}
+
+export interface EmergencyStopConfig {
+  host: string;
+  port: number;
+  baseUrl: string;
+  latencyBudgetMs: number;  // 端到端延迟预算，UDP在此时间内未确认则回退HTTP
+  retryIntervalMs: number;  // 数据报重发间隔
+  httpTimeoutMs: number;
+}
+
+export interface EmergencyStopResult {
+  acknowledged: boolean;
+  via: 'udp' | 'http';
+  latencyMs: number;
+  latencyBudgetMs: number;
+  withinBudget: boolean;
+  udpAttempts: number;
+  boards?: Array<EmergencyStopResult & { boardId: string }>;   // 多控制板时每个控制板的结果
+}
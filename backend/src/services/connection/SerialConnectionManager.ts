@@ -2,6 +2,9 @@ import { EventEmitter } from 'events';
 import { SerialPort } from 'serialport';
 import winston from 'winston';
 import { ConnectionState, ConnectionStatus, DeviceCommand } from '../../types/device';
+import { FirmwareManifestStore } from '../code-generation/FirmwareManifest';
+import { FrameType, SerialFrameDecoder, decodeStateSnapshot, encodeCommandFrame, encodeControlLoopFrame, encodeFrame } from './SerialFrameCodec';
+import type { ControlLoopUpdate, DecodedFrame, FrameCommandEntry } from './SerialFrameCodec';
 
 /**
  * 串口连接管理器
@@ -11,7 +14,9 @@ import { ConnectionState, ConnectionStatus, DeviceCommand } from '../../types/de
  * - 串口扫描和连接
  * - 设备自动识别
  * - 连接状态监控
- * - 数据收发处理
+ * - 数据收发处理：COBS分帧 + CRC16 的二进制协议（见 SerialFrameCodec），
+ *   设备ID按固件清单映射为设备表索引；串口只能按索引寻址，
+ *   心跳回复中的清单哈希与清单一致之前不发送命令
  */
 export class SerialConnectionManager extends EventEmitter {
   private logger: winston.Logger;
@@ -20,8 +25,16 @@ export class SerialConnectionManager extends EventEmitter {
   private config: SerialConfig;
   private reconnectTimer: NodeJS.Timeout | null = null;
   private heartbeatTimer: NodeJS.Timeout | null = null;
+  private decoder = new SerialFrameDecoder();
+  private sequence = 0;
+  private pendingFrames: Map<number, (frame: DecodedFrame | null) => void> = new Map();
+  private missedHeartbeats = 0;
 
-  constructor(config: SerialConfig, logger: winston.Logger) {
+  constructor(
+    config: SerialConfig,
+    logger: winston.Logger,
+    private firmwareManifest?: FirmwareManifestStore
+  ) {
     super();
     this.config = config;
     this.logger = logger;
@@ -59,22 +72,78 @@ export class SerialConnectionManager extends EventEmitter {
    * 发送命令到设备
    */
   async sendCommand(command: DeviceCommand): Promise<boolean> {
+    return this.sendCommands([command]);
+  }
+
+  /**
+   * 批量发送命令：一帧携带多条命令，等待固件确认
+   */
+  async sendCommands(commands: DeviceCommand[]): Promise<boolean> {
     if (this.connectionState.status !== ConnectionStatus.CONNECTED) {
       this.logger.error('Cannot send command: device not connected');
       return false;
     }
 
+    const entries: FrameCommandEntry[] = [];
+    for (const command of commands) {
+      const entry = this.toFrameEntry(command);
+      if (!entry) return false;
+      entries.push(entry);
+    }
+
     try {
-      const commandStr = this.formatCommand(command);
-      await this.writeToSerial(commandStr);
-      this.logger.debug(`Command sent: ${commandStr}`);
-      return true;
+      const seq = this.nextSequence();
+      const ack = await this.sendFrameAndWait(seq, encodeCommandFrame(seq, entries));
+      if (!ack) {
+        this.logger.warn(`Command frame ${seq} not acknowledged within ${this.getAckTimeout()}ms`);
+        return false;
+      }
+
+      const executed = ack.data[0] ?? 0;
+      this.emitStateSnapshot(ack.data);
+      this.logger.debug(`Command frame ${seq} acknowledged: ${executed}/${entries.length} executed`);
+      return executed === entries.length;
     } catch (error) {
       this.logger.error('Failed to send command:', error);
       return false;
     }
   }
 
+  /**
+   * 通过串口急停
+   */
+  async emergencyStop(): Promise<boolean> {
+    if (!this.serialPort || !this.serialPort.isOpen) return false;
+
+    try {
+      const seq = this.nextSequence();
+      const ack = await this.sendFrameAndWait(seq, encodeFrame(FrameType.ESTOP, seq));
+      if (ack) this.emitStateSnapshot(ack.data);
+      return ack !== null;
+    } catch (error) {
+      this.logger.error('Failed to send emergency stop frame:', error);
+      return false;
+    }
+  }
+
+  /**
+   * 下发控制回路参数
+   */
+  async updateControlLoop(update: ControlLoopUpdate): Promise<boolean> {
+    if (!this.serialPort || !this.serialPort.isOpen) return false;
+
+    try {
+      const seq = this.nextSequence();
+      const ack = await this.sendFrameAndWait(seq, encodeControlLoopFrame(seq, update));
+      if (!ack) return false;
+      this.emitStateSnapshot(ack.data);
+      return ack.data[0] > 0;
+    } catch (error) {
+      this.logger.error('Failed to send control loop frame:', error);
+      return false;
+    }
+  }
+
   /**
    * 获取连接状态
    */
@@ -145,6 +214,7 @@ export class SerialConnectionManager extends EventEmitter {
       this.logger.info('Serial port opened successfully');
       this.updateConnectionState(ConnectionStatus.CONNECTED);
       this.startHeartbeat();
+      this.sendHeartbeat(); // 立即取得清单哈希，不等第一个心跳间隔
       this.emit('connected');
     });
 
@@ -208,25 +278,71 @@ export class SerialConnectionManager extends EventEmitter {
   }
 
   /**
-   * 处理串口数据
+   * 处理串口数据：确认帧交给等待者，文本日志照常转发
    */
   private handleSerialData(data: Buffer): void {
-    const message = data.toString().trim();
-    this.logger.debug(`Received from device: ${message}`);
-    this.emit('data', message);
+    const { frames, text } = this.decoder.push(data);
+
+    for (const frame of frames) {
+      const resolve = this.pendingFrames.get(frame.seq);
+      if (resolve) {
+        resolve(frame);
+      } else {
+        this.logger.debug(`Unexpected frame type 0x${frame.type.toString(16)} seq ${frame.seq}`);
+      }
+    }
+
+    for (const message of text) {
+      this.logger.debug(`Received from device: ${message}`);
+      this.emit('data', message);
+    }
+  }
+
+  /**
+   * 确认帧携带的状态快照以 'stateSnapshot' 事件发出
+   */
+  private emitStateSnapshot(ackData: Buffer): void {
+    const snapshot = decodeStateSnapshot(ackData.subarray(1));
+    if (snapshot) {
+      this.emit('stateSnapshot', snapshot);
+    }
+  }
+
+  /**
+   * 发送一帧并等待同序号的回复，超时返回null
+   */
+  private async sendFrameAndWait(seq: number, frame: Buffer): Promise<DecodedFrame | null> {
+    const reply = new Promise<DecodedFrame | null>(resolve => {
+      const timer = setTimeout(() => settle(null), this.getAckTimeout());
+      const settle = (result: DecodedFrame | null) => {
+        clearTimeout(timer);
+        this.pendingFrames.delete(seq);
+        resolve(result);
+      };
+      this.pendingFrames.set(seq, settle);
+    });
+
+    try {
+      await this.writeToSerial(frame);
+    } catch (error) {
+      this.pendingFrames.get(seq)?.(null);
+      throw error;
+    }
+
+    return reply;
   }
 
   /**
    * 向串口写入数据
    */
-  private async writeToSerial(data: string): Promise<void> {
+  private async writeToSerial(data: Buffer): Promise<void> {
     return new Promise((resolve, reject) => {
       if (!this.serialPort || !this.serialPort.isOpen) {
         reject(new Error('Serial port not open'));
         return;
       }
 
-      this.serialPort.write(data + '\n', (error) => {
+      this.serialPort.write(data, (error) => {
         if (error) {
           reject(error);
         } else {
@@ -237,21 +353,45 @@ export class SerialConnectionManager extends EventEmitter {
   }
 
   /**
-   * 格式化命令
+   * 设备命令 -> 帧条目
    */
-  private formatCommand(command: DeviceCommand): string {
-    const parts = [
-      'SET',
-      command.deviceId,
-      command.action,
-      command.value.toString()
-    ];
-    
-    if (command.duration !== undefined) {
-      parts.push(command.duration.toString());
+  private toFrameEntry(command: DeviceCommand): FrameCommandEntry | null {
+    const deviceIndex = this.firmwareManifest?.getDeviceIndex(command.deviceId) ?? -1;
+    if (deviceIndex < 0) {
+      this.logger.error(`Device ${command.deviceId} is not in the firmware manifest, regenerate firmware first`);
+      return null;
     }
-    
-    return parts.join(':');
+
+    // 串口连接的是主控制板，其他控制板上的设备索引在这里无效
+    const boardId = this.firmwareManifest?.getBoardOf(command.deviceId);
+    const primary = this.firmwareManifest?.getBoards()[0]?.id;
+    if (boardId && primary && boardId !== primary) {
+      this.logger.error(`Device ${command.deviceId} is on board ${boardId}, serial link only reaches board ${primary}`);
+      return null;
+    }
+
+    // 清单在生成代码时更新，控制板可能仍运行旧固件，索引会驱动错误的输出
+    if (primary && !this.firmwareManifest!.isBoardVerified(primary)) {
+      this.logger.error(`Board ${primary} has not reported the current firmware manifest, flash the generated firmware before sending serial commands`);
+      return null;
+    }
+
+    const isState = command.action === 'set_state' || typeof command.value === 'boolean';
+    return {
+      deviceIndex,
+      action: isState ? 'state' : 'power',
+      value: typeof command.value === 'boolean' ? (command.value ? 1 : 0) : command.value,
+      duration: command.duration ?? 0
+    };
+  }
+
+  private nextSequence(): number {
+    this.sequence = (this.sequence + 1) & 0xff;
+    return this.sequence;
+  }
+
+  private getAckTimeout(): number {
+    return this.config.ackTimeoutMs ?? 100;
   }
 
   /**
@@ -305,10 +445,29 @@ export class SerialConnectionManager extends EventEmitter {
       clearInterval(this.heartbeatTimer);
     }
     
-    this.heartbeatTimer = setInterval(() => {
-      this.logger.debug('Heartbeat check');
-      // TODO: 发送心跳命令
-    }, 5000);
+    this.missedHeartbeats = 0;
+    this.heartbeatTimer = setInterval(() => this.sendHeartbeat(), 5000);
+  }
+
+  /**
+   * 心跳：回复中带有固件的清单哈希，报告给固件清单
+   */
+  private async sendHeartbeat(): Promise<void> {
+    const seq = this.nextSequence();
+    try {
+      const pong = await this.sendFrameAndWait(seq, encodeFrame(FrameType.PING, seq));
+      this.missedHeartbeats = pong ? 0 : this.missedHeartbeats + 1;
+      const primary = this.firmwareManifest?.getBoards()[0]?.id;
+      if (pong && primary && pong.data.length >= 4) {
+        this.firmwareManifest!.reportBoardHash(primary, pong.data.readUInt32LE(0));
+      }
+    } catch {
+      this.missedHeartbeats++;
+    }
+
+    if (this.missedHeartbeats >= 3) {
+      this.logger.warn(`No heartbeat reply for ${this.missedHeartbeats} intervals, firmware may not support serial frames`);
+    }
   }
 
   /**
@@ -324,11 +483,16 @@ export class SerialConnectionManager extends EventEmitter {
       clearInterval(this.heartbeatTimer);
       this.heartbeatTimer = null;
     }
+
+    for (const settle of [...this.pendingFrames.values()]) {
+      settle(null);
+    }
   }
 }
 
 export interface SerialConfig {
   port: string;
-  baudRate: number;
+  baudRate: number;       // 生成固件使用 1000000
   autoDetect: boolean;
+  ackTimeoutMs?: number;  // 等待固件确认帧的超时，默认100ms
 }
@@ -0,0 +1,255 @@
+/**
+ * 串口二进制帧编解码
+ * 与生成固件中的 pollSerialCommands/handleSerialFrame 对应
+ *
+ * 帧 = COBS(载荷 + CRC16) + 0x00
+ * 载荷 = [类型][序号][数据...]，多字节字段为小端序
+ */
+
+import type { FirmwareStateSnapshot } from '../../types/device';
+
+export enum FrameType {
+  COMMAND = 0x01,  // [数量] + 数量 x [设备索引][动作][值][时长u32]
+  ESTOP = 0x02,
+  PING = 0x03,
+  CONTROL_LOOP = 0x04, // [回路索引][标志][设定值i32][kp i32][ki i32][kd i32][下限u16][上限u16]
+  ACK = 0x81,      // [执行数] + 状态快照
+  PONG = 0x83      // [清单哈希u32]（旧固件为空）
+}
+
+export const FRAME_ENTRY_SIZE = 7;
+export const FRAME_MAX_ENTRIES = 32;
+
+export const LOOP_FRAME_SIZE = 22;
+
+export const SNAPSHOT_HEADER_SIZE = 11;
+export const SNAPSHOT_ENTRY_SIZE = 7;
+
+export interface FrameCommandEntry {
+  deviceIndex: number;
+  action: 'power' | 'state';
+  value: number;     // 功率 0-100 或 开关 0/1
+  duration: number;  // 毫秒，0表示不自动关闭
+}
+
+/**
+ * 控制回路参数更新，未提供的字段保持不变（参数均为固件定点值，见 ControlLoopCodec）
+ */
+export interface ControlLoopUpdate {
+  loopIndex: number;
+  enabled?: boolean;
+  setpoint?: number;
+  gains?: { kp: number; ki: number; kd: number };
+  limits?: { outputMin: number; outputMax: number };
+}
+
+export interface DecodedFrame {
+  type: number;
+  seq: number;
+  data: Buffer;
+}
+
+/**
+ * CRC-16/CCITT-FALSE (多项式0x1021，初值0xFFFF)
+ */
+export function crc16(data: Buffer): number {
+  let crc = 0xffff;
+  for (const byte of data) {
+    crc ^= byte << 8;
+    for (let b = 0; b < 8; b++) {
+      crc = crc & 0x8000 ? ((crc << 1) ^ 0x1021) & 0xffff : (crc << 1) & 0xffff;
+    }
+  }
+  return crc;
+}
+
+/**
+ * COBS编码（输出不含结尾0x00）
+ */
+export function cobsEncode(input: Buffer): Buffer {
+  const output = Buffer.alloc(input.length + Math.ceil(input.length / 254) + 1);
+  let codeIndex = 0;
+  let written = 1;
+  let code = 1;
+
+  for (const byte of input) {
+    if (byte === 0) {
+      output[codeIndex] = code;
+      codeIndex = written++;
+      code = 1;
+    } else {
+      output[written++] = byte;
+      if (++code === 0xff) {
+        output[codeIndex] = code;
+        codeIndex = written++;
+        code = 1;
+      }
+    }
+  }
+  output[codeIndex] = code;
+
+  return output.subarray(0, written);
+}
+
+/**
+ * COBS解码（输入不含结尾0x00），格式错误返回null
+ */
+export function cobsDecode(input: Buffer): Buffer | null {
+  const output = Buffer.alloc(input.length);
+  let read = 0;
+  let written = 0;
+
+  while (read < input.length) {
+    const code = input[read++];
+    if (code === 0 || read + code - 1 > input.length) return null;
+    for (let i = 1; i < code; i++) {
+      output[written++] = input[read++];
+    }
+    if (code < 0xff && read < input.length) {
+      output[written++] = 0;
+    }
+  }
+
+  return output.subarray(0, written);
+}
+
+/**
+ * 编码一帧（含前后分隔符）
+ */
+export function encodeFrame(type: FrameType, seq: number, data: Buffer = Buffer.alloc(0)): Buffer {
+  const payload = Buffer.alloc(data.length + 4);
+  payload[0] = type;
+  payload[1] = seq & 0xff;
+  data.copy(payload, 2);
+  payload.writeUInt16LE(crc16(payload.subarray(0, data.length + 2)), data.length + 2);
+
+  return Buffer.concat([Buffer.from([0]), cobsEncode(payload), Buffer.from([0])]);
+}
+
+/**
+ * 编码命令帧
+ */
+export function encodeCommandFrame(seq: number, entries: FrameCommandEntry[]): Buffer {
+  if (entries.length > FRAME_MAX_ENTRIES) {
+    throw new Error(`Too many commands in one frame: ${entries.length} > ${FRAME_MAX_ENTRIES}`);
+  }
+
+  const data = Buffer.alloc(1 + entries.length * FRAME_ENTRY_SIZE);
+  data[0] = entries.length;
+  entries.forEach((entry, i) => {
+    const offset = 1 + i * FRAME_ENTRY_SIZE;
+    data[offset] = entry.deviceIndex;
+    data[offset + 1] = entry.action === 'power' ? 0 : 1;
+    data[offset + 2] = Math.max(0, Math.min(100, Math.round(entry.value)));
+    data.writeUInt32LE(Math.max(0, Math.round(entry.duration)), offset + 3);
+  });
+
+  return encodeFrame(FrameType.COMMAND, seq, data);
+}
+
+/**
+ * 编码控制回路参数帧
+ */
+export function encodeControlLoopFrame(seq: number, update: ControlLoopUpdate): Buffer {
+  const data = Buffer.alloc(LOOP_FRAME_SIZE);
+  let flags = 0;
+  if (update.setpoint !== undefined) flags |= 0x01;
+  if (update.gains) flags |= 0x02;
+  if (update.limits) flags |= 0x04;
+  if (update.enabled !== undefined) flags |= update.enabled ? 0x08 : 0x10;
+
+  data[0] = update.loopIndex;
+  data[1] = flags;
+  data.writeInt32LE(update.setpoint ?? 0, 2);
+  data.writeInt32LE(update.gains?.kp ?? 0, 6);
+  data.writeInt32LE(update.gains?.ki ?? 0, 10);
+  data.writeInt32LE(update.gains?.kd ?? 0, 14);
+  data.writeUInt16LE(update.limits?.outputMin ?? 0, 18);
+  data.writeUInt16LE(update.limits?.outputMax ?? 0, 20);
+
+  return encodeFrame(FrameType.CONTROL_LOOP, seq, data);
+}
+
+/**
+ * 解析确认帧中的状态快照
+ * [版本u32][运行ms u32][占空比上限u16][设备数] + 设备数 x [当前值u16][标志][剩余ms u32]
+ */
+export function decodeStateSnapshot(data: Buffer): FirmwareStateSnapshot | null {
+  if (data.length < SNAPSHOT_HEADER_SIZE) return null;
+
+  const count = data[10];
+  if (data.length < SNAPSHOT_HEADER_SIZE + count * SNAPSHOT_ENTRY_SIZE) return null;
+
+  const devices: FirmwareStateSnapshot['devices'] = [];
+  for (let i = 0; i < count; i++) {
+    const offset = SNAPSHOT_HEADER_SIZE + i * SNAPSHOT_ENTRY_SIZE;
+    devices.push({
+      value: data.readUInt16LE(offset),
+      isActive: (data[offset + 2] & 0x01) !== 0,
+      remainingMs: data.readUInt32LE(offset + 3)
+    });
+  }
+
+  return {
+    version: data.readUInt32LE(0),
+    uptimeMs: data.readUInt32LE(4),
+    dutyMax: data.readUInt16LE(8),
+    devices
+  };
+}
+
+/**
+ * 流式帧解码器
+ * 按0x00切分字节流；CRC校验通过的为帧，其余视为固件输出的文本日志
+ */
+export class SerialFrameDecoder {
+  private buffer: Buffer = Buffer.alloc(0);
+  private frameErrors = 0;
+
+  /**
+   * 输入一段字节，返回其中完整的帧与文本片段
+   */
+  push(chunk: Buffer): { frames: DecodedFrame[]; text: string[] } {
+    const frames: DecodedFrame[] = [];
+    const text: string[] = [];
+
+    this.buffer = this.buffer.length > 0 ? Buffer.concat([this.buffer, chunk]) : chunk;
+
+    let start = 0;
+    let delimiter: number;
+    while ((delimiter = this.buffer.indexOf(0, start)) !== -1) {
+      const segment = this.buffer.subarray(start, delimiter);
+      start = delimiter + 1;
+      if (segment.length === 0) continue;
+
+      const frame = this.decodeSegment(segment);
+      if (frame) {
+        frames.push(frame);
+      } else {
+        const message = segment.toString().trim();
+        if (message) text.push(message);
+      }
+    }
+
+    this.buffer = Buffer.from(this.buffer.subarray(start));
+    return { frames, text };
+  }
+
+  getFrameErrors(): number {
+    return this.frameErrors;
+  }
+
+  private decodeSegment(segment: Buffer): DecodedFrame | null {
+    const payload = cobsDecode(segment);
+    if (!payload || payload.length < 4) return null;
+
+    const body = payload.subarray(0, payload.length - 2);
+    if (payload.readUInt16LE(payload.length - 2) !== crc16(body)) {
+      // 可能只是文本日志；只有看起来像帧的段才计为错误
+      if (body[0] === FrameType.ACK || body[0] === FrameType.PONG) this.frameErrors++;
+      return null;
+    }
+
+    return { type: body[0], seq: body[1], data: Buffer.from(body.subarray(2)) };
+  }
+}
@@ -1,6 +1,7 @@
 import { EventEmitter } from 'events';
 import winston from 'winston';
 import { DeviceConfig, DeviceState, DeviceCommand } from '../../types/device';
+import type { FirmwareStateSnapshot } from '../../types/device';
 
 /**
  * 设备状态管理器
@@ -17,6 +18,7 @@ export class DeviceStateManager extends EventEmitter {
   private devices: Map<string, DeviceConfig> = new Map();
   private deviceStates: Map<string, DeviceState> = new Map();
   private stateUpdateTimer: NodeJS.Timeout | null = null;
+  private lastSnapshots: Map<string, { version: number; uptimeMs: number }> = new Map();  // 控制板ID -> 最近应用的快照
 
   constructor(logger: winston.Logger) {
     super();
@@ -126,6 +128,46 @@ export class DeviceStateManager extends EventEmitter {
     this.emit('batchDeviceStateChanged', changedStates);
   }
 
+  /**
+   * 应用固件确认中携带的状态快照
+   * 快照按该控制板的固件设备表顺序排列；比同一控制板已应用版本旧的快照（乱序到达的确认）被忽略，
+   * 固件运行时间变小视为重启，版本重新计数
+   */
+  applyFirmwareSnapshot(snapshot: FirmwareStateSnapshot, deviceOrder: string[]): boolean {
+    const boardId = snapshot.boardId ?? 'main';
+    const last = this.lastSnapshots.get(boardId) ?? null;
+    const rebooted = last !== null && snapshot.uptimeMs < last.uptimeMs;
+    if (last && !rebooted && snapshot.version < last.version) {
+      return false;
+    }
+    this.lastSnapshots.set(boardId, { version: snapshot.version, uptimeMs: snapshot.uptimeMs });
+
+    const updates: Array<{ deviceId: string; updates: Partial<DeviceState> }> = [];
+    snapshot.devices.forEach((deviceSnapshot, index) => {
+      const deviceId = deviceOrder[index];
+      const device = deviceId ? this.devices.get(deviceId) : undefined;
+      if (!device) return;
+
+      const currentValue = device.type === 'pwm'
+        ? Math.round(deviceSnapshot.value * 1000 / Math.max(1, snapshot.dutyMax)) / 10
+        : deviceSnapshot.value > 0;
+
+      updates.push({
+        deviceId,
+        updates: {
+          isOnline: true,
+          currentValue,
+          remainingMs: deviceSnapshot.remainingMs
+        }
+      });
+    });
+
+    if (updates.length > 0) {
+      this.batchUpdateDeviceStates(updates);
+    }
+    return true;
+  }
+
   /**
    * 设置设备在线状态
    */
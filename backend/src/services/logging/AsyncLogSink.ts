@@ -0,0 +1,132 @@
+/**
+ * 异步批量日志输出
+ * 调用方只把结构化记录放入有界队列，格式化与写出（winston 控制台/文件、跨线程消息）
+ * 由后台定时成批进行，每批之间让出事件循环
+ *
+ * 队列满时丢弃新的 info/debug 记录；error/warn 另有预留空间，预留也用完时同样丢弃并计数
+ */
+export class AsyncLogSink<T> {
+  private queue: T[] = [];
+  private timer: NodeJS.Timeout | null = null;
+  private draining = false;
+  private overflowing = false;
+  private config: AsyncLogSinkConfig;
+  private counters = { enqueued: 0, written: 0, dropped: 0, overflows: 0, batches: 0, writeErrors: 0, maxDepth: 0 };
+
+  constructor(
+    private write: (records: T[]) => void,
+    config: Partial<AsyncLogSinkConfig> = {}
+  ) {
+    this.config = { ...getDefaultAsyncLogSinkConfig(), ...config };
+  }
+
+  /**
+   * 放入一条记录；critical 为 error/warn 级别。返回是否被接收
+   */
+  enqueue(record: T, critical: boolean = false): boolean {
+    const limit = critical ? this.config.maxQueue + this.config.criticalReserve : this.config.maxQueue;
+    if (this.queue.length >= limit) {
+      this.counters.dropped++;
+      if (!this.overflowing) {
+        this.overflowing = true;
+        this.counters.overflows++;
+      }
+      return false;
+    }
+
+    this.queue.push(record);
+    this.counters.enqueued++;
+    if (this.queue.length > this.counters.maxDepth) {
+      this.counters.maxDepth = this.queue.length;
+    }
+
+    if (!this.timer && !this.draining) {
+      this.timer = setTimeout(() => this.drain(), this.config.flushIntervalMs);
+      this.timer.unref();
+    }
+    return true;
+  }
+
+  /**
+   * 立即写出全部记录（进程退出前调用）
+   */
+  flush(): void {
+    if (this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+    }
+    while (this.queue.length > 0) {
+      this.writeBatch();
+    }
+  }
+
+  getStats(): AsyncLogSinkStats {
+    return {
+      queued: this.queue.length,
+      maxQueue: this.config.maxQueue,
+      ...this.counters
+    };
+  }
+
+  /**
+   * 后台写出：每次写一批，剩余的在下一轮事件循环继续
+   */
+  private drain(): void {
+    this.timer = null;
+    this.writeBatch();
+
+    if (this.queue.length > 0) {
+      this.draining = true;
+      setImmediate(() => this.drain());
+    } else {
+      this.draining = false;
+    }
+  }
+
+  private writeBatch(): void {
+    const batch = this.queue.length <= this.config.maxBatchSize
+      ? this.queue
+      : this.queue.slice(0, this.config.maxBatchSize);
+    this.queue = batch === this.queue ? [] : this.queue.slice(batch.length);
+    if (this.queue.length < this.config.maxQueue) {
+      this.overflowing = false;
+    }
+
+    try {
+      this.write(batch);
+      this.counters.written += batch.length;
+    } catch {
+      // 输出失败时无处可报告，只计数
+      this.counters.writeErrors++;
+    }
+    this.counters.batches++;
+  }
+}
+
+function getDefaultAsyncLogSinkConfig(): AsyncLogSinkConfig {
+  return {
+    flushIntervalMs: 50,
+    maxBatchSize: 200,
+    maxQueue: 10000,
+    criticalReserve: 1000
+  };
+}
+
+export interface AsyncLogSinkConfig {
+  flushIntervalMs: number;   // 第一条记录入队后多久开始写出
+  maxBatchSize: number;      // 每批最多写出的记录数
+  maxQueue: number;          // 队列上限，超出时丢弃 info/debug 记录
+  criticalReserve: number;   // error/warn 在上限之外的预留
+}
+
+export interface AsyncLogSinkStats {
+  queued: number;
+  maxQueue: number;
+  enqueued: number;
+  written: number;
+  dropped: number;       // 队列满时丢弃的记录数
+  overflows: number;     // 队列进入已满状态的次数
+  batches: number;
+  writeErrors: number;
+  maxDepth: number;      // 队列的最大深度
+}
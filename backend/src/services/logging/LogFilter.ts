@@ -0,0 +1,52 @@
+import type { LogEntry, LogLevel, LogCategory } from '../UnifiedLogService';
+import { entryKeys, keysMatchQuery, parseSearchQuery } from './LogTextIndex';
+
+/**
+ * 日志过滤条件
+ * 同一字段可给出多个值（任一匹配），不同字段同时满足；search 的语法与全文索引相同（词前缀、`字段:值`）
+ */
+export interface LogFilter {
+  level?: LogLevel | LogLevel[];
+  source?: string | string[];
+  category?: LogCategory | LogCategory[];
+  search?: string;
+}
+
+export function createLogFilter(filter: LogFilter): (entry: LogEntry) => boolean {
+  const levels = toSet(filter.level);
+  const sources = toSet(filter.source);
+  const categories = toSet(filter.category);
+  const matchesText = filter.search ? createSearchMatcher(filter.search) : null;
+
+  return entry =>
+    (!levels || levels.has(entry.level)) &&
+    (!sources || sources.has(entry.source)) &&
+    (!categories || categories.has(entry.category)) &&
+    (!matchesText || matchesText(entry));
+}
+
+/**
+ * 逐条判断关键词，与全文索引的结果一致；没有可索引的词时按原文包含匹配
+ */
+export function createSearchMatcher(search: string): (entry: LogEntry) => boolean {
+  const terms = parseSearchQuery(search);
+  if (terms.length === 0) {
+    const searchLower = search.toLowerCase();
+    return entry => matchesSearch(entry, searchLower);
+  }
+  return entry => keysMatchQuery(entryKeys(entry), terms);
+}
+
+/**
+ * 消息或 meta 包含关键词（关键词已转小写）
+ */
+export function matchesSearch(entry: LogEntry, searchLower: string): boolean {
+  return entry.message.toLowerCase().includes(searchLower) ||
+    (entry.meta !== undefined && entry.meta !== null && JSON.stringify(entry.meta).toLowerCase().includes(searchLower));
+}
+
+function toSet<T extends string>(value: T | T[] | undefined): Set<string> | null {
+  if (value === undefined || value === null) return null;
+  const values = (Array.isArray(value) ? value : [value]).filter(v => typeof v === 'string' && v.length > 0);
+  return values.length > 0 ? new Set(values) : null;
+}
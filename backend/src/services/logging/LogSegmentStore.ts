@@ -0,0 +1,288 @@
+import fs from 'fs';
+import fsp from 'fs/promises';
+import path from 'path';
+import readline from 'readline';
+import type { Logger } from 'winston';
+import type { LogEntry, GetLogsOptions } from '../UnifiedLogService';
+import { createLogFilter } from './LogFilter';
+
+/**
+ * 日志分段文件存储
+ * 日志以 JSON Lines 追加到按时间分段的文件（文件名为段内第一条日志的时间戳与段序号），
+ * 缓冲后批量写入；段超过大小或时长时切换新段，总大小超过上限时删除最旧的段
+ * 查询按时间范围只读取重叠的段，内存占用与保存的历史长度无关
+ */
+export class LogSegmentStore {
+  private config: LogSegmentStoreConfig;
+  private segments: SegmentInfo[] = [];   // 按开始时间排序，最后一个为当前写入段
+  private nextSegmentId = 1;
+  private pending: string[] = [];
+  private flushTimer: NodeJS.Timeout | null = null;
+  private writing: Promise<void> = Promise.resolve();
+  private counters = { written: 0, dropped: 0, writeErrors: 0, deletedSegments: 0 };
+
+  constructor(
+    private logger: Logger,
+    config: Partial<LogSegmentStoreConfig> = {}
+  ) {
+    this.config = { ...getDefaultLogSegmentStoreConfig(), ...config };
+  }
+
+  /**
+   * 扫描已有的段
+   */
+  async open(): Promise<void> {
+    await fsp.mkdir(this.config.dir, { recursive: true });
+    const files = (await fsp.readdir(this.config.dir)).filter(file => SEGMENT_PATTERN.test(file));
+
+    const segments: SegmentInfo[] = [];
+    for (const file of files) {
+      const stat = await fsp.stat(path.join(this.config.dir, file));
+      const [, startTime, id] = SEGMENT_PATTERN.exec(file)!;
+      segments.push({ file, id: Number(id), startTime: Number(startTime), bytes: stat.size, openedAt: stat.mtimeMs });
+      this.nextSegmentId = Math.max(this.nextSegmentId, Number(id) + 1);
+    }
+    this.segments = segments.sort((a, b) => a.startTime - b.startTime || a.id - b.id);
+    this.logger.info(`Log store: ${this.segments.length} segments, ${Math.round(this.totalBytes() / 1024)} KB in ${this.config.dir}`);
+  }
+
+  /**
+   * 缓冲一条日志，按间隔或数量批量写入
+   */
+  append(entry: LogEntry): void {
+    if (this.pending.length >= this.config.maxPendingEntries) {
+      this.counters.dropped++;
+      return;
+    }
+    this.pending.push(JSON.stringify(entry) + '\n');
+
+    if (this.pending.length >= this.config.flushBatchSize) {
+      this.flush();
+    } else if (!this.flushTimer) {
+      this.flushTimer = setTimeout(() => this.flush(), this.config.flushIntervalMs);
+    }
+  }
+
+  /**
+   * 写入缓冲的日志；写入串行进行，返回本批写完的Promise
+   */
+  flush(): Promise<void> {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+    if (this.pending.length === 0) return this.writing;
+
+    const lines = this.pending;
+    this.pending = [];
+    this.writing = this.writing.then(() => this.write(lines));
+    return this.writing;
+  }
+
+  /**
+   * 最近的日志（旧的在前），用于启动时恢复内存中的最近日志
+   */
+  async readRecent(maxEntries: number): Promise<LogEntry[]> {
+    const chunks: LogEntry[][] = [];
+    let count = 0;
+    for (let i = this.segments.length - 1; i >= 0 && count < maxEntries; i--) {
+      const entries: LogEntry[] = [];
+      await this.scan(this.segments[i], entry => { entries.push(entry); });
+      const kept = entries.slice(-(maxEntries - count));
+      chunks.unshift(kept);
+      count += kept.length;
+    }
+    return chunks.flat();
+  }
+
+  /**
+   * 从文件按条件查询，新日志在前；只读取与时间范围重叠的段
+   * 每次查询读取的段总大小不超过 maxQueryBytes，超出时停止并标记 truncated（total 只统计已读取的段）
+   */
+  async query(options: GetLogsOptions, offset: number, limit: number): Promise<{ logs: LogEntry[]; total: number; truncated: boolean }> {
+    await this.flush();
+
+    const { startTime, endTime } = options;
+    const filter = buildFilter(options);
+    const logs: LogEntry[] = [];
+    let total = 0;
+    let scannedBytes = 0;
+    let truncated = false;
+
+    for (let i = this.segments.length - 1; i >= 0; i--) {
+      const segment = this.segments[i];
+      const nextStart = this.segments[i + 1]?.startTime ?? Infinity;
+      if (endTime && segment.startTime > endTime) continue;
+      if (startTime && nextStart < startTime) break;
+      if (scannedBytes > 0 && scannedBytes + segment.bytes > this.config.maxQueryBytes) {
+        truncated = true;
+        break;
+      }
+      scannedBytes += segment.bytes;
+
+      const matches: LogEntry[] = [];
+      await this.scan(segment, entry => {
+        if (startTime && entry.timestamp < startTime) return;
+        if (endTime && entry.timestamp > endTime) return;
+        if (filter.matches(entry)) matches.push(entry);
+      }, filter.prefilter);
+
+      // 段内新的在后，按全局新到旧的位置取这一页
+      for (let j = matches.length - 1; j >= 0; j--, total++) {
+        if (total >= offset && logs.length < limit) logs.push(matches[j]);
+      }
+    }
+    return { logs, total, truncated };
+  }
+
+  /**
+   * 删除所有段
+   */
+  async clear(): Promise<void> {
+    this.pending = [];
+    await this.writing;
+    const segments = this.segments;
+    this.segments = [];
+    await Promise.all(segments.map(segment => fsp.rm(path.join(this.config.dir, segment.file), { force: true })));
+  }
+
+  async close(): Promise<void> {
+    await this.flush();
+  }
+
+  getStats(): LogSegmentStoreStats {
+    return {
+      dir: this.config.dir,
+      segments: this.segments.length,
+      totalBytes: this.totalBytes(),
+      maxTotalBytes: this.config.maxTotalBytes,
+      oldestTime: this.segments[0]?.startTime ?? null,
+      pending: this.pending.length,
+      ...this.counters
+    };
+  }
+
+  private async write(lines: string[]): Promise<void> {
+    const data = lines.join('');
+    const bytes = Buffer.byteLength(data);
+    const firstTime = (JSON.parse(lines[0]) as LogEntry).timestamp;
+
+    try {
+      let segment = this.segments[this.segments.length - 1];
+      if (!segment || segment.bytes >= this.config.segmentMaxBytes || Date.now() - segment.openedAt >= this.config.segmentMaxAgeMs) {
+        // 系统时钟回拨时沿用上一段的开始时间，保持段按时间有序
+        const startTime = Math.max(firstTime, segment?.startTime ?? 0);
+        const id = this.nextSegmentId++;
+        segment = { file: `${startTime}-${id}.jsonl`, id, startTime, bytes: 0, openedAt: Date.now() };
+        this.segments.push(segment);
+      }
+
+      await fsp.appendFile(path.join(this.config.dir, segment.file), data, 'utf-8');
+      segment.bytes += bytes;
+      this.counters.written += lines.length;
+      await this.enforceRetention();
+    } catch (error) {
+      this.counters.writeErrors++;
+      this.logger.warn(`Failed to write ${lines.length} log entries: ${error instanceof Error ? error.message : String(error)}`);
+    }
+  }
+
+  /**
+   * 总大小超过上限时删除最旧的段（保留当前写入段）
+   */
+  private async enforceRetention(): Promise<void> {
+    while (this.segments.length > 1 && this.totalBytes() > this.config.maxTotalBytes) {
+      const oldest = this.segments.shift()!;
+      await fsp.rm(path.join(this.config.dir, oldest.file), { force: true });
+      this.counters.deletedSegments++;
+    }
+  }
+
+  /**
+   * 逐行读取一个段；prefilter 为原始行须包含的文本，不包含时不解析
+   */
+  private async scan(segment: SegmentInfo, visit: (entry: LogEntry) => void, prefilter: string[] = []): Promise<void> {
+    const stream = fs.createReadStream(path.join(this.config.dir, segment.file), { encoding: 'utf-8' });
+    const lines = readline.createInterface({ input: stream, crlfDelay: Infinity });
+    try {
+      for await (const line of lines) {
+        if (!line || !prefilter.every(text => line.includes(text))) continue;
+        try {
+          visit(JSON.parse(line));
+        } catch {
+          // 进程中断时可能留下不完整的最后一行
+        }
+      }
+    } catch (error) {
+      if ((error as NodeJS.ErrnoException).code !== 'ENOENT') throw error;
+    } finally {
+      stream.destroy();
+    }
+  }
+
+  private totalBytes(): number {
+    return this.segments.reduce((sum, segment) => sum + segment.bytes, 0);
+  }
+}
+
+const SEGMENT_PATTERN = /^(\d+)-(\d+)\.jsonl$/;
+
+/**
+ * 条件过滤；级别/来源/分类同时生成原始行的预过滤文本
+ */
+function buildFilter(options: GetLogsOptions): { matches: (entry: LogEntry) => boolean; prefilter: string[] } {
+  const { level, source, category } = options;
+  return {
+    prefilter: [
+      ...(level ? [`"level":"${level}"`] : []),
+      ...(source ? [`"source":"${source}"`] : []),
+      ...(category ? [`"category":"${category}"`] : [])
+    ],
+    matches: createLogFilter(options)
+  };
+}
+
+function getDefaultLogSegmentStoreConfig(): LogSegmentStoreConfig {
+  return {
+    dir: process.env.LOG_STORE_DIR || path.join('logs', 'entries'),
+    segmentMaxBytes: 8 * 1024 * 1024,
+    segmentMaxAgeMs: 60 * 60 * 1000,
+    maxTotalBytes: Math.max(1, Number(process.env.LOG_STORE_MAX_MB || 256)) * 1024 * 1024,
+    maxQueryBytes: 32 * 1024 * 1024,
+    flushIntervalMs: 200,
+    flushBatchSize: 500,
+    maxPendingEntries: 20000
+  };
+}
+
+interface SegmentInfo {
+  file: string;
+  id: number;          // 段序号，同一毫秒开始的段按序号排序
+  startTime: number;   // 段内第一条日志的时间戳，段覆盖到下一段开始
+  bytes: number;
+  openedAt: number;
+}
+
+export interface LogSegmentStoreConfig {
+  dir: string;
+  segmentMaxBytes: number;     // 单段大小上限
+  segmentMaxAgeMs: number;     // 单段时长上限
+  maxTotalBytes: number;       // 所有段的总大小上限，超出时删除最旧的段
+  maxQueryBytes: number;       // 单次查询读取的段总大小上限（至少读取一段）
+  flushIntervalMs: number;     // 缓冲写入间隔
+  flushBatchSize: number;      // 缓冲达到此数量时立即写入
+  maxPendingEntries: number;   // 磁盘写入跟不上时缓冲的上限，超出时丢弃新日志
+}
+
+export interface LogSegmentStoreStats {
+  dir: string;
+  segments: number;
+  totalBytes: number;
+  maxTotalBytes: number;
+  oldestTime: number | null;
+  pending: number;
+  written: number;
+  dropped: number;
+  writeErrors: number;
+  deletedSegments: number;
+}
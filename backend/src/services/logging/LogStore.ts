@@ -0,0 +1,274 @@
+import type { LogEntry, GetLogsOptions } from '../UnifiedLogService';
+import { matchesSearch } from './LogFilter';
+import { SeqRing } from './SeqRing';
+import { LogTextIndex, entryKeys, parseSearchQuery } from './LogTextIndex';
+
+/**
+ * 日志环形存储
+ * 固定容量的环形缓冲区按写入序号保存日志，满时覆盖最旧的一条；
+ * 每个级别、来源、分类各维护一个序号索引环，消息与 meta 的词维护全文索引，时间范围在写入顺序上二分查找
+ * 写入与淘汰不随条目数增长；查询只遍历最小候选索引（有关键词时为全文索引的结果）在时间范围内的部分
+ */
+export class LogStore {
+  private entries: (LogEntry | undefined)[];
+  private timeKeys: Float64Array;                  // 槽位 -> 时间键（时间戳的前缀最大值，系统时钟回拨时仍单调）
+  private nextSeq = 0;
+  private firstSeq = 0;                            // 最旧一条的写入序号
+  private lastTimeKey = 0;
+  private indexes: Map<string, SeqRing> = new Map(); // "level:info" / "source:arduino" / "category:system" -> 序号
+  private text = new LogTextIndex();
+  private textKeys: (string[] | undefined)[];      // 槽位 -> 条目的词键，淘汰时从全文索引移除
+
+  constructor(private capacity: number) {
+    this.entries = new Array(capacity);
+    this.timeKeys = new Float64Array(capacity);
+    this.textKeys = new Array(capacity);
+  }
+
+  get size(): number {
+    return this.nextSeq - this.firstSeq;
+  }
+
+  get isFull(): boolean {
+    return this.size === this.capacity;
+  }
+
+  /**
+   * 全文索引中的词数
+   */
+  get indexedTokens(): number {
+    return this.text.tokenCount;
+  }
+
+  /**
+   * 最新一条的写入序号，空时为 -1
+   */
+  get lastSeq(): number {
+    return this.nextSeq - 1;
+  }
+
+  /**
+   * 最旧一条的时间戳，空时返回null
+   */
+  oldestTimestamp(): number | null {
+    return this.size > 0 ? this.entryAt(this.firstSeq).timestamp : null;
+  }
+
+  /**
+   * 写入一条日志，已满时淘汰最旧的一条；返回写入序号
+   */
+  append(entry: LogEntry): number {
+    if (this.isFull) {
+      this.evictOldest();
+    }
+
+    const seq = this.nextSeq++;
+    const slot = seq % this.capacity;
+    this.lastTimeKey = Math.max(this.lastTimeKey, entry.timestamp);
+    this.entries[slot] = entry;
+    this.timeKeys[slot] = this.lastTimeKey;
+
+    for (const key of indexKeys(entry)) {
+      let ring = this.indexes.get(key);
+      if (!ring) {
+        ring = new SeqRing();
+        this.indexes.set(key, ring);
+      }
+      ring.push(seq);
+    }
+
+    const keys = entryKeys(entry);
+    this.textKeys[slot] = keys;
+    this.text.add(seq, keys);
+    return seq;
+  }
+
+  /**
+   * 按条件查询，新日志在前；total 为满足条件的总数
+   */
+  query(options: GetLogsOptions, offset: number, limit: number): { logs: LogEntry[]; total: number } {
+    const view = this.candidates(options);
+    const from = options.startTime ? this.lowerBound(view, options.startTime) : 0;
+    const to = options.endTime ? this.lowerBound(view, options.endTime + 1) : view.length;
+    const matches = this.residualFilter(options, view.field);
+    const logs: LogEntry[] = [];
+
+    // 候选即结果：直接按位置取这一页
+    if (!matches) {
+      const total = Math.max(0, to - from);
+      for (let i = to - 1 - offset; i >= from && logs.length < limit; i--) {
+        logs.push(this.entryAt(view.seqAt(i)));
+      }
+      return { logs, total };
+    }
+
+    let total = 0;
+    for (let i = to - 1; i >= from; i--) {
+      const entry = this.entryAt(view.seqAt(i));
+      if (!matches(entry)) continue;
+      if (total >= offset && logs.length < limit) {
+        logs.push(entry);
+      }
+      total++;
+    }
+    return { logs, total };
+  }
+
+  /**
+   * 序号大于 seq 的条目（旧的在前）；其中有条目已被淘汰时返回null
+   */
+  since(seq: number): LogEntry[] | null {
+    if (seq + 1 < this.firstSeq) return null;
+    const entries: LogEntry[] = [];
+    for (let s = Math.max(seq + 1, this.firstSeq); s < this.nextSeq; s++) {
+      entries.push(this.entryAt(s));
+    }
+    return entries;
+  }
+
+  /**
+   * 从新到旧找出最多 limit 条满足条件的条目
+   */
+  findRecent(predicate: (entry: LogEntry) => boolean, limit: number): LogEntry[] {
+    const entries: LogEntry[] = [];
+    for (let s = this.nextSeq - 1; s >= this.firstSeq && entries.length < limit; s--) {
+      const entry = this.entryAt(s);
+      if (predicate(entry)) entries.push(entry);
+    }
+    return entries;
+  }
+
+  /**
+   * 时间戳不早于 since 的条目数
+   */
+  countSince(since: number): number {
+    const view = this.mainView();
+    return view.length - this.lowerBound(view, since);
+  }
+
+  /**
+   * 按字段统计条目数（只含出现过的值）
+   */
+  countBy(field: IndexedField): Record<string, number> {
+    const counts: Record<string, number> = {};
+    const prefix = `${field}:`;
+    for (const [key, ring] of this.indexes) {
+      if (key.startsWith(prefix) && ring.length > 0) {
+        counts[key.slice(prefix.length)] = ring.length;
+      }
+    }
+    return counts;
+  }
+
+  /**
+   * 清空，返回清除的条目数
+   */
+  clear(): number {
+    const count = this.size;
+    this.entries.fill(undefined);
+    this.textKeys.fill(undefined);
+    this.firstSeq = this.nextSeq;
+    this.indexes.clear();
+    this.text.clear();
+    return count;
+  }
+
+  private evictOldest(): void {
+    const seq = this.firstSeq++;
+    const slot = seq % this.capacity;
+    const entry = this.entries[slot];
+    const keys = this.textKeys[slot];
+    this.entries[slot] = undefined;
+    this.textKeys[slot] = undefined;
+    if (!entry) return;
+
+    if (keys) this.text.removeOldest(keys);
+
+    // 最旧的条目也是它所在每个索引环的最旧条目
+    for (const key of indexKeys(entry)) {
+      this.indexes.get(key)?.shift();
+    }
+  }
+
+  /**
+   * 选择候选：有可索引的关键词时为全文索引的结果，否则为条目最少的字段索引；没有索引条件时为全部日志
+   */
+  private candidates(options: GetLogsOptions): CandidateView {
+    const terms = options.search ? parseSearchQuery(options.search) : [];
+    if (terms.length > 0) {
+      const seqs = this.text.lookup(terms);
+      return { field: 'search', length: seqs.length, seqAt: i => seqs[i] };
+    }
+
+    let best: CandidateView | null = null;
+    for (const field of INDEXED_FIELDS) {
+      const value = options[field];
+      if (!value) continue;
+      const ring = this.indexes.get(`${field}:${value}`);
+      const view: CandidateView = ring
+        ? { field, length: ring.length, seqAt: i => ring.at(i) }
+        : { field, length: 0, seqAt: () => -1 };
+      if (!best || view.length < best.length) best = view;
+    }
+    return best ?? this.mainView();
+  }
+
+  private mainView(): CandidateView {
+    return { field: null, length: this.size, seqAt: i => this.firstSeq + i };
+  }
+
+  /**
+   * 候选之外仍需逐条检查的条件，没有时返回null
+   */
+  private residualFilter(options: GetLogsOptions, covered: CandidateView['field']): ((entry: LogEntry) => boolean) | null {
+    const checks: ((entry: LogEntry) => boolean)[] = [];
+    for (const field of INDEXED_FIELDS) {
+      const value = options[field];
+      if (value && field !== covered) {
+        checks.push(entry => entry[field] === value);
+      }
+    }
+    // 关键词中没有可索引的词（如只有标点）时按原文逐条匹配
+    if (options.search && covered !== 'search') {
+      const searchLower = options.search.toLowerCase();
+      checks.push(entry => matchesSearch(entry, searchLower));
+    }
+    if (checks.length === 0) return null;
+    return entry => checks.every(check => check(entry));
+  }
+
+  /**
+   * 第一个时间键不小于 time 的候选位置
+   */
+  private lowerBound(view: CandidateView, time: number): number {
+    let lo = 0;
+    let hi = view.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >>> 1;
+      if (this.timeKeys[view.seqAt(mid) % this.capacity] < time) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  private entryAt(seq: number): LogEntry {
+    return this.entries[seq % this.capacity]!;
+  }
+}
+
+const INDEXED_FIELDS = ['level', 'source', 'category'] as const;
+
+function indexKeys(entry: LogEntry): string[] {
+  return [`level:${entry.level}`, `source:${entry.source}`, `category:${entry.category}`];
+}
+
+export type IndexedField = typeof INDEXED_FIELDS[number];
+
+interface CandidateView {
+  field: IndexedField | 'search' | null;   // 候选来自哪个字段的索引或全文索引，null 为全部日志
+  length: number;
+  seqAt(i: number): number;                // 第 i 旧的候选序号
+}
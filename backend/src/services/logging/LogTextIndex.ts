@@ -0,0 +1,249 @@
+import type { LogEntry } from '../UnifiedLogService';
+import { SeqRing } from './SeqRing';
+
+/**
+ * 日志全文索引
+ * 写入时把消息与展开后的 meta 字段切分为词，每个词维护一个条目序号的倒排列表；
+ * 淘汰最旧的条目时从它所含每个词的列表头部移除，与环形存储同步
+ *
+ * 查询：空格分隔的每个词都须匹配（词前缀即可）；`字段:值` 只匹配该字段，
+ * 字段为 meta 中的键（嵌套键可写完整路径如 payload.status，也可只写最后一级）或 level/source/category
+ */
+export class LogTextIndex {
+  private postings: Map<string, SeqRing> = new Map();        // 词键 -> 含该词的条目序号
+  private vocabulary: Map<string, Set<string>> = new Map();  // 字段 + 词的前两个字符 -> 词键，用于前缀查找
+
+  get tokenCount(): number {
+    return this.postings.size;
+  }
+
+  add(seq: number, keys: string[]): void {
+    for (const key of keys) {
+      let ring = this.postings.get(key);
+      if (!ring) {
+        ring = new SeqRing(2);
+        this.postings.set(key, ring);
+        const bucket = bucketOf(key);
+        const words = this.vocabulary.get(bucket);
+        if (words) {
+          words.add(key);
+        } else {
+          this.vocabulary.set(bucket, new Set([key]));
+        }
+      }
+      ring.push(seq);
+    }
+  }
+
+  /**
+   * 移除最旧的条目（它也是所含每个词的倒排列表中最旧的）
+   */
+  removeOldest(keys: string[]): void {
+    for (const key of keys) {
+      const ring = this.postings.get(key);
+      if (!ring) continue;
+      ring.shift();
+      if (ring.length > 0) continue;
+
+      this.postings.delete(key);
+      const bucket = bucketOf(key);
+      const words = this.vocabulary.get(bucket);
+      words?.delete(key);
+      if (words?.size === 0) this.vocabulary.delete(bucket);
+    }
+  }
+
+  clear(): void {
+    this.postings.clear();
+    this.vocabulary.clear();
+  }
+
+  /**
+   * 满足全部查询词的条目序号（递增）
+   */
+  lookup(terms: SearchTerm[]): number[] {
+    // 从倒排列表最短的词开始求交集
+    const lists = terms
+      .map(term => this.matchingRings(term))
+      .map(rings => ({ rings, size: rings.reduce((sum, ring) => sum + ring.length, 0) }))
+      .sort((a, b) => a.size - b.size);
+
+    let result: number[] | null = null;
+    for (const { rings } of lists) {
+      const seqs = union(rings);
+      result = result ? intersect(result, seqs) : seqs;
+      if (result.length === 0) break;
+    }
+    return result ?? [];
+  }
+
+  /**
+   * 以查询词为前缀的所有词的倒排列表
+   */
+  private matchingRings(term: SearchTerm): SeqRing[] {
+    const prefix = wordKey(term.scope, term.token);
+    const rings: SeqRing[] = [];
+    const collect = (words: Set<string>) => {
+      for (const key of words) {
+        if (key.startsWith(prefix)) rings.push(this.postings.get(key)!);
+      }
+    };
+
+    if (term.token.length >= 2) {
+      const words = this.vocabulary.get(bucketOf(prefix));
+      if (words) collect(words);
+    } else {
+      for (const [bucket, words] of this.vocabulary) {
+        if (bucket.startsWith(prefix)) collect(words);
+      }
+    }
+    return rings;
+  }
+}
+
+/**
+ * 切分为小写的词：字母、数字、下划线组成的串；中日韩文字每个字为一个词
+ */
+export function tokenize(text: string): string[] {
+  const tokens = text.toLowerCase().match(TOKEN_PATTERN) ?? [];
+  return tokens.map(token => token.length > MAX_TOKEN_LENGTH ? token.slice(0, MAX_TOKEN_LENGTH) : token);
+}
+
+/**
+ * 一条日志的所有词键（去重）：消息与 meta 的键和值不限字段，
+ * meta 的值与 level/source/category 另按字段索引
+ */
+export function entryKeys(entry: LogEntry): string[] {
+  const keys = new Set<string>();
+  const add = (scope: string, text: string) => {
+    for (const token of tokenize(text)) {
+      if (keys.size >= MAX_KEYS_PER_ENTRY) return;
+      keys.add(wordKey(scope, token));
+    }
+  };
+
+  add('', entry.message);
+  add('level', entry.level);
+  add('source', entry.source);
+  add('category', entry.category);
+
+  const visit = (value: unknown, path: string, depth: number) => {
+    if (value === undefined || value === null || keys.size >= MAX_KEYS_PER_ENTRY) return;
+    if (typeof value === 'object') {
+      if (depth >= MAX_META_DEPTH) return;
+      if (Array.isArray(value)) {
+        value.forEach(item => visit(item, path, depth + 1));
+        return;
+      }
+      for (const [key, child] of Object.entries(value)) {
+        const field = key.toLowerCase();
+        add('', key);
+        visit(child, path ? `${path}.${field}` : field, depth + 1);
+      }
+      return;
+    }
+
+    const text = String(value);
+    add('', text);
+    if (!path) return;
+    add(path, text);
+    const leaf = path.slice(path.lastIndexOf('.') + 1);
+    if (leaf !== path) add(leaf, text);
+  };
+  visit(entry.meta, '', 0);
+
+  return [...keys];
+}
+
+/**
+ * 解析查询：空格分隔，`字段:值` 限定字段；值中的每个词都作为查询词
+ */
+export function parseSearchQuery(search: string): SearchTerm[] {
+  const terms: SearchTerm[] = [];
+  for (const part of search.trim().split(/\s+/)) {
+    if (!part) continue;
+    const scoped = SCOPED_TERM_PATTERN.exec(part);
+    const scope = scoped ? scoped[1].toLowerCase() : '';
+    for (const token of tokenize(scoped ? scoped[2] : part)) {
+      terms.push({ scope, token });
+    }
+  }
+  return terms;
+}
+
+/**
+ * 一条日志的词键是否满足全部查询词
+ */
+export function keysMatchQuery(keys: string[], terms: SearchTerm[]): boolean {
+  return terms.every(term => {
+    const prefix = wordKey(term.scope, term.token);
+    return keys.some(key => key.startsWith(prefix));
+  });
+}
+
+const CJK = '\\u3400-\\u9fff\\uf900-\\ufaff';
+const TOKEN_PATTERN = new RegExp(`[${CJK}]|(?:(?![${CJK}])[\\p{L}\\p{N}_])+`, 'gu');
+const SCOPED_TERM_PATTERN = /^([\p{L}\p{N}_.]+):(.+)$/u;
+const SCOPE_SEPARATOR = '\u0001';
+const MAX_TOKEN_LENGTH = 32;      // 更长的词按前缀索引
+const MAX_KEYS_PER_ENTRY = 256;   // 大的 meta 只索引前面的部分
+const MAX_META_DEPTH = 4;
+
+/**
+ * 词键：字段 + 分隔符 + 词，不限字段时字段为空
+ */
+function wordKey(scope: string, token: string): string {
+  return `${scope}${SCOPE_SEPARATOR}${token}`;
+}
+
+function bucketOf(key: string): string {
+  return key.slice(0, key.indexOf(SCOPE_SEPARATOR) + 3);
+}
+
+/**
+ * 合并多个倒排列表为递增且不重复的序号
+ */
+function union(rings: SeqRing[]): number[] {
+  if (rings.length === 1) {
+    const ring = rings[0];
+    const seqs = new Array<number>(ring.length);
+    for (let i = 0; i < ring.length; i++) seqs[i] = ring.at(i);
+    return seqs;
+  }
+
+  const all = new Float64Array(rings.reduce((sum, ring) => sum + ring.length, 0));
+  let n = 0;
+  for (const ring of rings) {
+    for (let i = 0; i < ring.length; i++) all[n++] = ring.at(i);
+  }
+  all.sort();
+
+  const seqs: number[] = [];
+  for (let i = 0; i < all.length; i++) {
+    if (i === 0 || all[i] !== all[i - 1]) seqs.push(all[i]);
+  }
+  return seqs;
+}
+
+function intersect(a: number[], b: number[]): number[] {
+  const result: number[] = [];
+  let i = 0;
+  let j = 0;
+  while (i < a.length && j < b.length) {
+    if (a[i] < b[j]) {
+      i++;
+    } else if (a[i] > b[j]) {
+      j++;
+    } else {
+      result.push(a[i]);
+      i++;
+      j++;
+    }
+  }
+  return result;
+}
+
+export interface SearchTerm {
+  scope: string;   // 限定的字段（小写），空为不限
+  token: string;   // 词前缀
+}
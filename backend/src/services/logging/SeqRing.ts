@@ -0,0 +1,43 @@
+/**
+ * 序号索引环：按写入顺序保存一组条目序号（某个字段值或词的倒排列表），容量按需倍增
+ * 只从尾部追加、从头部淘汰，环内序号始终递增
+ */
+export class SeqRing {
+  private buffer: Float64Array;
+  private head = 0;
+  length = 0;
+
+  constructor(initialCapacity: number = 16) {
+    this.buffer = new Float64Array(initialCapacity);
+  }
+
+  push(seq: number): void {
+    if (this.length === this.buffer.length) {
+      this.grow();
+    }
+    this.buffer[(this.head + this.length) % this.buffer.length] = seq;
+    this.length++;
+  }
+
+  shift(): void {
+    if (this.length === 0) return;
+    this.head = (this.head + 1) % this.buffer.length;
+    this.length--;
+  }
+
+  /**
+   * 第 i 旧的序号
+   */
+  at(i: number): number {
+    return this.buffer[(this.head + i) % this.buffer.length];
+  }
+
+  private grow(): void {
+    const next = new Float64Array(this.buffer.length * 2);
+    for (let i = 0; i < this.length; i++) {
+      next[i] = this.at(i);
+    }
+    this.buffer = next;
+    this.head = 0;
+  }
+}
@@ -0,0 +1,357 @@
+import winston from 'winston';
+import type { SocketConnectionManager, ClientInfo } from './SocketConnectionManager';
+import type { UnifiedLogService, LogEntry, LogLevel, LogCategory } from '../UnifiedLogService';
+import { createLogFilter } from '../logging/LogFilter';
+import type { LogFilter } from '../logging/LogFilter';
+
+/**
+ * 日志订阅管理器
+ * 客户端通过 logSubscribe 订阅带过滤条件的日志流，服务端逐条判断新日志，
+ * 匹配的日志在每个订阅的队列中合并，按间隔或数量成批推送（logBatch）
+ *
+ * 续传：每批带上日志流位置（实例标识 epoch + 写入序号 cursor），
+ * 客户端重连后带上最后的位置重新订阅，服务端补发之后匹配的日志；
+ * 位置已不在内存中（服务重启、日志被淘汰或清空）时改为发送最近的日志并标记 gap
+ */
+export class LogSubscriptionManager {
+  private logger: winston.Logger;
+  private connectionManager: SocketConnectionManager;
+  private logService: UnifiedLogService;
+  private config: LogSubscriptionConfig;
+  private subscriptions: Map<string, Map<string, LogSubscription>> = new Map(); // 客户端 -> 订阅ID -> 订阅
+  private started = false;
+
+  constructor(
+    connectionManager: SocketConnectionManager,
+    logService: UnifiedLogService,
+    logger: winston.Logger,
+    config: Partial<LogSubscriptionConfig> = {}
+  ) {
+    this.connectionManager = connectionManager;
+    this.logService = logService;
+    this.logger = logger;
+    this.config = { ...getDefaultLogSubscriptionConfig(), ...config };
+  }
+
+  /**
+   * 启动日志订阅
+   */
+  start(): void {
+    if (this.started) return;
+    this.started = true;
+
+    this.logService.on('newLog', this.handleNewLog);
+    this.logService.on('logsCleared', this.handleLogsCleared);
+    this.connectionManager.on('clientEvent', this.handleClientEvent);
+    this.connectionManager.on('clientDisconnected', this.handleClientDisconnected);
+    this.logger.info('Log Subscription Manager started');
+  }
+
+  /**
+   * 停止日志订阅
+   */
+  stop(): void {
+    if (!this.started) return;
+    this.started = false;
+
+    this.logService.off('newLog', this.handleNewLog);
+    this.logService.off('logsCleared', this.handleLogsCleared);
+    this.connectionManager.off('clientEvent', this.handleClientEvent);
+    this.connectionManager.off('clientDisconnected', this.handleClientDisconnected);
+    for (const clientId of [...this.subscriptions.keys()]) {
+      this.removeClient(clientId);
+    }
+    this.logger.info('Log Subscription Manager stopped');
+  }
+
+  /**
+   * 获取订阅统计
+   */
+  getStats(): LogSubscriptionStats {
+    let subscriptions = 0;
+    let pending = 0;
+    let dropped = 0;
+    for (const clientSubscriptions of this.subscriptions.values()) {
+      for (const subscription of clientSubscriptions.values()) {
+        subscriptions++;
+        pending += subscription.pending.length;
+        dropped += subscription.totalDropped;
+      }
+    }
+    return { clients: this.subscriptions.size, subscriptions, pending, dropped };
+  }
+
+  private handleClientEvent = (clientId: string, event: string, data: any): void => {
+    switch (event) {
+      case 'logSubscribe':
+        this.subscribe(clientId, data);
+        break;
+      case 'logUnsubscribe':
+        this.unsubscribe(clientId, data?.id);
+        break;
+    }
+  };
+
+  private handleClientDisconnected = (clientInfo: ClientInfo): void => {
+    this.removeClient(clientInfo.id);
+  };
+
+  /**
+   * 新日志：逐个订阅判断，匹配的加入队列
+   */
+  private handleNewLog = (entry: LogEntry): void => {
+    for (const [clientId, clientSubscriptions] of this.subscriptions) {
+      for (const subscription of clientSubscriptions.values()) {
+        if (!subscription.matches(entry)) continue;
+
+        subscription.pending.push(entry);
+        if (subscription.pending.length > this.config.maxPending) {
+          subscription.pending.shift();
+          subscription.dropped++;
+          subscription.totalDropped++;
+        }
+
+        if (subscription.pending.length >= this.config.maxBatchSize) {
+          this.flush(clientId, subscription);
+        } else if (!subscription.timer) {
+          subscription.timer = setTimeout(() => this.flush(clientId, subscription), this.config.batchIntervalMs);
+        }
+      }
+    }
+  };
+
+  /**
+   * 日志被清空：丢弃队列，通知客户端从当前位置重新开始
+   */
+  private handleLogsCleared = (): void => {
+    const { epoch, seq } = this.logService.getStreamPosition();
+    for (const [clientId, clientSubscriptions] of this.subscriptions) {
+      for (const subscription of clientSubscriptions.values()) {
+        this.clearTimer(subscription);
+        subscription.pending = [];
+        subscription.dropped = 0;
+        this.connectionManager.sendToClient(clientId, 'logReset', { id: subscription.id, epoch, cursor: seq });
+      }
+    }
+  };
+
+  /**
+   * 处理订阅请求：同一ID重复订阅时替换原订阅（修改过滤条件或重连续传）
+   */
+  private subscribe(clientId: string, request: LogSubscribeRequest): void {
+    const id = typeof request?.id === 'string' ? request.id : '';
+    if (!id || id.length > 64) {
+      this.connectionManager.sendToClient(clientId, 'logSubscribeError', { id, error: 'Invalid subscription id' });
+      return;
+    }
+
+    const filter = sanitizeFilter(request.filter);
+    if (typeof filter === 'string') {
+      this.connectionManager.sendToClient(clientId, 'logSubscribeError', { id, error: filter });
+      return;
+    }
+
+    let clientSubscriptions = this.subscriptions.get(clientId);
+    const existing = clientSubscriptions?.get(id);
+    if (existing) {
+      this.clearTimer(existing);
+    } else if (clientSubscriptions && clientSubscriptions.size >= this.config.maxSubscriptionsPerClient) {
+      this.connectionManager.sendToClient(clientId, 'logSubscribeError', {
+        id,
+        error: `Too many log subscriptions (max ${this.config.maxSubscriptionsPerClient})`
+      });
+      return;
+    }
+
+    const subscription: LogSubscription = {
+      id,
+      filter,
+      matches: createLogFilter(filter),
+      pending: [],
+      timer: null,
+      dropped: 0,
+      totalDropped: 0
+    };
+
+    const { epoch, seq } = this.logService.getStreamPosition();
+    const { entries, resumed, gap } = this.initialEntries(subscription, request, epoch);
+
+    if (!clientSubscriptions) {
+      clientSubscriptions = new Map();
+      this.subscriptions.set(clientId, clientSubscriptions);
+    }
+    clientSubscriptions.set(id, subscription);
+
+    const message: LogSubscribedMessage = { id, epoch, cursor: seq, resumed, gap, entries };
+    this.connectionManager.sendToClient(clientId, 'logSubscribed', message);
+    this.logger.debug(`Client ${clientId} subscribed to logs (${id}): ${entries.length} initial entries, resumed=${resumed}, gap=${gap}`);
+  }
+
+  /**
+   * 订阅时先发送的日志（旧的在前）：能续传时补发断开期间匹配的日志，否则发送最近的 backlog 条
+   */
+  private initialEntries(
+    subscription: LogSubscription,
+    request: LogSubscribeRequest,
+    epoch: string
+  ): { entries: LogEntry[]; resumed: boolean; gap: boolean } {
+    const resume = request.resume;
+    if (resume && typeof resume.cursor === 'number') {
+      const missed = resume.epoch === epoch ? this.logService.getLogsSince(resume.cursor) : null;
+      if (missed) {
+        const entries = missed.filter(subscription.matches);
+        const overflow = entries.length > this.config.maxReplay;
+        return { entries: overflow ? entries.slice(-this.config.maxReplay) : entries, resumed: true, gap: overflow };
+      }
+    }
+
+    const backlog = Math.min(
+      this.config.maxReplay,
+      Math.max(0, Number.isFinite(request.backlog) ? Number(request.backlog) : this.config.defaultBacklog)
+    );
+    const entries = backlog > 0 ? this.logService.findRecentLogs(subscription.matches, backlog).reverse() : [];
+    return { entries, resumed: false, gap: !!resume };
+  }
+
+  private unsubscribe(clientId: string, id: unknown): void {
+    const clientSubscriptions = this.subscriptions.get(clientId);
+    const subscription = typeof id === 'string' ? clientSubscriptions?.get(id) : undefined;
+    if (!clientSubscriptions || !subscription) return;
+
+    this.clearTimer(subscription);
+    clientSubscriptions.delete(subscription.id);
+    if (clientSubscriptions.size === 0) {
+      this.subscriptions.delete(clientId);
+    }
+  }
+
+  private removeClient(clientId: string): void {
+    const clientSubscriptions = this.subscriptions.get(clientId);
+    if (!clientSubscriptions) return;
+
+    for (const subscription of clientSubscriptions.values()) {
+      this.clearTimer(subscription);
+    }
+    this.subscriptions.delete(clientId);
+  }
+
+  /**
+   * 推送一个订阅队列中的日志；cursor 为推送时的日志流位置，之前匹配的日志都已在本批或之前的批次中
+   */
+  private flush(clientId: string, subscription: LogSubscription): void {
+    this.clearTimer(subscription);
+    if (subscription.pending.length === 0) return;
+
+    const { epoch, seq } = this.logService.getStreamPosition();
+    const message: LogBatchMessage = {
+      id: subscription.id,
+      epoch,
+      cursor: seq,
+      entries: subscription.pending,
+      dropped: subscription.dropped
+    };
+    subscription.pending = [];
+    subscription.dropped = 0;
+    this.connectionManager.sendToClient(clientId, 'logBatch', message);
+  }
+
+  private clearTimer(subscription: LogSubscription): void {
+    if (subscription.timer) {
+      clearTimeout(subscription.timer);
+      subscription.timer = null;
+    }
+  }
+}
+
+const LOG_LEVELS: LogLevel[] = ['error', 'warn', 'info', 'debug'];
+const LOG_CATEGORIES: LogCategory[] = ['system', 'communication', 'task_execution', 'device_control', 'user_action', 'error_handling'];
+const MAX_SEARCH_LENGTH = 200;
+
+/**
+ * 校验客户端传来的过滤条件，非法时返回错误信息
+ */
+function sanitizeFilter(raw: any): LogFilter | string {
+  if (raw === undefined || raw === null) return {};
+  if (typeof raw !== 'object') return 'Invalid filter';
+
+  const filter: LogFilter = {};
+  const fields = [['level', LOG_LEVELS], ['source', null], ['category', LOG_CATEGORIES]] as const;
+  for (const [field, allowed] of fields) {
+    const value = raw[field];
+    if (value === undefined || value === null || value === '') continue;
+    const values = Array.isArray(value) ? value : [value];
+    if (!values.every(v => typeof v === 'string' && (!allowed || (allowed as readonly string[]).includes(v)))) {
+      return `Invalid ${field} filter`;
+    }
+    (filter as any)[field] = values;
+  }
+
+  if (raw.search !== undefined && raw.search !== null && raw.search !== '') {
+    if (typeof raw.search !== 'string' || raw.search.length > MAX_SEARCH_LENGTH) {
+      return 'Invalid search filter';
+    }
+    filter.search = raw.search;
+  }
+  return filter;
+}
+
+function getDefaultLogSubscriptionConfig(): LogSubscriptionConfig {
+  return {
+    batchIntervalMs: 100,
+    maxBatchSize: 100,
+    maxPending: 1000,
+    maxReplay: 500,
+    defaultBacklog: 100,
+    maxSubscriptionsPerClient: 8
+  };
+}
+
+interface LogSubscription {
+  id: string;
+  filter: LogFilter;
+  matches: (entry: LogEntry) => boolean;
+  pending: LogEntry[];
+  timer: NodeJS.Timeout | null;
+  dropped: number;        // 本批之前因队列溢出丢弃的条数
+  totalDropped: number;
+}
+
+export interface LogSubscriptionConfig {
+  batchIntervalMs: number;             // 合并推送间隔
+  maxBatchSize: number;                // 队列达到此数量时立即推送
+  maxPending: number;                  // 客户端跟不上时每个订阅缓存的上限，超出时丢弃最旧的
+  maxReplay: number;                   // 订阅/续传时最多补发的条数
+  defaultBacklog: number;              // 未指定时订阅先发送的最近日志条数
+  maxSubscriptionsPerClient: number;
+}
+
+export interface LogSubscribeRequest {
+  id: string;
+  filter?: LogFilter;
+  resume?: { epoch: string; cursor: number };   // 上次收到的日志流位置
+  backlog?: number;                             // 不能续传时先发送的最近日志条数
+}
+
+export interface LogSubscribedMessage {
+  id: string;
+  epoch: string;
+  cursor: number;
+  resumed: boolean;      // 补发的是断开期间的日志（否则为最近的日志，客户端应替换而不是追加）
+  gap: boolean;          // 请求续传但有日志无法补发
+  entries: LogEntry[];
+}
+
+export interface LogBatchMessage {
+  id: string;
+  epoch: string;
+  cursor: number;
+  entries: LogEntry[];
+  dropped: number;       // 本批之前因客户端跟不上而丢弃的条数
+}
+
+export interface LogSubscriptionStats {
+  clients: number;
+  subscriptions: number;
+  pending: number;
+  dropped: number;
+}
@@ -1,6 +1,6 @@
 import { EventEmitter } from 'events';
 import winston from 'winston';
-import { SocketConnectionManager } from './SocketConnectionManager';
+import type { SocketConnectionManager, ClientInfo } from './SocketConnectionManager';
 import { DeviceState, DeviceCommand } from '../../types/device';
 
 /**
@@ -12,18 +12,46 @@ import { DeviceState, DeviceCommand } from '../../types/device';
  * - 系统消息广播
  * - 选择性消息发送
  * - 消息队列管理
+ *
+ * 每个处理周期（100ms）按优先级从高到低发出队列中的消息：
+ * - 设备状态按设备合并，周期内只保留每个设备的最新状态；
+ *   对每个客户端只发送与它当前持有的状态（已确认的状态叠加之后发送未确认的状态）相比变化的字段（deviceStateDelta），
+ *   客户端的确认（deviceStateAck）只用于缩短未确认记录
+ * - 带合并键的消息（连接状态、任务状态）在队列中只保留最新内容与时间
  */
 export class MessageBroadcaster extends EventEmitter {
   private logger: winston.Logger;
   private connectionManager: SocketConnectionManager;
-  private messageQueue: BroadcastMessage[] = [];
+  private queues: Record<MessagePriority, BroadcastMessage[]> = {
+    [MessagePriority.CRITICAL]: [],
+    [MessagePriority.HIGH]: [],
+    [MessagePriority.MEDIUM]: [],
+    [MessagePriority.LOW]: []
+  };
+  private keyedMessages: Map<string, BroadcastMessage> = new Map();       // 合并键 -> 队列中的消息
+  private pendingDeviceStates: Map<string, PendingDeviceState> = new Map(); // 设备ID -> 本周期最新状态
+  private clientSnapshots: Map<string, ClientSnapshot> = new Map();
   private isProcessingQueue = false;
+  private processingTimer: NodeJS.Timeout | null = null;
   private queueProcessingInterval = 100; // 100ms
+  private maxMessagesPerCycle = 50;
+  private maxQueueLength = 1000;
+  private maxUnackedDeltas = 16;         // 客户端不确认时保留的已发送未确认增量数
+  private counters = { coalescedDeviceUpdates: 0, deltasSent: 0, fieldsSent: 0, fieldsUnchanged: 0 };
 
   constructor(connectionManager: SocketConnectionManager, logger: winston.Logger) {
     super();
     this.connectionManager = connectionManager;
     this.logger = logger;
+
+    this.connectionManager.on('clientEvent', (clientId: string, event: string, data: any) => {
+      if (event === 'deviceStateAck') {
+        this.acknowledgeDeviceStates(clientId, data?.version);
+      }
+    });
+    this.connectionManager.on('clientDisconnected', (clientInfo: ClientInfo) => {
+      this.clientSnapshots.delete(clientInfo.id);
+    });
   }
 
   /**
@@ -39,22 +67,18 @@ export class MessageBroadcaster extends EventEmitter {
    */
   stop(): void {
     this.isProcessingQueue = false;
+    if (this.processingTimer) {
+      clearInterval(this.processingTimer);
+      this.processingTimer = null;
+    }
     this.logger.info('Message Broadcaster stopped');
   }
 
   /**
-   * 广播设备状态更新
+   * 广播设备状态更新（同一周期内同一设备只发送最新状态）
    */
-  broadcastDeviceState(deviceState: DeviceState): void {
-    const message: BroadcastMessage = {
-      type: 'device_state',
-      event: 'deviceStateUpdate',
-      data: deviceState,
-      timestamp: Date.now(),
-      priority: MessagePriority.HIGH
-    };
-
-    this.queueMessage(message);
+  broadcastDeviceState(deviceState: DeviceState, priority: MessagePriority = MessagePriority.HIGH): void {
+    this.queueDeviceState(deviceState, priority);
     this.logger.debug(`Queued device state broadcast: ${deviceState.deviceId}`);
   }
 
@@ -62,15 +86,7 @@ export class MessageBroadcaster extends EventEmitter {
    * 批量广播设备状态
    */
   broadcastBatchDeviceStates(deviceStates: DeviceState[]): void {
-    const message: BroadcastMessage = {
-      type: 'device_states_batch',
-      event: 'deviceStatesBatchUpdate',
-      data: deviceStates,
-      timestamp: Date.now(),
-      priority: MessagePriority.HIGH
-    };
-
-    this.queueMessage(message);
+    deviceStates.forEach(state => this.queueDeviceState(state, MessagePriority.HIGH));
     this.logger.debug(`Queued batch device states broadcast: ${deviceStates.length} devices`);
   }
 
@@ -128,7 +144,8 @@ export class MessageBroadcaster extends EventEmitter {
         timestamp: Date.now()
       },
       timestamp: Date.now(),
-      priority: MessagePriority.MEDIUM
+      priority: MessagePriority.MEDIUM,
+      key: `task_status:${taskId}`
     };
 
     this.queueMessage(message);
@@ -165,7 +182,8 @@ export class MessageBroadcaster extends EventEmitter {
       event: 'connectionStatusUpdate',
       data: stats,
       timestamp: Date.now(),
-      priority: MessagePriority.LOW
+      priority: MessagePriority.LOW,
+      key: 'connection_status'
     };
 
     this.queueMessage(message);
@@ -195,16 +213,18 @@ export class MessageBroadcaster extends EventEmitter {
    * 获取消息队列统计
    */
   getQueueStatistics(): QueueStatistics {
-    const priorityCounts = this.messageQueue.reduce((counts, msg) => {
-      counts[msg.priority] = (counts[msg.priority] || 0) + 1;
-      return counts;
-    }, {} as Record<MessagePriority, number>);
+    const priorityCounts = {} as Record<MessagePriority, number>;
+    for (const priority of PRIORITY_ORDER) {
+      priorityCounts[priority] = this.queues[priority].length;
+    }
 
     return {
-      queueLength: this.messageQueue.length,
+      queueLength: this.queueLength(),
       isProcessing: this.isProcessingQueue,
       priorityCounts,
-      oldestMessageAge: this.getOldestMessageAge()
+      oldestMessageAge: this.getOldestMessageAge(),
+      pendingDeviceStates: this.pendingDeviceStates.size,
+      ...this.counters
     };
   }
 
@@ -215,67 +235,107 @@ export class MessageBroadcaster extends EventEmitter {
     const now = Date.now();
     const maxAge = 60000; // 1分钟
 
-    const initialLength = this.messageQueue.length;
-    this.messageQueue = this.messageQueue.filter(msg => now - msg.timestamp < maxAge);
-    
-    const removedCount = initialLength - this.messageQueue.length;
+    let removedCount = 0;
+    for (const priority of PRIORITY_ORDER) {
+      const kept = this.queues[priority].filter(msg => now - msg.timestamp < maxAge);
+      removedCount += this.queues[priority].length - kept.length;
+      this.queues[priority] = kept;
+    }
+    for (const [key, message] of this.keyedMessages) {
+      if (now - message.timestamp >= maxAge) this.keyedMessages.delete(key);
+    }
+
     if (removedCount > 0) {
       this.logger.debug(`Cleaned up ${removedCount} expired messages`);
     }
   }
 
   /**
-   * 将消息加入队列
+   * 将消息加入队列；已有相同合并键的消息时只更新其内容
    */
   private queueMessage(message: BroadcastMessage): void {
-    this.messageQueue.push(message);
-    
-    // 按优先级排序
-    this.messageQueue.sort((a, b) => {
-      const priorityOrder = {
-        [MessagePriority.CRITICAL]: 0,
-        [MessagePriority.HIGH]: 1,
-        [MessagePriority.MEDIUM]: 2,
-        [MessagePriority.LOW]: 3
-      };
-      
-      return priorityOrder[a.priority] - priorityOrder[b.priority];
-    });
+    if (message.key) {
+      const queued = this.keyedMessages.get(message.key);
+      if (queued) {
+        // 内容已更新，过期时间从本次更新算起
+        queued.data = message.data;
+        queued.timestamp = message.timestamp;
+        return;
+      }
+      this.keyedMessages.set(message.key, message);
+    }
 
-    // 限制队列长度
-    if (this.messageQueue.length > 1000) {
-      this.messageQueue = this.messageQueue.slice(0, 1000);
-      this.logger.warn('Message queue truncated due to size limit');
+    this.queues[message.priority].push(message);
+
+    // 限制队列长度：丢弃优先级最低的最旧消息
+    if (this.queueLength() > this.maxQueueLength) {
+      for (let i = PRIORITY_ORDER.length - 1; i >= 0; i--) {
+        const dropped = this.queues[PRIORITY_ORDER[i]].shift();
+        if (dropped) {
+          if (dropped.key) this.keyedMessages.delete(dropped.key);
+          this.logger.warn(`Message queue full, dropped ${dropped.type} message`);
+          break;
+        }
+      }
     }
   }
 
+  /**
+   * 设备状态加入本周期的待发送状态，同一设备保留最新状态与较高的优先级
+   */
+  private queueDeviceState(state: DeviceState, priority: MessagePriority): void {
+    const pending = this.pendingDeviceStates.get(state.deviceId);
+    if (pending) {
+      pending.state = state;
+      if (PRIORITY_ORDER.indexOf(priority) < PRIORITY_ORDER.indexOf(pending.priority)) {
+        pending.priority = priority;
+      }
+      this.counters.coalescedDeviceUpdates++;
+      return;
+    }
+    this.pendingDeviceStates.set(state.deviceId, { state, priority });
+  }
+
   /**
    * 开始队列处理
    */
   private startQueueProcessing(): void {
     this.isProcessingQueue = true;
-    this.processQueue();
+    if (!this.processingTimer) {
+      this.processingTimer = setInterval(() => this.processQueue(), this.queueProcessingInterval);
+    }
   }
 
   /**
-   * 处理消息队列
+   * 处理一个周期：按优先级发出设备状态增量与队列中的消息（每周期最多 maxMessagesPerCycle 条普通消息）
    */
-  private async processQueue(): Promise<void> {
-    while (this.isProcessingQueue) {
-      if (this.messageQueue.length > 0) {
-        const message = this.messageQueue.shift()!;
-        await this.processMessage(message);
+  private processQueue(): void {
+    if (!this.isProcessingQueue) return;
+
+    const deviceStates = this.pendingDeviceStates;
+    this.pendingDeviceStates = new Map();
+    let budget = this.maxMessagesPerCycle;
+
+    for (const priority of PRIORITY_ORDER) {
+      const states = [...deviceStates.values()].filter(p => p.priority === priority).map(p => p.state);
+      if (states.length > 0) {
+        this.sendDeviceStateDeltas(states, priority);
       }
 
-      // 等待下一个处理周期
-      await new Promise(resolve => setTimeout(resolve, this.queueProcessingInterval));
+      const queue = this.queues[priority];
+      while (queue.length > 0 && budget > 0) {
+        const message = queue.shift()!;
+        if (message.key) this.keyedMessages.delete(message.key);
+        this.processMessage(message);
+        budget--;
+      }
     }
   }
 
   /**
    * 处理单个消息
    */
-  private async processMessage(message: BroadcastMessage): Promise<void> {
+  private processMessage(message: BroadcastMessage): void {
     try {
       this.connectionManager.broadcast(message.event, message.data);
       this.emit('messageBroadcast', message);
@@ -287,6 +347,83 @@ export class MessageBroadcaster extends EventEmitter {
     }
   }
 
+  /**
+   * 向每个客户端发送设备状态增量：只含与该客户端当前持有的状态不同的字段，没有变化的客户端不发送
+   */
+  private sendDeviceStateDeltas(states: DeviceState[], priority: MessagePriority): void {
+    const now = Date.now();
+    for (const client of this.connectionManager.getConnectedClients()) {
+      let snapshot = this.clientSnapshots.get(client.id);
+      if (!snapshot) {
+        snapshot = { version: 0, acked: new Map(), unacked: [] };
+        this.clientSnapshots.set(client.id, snapshot);
+      }
+
+      const changes: Record<string, Partial<Record<keyof DeviceState, unknown>>> = {};
+      const sent = new Map<string, DeviceState>();
+      for (const state of states) {
+        const fields = diffDeviceState(this.clientDeviceState(snapshot, state.deviceId), state);
+        const fieldCount = Object.keys(fields).length;
+        this.counters.fieldsUnchanged += Object.keys(state).length - 1 - fieldCount;
+        if (fieldCount === 0) continue;
+        changes[state.deviceId] = fields;
+        sent.set(state.deviceId, { ...state });
+        this.counters.fieldsSent += fieldCount;
+      }
+      if (sent.size === 0) continue;
+
+      const version = ++snapshot.version;
+      snapshot.unacked.push({ version, states: sent });
+      if (snapshot.unacked.length > this.maxUnackedDeltas) {
+        // 未确认的记录过多时把最旧的并入基准：同一连接内的消息按序送达，断开时快照被删除
+        mergeIntoAcked(snapshot, snapshot.unacked.shift()!.states);
+      }
+
+      const delta: DeviceStateDelta = { version, changes, timestamp: now };
+      try {
+        this.connectionManager.sendToClient(client.id, 'deviceStateDelta', delta);
+        this.counters.deltasSent++;
+      } catch (error) {
+        this.logger.error('Failed to send device state delta:', error);
+      }
+    }
+
+    this.emit('messageBroadcast', {
+      type: 'device_state_delta',
+      event: 'deviceStateDelta',
+      data: states,
+      timestamp: now,
+      priority
+    } as BroadcastMessage);
+  }
+
+  /**
+   * 客户端当前持有的设备状态：最后发送的未确认状态，没有时为已确认的状态
+   */
+  private clientDeviceState(snapshot: ClientSnapshot, deviceId: string): DeviceState | undefined {
+    for (let i = snapshot.unacked.length - 1; i >= 0; i--) {
+      const state = snapshot.unacked[i].states.get(deviceId);
+      if (state) return state;
+    }
+    return snapshot.acked.get(deviceId);
+  }
+
+  /**
+   * 客户端确认收到某个版本：该版本及之前发送的状态并入已确认的状态，不改变比较结果
+   */
+  private acknowledgeDeviceStates(clientId: string, version: unknown): void {
+    const snapshot = this.clientSnapshots.get(clientId);
+    if (!snapshot || typeof version !== 'number') return;
+
+    while (snapshot.unacked.length > 0 && snapshot.unacked[0].version <= version) {
+      mergeIntoAcked(snapshot, snapshot.unacked.shift()!.states);
+    }
+  }
+
+  private queueLength(): number {
+    return PRIORITY_ORDER.reduce((sum, priority) => sum + this.queues[priority].length, 0);
+  }
+
   /**
    * 获取系统消息优先级
    */
@@ -307,19 +444,46 @@ export class MessageBroadcaster extends EventEmitter {
    * 获取最旧消息的年龄
    */
   private getOldestMessageAge(): number {
-    if (this.messageQueue.length === 0) return 0;
-    
-    const oldestMessage = this.messageQueue[this.messageQueue.length - 1];
-    return Date.now() - oldestMessage.timestamp;
+    let oldest = Infinity;
+    for (const priority of PRIORITY_ORDER) {
+      const first = this.queues[priority][0];
+      if (first && first.timestamp < oldest) oldest = first.timestamp;
+    }
+    return oldest === Infinity ? 0 : Date.now() - oldest;
+  }
+}
+
+function mergeIntoAcked(snapshot: ClientSnapshot, states: Map<string, DeviceState>): void {
+  for (const [deviceId, state] of states) {
+    snapshot.acked.set(deviceId, state);
   }
 }
 
+/**
+ * 与基准相比变化的字段；基准中有而新状态中没有的字段为null（客户端删除该字段）
+ */
+function diffDeviceState(base: DeviceState | undefined, state: DeviceState): Partial<Record<keyof DeviceState, unknown>> {
+  const fields: Partial<Record<keyof DeviceState, unknown>> = {};
+  for (const key of Object.keys(state) as (keyof DeviceState)[]) {
+    if (key !== 'deviceId' && (!base || base[key] !== state[key])) {
+      fields[key] = state[key];
+    }
+  }
+  if (base) {
+    for (const key of Object.keys(base) as (keyof DeviceState)[]) {
+      if (!(key in state)) fields[key] = null;
+    }
+  }
+  return fields;
+}
+
 export interface BroadcastMessage {
   type: string;
   event: string;
   data: any;
   timestamp: number;
   priority: MessagePriority;
+  key?: string;   // 合并键：队列中已有相同键的消息时只更新其内容
 }
 
 export enum MessagePriority {
@@ -329,11 +493,43 @@ export enum MessagePriority {
   LOW = 'low'
 }
 
+const PRIORITY_ORDER: MessagePriority[] = [
+  MessagePriority.CRITICAL,
+  MessagePriority.HIGH,
+  MessagePriority.MEDIUM,
+  MessagePriority.LOW
+];
+
 export type MessageLevel = 'info' | 'warning' | 'error';
 
+interface PendingDeviceState {
+  state: DeviceState;
+  priority: MessagePriority;
+}
+
+interface ClientSnapshot {
+  version: number;                                                 // 最后发送的增量版本
+  acked: Map<string, DeviceState>;                                 // 客户端已确认的设备状态
+  unacked: { version: number; states: Map<string, DeviceState> }[]; // 已发送未确认的状态
+}
+
+/**
+ * 设备状态增量（deviceStateDelta），客户端应回复 deviceStateAck { version }
+ */
+export interface DeviceStateDelta {
+  version: number;
+  changes: Record<string, Partial<Record<keyof DeviceState, unknown>>>;   // 设备ID -> 变化的字段
+  timestamp: number;
+}
+
 export interface QueueStatistics {
   queueLength: number;
   isProcessing: boolean;
   priorityCounts: Record<MessagePriority, number>;
   oldestMessageAge: number;
+  pendingDeviceStates: number;      // 本周期待发送的设备数
+  coalescedDeviceUpdates: number;   // 被同周期更新状态覆盖的设备状态数
+  deltasSent: number;
+  fieldsSent: number;
+  fieldsUnchanged: number;          // 与客户端当前持有的状态相同而未发送的字段数
 }
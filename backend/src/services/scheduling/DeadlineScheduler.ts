@@ -0,0 +1,285 @@
+/**
+ * 截止时间调度器
+ * 事件按截止时间存放在最小堆中，只为堆顶事件设置一个定时器
+ *
+ * 职责：
+ * - 截止时间为单调时钟上的绝对时间，后续事件从计划时间推算，延迟不会累积
+ * - 定时器提前唤醒时重新设置剩余时间；临近截止时改用 setImmediate 逼近，避免定时器粒度带来的迟到
+ * - 记录每个事件的实际触发时间与计划时间之差（迟到量）
+ */
+export class DeadlineScheduler {
+  private heap: ScheduledEvent[] = [];
+  private pending: Set<number> = new Set();   // 未触发且未取消的事件ID
+  private nextId = 1;
+  private timer: NodeJS.Timeout | null = null;
+  private immediate: NodeJS.Immediate | null = null;
+  private armedAt: number | null = null;    // 当前定时器对应的截止时间
+  private draining = false;
+  private config: DeadlineSchedulerConfig;
+  private stats: LatenessAccumulator = createLatenessAccumulator();
+
+  constructor(
+    config: Partial<DeadlineSchedulerConfig> = {},
+    private onDrained?: () => void
+  ) {
+    this.config = { ...getDefaultDeadlineSchedulerConfig(), ...config };
+  }
+
+  /**
+   * 单调时钟（毫秒，带小数），不受系统时间调整影响
+   */
+  now(): number {
+    return Number(process.hrtime.bigint()) / 1e6;
+  }
+
+  /**
+   * 在单调时钟的 dueAt 时刻执行回调，返回事件ID
+   */
+  schedule(dueAt: number, callback: (event: FiredEvent) => void, label = ''): number {
+    const event: ScheduledEvent = { id: this.nextId++, dueAt, callback, label };
+    this.push(event);
+    this.pending.add(event.id);
+
+    // 新事件成为堆顶时需要提前定时器；触发过程中由 drain 结束后统一设置
+    if (!this.draining && (this.armedAt === null || dueAt < this.armedAt)) {
+      this.arm();
+    }
+    return event.id;
+  }
+
+  /**
+   * 取消事件（惰性删除，出堆时丢弃）
+   */
+  cancel(id: number): void {
+    this.pending.delete(id);
+  }
+
+  /**
+   * 取消所有事件并停止定时器
+   */
+  clear(): void {
+    this.heap = [];
+    this.pending.clear();
+    this.disarm();
+  }
+
+  /**
+   * 待触发的事件数
+   */
+  get size(): number {
+    return this.pending.size;
+  }
+
+  /**
+   * 迟到统计（毫秒）
+   */
+  getLatenessStats(): LatenessStats {
+    const { count, sum, max, last, lateCount, recent } = this.stats;
+    const sorted = [...recent].sort((a, b) => a - b);
+    const p95 = sorted.length > 0 ? sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * 0.95))] : 0;
+    const round = (value: number) => Math.round(value * 1000) / 1000;
+
+    return {
+      fired: count,
+      pending: this.size,
+      lastMs: round(last),
+      meanMs: count > 0 ? round(sum / count) : 0,
+      p95Ms: round(p95),
+      maxMs: round(max),
+      lateCount,
+      lateThresholdMs: this.config.lateThresholdMs
+    };
+  }
+
+  resetLatenessStats(): void {
+    this.stats = createLatenessAccumulator();
+  }
+
+  /**
+   * 为堆顶事件设置定时器：距离截止时间较远时用 setTimeout，临近时用 setImmediate
+   */
+  private arm(): void {
+    this.disarm();
+    const head = this.peek();
+    if (!head) return;
+
+    this.armedAt = head.dueAt;
+    const remaining = head.dueAt - this.now();
+
+    if (remaining <= this.config.spinThresholdMs) {
+      this.immediate = setImmediate(() => {
+        this.immediate = null;
+        this.drain();
+      });
+      return;
+    }
+
+    this.timer = setTimeout(() => {
+      this.timer = null;
+      this.drain();
+    }, Math.floor(remaining - this.config.spinThresholdMs));
+  }
+
+  private disarm(): void {
+    if (this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+    }
+    if (this.immediate) {
+      clearImmediate(this.immediate);
+      this.immediate = null;
+    }
+    this.armedAt = null;
+  }
+
+  /**
+   * 触发所有已到期的事件（含回调中新加入且已到期的事件），然后为下一个事件设置定时器
+   */
+  private drain(): void {
+    this.armedAt = null;
+    this.draining = true;
+    let fired = 0;
+
+    try {
+      let head = this.peek();
+      while (head && head.dueAt <= this.now()) {
+        this.pop();
+        this.pending.delete(head.id);
+        const firedAt = this.now();
+        const latenessMs = firedAt - head.dueAt;
+        this.record(latenessMs);
+        fired++;
+        head.callback({ id: head.id, label: head.label, dueAt: head.dueAt, firedAt, latenessMs });
+        head = this.peek();
+      }
+    } finally {
+      this.draining = false;
+      if (fired > 0) {
+        this.onDrained?.();
+      }
+      this.arm();
+    }
+  }
+
+  private record(latenessMs: number): void {
+    const stats = this.stats;
+    stats.count++;
+    stats.sum += latenessMs;
+    stats.last = latenessMs;
+    if (latenessMs > stats.max) stats.max = latenessMs;
+    if (latenessMs > this.config.lateThresholdMs) stats.lateCount++;
+
+    if (stats.recent.length < this.config.latencyWindowSize) {
+      stats.recent.push(latenessMs);
+    } else {
+      stats.recent[stats.recentIndex] = latenessMs;
+    }
+    stats.recentIndex = (stats.recentIndex + 1) % this.config.latencyWindowSize;
+  }
+
+  // ==================== 最小堆 ====================
+
+  /**
+   * 堆顶的有效事件（丢弃已取消的事件）
+   */
+  private peek(): ScheduledEvent | undefined {
+    while (this.heap.length > 0 && !this.pending.has(this.heap[0].id)) {
+      this.pop();
+    }
+    return this.heap[0];
+  }
+
+  private push(event: ScheduledEvent): void {
+    const heap = this.heap;
+    heap.push(event);
+    let i = heap.length - 1;
+    while (i > 0) {
+      const parent = (i - 1) >> 1;
+      if (!this.before(heap[i], heap[parent])) break;
+      [heap[i], heap[parent]] = [heap[parent], heap[i]];
+      i = parent;
+    }
+  }
+
+  private pop(): ScheduledEvent | undefined {
+    const heap = this.heap;
+    const top = heap[0];
+    const last = heap.pop();
+    if (heap.length > 0 && last) {
+      heap[0] = last;
+      let i = 0;
+      for (;;) {
+        const left = 2 * i + 1;
+        const right = left + 1;
+        let smallest = i;
+        if (left < heap.length && this.before(heap[left], heap[smallest])) smallest = left;
+        if (right < heap.length && this.before(heap[right], heap[smallest])) smallest = right;
+        if (smallest === i) break;
+        [heap[i], heap[smallest]] = [heap[smallest], heap[i]];
+        i = smallest;
+      }
+    }
+    return top;
+  }
+
+  /**
+   * 截止时间相同时按加入顺序触发
+   */
+  private before(a: ScheduledEvent, b: ScheduledEvent): boolean {
+    return a.dueAt < b.dueAt || (a.dueAt === b.dueAt && a.id < b.id);
+  }
+}
+
+function createLatenessAccumulator(): LatenessAccumulator {
+  return { count: 0, sum: 0, max: 0, last: 0, lateCount: 0, recent: [], recentIndex: 0 };
+}
+
+function getDefaultDeadlineSchedulerConfig(): DeadlineSchedulerConfig {
+  return {
+    spinThresholdMs: 2,
+    lateThresholdMs: Number(process.env.SCHEDULER_LATE_THRESHOLD_MS || 5),
+    latencyWindowSize: 256
+  };
+}
+
+interface ScheduledEvent {
+  id: number;
+  dueAt: number;
+  callback: (event: FiredEvent) => void;
+  label: string;
+}
+
+interface LatenessAccumulator {
+  count: number;
+  sum: number;
+  max: number;
+  last: number;
+  lateCount: number;
+  recent: number[];
+  recentIndex: number;
+}
+
+export interface DeadlineSchedulerConfig {
+  spinThresholdMs: number;    // 距截止时间小于此值时用 setImmediate 逼近
+  lateThresholdMs: number;    // 迟到超过此值计入 lateCount
+  latencyWindowSize: number;  // 计算p95的最近事件数
+}
+
+export interface FiredEvent {
+  id: number;
+  label: string;
+  dueAt: number;       // 计划时间（单调时钟）
+  firedAt: number;     // 实际触发时间（单调时钟）
+  latenessMs: number;
+}
+
+export interface LatenessStats {
+  fired: number;
+  pending: number;
+  lastMs: number;
+  meanMs: number;
+  p95Ms: number;
+  maxMs: number;
+  lateCount: number;
+  lateThresholdMs: number;
+}
@@ -0,0 +1,108 @@
+/**
+ * 设备仲裁器
+ * 多个任务同时执行时，决定每个设备由哪个任务驱动
+ *
+ * 规则：
+ * - 任务开始前声明其用到的设备（编译时间线中出现的设备）
+ * - 准入：与正在执行的任务共用设备时，只有优先级严格更高才能进入，并接管这些设备
+ * - 设备由声明它的优先级最高的任务驱动；优先级相同时先进入者驱动
+ * - 任务结束后其设备回到剩余任务中优先级最高者
+ */
+export class DeviceArbiter {
+  private claims: Map<string, DeviceClaim> = new Map();   // executionId -> 声明
+  private admissionCounter = 0;
+
+  /**
+   * 检查准入：返回阻止进入的冲突（为空则可以进入）与将被接管的设备
+   */
+  check(deviceIds: string[], priority: number): AdmissionCheck {
+    const conflicts: DeviceConflict[] = [];
+    const preempted: DeviceConflict[] = [];
+
+    for (const deviceId of deviceIds) {
+      const owner = this.ownerOf(deviceId);
+      if (!owner) continue;
+
+      const entry = { deviceId, executionId: owner.executionId, taskName: owner.taskName, priority: owner.priority };
+      if (owner.priority >= priority) {
+        conflicts.push(entry);
+      } else {
+        preempted.push(entry);
+      }
+    }
+    return { conflicts, preempted };
+  }
+
+  claim(executionId: string, taskName: string, deviceIds: string[], priority: number): void {
+    this.claims.set(executionId, {
+      executionId,
+      taskName,
+      priority,
+      devices: new Set(deviceIds),
+      admittedAt: this.admissionCounter++
+    });
+  }
+
+  release(executionId: string): void {
+    this.claims.delete(executionId);
+  }
+
+  /**
+   * 该任务当前是否驱动此设备
+   */
+  owns(executionId: string, deviceId: string): boolean {
+    return this.ownerOf(deviceId)?.executionId === executionId;
+  }
+
+  /**
+   * 该任务当前驱动的设备
+   */
+  ownedDevices(executionId: string): string[] {
+    const claim = this.claims.get(executionId);
+    return claim ? [...claim.devices].filter(deviceId => this.owns(executionId, deviceId)) : [];
+  }
+
+  /**
+   * 所有被声明设备的当前驱动者
+   */
+  getOwners(): Record<string, string> {
+    const owners: Record<string, string> = {};
+    for (const claim of this.claims.values()) {
+      for (const deviceId of claim.devices) {
+        owners[deviceId] ??= this.ownerOf(deviceId)!.executionId;
+      }
+    }
+    return owners;
+  }
+
+  private ownerOf(deviceId: string): DeviceClaim | null {
+    let owner: DeviceClaim | null = null;
+    for (const claim of this.claims.values()) {
+      if (!claim.devices.has(deviceId)) continue;
+      if (!owner || claim.priority > owner.priority || (claim.priority === owner.priority && claim.admittedAt < owner.admittedAt)) {
+        owner = claim;
+      }
+    }
+    return owner;
+  }
+}
+
+interface DeviceClaim {
+  executionId: string;
+  taskName: string;
+  priority: number;
+  devices: Set<string>;
+  admittedAt: number;
+}
+
+export interface DeviceConflict {
+  deviceId: string;
+  executionId: string;  // 当前驱动该设备的任务
+  taskName: string;
+  priority: number;
+}
+
+export interface AdmissionCheck {
+  conflicts: DeviceConflict[];   // 阻止进入
+  preempted: DeviceConflict[];   // 进入后被接管
+}
@@ -0,0 +1,92 @@
+import { monitorEventLoopDelay } from 'perf_hooks';
+import type { IntervalHistogram } from 'perf_hooks';
+import { Logger } from 'winston';
+
+/**
+ * 事件循环延迟监视器
+ * 按固定窗口统计当前线程事件循环的延迟（均值/p99/最大值），窗口最大值超过阈值时告警
+ */
+export class EventLoopLagMonitor {
+  private histogram: IntervalHistogram;
+  private timer: NodeJS.Timeout | null = null;
+  private lastWindow: EventLoopLagWindow = { meanMs: 0, p99Ms: 0, maxMs: 0 };
+  private worstMs = 0;
+  private config: EventLoopLagConfig;
+
+  constructor(
+    private logger: Logger,
+    private threadName: string,
+    config: Partial<EventLoopLagConfig> = {}
+  ) {
+    this.config = { ...getDefaultEventLoopLagConfig(), ...config };
+    this.histogram = monitorEventLoopDelay({ resolution: this.config.resolutionMs });
+  }
+
+  start(): void {
+    if (this.timer) return;
+    this.histogram.enable();
+    this.timer = setInterval(() => this.rollWindow(), this.config.windowMs);
+    this.timer.unref();
+  }
+
+  stop(): void {
+    if (this.timer) {
+      clearInterval(this.timer);
+      this.timer = null;
+    }
+    this.histogram.disable();
+  }
+
+  /**
+   * 最近一个完整窗口的统计，以及启动以来的最大延迟
+   */
+  getStats(): EventLoopLagStats {
+    return {
+      thread: this.threadName,
+      windowMs: this.config.windowMs,
+      ...this.lastWindow,
+      worstMs: this.worstMs
+    };
+  }
+
+  private rollWindow(): void {
+    const toMs = (ns: number) => Math.round(ns / 1e4) / 100;
+    const histogram = this.histogram;
+
+    this.lastWindow = histogram.count > 0
+      ? { meanMs: toMs(histogram.mean), p99Ms: toMs(histogram.percentile(99)), maxMs: toMs(histogram.max) }
+      : { meanMs: 0, p99Ms: 0, maxMs: 0 };
+    histogram.reset();
+
+    this.worstMs = Math.max(this.worstMs, this.lastWindow.maxMs);
+    if (this.lastWindow.maxMs > this.config.warnThresholdMs) {
+      this.logger.warn(`Event loop lag on ${this.threadName} thread: max ${this.lastWindow.maxMs}ms, p99 ${this.lastWindow.p99Ms}ms`);
+    }
+  }
+}
+
+function getDefaultEventLoopLagConfig(): EventLoopLagConfig {
+  return {
+    resolutionMs: 10,
+    windowMs: 10000,
+    warnThresholdMs: Number(process.env.EVENT_LOOP_LAG_WARN_MS || 50)
+  };
+}
+
+export interface EventLoopLagConfig {
+  resolutionMs: number;     // 采样间隔
+  windowMs: number;         // 统计窗口
+  warnThresholdMs: number;  // 窗口最大延迟超过此值时告警
+}
+
+interface EventLoopLagWindow {
+  meanMs: number;
+  p99Ms: number;
+  maxMs: number;
+}
+
+export interface EventLoopLagStats extends EventLoopLagWindow {
+  thread: string;
+  windowMs: number;
+  worstMs: number;          // 启动以来的最大窗口延迟
+}
@@ -0,0 +1,237 @@
+import type { Task, TaskAction, DelayAction, ParallelLoop, SubStep } from '../../types/task';
+
+/**
+ * 任务编译器
+ * 执行前把 步骤/延时/并行循环/子步骤 的嵌套结构展开为按时间排序的不可变时间线
+ *
+ * 时间规则（与前端预计用时一致）：
+ * - 步骤内的动作、延时、循环都从步骤开始时刻并行开始；步骤在其中最晚结束者结束后，下一步骤开始
+ * - 延时内的动作与循环（含嵌套延时）从延时到期时刻开始
+ * - 循环的子步骤依次执行，子步骤时长为其中最长的动作（含嵌套延时）；相邻两次迭代之间间隔 intervalMs
+ */
+export function compileTask(task: Task): CompiledTask {
+  const sizeError = checkTaskSize(task);
+  if (sizeError) {
+    throw new Error(sizeError);
+  }
+
+  const builder = new TimelineBuilder();
+  const barriers: StepBarrier[] = [];
+  let stepStartMs = 0;
+
+  task.steps.forEach((step, stepIndex) => {
+    const actionsEnd = builder.addActions(step.actions, stepStartMs, stepIndex);
+    const loopsEnd = builder.addLoops(step.parallelLoops, stepStartMs, stepIndex);
+    const stepEndMs = Math.max(stepStartMs, actionsEnd, loopsEnd);
+
+    barriers.push(Object.freeze({ stepIndex, stepId: step.id, name: step.name, startMs: stepStartMs, endMs: stepEndMs }));
+    stepStartMs = stepEndMs;
+  });
+
+  // 稳定排序：同一时刻的事件保持任务中的书写顺序
+  const events = builder.events
+    .map((event, order) => ({ event, order }))
+    .sort((a, b) => a.event.offsetMs - b.event.offsetMs || a.event.stepIndex - b.event.stepIndex || a.order - b.order)
+    .map(({ event }) => Object.freeze(event));
+
+  return Object.freeze({
+    taskId: task.id,
+    durationMs: stepStartMs,
+    events: Object.freeze(events),
+    barriers: Object.freeze(barriers),
+    occupancy: buildOccupancy(events, stepStartMs)
+  });
+}
+
+/**
+ * 编译后时间线的规模上限：循环次数（含嵌套循环相乘）展开后的事件数
+ */
+export const MAX_COMPILED_EVENTS = 100000;
+
+/**
+ * 不展开时间线，按任务结构计算展开后的事件数（没有动作的循环每次迭代按1计）；
+ * 超过上限时返回错误信息，否则返回 null
+ */
+export function checkTaskSize(task: Task, limit: number = MAX_COMPILED_EVENTS): string | null {
+  let total = 0;
+  for (const step of task.steps) {
+    total += countActions(step.actions) + countLoops(step.parallelLoops);
+    if (total > limit) {
+      return `Task expands to more than ${limit} timeline events (loop iterations multiply nested actions), reduce loop iterations`;
+    }
+  }
+  return null;
+}
+
+function countActions(actions: (TaskAction | DelayAction)[] = []): number {
+  let count = 0;
+  for (const action of actions) {
+    count += 'type' in action && action.type === 'delay'
+      ? countActions(action.actions) + countLoops(action.parallelLoops)
+      : 1;
+  }
+  return count;
+}
+
+function countLoops(loops: ParallelLoop[] = []): number {
+  let count = 0;
+  for (const loop of loops) {
+    // 与 addLoop 的迭代次数一致：小数向上取整，非正数或 NaN 不执行
+    const iterations = loop.iterations > 0 ? Math.ceil(loop.iterations) : 0;
+    const perIteration = (loop.subSteps ?? []).reduce((sum, subStep) => sum + countActions(subStep.actions), 0);
+    count += iterations * Math.max(1, perIteration);
+  }
+  return count;
+}
+
+/**
+ * 按偏移时刻查找所在步骤（时长为0的步骤不会被返回，除非位于末尾）
+ */
+export function findStepAt(compiled: CompiledTask, offsetMs: number): number {
+  const { barriers } = compiled;
+  for (let i = 0; i < barriers.length; i++) {
+    if (offsetMs < barriers[i].endMs) return i;
+  }
+  return Math.max(0, barriers.length - 1);
+}
+
+class TimelineBuilder {
+  readonly events: TimelineEvent[] = [];
+
+  /**
+   * 展开一组动作，返回其中最晚的结束时刻
+   */
+  addActions(actions: (TaskAction | DelayAction)[], startMs: number, stepIndex: number): number {
+    let endMs = startMs;
+    for (const action of actions) {
+      endMs = Math.max(endMs, this.addAction(action, startMs, stepIndex));
+    }
+    return endMs;
+  }
+
+  addLoops(loops: ParallelLoop[], startMs: number, stepIndex: number): number {
+    let endMs = startMs;
+    for (const loop of loops) {
+      endMs = Math.max(endMs, this.addLoop(loop, startMs, stepIndex));
+    }
+    return endMs;
+  }
+
+  private addAction(action: TaskAction | DelayAction, startMs: number, stepIndex: number): number {
+    if ('type' in action && action.type === 'delay') {
+      const fireMs = startMs + Math.max(0, action.delayMs);
+      return Math.max(
+        fireMs,
+        this.addActions(action.actions, fireMs, stepIndex),
+        this.addLoops(action.parallelLoops, fireMs, stepIndex)
+      );
+    }
+
+    const taskAction = action as TaskAction;
+    const durationMs = Math.max(0, taskAction.duration);
+    this.events.push({
+      offsetMs: startMs,
+      stepIndex,
+      deviceId: taskAction.deviceId,
+      actionType: taskAction.actionType,
+      value: taskAction.value,
+      durationMs,
+      ...(taskAction.profile && { profile: taskAction.profile }),
+      action: taskAction
+    });
+    return startMs + durationMs;
+  }
+
+  private addLoop(loop: ParallelLoop, startMs: number, stepIndex: number): number {
+    let iterationStartMs = startMs;
+    let endMs = startMs;
+
+    for (let iteration = 0; iteration < loop.iterations; iteration++) {
+      if (iteration > 0) {
+        iterationStartMs = endMs + Math.max(0, loop.intervalMs);
+      }
+      endMs = this.addSubSteps(loop.subSteps, iterationStartMs, stepIndex);
+    }
+    return endMs;
+  }
+
+  private addSubSteps(subSteps: SubStep[], startMs: number, stepIndex: number): number {
+    let subStepStartMs = startMs;
+    for (const subStep of subSteps) {
+      subStepStartMs = this.addActions(subStep.actions, subStepStartMs, stepIndex);
+    }
+    return subStepStartMs;
+  }
+}
+
+/**
+ * 每个设备的输出开启区间（相对任务开始，按时间排序）
+ * 新命令覆盖同一设备上仍在进行的命令；时长为0的开启命令保持到下一条命令或任务结束
+ */
+function buildOccupancy(events: TimelineEvent[], taskDurationMs: number): Readonly<Record<string, DeviceOccupancy>> {
+  const occupancy: Record<string, DeviceOccupancy> = {};
+
+  for (const event of events) {
+    const entry = occupancy[event.deviceId] || (occupancy[event.deviceId] = { commandCount: 0, busyMs: 0, intervals: [] });
+    entry.commandCount++;
+
+    const start = event.offsetMs;
+    const last = entry.intervals[entry.intervals.length - 1];
+    if (last && last[1] > start) {
+      last[1] = start;
+      if (last[1] <= last[0]) entry.intervals.pop();
+    }
+    if (!isActiveValue(event.value)) continue;
+
+    const end = event.durationMs > 0 ? start + event.durationMs : Math.max(start, taskDurationMs);
+    const previous = entry.intervals[entry.intervals.length - 1];
+    if (previous && previous[1] === start) {
+      previous[1] = end;
+    } else if (end > start) {
+      entry.intervals.push([start, end]);
+    }
+  }
+
+  for (const entry of Object.values(occupancy)) {
+    entry.busyMs = entry.intervals.reduce((total, [start, end]) => total + (end - start), 0);
+    Object.freeze(entry);
+  }
+  return Object.freeze(occupancy);
+}
+
+function isActiveValue(value: number | boolean): boolean {
+  return typeof value === 'boolean' ? value : value > 0;
+}
+
+export interface TimelineEvent {
+  offsetMs: number;       // 相对任务开始
+  stepIndex: number;
+  deviceId: string;
+  actionType: TaskAction['actionType'];
+  value: number | boolean;
+  durationMs: number;     // 固件在此时长后自动关闭，0为保持
+  profile?: TaskAction['profile'];
+  action: TaskAction;     // 原始动作
+}
+
+export interface StepBarrier {
+  stepIndex: number;
+  stepId: string;
+  name: string;
+  startMs: number;
+  endMs: number;
+}
+
+export interface DeviceOccupancy {
+  commandCount: number;
+  busyMs: number;                    // 输出开启的总时长
+  intervals: [number, number][];     // [开始, 结束) 相对任务开始
+}
+
+export interface CompiledTask {
+  taskId: string;
+  durationMs: number;
+  events: readonly Readonly<TimelineEvent>[];
+  barriers: readonly Readonly<StepBarrier>[];
+  occupancy: Readonly<Record<string, DeviceOccupancy>>;
+}
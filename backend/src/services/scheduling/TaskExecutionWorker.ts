@@ -0,0 +1,153 @@
+import { parentPort, workerData } from 'worker_threads';
+import { Writable } from 'stream';
+import winston from 'winston';
+import { TaskExecutionService } from '../TaskExecutionService';
+import type { ScheduleStatus, TaskAdmission, TaskExecutionLogSink } from '../TaskExecutionService';
+import { FirmwareManifestStore } from '../code-generation/FirmwareManifest';
+import type { FirmwareManifest } from '../code-generation/FirmwareManifest';
+import type { EmergencyStopResult } from '../connection/EmergencyStopChannel';
+import { EventLoopLagMonitor } from './EventLoopLagMonitor';
+import type { EventLoopLagStats } from './EventLoopLagMonitor';
+import { AsyncLogSink } from '../logging/AsyncLogSink';
+import type { AsyncLogSinkStats } from '../logging/AsyncLogSink';
+import type { FirmwareStateSnapshot } from '../../types/device';
+import type { Task } from '../../types/task';
+
+/**
+ * 任务调度工作线程
+ * TaskExecutionService 在独立线程中运行，定时器不受主线程HTTP、socket.io与日志写入影响
+ *
+ * 职责：
+ * - 执行主线程发来的控制消息（开始/停止单个任务/停止全部/急停/状态查询/清单更新）并回复
+ * - 日志、Arduino通信记录与固件状态快照以消息形式交给主线程处理，本线程不做文件I/O
+ *   （日志先进入有界队列，后台成批发给主线程，调度循环只付出入队的开销）
+ */
+if (!parentPort) {
+  throw new Error('TaskExecutionWorker must be started as a worker thread');
+}
+const port = parentPort;
+
+function post(message: TaskWorkerEvent): void {
+  try {
+    port.postMessage(message);
+  } catch {
+    // 元数据无法结构化复制时（如含函数）退回为JSON文本
+    port.postMessage(JSON.parse(JSON.stringify(message)));
+  }
+}
+
+const logSink = new AsyncLogSink<winston.LogEntry>(entries => post({ type: 'log', entries }));
+
+// 记录原样入队，不做格式化与序列化：时间戳、JSON 等格式由主线程的 Winston 在写出时处理
+const passThrough = winston.format(info => info);
+
+const logger = winston.createLogger({
+  level: (workerData as TaskWorkerData)?.logLevel || 'info',
+  format: passThrough(),
+  transports: [
+    new winston.transports.Stream({
+      stream: new Writable({
+        objectMode: true,
+        write(info: winston.LogEntry, _encoding, callback) {
+          logSink.enqueue(info, info.level === 'error' || info.level === 'warn');
+          callback();
+        }
+      })
+    })
+  ]
+});
+
+const logService: TaskExecutionLogSink = {
+  logTaskExecution: (phase, message, meta) => post({ type: 'logService', method: 'logTaskExecution', args: [phase, message, meta] }),
+  logArduino: (direction, message, payload) => post({ type: 'logService', method: 'logArduino', args: [direction, message, payload] })
+};
+
+const deviceStateSink = {
+  applyFirmwareSnapshot: (snapshot: FirmwareStateSnapshot, deviceOrder: string[]) => {
+    post({ type: 'snapshot', snapshot, deviceOrder });
+    return true;
+  }
+};
+
+const firmwareManifest = new FirmwareManifestStore(logger);
+firmwareManifest.replace((workerData as TaskWorkerData)?.manifest ?? null);
+
+const service = new TaskExecutionService(logger, logService, firmwareManifest, deviceStateSink);
+const lagMonitor = new EventLoopLagMonitor(logger, 'scheduler');
+lagMonitor.start();
+
+// 预先加载 fetch 实现，避免第一批命令发送时的同步初始化推迟后续事件
+fetch('data:,').catch(() => {});
+
+port.on('message', async (request: TaskWorkerRequest) => {
+  try {
+    switch (request.type) {
+      case 'execute': {
+        const admission = await service.executeTask(request.task, request.estimatedDuration, request.priority);
+        reply(request.id, { ...snapshotStatus(), admission });
+        break;
+      }
+      case 'stopTask': {
+        const stopped = service.stopTask(request.executionId);
+        reply(request.id, { ...snapshotStatus(), stopped });
+        break;
+      }
+      case 'stop':
+        service.stopExecution();
+        reply(request.id, snapshotStatus());
+        break;
+      case 'estop':
+        post({ type: 'accepted', id: request.id });
+        reply(request.id, await service.emergencyStop());
+        break;
+      case 'status':
+        reply(request.id, snapshotStatus());
+        break;
+      case 'manifest':
+        firmwareManifest.replace(request.manifest);
+        break;
+    }
+  } catch (error) {
+    if ('id' in request) {
+      post({ type: 'reply', id: request.id, error: error instanceof Error ? error.message : String(error) });
+    }
+  }
+});
+
+function reply(id: number, result: WorkerStatusReply | EmergencyStopResult): void {
+  post({ type: 'reply', id, result });
+}
+
+function snapshotStatus(): WorkerStatusReply {
+  return { status: service.getScheduleStatus(), eventLoopLag: lagMonitor.getStats(), logSink: logSink.getStats() };
+}
+
+// ==================== 消息类型 ====================
+
+export interface TaskWorkerData {
+  manifest: FirmwareManifest | null;
+  logLevel: string;
+}
+
+export type TaskWorkerRequest =
+  | { type: 'execute'; id: number; task: Task; estimatedDuration?: number; priority?: number }
+  | { type: 'stopTask'; id: number; executionId: string }
+  | { type: 'stop'; id: number }
+  | { type: 'estop'; id: number }
+  | { type: 'status'; id: number }
+  | { type: 'manifest'; manifest: FirmwareManifest };
+
+export type TaskWorkerEvent =
+  | { type: 'accepted'; id: number }
+  | { type: 'reply'; id: number; result?: WorkerStatusReply | EmergencyStopResult; error?: string }
+  | { type: 'log'; entries: winston.LogEntry[] }
+  | { type: 'logService'; method: keyof TaskExecutionLogSink; args: any[] }
+  | { type: 'snapshot'; snapshot: FirmwareStateSnapshot; deviceOrder: string[] };
+
+export interface WorkerStatusReply {
+  status: ScheduleStatus;
+  eventLoopLag: EventLoopLagStats;
+  logSink: AsyncLogSinkStats;   // 本线程的日志队列
+  admission?: TaskAdmission;   // execute 的准入结果
+  stopped?: boolean;           // stopTask 是否找到该任务
+}
@@ -3,16 +3,73 @@
 export interface DeviceConfig {
   id: string;
   name: string;
-  type: 'pwm' | 'digital';
+  type: 'pwm' | 'digital' | 'sensor';
   pin: number;
   icon?: string;
   pwmFrequency?: number;
   maxPower?: number;
+  sensor?: SensorChannelConfig; // 仅 sensor 类型：ADC采样配置
   description?: string;
+  groupId?: string; // 所属分组ID（生成固件时用于分组位掩码）
+  boardId?: string; // 所属控制板ID（多控制板部署），缺省为主控制板 "main"
   createdAt?: string;
   updatedAt?: string;
 }
 
+/**
+ * 控制板配置（config/devices.json 的 boards，可选）
+ * 第一个控制板为主控制板，创建WiFi热点；其他控制板以 host 为固定IP加入该热点
+ * 设备引用了未配置的控制板时，生成器按顺序自动分配地址
+ */
+export interface BoardConfig {
+  id: string;
+  name?: string;
+  host?: string;    // IPv4地址，如 192.168.4.10
+}
+
+/**
+ * 传感器通道配置（ADC引脚，UNO R4 为 A0-A5 即 14-19）
+ * 固件按 sampleRateHz 定时采样，每 windowSamples 个样本汇总为一个 min/max/mean 窗口
+ */
+export interface SensorChannelConfig {
+  sampleRateHz: number;
+  windowSamples: number;
+  scale?: number;   // 物理量 = 原始ADC值 * scale + offset
+  offset?: number;
+  unit?: string;    // 如 kPa
+}
+
+/**
+ * 传感器窗口数据（已换算为物理量）
+ */
+export interface SensorWindow {
+  sensorId: string;
+  timestamp: number;  // 窗口起始时间（后端时钟，ms）
+  windowMs: number;
+  min: number;
+  max: number;
+  mean: number;
+}
+
+/**
+ * 闭环控制回路：传感器通道 -> PWM设备，固件中以定点PID按固定频率运行
+ * 增益以物理量为单位：kp 输出%/单位，ki 输出%/(单位·s)，kd 输出%·s/单位
+ */
+export interface ControlLoopConfig {
+  id: string;
+  name: string;
+  sensorId: string;
+  outputId: string;
+  rateHz: number;      // 必须整除采样定时器频率，且不高于传感器采样率
+  setpoint: number;    // 传感器物理量
+  kp: number;
+  ki: number;
+  kd: number;
+  outputMin?: number;  // 输出下限 %，默认0
+  outputMax?: number;  // 输出上限 %，默认100（仍受设备 maxPower 限制）
+  enabled?: boolean;   // 上电后是否立即闭环
+}
+
 export interface DeviceCommand {
   deviceId: string;
   action: 'set_power' | 'set_state' | 'timed_action';
@@ -29,6 +86,22 @@ export interface DeviceState {
   lastUpdate: number;
   isLocked: boolean; // 设备是否被锁定（防止冲突）
   lockExpiry?: number; // 锁定过期时间
+  remainingMs?: number; // 固件上报的定时关闭剩余时间
+}
+
+/**
+ * 固件随命令确认返回的状态快照
+ */
+export interface FirmwareStateSnapshot {
+  boardId?: string;  // 来源控制板，缺省为主控制板
+  version: number;   // 固件状态版本，单调递增（重启后归零）
+  uptimeMs: number;  // 固件运行时间，用于识别重启
+  dutyMax: number;   // PWM占空比计数上限
+  devices: Array<{
+    value: number;        // PWM: 占空比计数, 数字: 0/1
+    isActive: boolean;
+    remainingMs: number;
+  }>;                     // 按固件设备表顺序
 }
 
 export interface ConnectionConfig {
@@ -25,6 +25,19 @@ export interface TaskAction {
   value: number | boolean;
   duration: number;
   name: string;
+  profile?: PwmProfile; // 仅PWM动作：由固件本地生成的波形，替代逐点下发
+}
+
+/**
+ * PWM波形配置
+ * 固件以高频率在本地计算占空比：offset + amplitude * f(相位)
+ */
+export interface PwmProfile {
+  shape: 'ramp' | 'ease' | 'square' | 'sine';
+  periodMs: number;   // 单周期时长（斜坡为爬升时长）
+  amplitude: number;  // 幅值 0-100 (%)
+  offset: number;     // 基准值 0-100 (%)
+  cycles: number;     // 周期数，0表示持续到动作结束或被覆盖
 }
 
 export interface DelayAction {
@@ -0,0 +1,13 @@
+#ifndef MANTA_CONFIG_H
+#define MANTA_CONFIG_H
+
+/**
+ * 设备表所需的类型，生成的草图先包含本文件、定义 manta::config 设备表，再包含 MantaControl.h
+ */
+
+#include <Arduino.h>
+#include <pwm.h>
+
+#include "manta/Config.h"
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef MANTA_CONTROL_H
+#define MANTA_CONTROL_H
+
+/**
+ * MantaControl 固件库（Arduino UNO R4 WiFi）
+ *
+ * 草图只描述本次配置：设备数量等宏与 manta::config 中的设备表，然后包含本文件，
+ * 在 setup()/loop() 中调用 manta::setup()/manta::loop()。
+ * manta/ 下的头文件不依赖Arduino，可在主机上单元测试；manta/arduino/ 为硬件绑定。
+ *
+ * 草图需要在包含本文件前定义：
+ *   MANTA_SKETCH_FORMAT         生成器使用的设备表格式，须与 MANTA_CONFIG_FORMAT 一致
+ *   MANTA_DEVICE_COUNT          输出设备数（1-32）
+ *   MANTA_GROUP_COUNT           分组数
+ *   MANTA_SENSOR_COUNT          传感器数
+ *   MANTA_SENSOR_TIMER_HZ       采样定时器频率（有传感器时）
+ *   MANTA_CONTROL_LOOP_COUNT    控制回路数
+ *   MANTA_MANIFEST_HASH         设备表/分组/回路顺序的哈希，在 /api/status、命令确认与串口心跳中上报，
+ *                               后端与其清单一致时才使用位掩码与索引寻址（未定义时为0，后端只按设备ID寻址）
+ * 以及 manta::config 中的 WIFI_SSID、WIFI_PASS、DEVICES、PWM_OUTPUTS、GROUPS、SENSORS、CONTROL_LOOPS
+ *
+ * 多控制板部署时可选定义：
+ *   MANTA_BOARD_ID              控制板ID（默认 "main"），通过 /api/status 上报
+ *   MANTA_WIFI_STATION          为1时以 manta::config::STATION_IP 加入主控制板的热点，而不是创建热点
+ */
+
+#include "MantaConfig.h"
+
+#if !defined(MANTA_DEVICE_COUNT) || !defined(MANTA_GROUP_COUNT) || !defined(MANTA_SENSOR_COUNT) || !defined(MANTA_CONTROL_LOOP_COUNT)
+#error "请先定义设备表（由代码生成器生成），再包含 MantaControl.h"
+#endif
+
+#if !defined(MANTA_SKETCH_FORMAT) || MANTA_SKETCH_FORMAT != MANTA_CONFIG_FORMAT
+#error "草图与 MantaControl 库版本不一致，请重新生成代码或更新库"
+#endif
+
+#if MANTA_SENSOR_COUNT > 0 && !defined(MANTA_SENSOR_TIMER_HZ)
+#error "有传感器时须定义 MANTA_SENSOR_TIMER_HZ"
+#endif
+
+#if MANTA_CONTROL_LOOP_COUNT > 0 && MANTA_SENSOR_COUNT == 0
+#error "控制回路需要至少一个传感器"
+#endif
+
+#ifndef MANTA_BOARD_ID
+#define MANTA_BOARD_ID "main"
+#endif
+
+#ifndef MANTA_MANIFEST_HASH
+#define MANTA_MANIFEST_HASH 0UL
+#endif
+
+#ifndef MANTA_WIFI_STATION
+#define MANTA_WIFI_STATION 0
+#endif
+
+static_assert(MANTA_DEVICE_COUNT >= 1 && MANTA_DEVICE_COUNT <= 32, "设备数量必须在1-32之间（分组掩码为32位）");
+
+#include <WiFiS3.h>
+#include <ArduinoJson.h>
+#if MANTA_SENSOR_COUNT > 0
+#include <FspTimer.h>
+#endif
+
+#include "manta/Commands.h"
+#include "manta/ControlLoop.h"
+#include "manta/DeviceBank.h"
+#include "manta/FormatArena.h"
+#include "manta/FrameCodec.h"
+#include "manta/HttpRequest.h"
+#include "manta/Logger.h"
+#include "manta/SensorChannel.h"
+#include "manta/Waveform.h"
+
+#include "manta/arduino/Hardware.h"
+#include "manta/arduino/Runtime.h"
+#include "manta/arduino/Devices.h"
+#include "manta/arduino/ControlLoops.h"
+#include "manta/arduino/Sensors.h"
+#include "manta/arduino/SerialLink.h"
+#include "manta/arduino/HttpApi.h"
+#include "manta/arduino/Firmware.h"
+
+#endif
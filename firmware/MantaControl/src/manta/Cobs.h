@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace manta {
+
+/**
+ * COBS解码（输入不含结尾0x00），返回解码长度，格式错误返回-1
+ * out 至少需要 length 字节
+ */
+inline int cobsDecode(const uint8_t* in, size_t length, uint8_t* out) {
+  size_t read = 0;
+  size_t written = 0;
+  while (read < length) {
+    uint8_t code = in[read++];
+    if (code == 0 || read + code - 1 > length) return -1;
+    for (int i = 1; i < code; i++) {
+      out[written++] = in[read++];
+    }
+    if (code < 0xFF && read < length) {
+      out[written++] = 0;
+    }
+  }
+  return (int)written;
+}
+
+/**
+ * COBS编码（输出不含结尾0x00），返回编码长度
+ * out 至少需要 length + length / 254 + 1 字节
+ */
+inline size_t cobsEncode(const uint8_t* in, size_t length, uint8_t* out) {
+  size_t codeIndex = 0;
+  size_t written = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < length; i++) {
+    if (in[i] == 0) {
+      out[codeIndex] = code;
+      codeIndex = written++;
+      code = 1;
+    } else {
+      out[written++] = in[i];
+      if (++code == 0xFF) {
+        out[codeIndex] = code;
+        codeIndex = written++;
+        code = 1;
+      }
+    }
+  }
+  out[codeIndex] = code;
+  return written;
+}
+
+}  // namespace manta
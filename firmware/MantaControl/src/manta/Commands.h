@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Config.h"
+
+namespace manta {
+
+/**
+ * 命令动作
+ * 后端压缩格式 setPwr/setSt 与旧格式 power/set_power、state/set_state 等价
+ */
+enum CommandAction : uint8_t {
+  ACTION_UNKNOWN = 0,
+  ACTION_POWER,
+  ACTION_STATE,
+  ACTION_LOOP     // 闭环参数 {act: "loop", lp, en, sp, kp, ki, kd, lo, hi}
+};
+
+inline CommandAction parseAction(const char* action) {
+  if (!action) return ACTION_UNKNOWN;
+  if (strcmp(action, "setPwr") == 0 || strcmp(action, "power") == 0 || strcmp(action, "set_power") == 0) {
+    return ACTION_POWER;
+  }
+  if (strcmp(action, "setSt") == 0 || strcmp(action, "state") == 0 || strcmp(action, "set_state") == 0) {
+    return ACTION_STATE;
+  }
+  if (strcmp(action, "loop") == 0) return ACTION_LOOP;
+  return ACTION_UNKNOWN;
+}
+
+/**
+ * 根据分组ID查找位掩码，未知分组返回false
+ */
+inline bool findGroupMask(const GroupDescriptor* groups, size_t count, const char* groupId, uint32_t& mask) {
+  if (!groupId) return false;
+  for (size_t g = 0; g < count; g++) {
+    if (strcmp(groups[g].name, groupId) == 0) {
+      mask = groups[g].mask;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * HTTP批处理命令的顺序门
+ * 后端每个会话从1开始递增序号 sq；同一会话中不大于已执行序号的批次已过时，丢弃
+ * 会话 ss 改变（后端重启）时重新开始
+ *
+ * 急停后锁定：急停时仍在网络中或套接字积压中的批次属于当前会话，一律拒绝；
+ * 后端急停后以新会话重新开始发送，新会话的第一批解除锁定
+ */
+class CommandSequenceGate {
+ public:
+  bool accept(uint32_t session, uint32_t sequence) {
+    if (session != session_ || !started_) {
+      session_ = session;
+      last_ = sequence;
+      started_ = true;
+      fenced_ = false;
+      return true;
+    }
+    if (fenced_) {
+      fencedCount_++;
+      return false;
+    }
+    // 按差值比较，序号回绕后仍然有效
+    if ((int32_t)(sequence - last_) <= 0) {
+      staleCount_++;
+      return false;
+    }
+    last_ = sequence;
+    return true;
+  }
+
+  /**
+   * 急停时调用：锁定当前会话，直到收到新会话的批次
+   */
+  void fence() { fenced_ = true; }
+
+  bool fenced() const { return fenced_; }
+  uint32_t lastSequence() const { return last_; }
+  uint32_t staleCount() const { return staleCount_; }
+  uint32_t fencedCount() const { return fencedCount_; }
+
+ private:
+  uint32_t session_ = 0;
+  uint32_t last_ = 0;
+  uint32_t staleCount_ = 0;
+  uint32_t fencedCount_ = 0;
+  bool started_ = false;
+  bool fenced_ = false;
+};
+
+/**
+ * 定时执行的批次
+ * 多控制板部署时后端为批次给出本板时钟上的执行时刻 at，各板在同一时刻执行；
+ * 提前到达的批次等待 holdMs，已过时刻的批次立即执行并上报迟到量；
+ * 超过 maxHoldMs 的执行时刻视为时钟估计失效，立即执行
+ */
+struct BatchTiming {
+  uint32_t holdMs;
+  uint32_t lateMs;
+  bool outOfRange;
+};
+
+inline BatchTiming scheduleBatch(uint32_t at, uint32_t nowMs, uint32_t maxHoldMs) {
+  int32_t ahead = (int32_t)(at - nowMs);  // 按差值比较，millis() 回绕后仍然有效
+  if (ahead <= 0) return {0, (uint32_t)(-(int64_t)ahead), false};
+  if ((uint32_t)ahead > maxHoldMs) return {0, 0, true};
+  return {(uint32_t)ahead, 0, false};
+}
+
+}  // namespace manta
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace manta {
+
+/**
+ * 设备表类型
+ * 生成的草图用这些类型描述本次配置的设备、分组、传感器与控制回路，然后包含 MantaControl.h
+ */
+
+// 生成器与库之间的设备表格式版本，不一致时编译报错
+#define MANTA_CONFIG_FORMAT 1
+
+const int PWM_DUTY_BITS = 12;        // 占空比分辨率（analogWrite默认仅8位）
+const uint16_t PWM_DUTY_MAX = 4095;
+
+enum DeviceType : uint8_t {
+  DEVICE_DIGITAL = 0,
+  DEVICE_PWM = 1
+};
+
+struct DeviceDescriptor {
+  const char* name;      // 设备ID，与后端一致
+  uint8_t pin;
+  DeviceType type;
+  float pwmFrequency;    // 硬件PWM频率，数字设备为0
+  uint16_t maxDuty;      // maxPower 对应的占空比上限，数字设备为0
+};
+
+// 第i位对应设备表中的第i个设备
+struct GroupDescriptor {
+  const char* name;
+  uint32_t mask;
+};
+
+struct SensorDescriptor {
+  const char* name;
+  uint8_t pin;
+  uint16_t divider;        // 相对采样定时器的分频
+  uint16_t windowSamples;  // 每个 min/max/mean 窗口的样本数
+};
+
+// 增益为Q16.16定点数，设定值为ADC原始计数，上下限为占空比计数
+struct ControlLoopDescriptor {
+  const char* name;
+  uint8_t sensor;          // 传感器表索引
+  uint8_t output;          // 设备表索引
+  uint16_t divider;        // 相对采样定时器的分频
+  bool enabled;            // 上电默认状态
+  int32_t setpoint;
+  int32_t kp;
+  int32_t ki;
+  int32_t kd;
+  int32_t outMin;
+  int32_t outMax;
+};
+
+}  // namespace manta
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Config.h"
+#include "FrameCodec.h"
+
+namespace manta {
+
+/**
+ * 定点PID
+ * 误差为ADC原始计数，输出为占空比计数，增益为Q16.16定点数（ki已除以频率，kd已乘以频率）
+ */
+
+const int PID_FRACTION_BITS = 16;
+const int32_t SENSOR_ADC_MAX = 16383;   // 14位ADC
+const int FRAME_LOOP_SIZE = 22;         // [回路索引][标志][设定值][kp][ki][kd][下限][上限]
+
+enum ControlLoopFlags : uint8_t {
+  LOOP_SET_SETPOINT = 0x01,
+  LOOP_SET_GAINS = 0x02,
+  LOOP_SET_LIMITS = 0x04,
+  LOOP_ENABLE = 0x08,
+  LOOP_DISABLE = 0x10
+};
+
+struct ControlLoop {
+  volatile bool enabled;
+  int32_t setpoint;        // ADC原始计数
+  int32_t kp;
+  int32_t ki;
+  int32_t kd;
+  int32_t outMin;          // 占空比计数
+  int32_t outMax;
+  int64_t integral;        // Q16.16 占空比计数
+  int32_t lastMeasurement;
+  uint16_t tick;
+  volatile uint16_t output;
+};
+
+struct ControlLoopUpdate {
+  uint8_t flags;
+  int32_t setpoint;
+  int32_t kp;
+  int32_t ki;
+  int32_t kd;
+  int32_t outMin;
+  int32_t outMax;
+};
+
+inline int32_t clampInt32(int32_t value, int32_t low, int32_t high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+inline void initControlLoop(ControlLoop& loop, const ControlLoopDescriptor& descriptor) {
+  loop.enabled = descriptor.enabled;
+  loop.setpoint = descriptor.setpoint;
+  loop.kp = descriptor.kp;
+  loop.ki = descriptor.ki;
+  loop.kd = descriptor.kd;
+  loop.outMin = descriptor.outMin;
+  loop.outMax = descriptor.outMax;
+  loop.integral = 0;
+  loop.lastMeasurement = 0;
+  loop.tick = 0;
+  loop.output = 0;
+}
+
+/**
+ * 执行一次PID，输出变化时返回true（新输出在 loop.output）
+ * 微分作用于测量值，设定值突变不产生冲击；积分项限幅在输出范围内，防止饱和时积分累积
+ */
+inline bool stepControlLoop(ControlLoop& loop, int32_t measurement) {
+  if (!loop.enabled) {
+    loop.lastMeasurement = measurement;
+    return false;
+  }
+
+  int32_t error = loop.setpoint - measurement;
+  int64_t outMinQ = (int64_t)loop.outMin << PID_FRACTION_BITS;
+  int64_t outMaxQ = (int64_t)loop.outMax << PID_FRACTION_BITS;
+
+  loop.integral += (int64_t)loop.ki * error;
+  if (loop.integral > outMaxQ) loop.integral = outMaxQ;
+  else if (loop.integral < outMinQ) loop.integral = outMinQ;
+
+  int64_t u = (int64_t)loop.kp * error + loop.integral - (int64_t)loop.kd * (measurement - loop.lastMeasurement);
+  loop.lastMeasurement = measurement;
+
+  if (u > outMaxQ) u = outMaxQ;
+  else if (u < outMinQ) u = outMinQ;
+
+  uint16_t duty = (uint16_t)(u >> PID_FRACTION_BITS);
+  if (duty == loop.output) return false;
+  loop.output = duty;
+  return true;
+}
+
+/**
+ * 写入设定值、增益与上下限（调用方负责屏蔽中断与启停切换）
+ */
+inline void applyControlLoopParams(ControlLoop& loop, const ControlLoopUpdate& update, int32_t maxDuty) {
+  if (update.flags & LOOP_SET_SETPOINT) {
+    loop.setpoint = clampInt32(update.setpoint, 0, SENSOR_ADC_MAX);
+  }
+  if (update.flags & LOOP_SET_GAINS) {
+    loop.kp = update.kp;
+    loop.ki = update.ki;
+    loop.kd = update.kd;
+  }
+  if (update.flags & LOOP_SET_LIMITS) {
+    loop.outMax = clampInt32(update.outMax, 0, maxDuty);
+    loop.outMin = clampInt32(update.outMin, 0, loop.outMax);
+  }
+}
+
+/**
+ * 启用回路：从当前输出无扰切换
+ */
+inline void enableControlLoop(ControlLoop& loop, uint16_t currentOutput, int32_t measurement) {
+  loop.integral = (int64_t)currentOutput << PID_FRACTION_BITS;
+  loop.lastMeasurement = measurement;
+  loop.output = currentOutput;
+  loop.enabled = true;
+}
+
+/**
+ * 解析 FRAME_LOOP 数据：[回路索引][标志][设定值i32][kp i32][ki i32][kd i32][下限u16][上限u16]
+ */
+inline uint8_t decodeControlLoopFrame(const uint8_t* data, ControlLoopUpdate& update) {
+  update.flags = data[1];
+  update.setpoint = readInt32LE(data + 2);
+  update.kp = readInt32LE(data + 6);
+  update.ki = readInt32LE(data + 10);
+  update.kd = readInt32LE(data + 14);
+  update.outMin = readUint16LE(data + 18);
+  update.outMax = readUint16LE(data + 20);
+  return data[0];
+}
+
+}  // namespace manta
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace manta {
+
+/**
+ * 定时关闭队列：每个设备最多一个到期时间
+ * 时间为32位毫秒计数，按差值比较，millis() 回绕（约49.7天）后仍然正确；
+ * 用位掩码记录已设定的条目，没有定时任务时 popExpired 不遍历设备
+ */
+template <size_t N>
+class DeadlineTable {
+  static_assert(N > 0 && N <= 32, "DeadlineTable 最多支持32个条目");
+
+  private:
+    uint32_t deadlines[N];
+    uint32_t armedMask = 0;
+
+  public:
+    /**
+     * 设定 duration 毫秒后到期（duration 为0时取消）
+     */
+    void arm(size_t index, uint32_t nowMs, uint32_t durationMs) {
+      if (durationMs == 0) {
+        cancel(index);
+        return;
+      }
+      deadlines[index] = nowMs + durationMs;
+      armedMask |= (1UL << index);
+    }
+
+    void cancel(size_t index) {
+      armedMask &= ~(1UL << index);
+    }
+
+    void clear() {
+      armedMask = 0;
+    }
+
+    bool armed(size_t index) const {
+      return (armedMask & (1UL << index)) != 0;
+    }
+
+    bool empty() const {
+      return armedMask == 0;
+    }
+
+    /**
+     * 到期前的剩余时间（ms），未设定或已到期返回0
+     */
+    uint32_t remaining(size_t index, uint32_t nowMs) const {
+      if (!armed(index)) return 0;
+      int32_t left = (int32_t)(deadlines[index] - nowMs);
+      return left > 0 ? (uint32_t)left : 0;
+    }
+
+    /**
+     * 取出一个已到期的条目并取消它，没有到期条目返回-1
+     */
+    int popExpired(uint32_t nowMs) {
+      uint32_t pending = armedMask;
+      while (pending) {
+        int index = __builtin_ctz(pending);
+        pending &= pending - 1;
+        if ((int32_t)(nowMs - deadlines[index]) >= 0) {
+          cancel(index);
+          return index;
+        }
+      }
+      return -1;
+    }
+};
+
+}  // namespace manta
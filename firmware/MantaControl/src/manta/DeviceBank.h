@@ -0,0 +1,294 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Config.h"
+#include "DeadlineTable.h"
+#include "FrameCodec.h"
+#include "Waveform.h"
+
+namespace manta {
+
+struct DeviceState {
+  uint16_t currentValue;   // 当前值（PWM: 占空比计数 0-PWM_DUTY_MAX, 数字: 0/1）
+  bool isActive;           // 是否激活
+};
+
+// 设备运行计数（磨损/能耗统计），在 record 中随每次输出变化累加
+struct DeviceCounters {
+  uint32_t onTimeMs;       // 累计开启时间
+  uint64_t dutyTimeAccum;  // 占空比加权开启时间 x PWM_DUTY_MAX
+  uint32_t switchCount;    // 开/关切换次数
+  uint32_t lastChangeMs;   // 最近一次输出变化时间
+  uint32_t lastAccountMs;  // 上次结算时间
+};
+
+// 查询时补算到当前时刻的运行计数
+struct DeviceMetrics {
+  uint32_t onTimeMs;
+  uint32_t dutyTimeMs;     // 折算为满占空比的开启时间
+  uint32_t switchCount;
+  uint32_t lastChangeMs;
+};
+
+/**
+ * 输出设备组：设备状态、定时关闭、本地波形与运行计数
+ * Driver 负责实际输出：begin(i) 上电置为关闭，writeDuty(i, duty)，writeDigital(i, on)
+ */
+template <size_t N, typename Driver>
+class DeviceBank {
+  private:
+    struct WaveformState {
+      bool active;
+      WaveformParams params;
+      uint32_t startMs;
+    };
+
+    const DeviceDescriptor* table;
+    Driver& driver;
+    DeviceState states[N];
+    DeviceCounters counters[N];
+    WaveformState waveforms[N];
+    DeadlineTable<N> deadlines;
+    uint32_t stateVersion = 0;   // 命令、定时关闭、急停时递增（波形的中间占空比不计）
+
+    void writeOff(size_t i) {
+      if (isPwm(i)) {
+        driver.writeDuty(i, 0);
+      } else {
+        driver.writeDigital(i, false);
+      }
+    }
+
+    void finishCommand(size_t i, int value, int32_t durationMs, uint32_t nowMs) {
+      states[i].isActive = (value > 0);
+      if (durationMs > 0 && value > 0) {
+        deadlines.arm(i, nowMs, (uint32_t)durationMs);
+      } else {
+        deadlines.cancel(i);
+      }
+      stateVersion++;
+    }
+
+  public:
+    DeviceBank(const DeviceDescriptor* table, Driver& driver) : table(table), driver(driver) {}
+
+    /**
+     * 上电初始化：所有输出关闭，计数清零
+     */
+    void begin() {
+      for (size_t i = 0; i < N; i++) {
+        driver.begin(i);
+        states[i].currentValue = 0;
+        states[i].isActive = false;
+        counters[i] = DeviceCounters();
+        waveforms[i].active = false;
+      }
+      deadlines.clear();
+    }
+
+    size_t count() const { return N; }
+    bool isPwm(size_t i) const { return table[i].type == DEVICE_PWM; }
+    const char* name(size_t i) const { return table[i].name; }
+    const DeviceState& state(size_t i) const { return states[i]; }
+    bool waveformActive(size_t i) const { return waveforms[i].active; }
+    uint32_t version() const { return stateVersion; }
+    void touch() { stateVersion++; }
+
+    /**
+     * 按设备名查找索引，未知设备返回-1
+     */
+    int find(const char* deviceId) const {
+      for (size_t i = 0; i < N; i++) {
+        if (strcmp(table[i].name, deviceId) == 0) return (int)i;
+      }
+      return -1;
+    }
+
+    /**
+     * 千分比占空比 -> 占空比计数，并按编译期的 maxPower 上限限幅
+     */
+    uint16_t dutyFromPermille(size_t i, uint32_t permille) const {
+      uint32_t duty = permille * PWM_DUTY_MAX / 1000UL;
+      return duty > table[i].maxDuty ? table[i].maxDuty : (uint16_t)duty;
+    }
+
+    /**
+     * PWM功率命令（value 0-100%）；waveform 非空时启动本地波形，数字设备返回false
+     */
+    bool setPower(size_t i, int value, int32_t durationMs, const WaveformParams* waveform, uint32_t nowMs) {
+      // 新命令总是覆盖正在运行的波形
+      waveforms[i].active = false;
+      if (!isPwm(i)) return false;
+
+      uint16_t duty;
+      if (waveform) {
+        waveforms[i].params = *waveform;
+        waveforms[i].startMs = nowMs;
+        waveforms[i].active = true;
+        // 以波形峰值作为激活判断与定时关闭的依据
+        value = waveform->offset + waveform->amplitude;
+        duty = dutyFromPermille(i, evaluateWaveform(*waveform, 0));
+      } else {
+        int percent = value < 0 ? 0 : (value > 100 ? 100 : value);
+        duty = dutyFromPermille(i, percent * 10);
+      }
+
+      driver.writeDuty(i, duty);
+      record(i, duty, nowMs);
+      finishCommand(i, value, durationMs, nowMs);
+      return true;
+    }
+
+    /**
+     * 开关命令，value > 0 为开启
+     */
+    bool setState(size_t i, int value, int32_t durationMs, uint32_t nowMs) {
+      waveforms[i].active = false;
+      bool on = value > 0;
+      driver.writeDigital(i, on);
+      record(i, on ? 1 : 0, nowMs);
+      finishCommand(i, value, durationMs, nowMs);
+      return true;
+    }
+
+    /**
+     * 闭环接管输出：取消波形与定时关闭，输出由回路写入
+     */
+    void hold(size_t i) {
+      waveforms[i].active = false;
+      deadlines.cancel(i);
+      states[i].isActive = true;
+    }
+
+    /**
+     * 关闭单个输出并取消其波形与定时关闭（不改变状态版本）
+     */
+    void turnOff(size_t i, uint32_t nowMs) {
+      writeOff(i);
+      record(i, 0, nowMs);
+      states[i].isActive = false;
+      waveforms[i].active = false;
+      deadlines.cancel(i);
+    }
+
+    /**
+     * 急停：关闭所有输出
+     */
+    void stopAll(uint32_t nowMs) {
+      for (size_t i = 0; i < N; i++) {
+        turnOff(i, nowMs);
+      }
+      stateVersion++;
+    }
+
+    /**
+     * 关闭一个定时到期的设备，返回其索引；没有到期设备返回-1
+     */
+    int expire(uint32_t nowMs) {
+      int i = deadlines.popExpired(nowMs);
+      if (i >= 0) {
+        turnOff(i, nowMs);
+        stateVersion++;
+      }
+      return i;
+    }
+
+    /**
+     * 更新所有运行中的波形，只在占空比变化时写输出
+     */
+    void updateWaveforms(uint32_t nowMs) {
+      for (size_t i = 0; i < N; i++) {
+        if (!waveforms[i].active) continue;
+
+        const WaveformParams& wave = waveforms[i].params;
+        uint32_t elapsed = nowMs - waveforms[i].startMs;
+        uint32_t finalPermille;
+        uint16_t duty;
+
+        if (waveformFinished(wave, elapsed, finalPermille)) {
+          duty = dutyFromPermille(i, finalPermille);
+          waveforms[i].active = false;
+          states[i].isActive = (finalPermille > 0);
+          stateVersion++;
+        } else {
+          duty = dutyFromPermille(i, evaluateWaveform(wave, elapsed));
+        }
+
+        if (duty != states[i].currentValue) {
+          driver.writeDuty(i, duty);
+          record(i, duty, nowMs);
+        }
+      }
+    }
+
+    /**
+     * 记录设备输出值：先按旧值结算运行计数，再写入新值
+     * 所有改变 currentValue 的路径都经过这里（含1kHz波形更新），只做整数加法
+     */
+    void record(size_t i, uint16_t value, uint32_t nowMs) {
+      DeviceCounters& c = counters[i];
+      uint16_t previous = states[i].currentValue;
+      uint32_t elapsed = nowMs - c.lastAccountMs;
+
+      if (previous > 0) {
+        c.onTimeMs += elapsed;
+        c.dutyTimeAccum += (uint64_t)elapsed * (isPwm(i) ? previous : PWM_DUTY_MAX);
+      }
+      if ((previous > 0) != (value > 0)) {
+        c.switchCount++;
+      }
+      if (previous != value) {
+        c.lastChangeMs = nowMs;
+      }
+      c.lastAccountMs = nowMs;
+      states[i].currentValue = value;
+    }
+
+    /**
+     * 运行计数；当前仍开启的设备补算到此刻（不修改计数）
+     */
+    DeviceMetrics metrics(size_t i, uint32_t nowMs) const {
+      const DeviceCounters& c = counters[i];
+      uint16_t value = states[i].currentValue;
+      uint32_t pending = value > 0 ? nowMs - c.lastAccountMs : 0;
+      uint64_t dutyAccum = c.dutyTimeAccum + (uint64_t)pending * (isPwm(i) ? value : PWM_DUTY_MAX);
+
+      DeviceMetrics m;
+      m.onTimeMs = c.onTimeMs + pending;
+      m.dutyTimeMs = (uint32_t)(dutyAccum / PWM_DUTY_MAX);
+      m.switchCount = c.switchCount;
+      m.lastChangeMs = c.lastChangeMs;
+      return m;
+    }
+
+    /**
+     * 定时关闭前的剩余时间（ms），无定时返回0
+     */
+    uint32_t remaining(size_t i, uint32_t nowMs) const {
+      return deadlines.remaining(i, nowMs);
+    }
+
+    /**
+     * 打包二进制状态快照，返回字节数（out 至少 11 + 7 * N 字节）
+     * [版本u32][运行ms u32][占空比上限u16][设备数] + 设备数 x [当前值u16][标志 bit0=激活 bit1=波形][剩余ms u32]
+     */
+    size_t packSnapshot(uint8_t* out, uint32_t nowMs) const {
+      size_t n = 0;
+      n += writeUint32LE(out + n, stateVersion);
+      n += writeUint32LE(out + n, nowMs);
+      n += writeUint16LE(out + n, PWM_DUTY_MAX);
+      out[n++] = (uint8_t)N;
+
+      for (size_t i = 0; i < N; i++) {
+        n += writeUint16LE(out + n, states[i].currentValue);
+        out[n++] = (states[i].isActive ? 1 : 0) | (waveforms[i].active ? 2 : 0);
+        n += writeUint32LE(out + n, remaining(i, nowMs));
+      }
+      return n;
+    }
+};
+
+}  // namespace manta
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+
+namespace manta {
+
+/**
+ * 格式化缓冲区
+ * 固件稳态不做堆分配（不使用String）：HTTP请求体与所有格式化文本都从这块静态缓冲区分配，
+ * 每次主循环与每个HTTP请求开始时整体复位
+ */
+template <size_t Size>
+class FormatArena {
+  private:
+    char buffer[Size];
+    size_t used = 0;
+
+  public:
+    void reset() {
+      used = 0;
+    }
+
+    // 批量命令中每条命令处理前回退到快照，释放上一条命令的格式化文本
+    size_t mark() const {
+      return used;
+    }
+
+    void rewind(size_t position) {
+      used = position;
+    }
+
+    size_t capacity() const {
+      return Size;
+    }
+
+    /**
+     * 分配 size 字节，空间不足返回NULL
+     */
+    char* alloc(size_t size) {
+      if (size > Size - used) return NULL;
+      char* p = buffer + used;
+      used += size;
+      return p;
+    }
+
+    /**
+     * printf风格格式化，返回以0结尾的字符串；空间不足时截断
+     */
+    __attribute__((format(printf, 2, 3)))
+    const char* format(const char* fmt, ...) {
+      size_t available = Size - used;
+      if (available == 0) return "";
+
+      char* p = buffer + used;
+      va_list args;
+      va_start(args, fmt);
+      int length = vsnprintf(p, available, fmt, args);
+      va_end(args);
+
+      if (length < 0) {
+        p[0] = '\0';
+        length = 0;
+      }
+      used += ((size_t)length + 1 < available) ? (size_t)length + 1 : available;
+      return p;
+    }
+};
+
+}  // namespace manta
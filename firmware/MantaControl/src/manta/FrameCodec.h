@@ -0,0 +1,135 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Cobs.h"
+#include "Crc16.h"
+
+namespace manta {
+
+/**
+ * 串口二进制帧
+ * 帧 = COBS(载荷 + CRC16) + 0x00；载荷 = [类型][序号][数据...]，多字节字段为小端序
+ */
+
+inline int32_t readInt32LE(const uint8_t* data) {
+  return (int32_t)((uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+}
+
+inline uint16_t readUint16LE(const uint8_t* data) {
+  return (uint16_t)(data[0] | ((uint16_t)data[1] << 8));
+}
+
+inline size_t writeUint16LE(uint8_t* out, uint16_t value) {
+  out[0] = value & 0xFF;
+  out[1] = value >> 8;
+  return 2;
+}
+
+inline size_t writeUint32LE(uint8_t* out, uint32_t value) {
+  for (int b = 0; b < 4; b++) out[b] = (value >> (8 * b)) & 0xFF;
+  return 4;
+}
+
+/**
+ * 逐字节解码：遇到0x00分隔符时解码并校验一帧
+ * 超长帧整帧丢弃；格式或CRC错误计入 errors()
+ */
+template <size_t MaxSize>
+class FrameDecoder {
+  private:
+    uint8_t buffer[MaxSize];
+    uint8_t payload[MaxSize];
+    size_t length = 0;
+    size_t payloadLength = 0;
+    bool overflow = false;
+    uint32_t errorCount = 0;
+
+    bool decode() {
+      int decoded = cobsDecode(buffer, length, payload);
+      if (decoded < 4) {
+        errorCount++;
+        return false;
+      }
+
+      size_t n = (size_t)decoded - 2;
+      if (readUint16LE(payload + n) != crc16(payload, n)) {
+        errorCount++;
+        return false;
+      }
+      payloadLength = n;
+      return true;
+    }
+
+  public:
+    /**
+     * 输入一个字节，一帧校验通过时返回true，随后可读取 type()/seq()/data()
+     */
+    bool push(uint8_t c) {
+      if (c != 0) {
+        if (length < MaxSize) {
+          buffer[length++] = c;
+        } else {
+          overflow = true;
+        }
+        return false;
+      }
+
+      bool complete = false;
+      if (overflow) {
+        errorCount++;
+      } else if (length > 0) {
+        complete = decode();
+      }
+      length = 0;
+      overflow = false;
+      return complete;
+    }
+
+    uint8_t type() const { return payload[0]; }
+    uint8_t seq() const { return payload[1]; }
+    const uint8_t* data() const { return payload + 2; }
+    size_t dataLength() const { return payloadLength - 2; }
+
+    // 帧校验通过但内容不合法时由调用方计数
+    void countError() { errorCount++; }
+    uint32_t errors() const { return errorCount; }
+};
+
+/**
+ * 编码一帧，bytes() 为COBS编码结果（不含分隔符）
+ */
+template <size_t MaxSize>
+class FrameEncoder {
+  private:
+    uint8_t payload[MaxSize];
+    uint8_t encoded[MaxSize + MaxSize / 254 + 1];
+    size_t encodedLength = 0;
+
+  public:
+    static const size_t MAX_DATA = MaxSize - 4;
+
+    /**
+     * 返回编码长度，数据超过 MAX_DATA 时返回0
+     */
+    size_t encode(uint8_t type, uint8_t seq, const uint8_t* data, size_t length) {
+      if (length > MAX_DATA) return 0;
+
+      payload[0] = type;
+      payload[1] = seq;
+      if (length > 0) {
+        memcpy(payload + 2, data, length);
+      }
+      writeUint16LE(payload + length + 2, crc16(payload, length + 2));
+
+      encodedLength = cobsEncode(payload, length + 4, encoded);
+      return encodedLength;
+    }
+
+    const uint8_t* bytes() const { return encoded; }
+    size_t size() const { return encodedLength; }
+};
+
+}  // namespace manta
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+namespace manta {
+
+/**
+ * HTTP请求头中固件关心的字段
+ */
+struct HttpRequestHead {
+  int contentLength = 0;
+  char ifNoneMatch[48] = "";
+};
+
+/**
+ * 请求头值：跳过冒号后的空白，复制到 dest（超长截断）
+ */
+inline void copyHeaderValue(char* dest, size_t size, const char* value) {
+  while (*value == ' ' || *value == '\t') value++;
+  strncpy(dest, value, size - 1);
+  dest[size - 1] = '\0';
+}
+
+/**
+ * 解析一行请求头（不区分大小写），未关心的字段忽略
+ */
+inline void parseHeaderLine(HttpRequestHead& head, const char* line) {
+  if (strncasecmp(line, "content-length:", 15) == 0) {
+    int length = atoi(line + 15);
+    head.contentLength = length > 0 ? length : 0;
+  } else if (strncasecmp(line, "if-none-match:", 14) == 0) {
+    copyHeaderValue(head.ifNoneMatch, sizeof(head.ifNoneMatch), line + 14);
+  }
+}
+
+/**
+ * 请求行是否以 "方法 路径" 开头
+ */
+inline bool requestIs(const char* requestLine, const char* methodAndPath) {
+  return strncmp(requestLine, methodAndPath, strlen(methodAndPath)) == 0;
+}
+
+}  // namespace manta
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace manta {
+
+/**
+ * 清理并转义JSON字符串中的字符，写入 dest（始终以0结尾），返回写入长度
+ */
+inline size_t escapeJson(char* dest, size_t size, const char* input) {
+  size_t length = 0;
+  for (; *input && length + 2 < size; input++) {
+    char c = *input;
+    // 过滤控制字符，保留可打印字符
+    if (c >= 32 && c <= 126) {
+      // 转义JSON特殊字符
+      if (c == '"' || c == '\\') {
+        dest[length++] = '\\';
+      }
+      dest[length++] = c;
+    } else if (c == '\n' || c == '\r' || c == '\t') {
+      dest[length++] = '\\';
+      dest[length++] = (c == '\n') ? 'n' : (c == '\r') ? 'r' : 't';
+    }
+    // 其他控制字符直接忽略
+  }
+  dest[length] = '\0';
+  return length;
+}
+
+/**
+ * 日志上报器
+ * warn/error 立即发送，info/debug 每秒最多一条；发送失败时保留最近一条等待重试
+ * Transport 需提供 bool post(const char* body, size_t length)
+ */
+template <typename Transport>
+class Logger {
+  private:
+    static const size_t LOG_BUFFER_SIZE = 320;
+    static const size_t MESSAGE_SIZE = 192;
+    static const uint32_t MIN_SEND_INTERVAL_MS = 1000;
+
+    Transport& transport;
+    char lastLog[LOG_BUFFER_SIZE];   // 最近一条JSON日志，发送失败时保留用于重试
+    size_t lastLogLength = 0;
+    bool hasPendingLog = false;
+    uint32_t lastSendTime = 0;
+
+  public:
+    explicit Logger(Transport& transport) : transport(transport) {
+      lastLog[0] = '\0';
+    }
+
+    void log(const char* level, const char* message, const char* category, uint32_t nowMs) {
+      // 只发送重要日志，避免过度发送
+      if (strcmp(level, "error") == 0 || strcmp(level, "warn") == 0) {
+        sendImmediately(level, message, category, nowMs);
+      } else if (nowMs - lastSendTime >= MIN_SEND_INTERVAL_MS) {
+        sendImmediately(level, message, category, nowMs);
+        lastSendTime = nowMs;
+      }
+    }
+
+    void sendImmediately(const char* level, const char* message, const char* category, uint32_t nowMs) {
+      char cleanMessage[MESSAGE_SIZE];
+      escapeJson(cleanMessage, sizeof(cleanMessage), message);
+
+      int length = snprintf(lastLog, LOG_BUFFER_SIZE,
+                            "{\"timestamp\":%lu,\"level\":\"%s\",\"message\":\"%s\",\"category\":\"%s\"}",
+                            (unsigned long)nowMs, level, cleanMessage, category);
+      if (length < 0) length = 0;
+      lastLogLength = (size_t)length < LOG_BUFFER_SIZE ? (size_t)length : LOG_BUFFER_SIZE - 1;
+
+      // 连接失败则保留这条日志用于重试
+      hasPendingLog = !transport.post(lastLog, lastLogLength);
+    }
+
+    void retry() {
+      if (hasPendingLog && transport.post(lastLog, lastLogLength)) {
+        hasPendingLog = false;
+      }
+    }
+
+    bool pending() const { return hasPendingLog; }
+    const char* last() const { return lastLog; }
+    size_t lastLength() const { return lastLogLength; }
+};
+
+}  // namespace manta
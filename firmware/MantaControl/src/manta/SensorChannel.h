@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "Config.h"
+
+namespace manta {
+
+struct SensorWindow {
+  uint32_t startMs;
+  uint16_t min;
+  uint16_t max;
+  uint16_t mean;
+};
+
+/**
+ * 传感器通道：按分频采样并汇总 min/max/mean 窗口
+ * 单生产者(中断)单消费者(主循环)环形缓冲：中断只写head，主循环只写tail
+ */
+template <size_t RingSize>
+class SensorChannel {
+  static_assert(RingSize >= 2 && RingSize <= 256, "环形缓冲区长度必须在2-256之间");
+
+  private:
+    uint16_t tick = 0;       // 分频计数
+    uint16_t count = 0;      // 当前窗口样本数
+    uint16_t min = 0;
+    uint16_t max = 0;
+    uint32_t sum = 0;
+    uint32_t startMs = 0;
+    volatile uint16_t latestSample = 0;   // 最近一次原始采样值
+    SensorWindow ring[RingSize];
+    volatile uint8_t head = 0;
+    volatile uint8_t tail = 0;
+
+  public:
+    static uint8_t next(uint8_t position) {
+      return (uint8_t)((position + 1) % RingSize);
+    }
+
+    void reset() {
+      tick = 0;
+      count = 0;
+      latestSample = 0;
+      head = 0;
+      tail = 0;
+    }
+
+    // ---------- 中断侧 ----------
+
+    /**
+     * 分频计数，返回true表示本次定时器中断需要采样
+     */
+    bool due(uint16_t divider) {
+      if (++tick < divider) return false;
+      tick = 0;
+      return true;
+    }
+
+    /**
+     * 加入一个样本；窗口完成但缓冲区已满时丢弃该窗口并返回false
+     */
+    bool addSample(uint16_t sample, uint32_t nowMs, uint16_t windowSamples) {
+      latestSample = sample;
+
+      if (count == 0) {
+        startMs = nowMs;
+        min = sample;
+        max = sample;
+        sum = 0;
+      }
+      if (sample < min) min = sample;
+      if (sample > max) max = sample;
+      sum += sample;
+
+      if (++count < windowSamples) return true;
+
+      bool stored = false;
+      uint8_t nextHead = next(head);
+      if (nextHead != tail) {
+        SensorWindow& w = ring[head];
+        w.startMs = startMs;
+        w.min = min;
+        w.max = max;
+        w.mean = (uint16_t)(sum / count);
+        head = nextHead;
+        stored = true;
+      }
+      count = 0;
+      return stored;
+    }
+
+    uint16_t latest() const {
+      return latestSample;
+    }
+
+    // ---------- 主循环侧 ----------
+
+    uint8_t pending() const {
+      return (uint8_t)((head + RingSize - tail) % RingSize);
+    }
+
+    uint8_t readPosition() const { return tail; }
+    uint8_t writePosition() const { return head; }
+    const SensorWindow& at(uint8_t position) const { return ring[position]; }
+
+    // 上传成功后才推进tail，释放已发送的窗口
+    void consumeTo(uint8_t position) {
+      tail = position;
+    }
+};
+
+namespace detail {
+
+/**
+ * 追加格式化文本；空间不足时置 truncated 并不再写入
+ */
+__attribute__((format(printf, 5, 6)))
+inline void appendFormat(char* buffer, size_t size, size_t& length, bool& truncated, const char* fmt, ...) {
+  if (truncated) return;
+
+  va_list args;
+  va_start(args, fmt);
+  int written = vsnprintf(buffer + length, size - length, fmt, args);
+  va_end(args);
+
+  if (written < 0 || (size_t)written >= size - length) {
+    truncated = true;
+    return;
+  }
+  length += (size_t)written;
+}
+
+}  // namespace detail
+
+/**
+ * 组装一批待上传的窗口
+ * {"up":运行ms,"ov":丢弃窗口数,"s":[{"id":"sensor","d":[[起始ms,min,max,mean],...]}]}
+ * 每个通道为后续通道的头部与结尾预留 reservePerChannel 字节，一次放不下的窗口留到下一批；
+ * newTails 返回各通道发送成功后应推进到的位置。没有窗口或缓冲区不足时返回0
+ */
+template <size_t RingSize>
+size_t formatSensorBatch(char* buffer, size_t size, uint32_t uptimeMs, uint32_t overflows,
+                         const SensorChannel<RingSize>* channels, const SensorDescriptor* sensors, size_t count,
+                         size_t reservePerChannel, uint8_t* newTails) {
+  size_t length = 0;
+  bool truncated = false;
+  bool hasWindows = false;
+
+  detail::appendFormat(buffer, size, length, truncated, "{\"up\":%lu,\"ov\":%lu,\"s\":[",
+                       (unsigned long)uptimeMs, (unsigned long)overflows);
+
+  for (size_t s = 0; s < count; s++) {
+    const SensorChannel<RingSize>& ch = channels[s];
+    uint8_t tail = ch.readPosition();
+    uint8_t head = ch.writePosition();
+    detail::appendFormat(buffer, size, length, truncated, "%s{\"id\":\"%s\",\"d\":[", s > 0 ? "," : "", sensors[s].name);
+
+    bool first = true;
+    size_t reserve = (count - s) * reservePerChannel;
+    while (tail != head && !truncated && length + reserve < size) {
+      const SensorWindow& w = ch.at(tail);
+      detail::appendFormat(buffer, size, length, truncated, "%s[%lu,%u,%u,%u]",
+                           first ? "" : ",", (unsigned long)w.startMs, w.min, w.max, w.mean);
+      first = false;
+      hasWindows = true;
+      tail = SensorChannel<RingSize>::next(tail);
+    }
+    newTails[s] = tail;
+    detail::appendFormat(buffer, size, length, truncated, "]}");
+  }
+  detail::appendFormat(buffer, size, length, truncated, "]}");
+
+  return (hasWindows && !truncated) ? length : 0;
+}
+
+}  // namespace manta
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace manta {
+
+/**
+ * PWM波形发生器
+ * 命令附带 prf {s, p, a, o, n} 时由固件本地计算占空比，无需后端逐点下发；全部为整数运算
+ */
+
+enum WaveformShape : uint8_t {
+  WAVE_RAMP = 0,
+  WAVE_EASE = 1,
+  WAVE_SQUARE = 2,
+  WAVE_SINE = 3
+};
+
+const uint32_t WAVEFORM_MAX_PERIOD_MS = 3600000;   // 相位计算不溢出的上限
+
+struct WaveformParams {
+  uint8_t shape;           // 波形
+  uint32_t periodMs;       // 周期（斜坡为爬升时长）
+  int amplitude;           // 幅值 0-100 (%)
+  int offset;              // 基准值 0-100 (%)
+  unsigned int cycles;     // 周期数，0为持续到定时结束或被覆盖
+};
+
+// 正弦查表：(1 - cos) / 2 * 1000，64段，从基准值平滑起步
+static const uint16_t WAVEFORM_SINE_TABLE[65] = {
+  0, 2, 10, 22, 38, 59, 84, 113, 146, 183, 222, 264, 309, 355, 402, 451,
+  500, 549, 598, 645, 691, 736, 778, 817, 854, 887, 916, 941, 962, 978, 990, 998,
+  1000, 998, 990, 978, 962, 941, 916, 887, 854, 817, 778, 736, 691, 645, 598, 549,
+  500, 451, 402, 355, 309, 264, 222, 183, 146, 113, 84, 59, 38, 22, 10, 2,
+  0
+};
+
+/**
+ * 校验并限幅波形参数，形状未知时返回false
+ */
+inline bool makeWaveform(int shape, uint32_t periodMs, int amplitude, int offset, unsigned int cycles, WaveformParams& out) {
+  if (shape < WAVE_RAMP || shape > WAVE_SINE) return false;
+
+  out.shape = (uint8_t)shape;
+  out.periodMs = periodMs < 1 ? 1 : (periodMs > WAVEFORM_MAX_PERIOD_MS ? WAVEFORM_MAX_PERIOD_MS : periodMs);
+  out.amplitude = amplitude < 0 ? 0 : (amplitude > 100 ? 100 : amplitude);
+  int maxOffset = 100 - out.amplitude;
+  out.offset = offset < 0 ? 0 : (offset > maxOffset ? maxOffset : offset);
+  out.cycles = cycles;
+  return true;
+}
+
+/**
+ * 计算波形在某一时刻的占空比（千分比 0-1000）
+ */
+inline uint32_t evaluateWaveform(const WaveformParams& wave, uint32_t elapsedMs) {
+  // 相位 0-1023（周期不超过 WAVEFORM_MAX_PERIOD_MS，32位乘法不溢出）
+  uint32_t phase = (elapsedMs % wave.periodMs) * 1024UL / wave.periodMs;
+  uint32_t unit = 0; // 0-1000
+
+  switch (wave.shape) {
+    case WAVE_RAMP:
+      unit = phase * 1000UL / 1024UL;
+      break;
+    case WAVE_EASE: {
+      // smoothstep: t^2 * (3 - 2t)
+      uint32_t t = phase * 1000UL / 1024UL;
+      unit = t * t / 1000UL * (3000UL - 2UL * t) / 1000UL;
+      break;
+    }
+    case WAVE_SQUARE:
+      unit = phase < 512 ? 1000UL : 0UL;
+      break;
+    case WAVE_SINE: {
+      // 查表 + 线性插值
+      uint32_t index = phase >> 4;
+      uint32_t frac = phase & 15;
+      unit = (WAVEFORM_SINE_TABLE[index] * (16 - frac) + WAVEFORM_SINE_TABLE[index + 1] * frac) / 16;
+      break;
+    }
+  }
+
+  return wave.offset * 10UL + wave.amplitude * unit / 100UL;
+}
+
+/**
+ * 周期数用完时返回true，并给出终值（千分比）：斜坡保持在终值，方波/正弦回到基准值
+ */
+inline bool waveformFinished(const WaveformParams& wave, uint32_t elapsedMs, uint32_t& finalPermille) {
+  if (wave.cycles == 0 || elapsedMs / wave.periodMs < wave.cycles) return false;
+
+  bool holdPeak = (wave.shape == WAVE_RAMP || wave.shape == WAVE_EASE);
+  finalPermille = (holdPeak ? wave.offset + wave.amplitude : wave.offset) * 10UL;
+  return true;
+}
+
+}  // namespace manta
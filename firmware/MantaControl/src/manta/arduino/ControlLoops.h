@@ -0,0 +1,138 @@
+#pragma once
+
+/**
+ * 闭环控制：回路在采样中断中运行，参数命令 {act: "loop", lp, en, sp, kp, ki, kd, lo, hi} 或串口 FRAME_LOOP 帧
+ */
+
+namespace manta {
+
+#if MANTA_CONTROL_LOOP_COUNT > 0
+
+void initializeControlLoops() {
+  for (int l = 0; l < MANTA_CONTROL_LOOP_COUNT; l++) {
+    initControlLoop(controlLoops[l], config::CONTROL_LOOPS[l]);
+  }
+}
+
+/**
+ * 在采样中断中调用，使用本次中断刚采到的值
+ */
+void runControlLoops() {
+  for (int l = 0; l < MANTA_CONTROL_LOOP_COUNT; l++) {
+    ControlLoop& loop = controlLoops[l];
+    const ControlLoopDescriptor& descriptor = config::CONTROL_LOOPS[l];
+    if (++loop.tick < descriptor.divider) continue;
+    loop.tick = 0;
+
+    if (stepControlLoop(loop, sensorChannels[descriptor.sensor].latest())) {
+      outputDriver.writeDuty(descriptor.output, loop.output);
+    }
+  }
+}
+
+/**
+ * 应用回路参数；启用时从当前输出无扰切换
+ */
+bool applyControlLoopUpdate(int l, const ControlLoopUpdate& update) {
+  if (l < 0 || l >= MANTA_CONTROL_LOOP_COUNT) return false;
+
+  ControlLoop& loop = controlLoops[l];
+  const ControlLoopDescriptor& descriptor = config::CONTROL_LOOPS[l];
+  int out = descriptor.output;
+  bool enabling = (update.flags & LOOP_ENABLE) && !loop.enabled;
+  bool disabling = (update.flags & LOOP_DISABLE) && loop.enabled;
+
+  // 多字段更新期间屏蔽中断，PID不会看到半更新的参数
+  noInterrupts();
+  applyControlLoopParams(loop, update, config::DEVICES[out].maxDuty);
+  if (enabling) {
+    enableControlLoop(loop, bank.state(out).currentValue, sensorChannels[descriptor.sensor].latest());
+  }
+  if (disabling) {
+    loop.enabled = false;
+  }
+  interrupts();
+
+  if (enabling) {
+    // 回路接管输出：取消波形与定时关闭
+    bank.hold(out);
+  }
+  if (disabling) {
+    // 关闭回路时输出归零
+    bank.turnOff(out, millis());
+  }
+
+  bank.touch();
+  return true;
+}
+
+/**
+ * 解析HTTP命令 {act: "loop", lp, en, sp, kp, ki, kd, lo, hi}，缺省字段保持不变
+ */
+bool applyControlLoopCommand(JsonObject cmd) {
+  int l = cmd["lp"] | -1;
+  if (l < 0 || l >= MANTA_CONTROL_LOOP_COUNT) return false;
+
+  const ControlLoop& loop = controlLoops[l];
+  ControlLoopUpdate update;
+  update.flags = 0;
+  update.setpoint = cmd["sp"] | loop.setpoint;
+  update.kp = cmd["kp"] | loop.kp;
+  update.ki = cmd["ki"] | loop.ki;
+  update.kd = cmd["kd"] | loop.kd;
+  update.outMin = cmd["lo"] | loop.outMin;
+  update.outMax = cmd["hi"] | loop.outMax;
+
+  if (cmd.containsKey("sp")) update.flags |= LOOP_SET_SETPOINT;
+  if (cmd.containsKey("kp") || cmd.containsKey("ki") || cmd.containsKey("kd")) update.flags |= LOOP_SET_GAINS;
+  if (cmd.containsKey("lo") || cmd.containsKey("hi")) update.flags |= LOOP_SET_LIMITS;
+  if (cmd.containsKey("en")) update.flags |= (cmd["en"] | 0) ? LOOP_ENABLE : LOOP_DISABLE;
+
+  return applyControlLoopUpdate(l, update);
+}
+
+/**
+ * 手动命令接管输出时停止驱动该输出的回路（不改变输出，由手动命令写入）
+ */
+void releaseControlLoops(int deviceIndex) {
+  for (int l = 0; l < MANTA_CONTROL_LOOP_COUNT; l++) {
+    if (config::CONTROL_LOOPS[l].output == deviceIndex) {
+      controlLoops[l].enabled = false;
+    }
+  }
+}
+
+void disableControlLoops() {
+  for (int l = 0; l < MANTA_CONTROL_LOOP_COUNT; l++) {
+    controlLoops[l].enabled = false;
+  }
+}
+
+/**
+ * 主循环中把闭环输出计入设备状态（运行计数只在主循环中更新）
+ */
+void syncControlLoops() {
+  for (int l = 0; l < MANTA_CONTROL_LOOP_COUNT; l++) {
+    if (!controlLoops[l].enabled) continue;
+    int out = config::CONTROL_LOOPS[l].output;
+    uint16_t duty = controlLoops[l].output;
+    if (duty != bank.state(out).currentValue) {
+      bank.record(out, duty, millis());
+    }
+  }
+}
+
+#else
+
+// 没有控制回路：参数命令一律不执行
+void initializeControlLoops() {}
+void runControlLoops() {}
+bool applyControlLoopUpdate(int, const ControlLoopUpdate&) { return false; }
+bool applyControlLoopCommand(JsonObject) { return false; }
+void releaseControlLoops(int) {}
+void disableControlLoops() {}
+void syncControlLoops() {}
+
+#endif
+
+}  // namespace manta
@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * 设备命令、急停、定时关闭与波形更新
+ */
+
+namespace manta {
+
+/**
+ * 按设备索引应用命令（waveform 非空时启动本地波形，否则取消该设备的波形）
+ */
+bool applyDeviceCommand(int deviceIndex, CommandAction action, int value, int duration, const WaveformParams* waveform) {
+  const char* deviceId = bank.name(deviceIndex);
+  unsigned long now = millis();
+
+  // 新命令总是覆盖正在运行的闭环控制
+  releaseControlLoops(deviceIndex);
+
+  if (action == ACTION_POWER) {
+    if (!bank.setPower(deviceIndex, value, duration, waveform, now)) {
+      Serial.print("设备 ");
+      Serial.print(deviceId);
+      Serial.println(" 不支持PWM控制");
+      return false;
+    }
+
+    if (verboseCommandLog) {
+      const char* logMsg = waveform
+        ? arena.format("设备 %s 启动波形 %u，周期 %lums", deviceId, waveform->shape, (unsigned long)waveform->periodMs)
+        : arena.format("设备 %s PWM设置为 %d%% (%u/%u)", deviceId, value,
+                       (unsigned int)bank.state(deviceIndex).currentValue, (unsigned int)PWM_DUTY_MAX);
+      logEvent("info", logMsg, "device_control");
+    }
+  } else if (action == ACTION_STATE) {
+    bank.setState(deviceIndex, value, duration, now);
+
+    if (verboseCommandLog) {
+      const char* logMsg = arena.format("设备 %s 状态设置为 %s", deviceId, value > 0 ? "开启" : "关闭");
+      logEvent("info", logMsg, "device_control");
+    }
+  } else {
+    return false;
+  }
+
+  if (verboseCommandLog && bank.remaining(deviceIndex, now) > 0) {
+    Serial.print("将在 ");
+    Serial.print(duration);
+    Serial.println("ms 后自动关闭");
+  }
+  return true;
+}
+
+/**
+ * 执行分组命令：按位掩码一次遍历设置所有成员，返回成功执行的设备数
+ */
+int executeMaskCommand(uint32_t mask, CommandAction action, int value, int duration, const WaveformParams* waveform) {
+  int executed = 0;
+  for (int i = 0; i < MANTA_DEVICE_COUNT; i++) {
+    if ((mask & (1UL << i)) && applyDeviceCommand(i, action, value, duration, waveform)) {
+      executed++;
+    }
+  }
+  return executed;
+}
+
+/**
+ * 按设备ID执行命令
+ */
+bool executeDeviceCommand(const char* deviceId, CommandAction action, int value, int duration, const WaveformParams* waveform) {
+  int deviceIndex = bank.find(deviceId);
+  if (deviceIndex == -1) {
+    logEvent("error", arena.format("未知设备: %s", deviceId), "device_control");
+    return false;
+  }
+
+  return applyDeviceCommand(deviceIndex, action, value, duration, waveform);
+}
+
+/**
+ * 根据分组ID查找位掩码，未知分组返回0
+ */
+uint32_t lookupGroupMask(const char* groupId) {
+  uint32_t mask = 0;
+  if (!groupId) return 0;
+  if (!findGroupMask(config::GROUPS, MANTA_GROUP_COUNT, groupId, mask)) {
+    logEvent("error", arena.format("未知分组: %s", groupId), "device_control");
+  }
+  return mask;
+}
+
+/**
+ * 急停：关闭所有输出并取消所有定时任务，锁定HTTP批处理直到后端以新会话重新开始
+ */
+void emergencyStop() {
+  // 先停闭环，避免采样中断在关闭输出后再次写入占空比
+  disableControlLoops();
+
+  bank.stopAll(millis());
+  commandSequence.fence();
+  estopCount++;
+  lastEstopMs = millis();
+}
+
+/**
+ * 定时关闭到期的设备
+ */
+void checkTimedTasks() {
+  unsigned long now = millis();
+  int deviceIndex;
+  while ((deviceIndex = bank.expire(now)) >= 0) {
+    logEvent("info", arena.format("设备 %s 定时关闭", bank.name(deviceIndex)), "timer_task");
+  }
+}
+
+/**
+ * 更新所有运行中的波形（按 WAVEFORM_UPDATE_INTERVAL_US 限速）
+ */
+void updateWaveforms() {
+  unsigned long nowUs = micros();
+  if (nowUs - lastWaveformUpdateUs < WAVEFORM_UPDATE_INTERVAL_US) return;
+  lastWaveformUpdateUs = nowUs;
+
+  bank.updateWaveforms(millis());
+}
+
+}  // namespace manta
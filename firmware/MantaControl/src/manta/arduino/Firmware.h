@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * 固件入口：草图的 setup()/loop() 直接转调
+ */
+
+namespace manta {
+
+void setup() {
+  // 先把所有输出置为安全状态（关闭），不依赖串口和WiFi；这里不做任何打印
+  bank.begin();
+  initializeControlLoops();
+  bootTimings.outputsReadyMs = millis();
+
+  // 初始化串口（不等待USB连接，电池供电时也能直接启动）
+  Serial.begin(SERIAL_BAUD_RATE);
+  Serial.println("=================================");
+  Serial.println("FishControl 自动生成版本启动中...");
+  Serial.print("设备数量: ");
+  Serial.println(MANTA_DEVICE_COUNT);
+  Serial.println("=================================");
+
+  // 初始化WiFi热点
+  initializeWiFi();
+
+  // 启动HTTP服务器与急停UDP通道
+  server.begin();
+  estopUdp.begin(ESTOP_UDP_PORT);
+  bootTimings.serverReadyMs = millis();
+  bootNonce = micros(); // WiFi模组初始化耗时抖动，作为本次上电的标识
+
+  Serial.print("HTTP服务器已启动，IP地址: ");
+  Serial.println(WiFi.localIP());
+  Serial.print("启动耗时(ms): 输出=");
+  Serial.print(bootTimings.outputsReadyMs);
+  Serial.print(", 热点=");
+  Serial.print(bootTimings.apReadyMs);
+  Serial.print(", 服务器=");
+  Serial.println(bootTimings.serverReadyMs);
+  Serial.print("控制板: ");
+  Serial.println(MANTA_BOARD_ID);
+
+  // 最后启动采样定时器，避免启动阶段堆积窗口
+  if (!initializeSensors()) {
+    Serial.println("传感器采样定时器启动失败");
+  }
+  Serial.println("=================================");
+}
+
+void loop() {
+  // 急停优先：每次循环最先检查
+  pollEmergencyStop();
+
+  // 上一轮的格式化文本已全部发出
+  arena.reset();
+
+  // 有线部署：解码串口二进制命令帧
+  pollSerialCommands();
+
+  // 从站控制板断线重连
+  maintainWiFi();
+
+  // 处理HTTP请求
+  handleHTTPRequests();
+
+  // 更新PWM波形（内部按 WAVEFORM_UPDATE_INTERVAL_US 限速）
+  updateWaveforms();
+
+  // 检查定时任务
+  checkTimedTasks();
+
+  // 把中断中的闭环输出同步到设备状态与运行计数
+  syncControlLoops();
+
+  // 批量上传已完成的传感器窗口
+  uploadSensorWindows();
+
+  // 重试失败的日志发送（每秒最多一次，避免阻塞波形更新）
+  static unsigned long lastLogRetryMs = 0;
+  if (millis() - lastLogRetryMs >= 1000) {
+    lastLogRetryMs = millis();
+    wifiLogger.retry();
+  }
+}
+
+}  // namespace manta
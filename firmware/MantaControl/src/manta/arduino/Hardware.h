@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * 硬件绑定：PWM/数字输出驱动与到后端的HTTP上报
+ */
+
+namespace manta {
+
+const char* const BACKEND_HOST = "192.168.4.2";   // 连接热点的电脑
+const uint16_t BACKEND_PORT = 8080;
+
+/**
+ * DeviceBank 的输出驱动：PWM设备使用生成的 PwmOut（独占一个GPT定时器输出），数字设备直接写引脚
+ */
+struct PwmOutputDriver {
+  void begin(size_t i) {
+    const DeviceDescriptor& device = config::DEVICES[i];
+    if (device.type == DEVICE_PWM) {
+      // 以0占空比启动硬件PWM，频率按设备配置
+      config::PWM_OUTPUTS[i]->begin(device.pwmFrequency, 0.0f);
+    } else {
+      // 先写低电平再切换为输出，避免上电瞬间输出毛刺
+      digitalWrite(device.pin, LOW);
+      pinMode(device.pin, OUTPUT);
+    }
+  }
+
+  void writeDuty(size_t i, uint16_t duty) {
+    config::PWM_OUTPUTS[i]->pulse_perc(duty * 100.0f / PWM_DUTY_MAX);
+  }
+
+  void writeDigital(size_t i, bool on) {
+    digitalWrite(config::DEVICES[i].pin, on ? HIGH : LOW);
+  }
+};
+
+/**
+ * POST一段JSON到后端，连接失败返回false
+ */
+bool postToBackend(const char* path, const char* body, size_t length, unsigned long settleMs = 0) {
+  WiFiClient client;
+  if (!client.connect(BACKEND_HOST, BACKEND_PORT)) return false;
+
+  client.print("POST ");
+  client.print(path);
+  client.println(" HTTP/1.1");
+  client.print("Host: ");
+  client.print(BACKEND_HOST);
+  client.print(":");
+  client.println(BACKEND_PORT);
+  client.println("Content-Type: application/json");
+  client.println("Connection: close");
+  client.print("Content-Length: ");
+  client.println(length);
+  client.println();
+  client.write((const uint8_t*)body, length);
+  client.flush(); // 确保数据发送完成
+  if (settleMs > 0) {
+    delay(settleMs);  // 给服务器时间处理
+  }
+  client.stop();
+  return true;
+}
+
+/**
+ * Logger 的传输：发送到后端 /api/arduino-logs
+ */
+struct WiFiLogTransport {
+  bool post(const char* body, size_t length) {
+    return postToBackend("/api/arduino-logs", body, length, 10);
+  }
+};
+
+}  // namespace manta
@@ -0,0 +1,583 @@
+#pragma once
+
+/**
+ * WiFi控制通道：HTTP API 与 UDP 急停
+ */
+
+namespace manta {
+
+void handleBatchCommands(WiFiClient& client, char* body, int bodyLength);
+void handleEmergencyStopRequest(WiFiClient& client);
+void handleStatusQuery(WiFiClient& client, const char* ifNoneMatch);
+void handleMetricsQuery(WiFiClient& client);
+void handleCORSPreflight(WiFiClient& client);
+void send404(WiFiClient& client);
+void sendError(WiFiClient& client, int code, const char* message);
+void sendCORSHeaders(WiFiClient& client);
+void printStateSnapshot(WiFiClient& client);
+#if MANTA_WIFI_STATION
+bool joinAccessPoint();
+#endif
+
+/**
+ * 检查急停数据报，收到后立即急停并回复确认
+ * 在 loop() 开头以及HTTP读取等待中调用，保证急停不被其他工作阻塞
+ */
+bool pollEmergencyStop() {
+  int packetSize = estopUdp.parsePacket();
+  if (packetSize <= 0) return false;
+
+  char packet[24];
+  int len = estopUdp.read((uint8_t*)packet, sizeof(packet) - 1);
+  packet[len > 0 ? len : 0] = '\0';
+  if (strncmp(packet, "ESTOP", 5) != 0) return false;
+
+  // 先关闭输出，再做任何通信
+  emergencyStop();
+
+  // 回显序号：ESTOP:<seq> -> ESTOP_ACK:<seq>
+  const char* seq = strchr(packet, ':');
+  estopUdp.beginPacket(estopUdp.remoteIP(), estopUdp.remotePort());
+  estopUdp.write((const uint8_t*)"ESTOP_ACK", 9);
+  if (seq) {
+    estopUdp.write((const uint8_t*)seq, strlen(seq));
+  }
+  estopUdp.endPacket();
+
+  Serial.println("急停已执行");
+  return true;
+}
+
+/**
+ * 读取一行（去掉\r\n）到 buffer，超长部分丢弃；超时或断开返回-1
+ * 等待数据时照常检查急停与更新波形
+ */
+int readHttpLine(WiFiClient& client, char* buffer, int size, unsigned long deadline) {
+  int length = 0;
+  while (client.connected() && (long)(deadline - millis()) > 0) {
+    if (!client.available()) {
+      pollEmergencyStop();
+      updateWaveforms();
+      continue;
+    }
+
+    char c = client.read();
+    if (c == '\n') {
+      buffer[length] = '\0';
+      return length;
+    }
+    if (c != '\r' && length < size - 1) {
+      buffer[length++] = c;
+    }
+  }
+  buffer[length] = '\0';
+  return -1;
+}
+
+/**
+ * 处理HTTP请求
+ */
+void handleHTTPRequests() {
+  WiFiClient client = server.available();
+  if (!client) return;
+
+  // 记录进入时的急停计数，读取期间若发生急停则丢弃本次命令
+  unsigned long estopAtStart = estopCount;
+  arena.reset();
+
+  char requestLine[HTTP_LINE_MAX];
+  char header[HTTP_LINE_MAX];
+  HttpRequestHead head;
+  bool headersComplete = false;
+  unsigned long deadline = millis() + 3000; // 3秒超时
+
+  // 读取请求行与请求头（空行结束）
+  if (readHttpLine(client, requestLine, sizeof(requestLine), deadline) < 0) {
+    client.stop();
+    return;
+  }
+
+  int headerLength;
+  while ((headerLength = readHttpLine(client, header, sizeof(header), deadline)) >= 0) {
+    if (headerLength == 0) {
+      headersComplete = true;
+      break;
+    }
+    parseHeaderLine(head, header);
+  }
+
+  // 如果是POST请求，把请求体读入格式化缓冲区
+  char* body = NULL;
+  int bodyLength = 0;
+  int contentLength = head.contentLength;
+  if (headersComplete && contentLength > 0 && requestIs(requestLine, "POST")) {
+    if (contentLength > HTTP_BODY_MAX || (body = arena.alloc(contentLength + 1)) == NULL) {
+      sendError(client, 413, "Request body too large");
+      client.stop();
+      return;
+    }
+
+    unsigned long bodyDeadline = millis() + 2000; // 2秒超时
+    while (client.connected() && (long)(bodyDeadline - millis()) > 0 && bodyLength < contentLength) {
+      int available = client.available();
+      if (available <= 0) {
+        pollEmergencyStop();
+        updateWaveforms();
+        continue;
+      }
+      int bytesRead = client.read((uint8_t*)body + bodyLength, min(available, contentLength - bodyLength));
+      if (bytesRead > 0) bodyLength += bytesRead;
+    }
+    body[bodyLength] = '\0';
+  }
+
+  // 解析请求（急停优先匹配）
+  if (requestIs(requestLine, "POST /api/estop")) {
+    emergencyStop();
+    handleEmergencyStopRequest(client);
+  } else if (requestIs(requestLine, "POST /api/commands")) {
+    if (estopCount != estopAtStart) {
+      // 读取期间收到急停，不再执行这批可能已过时的命令
+      sendError(client, 409, "Emergency stop in progress");
+    } else {
+      handleBatchCommands(client, body, bodyLength);
+    }
+  } else if (requestIs(requestLine, "GET /api/metrics")) {
+    handleMetricsQuery(client);
+  } else if (requestIs(requestLine, "GET /api/status")) {
+    handleStatusQuery(client, head.ifNoneMatch);
+  } else if (requestIs(requestLine, "OPTIONS")) {
+    handleCORSPreflight(client);
+  } else {
+    wifiLogger.log("warn", arena.format("Unknown request: %.30s", requestLine), "http", millis());
+    send404(client);
+  }
+
+  client.stop();
+}
+
+/**
+ * 解析波形配置 prf {s, p, a, o, n}，缺失或非法时返回false
+ */
+bool parseWaveform(JsonObject prf, WaveformParams& out) {
+  if (prf.isNull()) return false;
+
+  int shape = prf["s"] | 0;
+  if (!makeWaveform(shape, prf["p"] | 1UL, prf["a"] | 0, prf["o"] | 0, prf["n"] | 0U, out)) {
+    Serial.print("未知波形: ");
+    Serial.println(shape);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * 等待定时批次的执行时刻，期间照常检查急停、更新波形与定时关闭
+ * 等待中发生急停返回false，这批命令不再执行
+ */
+bool holdBatch(uint32_t holdMs) {
+  if (holdMs == 0) return true;
+
+  unsigned long estopAtStart = estopCount;
+  unsigned long start = millis();
+  while (millis() - start < holdMs) {
+    pollEmergencyStop();
+    if (estopCount != estopAtStart) return false;
+    updateWaveforms();
+    checkTimedTasks();
+  }
+  return true;
+}
+
+/**
+ * 处理批量命令
+ */
+void handleBatchCommands(WiFiClient& client, char* body, int bodyLength) {
+  // 请求体读完的时刻，回复中作为 rx 供后端估计本板时钟（与状态快照中的 up 一起）
+  unsigned long receivedMs = millis();
+
+  if (body == NULL || bodyLength == 0) {
+    Serial.println("错误: 请求中没有找到JSON数据");
+    sendError(client, 400, "No JSON found");
+    return;
+  }
+
+  // 解析JSON：可写缓冲区为零拷贝模式，字符串直接指向请求体
+  StaticJsonDocument<1536> doc; // 固定内存占用，避免堆碎片
+  DeserializationError error = deserializeJson(doc, body, bodyLength);
+
+  if (error) {
+    const char* errorMsg = arena.format("JSON解析失败: %s", error.c_str());
+    Serial.println(errorMsg);
+    wifiLogger.log("error", errorMsg, "json_parse", millis());
+    sendError(client, 400, "JSON Parse Error");
+    return;
+  }
+
+  // 执行命令 - 后端格式 {id, ts, ss, sq, at?, cmds: [{dev, act, val, dur}]}
+  const char* commandId = doc["id"] | "";
+  unsigned long timestamp = doc["ts"];
+  JsonArray commands = doc["cmds"];
+  int executedCount = 0;
+
+  // 记录上电后第一批命令的到达时间（空批次是后端的时钟探测）
+  if (bootTimings.firstCommandMs == 0 && commands.size() > 0) {
+    bootTimings.firstCommandMs = millis();
+  }
+
+  // 后端允许多个请求同时在途，先发出的批次可能后到达；比已执行批次旧的批次不再执行
+  // 急停后当前会话的批次（包括急停时已在套接字积压中的）一律拒绝，直到新会话
+  uint32_t sequence = doc["sq"].as<uint32_t>();
+  if (sequence != 0 && !commandSequence.accept(doc["ss"].as<uint32_t>(), sequence)) {
+    if (commandSequence.fenced()) {
+      Serial.print("急停已锁定，拒绝批次 ID: ");
+      Serial.println(commandId);
+      sendError(client, 409, "Emergency stop latched");
+      return;
+    }
+    Serial.print("丢弃过时批次 ID: ");
+    Serial.println(commandId);
+    client.println("HTTP/1.1 200 OK");
+    client.println("Content-Type: application/json");
+    sendCORSHeaders(client);
+    client.println("Connection: close");
+    client.println();
+    client.print("{\"success\": true, \"executed\": 0, \"stale\": true, \"rx\": ");
+    client.print(receivedMs);
+    client.print(", \"state\": ");
+    printStateSnapshot(client);
+    client.println("}");
+    return;
+  }
+
+  // 多控制板部署：等到执行时刻 at（本板时钟）再执行，各板的命令同时生效
+  bool timed = doc.containsKey("at");
+  BatchTiming timing = {0, 0, false};
+  if (timed) {
+    timing = scheduleBatch(doc["at"].as<uint32_t>(), millis(), MAX_BATCH_HOLD_MS);
+    if (timing.lateMs > 0) lateBatches++;
+    if (timing.outOfRange) {
+      wifiLogger.log("warn", arena.format("批次 %s 的执行时刻超出 %lums，立即执行", commandId, MAX_BATCH_HOLD_MS), "timing", millis());
+    }
+    if (!holdBatch(timing.holdMs)) {
+      sendError(client, 409, "Emergency stop in progress");
+      return;
+    }
+  }
+
+  Serial.print("收到批处理命令 ID: ");
+  Serial.print(commandId);
+  Serial.print(", 时间戳: ");
+  Serial.print(timestamp);
+  Serial.print(", 命令数: ");
+  Serial.println(commands.size());
+
+  // 每条命令的格式化文本（日志）在下一条命令开始前释放
+  size_t arenaMark = arena.mark();
+
+  for (JsonObject cmd : commands) {
+    arena.rewind(arenaMark);
+
+    const char* actionName = cmd["act"] | "";
+    CommandAction action = parseAction(actionName);
+
+    // 闭环参数 {act: "loop", lp, en, sp, kp, ki, kd, lo, hi}
+    if (action == ACTION_LOOP) {
+      if (applyControlLoopCommand(cmd)) {
+        executedCount++;
+      }
+      continue;
+    }
+    if (action == ACTION_UNKNOWN) {
+      Serial.print("未知动作: ");
+      Serial.println(actionName);
+      continue;
+    }
+
+    int value = cmd["val"];
+    int duration = cmd["dur"];
+
+    // 波形配置：每条命令只解析一次，分组成员共享
+    WaveformParams waveform;
+    const WaveformParams* waveformPtr = parseWaveform(cmd["prf"], waveform) ? &waveform : NULL;
+
+    // 分组命令：msk（位掩码）或 grp（分组ID），一次遍历作用于所有成员
+    if (cmd.containsKey("msk") || cmd.containsKey("grp")) {
+      uint32_t mask = cmd.containsKey("msk") ? cmd["msk"].as<uint32_t>() : lookupGroupMask(cmd["grp"]);
+      executedCount += executeMaskCommand(mask, action, value, duration, waveformPtr);
+      continue;
+    }
+
+    if (executeDeviceCommand(cmd["dev"] | "", action, value, duration, waveformPtr)) {
+      executedCount++;
+    }
+  }
+
+  // 返回结果
+  client.println("HTTP/1.1 200 OK");
+  client.println("Content-Type: application/json");
+  sendCORSHeaders(client);
+  client.println("Connection: close");
+  client.println();
+  client.print("{\"success\": true, \"executed\": ");
+  client.print(executedCount);
+  client.print(", \"rx\": ");
+  client.print(receivedMs);
+  if (timed) {
+    client.print(", \"late\": ");
+    client.print((unsigned long)timing.lateMs);
+  }
+  client.print(", \"state\": ");
+  printStateSnapshot(client);
+  client.println("}");
+
+  Serial.print("执行了 ");
+  Serial.print(executedCount);
+  Serial.println(" 个命令");
+}
+
+/**
+ * 处理HTTP急停请求（UDP通道的备用路径）
+ */
+void handleEmergencyStopRequest(WiFiClient& client) {
+  client.println("HTTP/1.1 200 OK");
+  client.println("Content-Type: application/json");
+  sendCORSHeaders(client);
+  client.println("Connection: close");
+  client.println();
+  client.print("{\"success\": true, \"estopCount\": ");
+  client.print(estopCount);
+  client.println("}");
+}
+
+/**
+ * 处理状态查询
+ */
+void handleStatusQuery(WiFiClient& client, const char* ifNoneMatch) {
+  // 状态ETag：上电标识-状态版本-串口错误帧数；与请求的 If-None-Match 相同时只回复304
+  char etag[40];
+  snprintf(etag, sizeof(etag), "\"%lx-%lu-%lu\"", bootNonce,
+           (unsigned long)bank.version(), (unsigned long)serialDecoder.errors());
+  if (strcmp(ifNoneMatch, etag) == 0) {
+    client.println("HTTP/1.1 304 Not Modified");
+    client.print("ETag: ");
+    client.println(etag);
+    sendCORSHeaders(client);
+    client.println("Connection: close");
+    client.println();
+    return;
+  }
+
+  // CORS
+  client.println("HTTP/1.1 200 OK");
+  client.print("ETag: ");
+  client.println(etag);
+  client.println("Content-Type: application/json");
+  sendCORSHeaders(client);
+  client.println("Connection: close");
+  client.println();
+
+  unsigned long uptime = millis() / 1000; // seconds
+  client.print("{\"status\": \"online\", \"board\": \"");
+  client.print(MANTA_BOARD_ID);
+  client.print("\", \"devices\": ");
+  client.print(MANTA_DEVICE_COUNT);
+  client.print(", \"manifestHash\": ");
+  client.print((unsigned long)MANTA_MANIFEST_HASH);
+  client.print(", \"uptimeSec\": ");
+  client.print(uptime);
+  client.print(", \"version\": ");
+  client.print((unsigned long)bank.version());
+  client.print(", \"estopCount\": ");
+  client.print(estopCount);
+  client.print(", \"serialFrameErrors\": ");
+  client.print((unsigned long)serialDecoder.errors());
+  client.print(", \"staleBatches\": ");
+  client.print((unsigned long)commandSequence.staleCount());
+  client.print(", \"estopLatched\": ");
+  client.print(commandSequence.fenced() ? "true" : "false");
+  client.print(", \"fencedBatches\": ");
+  client.print((unsigned long)commandSequence.fencedCount());
+  client.print(", \"lateBatches\": ");
+  client.print(lateBatches);
+  client.print(", \"boot\": {\"outputsMs\": ");
+  client.print(bootTimings.outputsReadyMs);
+  client.print(", \"apMs\": ");
+  client.print(bootTimings.apReadyMs);
+  client.print(", \"serverMs\": ");
+  client.print(bootTimings.serverReadyMs);
+  client.print(", \"firstCommandMs\": ");
+  client.print(bootTimings.firstCommandMs);
+  client.println("}}");
+}
+
+/**
+ * 处理运行计数查询
+ * {"up": 运行ms, "m": [[开启ms, 占空比加权ms, 切换次数, 最近变化ms], ...]}，按固件设备表顺序
+ */
+void handleMetricsQuery(WiFiClient& client) {
+  client.println("HTTP/1.1 200 OK");
+  client.println("Content-Type: application/json");
+  sendCORSHeaders(client);
+  client.println("Connection: close");
+  client.println();
+
+  unsigned long now = millis();
+  client.print("{\"up\": ");
+  client.print(now);
+  client.print(", \"m\": [");
+  for (int i = 0; i < MANTA_DEVICE_COUNT; i++) {
+    DeviceMetrics m = bank.metrics(i, now);
+    if (i > 0) client.print(",");
+    client.print("[");
+    client.print((unsigned long)m.onTimeMs);
+    client.print(",");
+    client.print((unsigned long)m.dutyTimeMs);
+    client.print(",");
+    client.print((unsigned long)m.switchCount);
+    client.print(",");
+    client.print((unsigned long)m.lastChangeMs);
+    client.print("]");
+  }
+  client.println("]}");
+}
+
+/**
+ * 输出JSON状态快照：{"v": 版本, "up": 运行ms, "dm": 占空比上限, "mh": 清单哈希, "d": [[当前值, 激活, 剩余ms], ...]}
+ * "d" 按固件设备表顺序排列
+ */
+void printStateSnapshot(WiFiClient& client) {
+  unsigned long now = millis();
+  client.print("{\"v\": ");
+  client.print((unsigned long)bank.version());
+  client.print(", \"up\": ");
+  client.print(now);
+  client.print(", \"dm\": ");
+  client.print(PWM_DUTY_MAX);
+  client.print(", \"mh\": ");
+  client.print((unsigned long)MANTA_MANIFEST_HASH);
+  client.print(", \"d\": [");
+  for (int i = 0; i < MANTA_DEVICE_COUNT; i++) {
+    const DeviceState& state = bank.state(i);
+    if (i > 0) client.print(",");
+    client.print("[");
+    client.print(state.currentValue);
+    client.print(state.isActive ? ",1," : ",0,");
+    client.print((unsigned long)bank.remaining(i, now));
+    client.print("]");
+  }
+  client.print("]}");
+}
+
+/**
+ * 处理CORS预检请求
+ */
+void handleCORSPreflight(WiFiClient& client) {
+  client.println("HTTP/1.1 200 OK");
+  sendCORSHeaders(client);
+  client.println("Connection: close");
+  client.println();
+}
+
+/**
+ * 发送404错误
+ */
+void send404(WiFiClient& client) {
+  client.println("HTTP/1.1 404 Not Found");
+  client.println("Content-Type: text/plain");
+  client.println("Connection: close");
+  client.println();
+  client.println("404 Not Found");
+}
+
+/**
+ * 发送错误响应
+ */
+void sendError(WiFiClient& client, int code, const char* message) {
+  client.print("HTTP/1.1 ");
+  client.print(code);
+  client.println(" Error");
+  client.println("Content-Type: application/json");
+  sendCORSHeaders(client);
+  client.println("Connection: close");
+  client.println();
+  client.print("{\"error\": \"");
+  client.print(message);
+  client.println("\"}");
+}
+
+/**
+ * 发送CORS头
+ */
+void sendCORSHeaders(WiFiClient& client) {
+  client.println("Access-Control-Allow-Origin: *");
+  client.println("Access-Control-Allow-Methods: GET, POST, OPTIONS");
+  client.println("Access-Control-Allow-Headers: Content-Type, If-None-Match");
+  client.println("Access-Control-Expose-Headers: ETag");
+}
+
+/**
+ * 初始化WiFi
+ * 主控制板创建热点；多控制板部署中的其他控制板以固定IP加入主控制板的热点
+ */
+void initializeWiFi() {
+#if MANTA_WIFI_STATION
+  joinAccessPoint();
+#else
+  Serial.println("正在创建WiFi热点...");
+
+  // 创建WiFi热点：beginAP 在模组完成配置后才返回，直接使用其返回状态，无需轮询等待
+  int apStatus = WiFi.beginAP(config::WIFI_SSID, config::WIFI_PASS);
+  if (apStatus != WL_AP_LISTENING) {
+    Serial.print("WiFi热点创建失败，状态码: ");
+    Serial.println(apStatus);
+    return;
+  }
+  bootTimings.apReadyMs = millis();
+
+  Serial.println("WiFi热点已创建");
+  Serial.print("热点名称: ");
+  Serial.println(config::WIFI_SSID);
+  Serial.print("IP地址: ");
+  Serial.println(WiFi.localIP());
+  Serial.println("其他设备可以连接此热点来控制Arduino");
+#endif
+}
+
+#if MANTA_WIFI_STATION
+/**
+ * 以固定IP加入主控制板的热点（后端按此地址发送命令）
+ */
+bool joinAccessPoint() {
+  Serial.print("正在加入热点 ");
+  Serial.println(config::WIFI_SSID);
+
+  WiFi.config(IPAddress(config::STATION_IP[0], config::STATION_IP[1], config::STATION_IP[2], config::STATION_IP[3]));
+  int status = WiFi.begin(config::WIFI_SSID, config::WIFI_PASS);
+  if (status != WL_CONNECTED) {
+    Serial.print("加入热点失败，状态码: ");
+    Serial.println(status);
+    return false;
+  }
+  bootTimings.apReadyMs = millis();
+
+  Serial.print("已加入热点，IP地址: ");
+  Serial.println(WiFi.localIP());
+  return true;
+}
+#endif
+
+/**
+ * 从站控制板断线后重新加入热点（主控制板重启时），每 WIFI_RETRY_INTERVAL_MS 最多尝试一次
+ */
+void maintainWiFi() {
+#if MANTA_WIFI_STATION
+  static unsigned long lastAttemptMs = 0;
+  if (WiFi.status() == WL_CONNECTED || millis() - lastAttemptMs < WIFI_RETRY_INTERVAL_MS) return;
+
+  lastAttemptMs = millis();
+  joinAccessPoint();
+#endif
+}
+
+}  // namespace manta
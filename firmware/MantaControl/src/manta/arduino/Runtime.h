@@ -0,0 +1,91 @@
+#pragma once
+
+/**
+ * 固件运行时状态
+ * 各模块共享的常量、全局对象与前向声明
+ */
+
+namespace manta {
+
+const unsigned long SERIAL_BAUD_RATE = 1000000;
+const int HTTP_LINE_MAX = 128;      // 请求行/请求头单行上限，超出部分丢弃
+const int HTTP_BODY_MAX = 2048;     // 请求体上限，从格式化缓冲区分配
+const size_t FORMAT_ARENA_SIZE = 3072;
+const unsigned long WAVEFORM_UPDATE_INTERVAL_US = 1000; // 1kHz 更新
+const unsigned long MAX_BATCH_HOLD_MS = 250;    // 定时批次最多等待的时间，超出视为时钟估计失效
+const unsigned long WIFI_RETRY_INTERVAL_MS = 10000;
+
+// ==================== 急停通道 ====================
+// UDP数据报 "ESTOP:<seq>" -> 关闭所有输出并回复 "ESTOP_ACK:<seq>"
+const unsigned int ESTOP_UDP_PORT = 8888;
+
+// ==================== 串口二进制协议 ====================
+// 发送帧前先写一个 0x00，使串口上的文本日志自成一段，被对端当作非帧数据丢弃
+const uint8_t FRAME_CMD = 0x01;     // [数量] + 数量 x [设备索引][动作 0=功率 1=开关][值][时长u32]
+const uint8_t FRAME_ESTOP = 0x02;
+const uint8_t FRAME_PING = 0x03;
+const uint8_t FRAME_LOOP = 0x04;    // 见 ControlLoop.h decodeControlLoopFrame
+const uint8_t FRAME_ACK = 0x81;     // [执行数] + 状态快照（见 DeviceBank::packSnapshot）
+const uint8_t FRAME_PONG = 0x83;    // [清单哈希u32]
+const size_t FRAME_MAX_SIZE = 256;
+const size_t FRAME_ENTRY_SIZE = 7;
+
+// ==================== 启动阶段时间戳 ====================
+// 单位 ms（相对上电），0 表示该阶段尚未发生；通过 /api/status 上报
+struct BootTimings {
+  unsigned long outputsReadyMs;  // 所有输出已置为安全状态
+  unsigned long apReadyMs;       // WiFi热点已建立（从站控制板：已加入热点）
+  unsigned long serverReadyMs;   // HTTP服务器开始监听
+  unsigned long firstCommandMs;  // 收到第一批命令
+};
+
+BootTimings bootTimings = {0, 0, 0, 0};
+unsigned long bootNonce = 0;      // 每次上电不同，与状态版本一起组成ETag，避免重启后版本号重复
+unsigned long estopCount = 0;     // 累计急停次数（也用于检测请求处理期间是否发生急停）
+unsigned long lastEstopMs = 0;
+unsigned long lastWaveformUpdateUs = 0;
+unsigned long lateBatches = 0;    // 到达时已过执行时刻的定时批次
+bool verboseCommandLog = true;    // 处理串口帧时关闭文本与WiFi日志，保证确定性延迟
+
+PwmOutputDriver outputDriver;
+DeviceBank<MANTA_DEVICE_COUNT, PwmOutputDriver> bank(config::DEVICES, outputDriver);
+FormatArena<FORMAT_ARENA_SIZE> arena;
+WiFiLogTransport logTransport;
+Logger<WiFiLogTransport> wifiLogger(logTransport);
+
+WiFiServer server(80);
+WiFiUDP estopUdp;
+FrameDecoder<FRAME_MAX_SIZE> serialDecoder;
+FrameEncoder<FRAME_MAX_SIZE> serialEncoder;
+CommandSequenceGate commandSequence;   // HTTP批处理命令按序号执行，丢弃迟到的旧批次
+
+#if MANTA_SENSOR_COUNT > 0
+const int SENSOR_ADC_BITS = 14;
+const size_t SENSOR_RING_SIZE = 32;                 // 每通道缓存的窗口数
+const unsigned long SENSOR_UPLOAD_INTERVAL_MS = 1000;
+const size_t SENSOR_UPLOAD_BUFFER_SIZE = 2048;
+const size_t SENSOR_UPLOAD_RESERVE = 64;            // 每通道头部与结尾预留（通道名长度由生成器限制）
+
+SensorChannel<SENSOR_RING_SIZE> sensorChannels[MANTA_SENSOR_COUNT];
+volatile unsigned long sensorOverflows = 0;         // 缓冲区满而丢弃的窗口数
+#endif
+
+#if MANTA_CONTROL_LOOP_COUNT > 0
+ControlLoop controlLoops[MANTA_CONTROL_LOOP_COUNT];
+#endif
+
+void emergencyStop();
+bool pollEmergencyStop();
+void updateWaveforms();
+void releaseControlLoops(int deviceIndex);
+void disableControlLoops();
+
+/**
+ * 打印到串口并上报到后端
+ */
+void logEvent(const char* level, const char* message, const char* category) {
+  Serial.println(message);
+  wifiLogger.log(level, message, category, millis());
+}
+
+}  // namespace manta
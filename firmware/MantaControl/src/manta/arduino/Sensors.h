@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+ * 传感器采样：定时器中断按分频采样，主循环批量上传 min/max/mean 窗口
+ */
+
+namespace manta {
+
+#if MANTA_SENSOR_COUNT > 0
+
+FspTimer sensorTimer;
+char sensorUploadBuffer[SENSOR_UPLOAD_BUFFER_SIZE];
+
+/**
+ * 采样定时器中断
+ */
+void onSensorTimer(timer_callback_args_t* args) {
+  (void)args;
+  for (int s = 0; s < MANTA_SENSOR_COUNT; s++) {
+    const SensorDescriptor& sensor = config::SENSORS[s];
+    SensorChannel<SENSOR_RING_SIZE>& ch = sensorChannels[s];
+    if (!ch.due(sensor.divider)) continue;
+
+    if (!ch.addSample(analogRead(sensor.pin), millis(), sensor.windowSamples)) {
+      sensorOverflows++;
+    }
+  }
+
+  // 闭环控制使用本次中断刚采到的值
+  runControlLoops();
+}
+
+/**
+ * 启动采样定时器（优先使用AGT，GPT留给PWM输出）
+ */
+bool initializeSensors() {
+  analogReadResolution(SENSOR_ADC_BITS);
+  for (int s = 0; s < MANTA_SENSOR_COUNT; s++) {
+    sensorChannels[s].reset();
+  }
+
+  uint8_t timerType = AGT_TIMER;
+  int8_t channel = FspTimer::get_available_timer(timerType);
+  if (channel < 0) {
+    timerType = GPT_TIMER;
+    channel = FspTimer::get_available_timer(timerType);
+  }
+  if (channel < 0) return false;
+
+  if (!sensorTimer.begin(TIMER_MODE_PERIODIC, timerType, channel, MANTA_SENSOR_TIMER_HZ, 0.0f, onSensorTimer)) return false;
+  if (!sensorTimer.setup_overflow_irq()) return false;
+  return sensorTimer.open() && sensorTimer.start();
+}
+
+/**
+ * 批量上传已完成的窗口：每 SENSOR_UPLOAD_INTERVAL_MS 一次，任一通道缓冲过半时提前上传
+ * 发送成功后才推进tail；一次放不下的窗口留到下一批
+ */
+void uploadSensorWindows() {
+  static unsigned long lastUploadMs = 0;
+  bool due = millis() - lastUploadMs >= SENSOR_UPLOAD_INTERVAL_MS;
+  for (int s = 0; s < MANTA_SENSOR_COUNT && !due; s++) {
+    due = sensorChannels[s].pending() >= SENSOR_RING_SIZE / 2;
+  }
+  if (!due) return;
+  lastUploadMs = millis();
+
+  uint8_t newTails[MANTA_SENSOR_COUNT];
+  size_t len = formatSensorBatch(sensorUploadBuffer, SENSOR_UPLOAD_BUFFER_SIZE, millis(), sensorOverflows,
+                                 sensorChannels, config::SENSORS, MANTA_SENSOR_COUNT,
+                                 SENSOR_UPLOAD_RESERVE, newTails);
+  if (len == 0) return;
+
+  // 连接失败时窗口保留在缓冲区，下次重试
+  if (!postToBackend("/api/sensors/batch", sensorUploadBuffer, len)) return;
+
+  for (int s = 0; s < MANTA_SENSOR_COUNT; s++) {
+    sensorChannels[s].consumeTo(newTails[s]);
+  }
+}
+
+#else
+
+bool initializeSensors() { return true; }
+void uploadSensorWindows() {}
+
+#endif
+
+}  // namespace manta
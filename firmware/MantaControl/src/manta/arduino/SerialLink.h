@@ -0,0 +1,107 @@
+#pragma once
+
+/**
+ * 串口二进制协议：COBS分帧 + CRC16，帧格式见 FrameCodec.h
+ */
+
+namespace manta {
+
+void handleSerialFrame();
+
+/**
+ * 发送一帧：[类型][序号][数据] + CRC16
+ */
+void sendFrame(uint8_t type, uint8_t seq, const uint8_t* data, size_t length) {
+  if (serialEncoder.encode(type, seq, data, length) == 0) return;
+
+  Serial.write((uint8_t)0);
+  Serial.write(serialEncoder.bytes(), serialEncoder.size());
+  Serial.write((uint8_t)0);
+}
+
+/**
+ * 发送确认帧：[执行数] + 状态快照
+ */
+void sendAckFrame(uint8_t seq, uint8_t executed) {
+  static_assert(1 + 11 + 7 * MANTA_DEVICE_COUNT <= FrameEncoder<FRAME_MAX_SIZE>::MAX_DATA, "状态快照超出串口帧长度");
+  uint8_t data[FrameEncoder<FRAME_MAX_SIZE>::MAX_DATA];
+  data[0] = executed;
+  size_t length = 1 + bank.packSnapshot(data + 1, millis());
+  sendFrame(FRAME_ACK, seq, data, length);
+}
+
+/**
+ * 读取串口字节，每收到完整一帧就处理
+ */
+void pollSerialCommands() {
+  while (Serial.available() > 0) {
+    if (serialDecoder.push(Serial.read())) {
+      handleSerialFrame();
+    }
+  }
+}
+
+/**
+ * 执行已通过校验的一帧
+ */
+void handleSerialFrame() {
+  uint8_t seq = serialDecoder.seq();
+  const uint8_t* data = serialDecoder.data();
+  size_t length = serialDecoder.dataLength();
+  uint8_t executed = 0;
+
+  switch (serialDecoder.type()) {
+    case FRAME_CMD: {
+      size_t count = length > 0 ? data[0] : 0;
+      if (length != 1 + count * FRAME_ENTRY_SIZE) {
+        serialDecoder.countError();
+        return;
+      }
+      if (bootTimings.firstCommandMs == 0) {
+        bootTimings.firstCommandMs = millis();
+      }
+
+      verboseCommandLog = false;
+      for (size_t e = 0; e < count; e++) {
+        const uint8_t* entry = data + 1 + e * FRAME_ENTRY_SIZE;
+        int deviceIndex = entry[0];
+        if (deviceIndex >= MANTA_DEVICE_COUNT) continue;
+        CommandAction action = entry[1] == 0 ? ACTION_POWER : ACTION_STATE;
+        if (applyDeviceCommand(deviceIndex, action, entry[2], readInt32LE(entry + 3), NULL)) {
+          executed++;
+        }
+      }
+      verboseCommandLog = true;
+      sendAckFrame(seq, executed);
+      break;
+    }
+    case FRAME_LOOP: {
+      ControlLoopUpdate update;
+      if (length != FRAME_LOOP_SIZE) {
+        serialDecoder.countError();
+        return;
+      }
+      if (applyControlLoopUpdate(decodeControlLoopFrame(data, update), update)) {
+        executed = 1;
+      }
+      sendAckFrame(seq, executed);
+      break;
+    }
+    case FRAME_ESTOP:
+      emergencyStop();
+      sendAckFrame(seq, MANTA_DEVICE_COUNT);
+      break;
+    case FRAME_PING: {
+      // 回复带上清单哈希，后端据此确认索引寻址可用
+      uint8_t pong[4];
+      writeUint32LE(pong, MANTA_MANIFEST_HASH);
+      sendFrame(FRAME_PONG, seq, pong, sizeof(pong));
+      break;
+    }
+    default:
+      serialDecoder.countError();
+      break;
+  }
+}
+
+}  // namespace manta
@@ -0,0 +1,96 @@
+#include <manta/Commands.h>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+TEST(mapsBackendAndLegacyActions) {
+  CHECK_EQ(parseAction("setPwr"), ACTION_POWER);
+  CHECK_EQ(parseAction("power"), ACTION_POWER);
+  CHECK_EQ(parseAction("set_power"), ACTION_POWER);
+  CHECK_EQ(parseAction("setSt"), ACTION_STATE);
+  CHECK_EQ(parseAction("set_state"), ACTION_STATE);
+  CHECK_EQ(parseAction("loop"), ACTION_LOOP);
+  CHECK_EQ(parseAction("jump"), ACTION_UNKNOWN);
+  CHECK_EQ(parseAction(nullptr), ACTION_UNKNOWN);
+}
+
+TEST(findsGroupMask) {
+  const GroupDescriptor groups[] = {{"all", 0x3F}, {"valve", 0x30}};
+  uint32_t mask = 0;
+  CHECK(findGroupMask(groups, 2, "valve", mask));
+  CHECK_EQ(mask, 0x30);
+  CHECK(!findGroupMask(groups, 2, "pumps", mask));
+  CHECK(!findGroupMask(groups, 2, nullptr, mask));
+}
+
+TEST(dropsStaleBatchesWithinSession) {
+  CommandSequenceGate gate;
+  CHECK(gate.accept(7, 1));
+  CHECK(gate.accept(7, 3));
+  CHECK(!gate.accept(7, 2));
+  CHECK(!gate.accept(7, 3));
+  CHECK(gate.accept(7, 4));
+  CHECK_EQ(gate.staleCount(), 2u);
+  CHECK_EQ(gate.lastSequence(), 4u);
+}
+
+TEST(restartsOnNewSession) {
+  CommandSequenceGate gate;
+  CHECK(gate.accept(7, 500));
+  CHECK(gate.accept(9, 1));
+  CHECK(gate.accept(9, 2));
+  CHECK(!gate.accept(9, 1));
+}
+
+TEST(acceptsSequenceWraparound) {
+  CommandSequenceGate gate;
+  CHECK(gate.accept(1, 0xFFFFFFFFu));
+  CHECK(gate.accept(1, 0));
+  CHECK(!gate.accept(1, 0xFFFFFFFEu));
+}
+
+TEST(latchesEmergencyStopUntilNewSession) {
+  CommandSequenceGate gate;
+  CHECK(gate.accept(7, 1));
+  gate.fence();
+  CHECK(gate.fenced());
+  // 急停前已发出、之后才读到的批次，序号再新也不执行
+  CHECK(!gate.accept(7, 2));
+  CHECK(!gate.accept(7, 3));
+  CHECK_EQ(gate.fencedCount(), 2u);
+  CHECK_EQ(gate.staleCount(), 0u);
+  // 后端以新会话重新开始
+  CHECK(gate.accept(8, 1));
+  CHECK(!gate.fenced());
+  CHECK(gate.accept(8, 2));
+}
+
+TEST(holdsBatchUntilExecutionTime) {
+  BatchTiming timing = scheduleBatch(1040, 1000, 250);
+  CHECK_EQ(timing.holdMs, 40u);
+  CHECK_EQ(timing.lateMs, 0u);
+  CHECK(!timing.outOfRange);
+}
+
+TEST(reportsLateBatches) {
+  BatchTiming timing = scheduleBatch(990, 1000, 250);
+  CHECK_EQ(timing.holdMs, 0u);
+  CHECK_EQ(timing.lateMs, 10u);
+
+  timing = scheduleBatch(1000, 1000, 250);
+  CHECK_EQ(timing.holdMs, 0u);
+  CHECK_EQ(timing.lateMs, 0u);
+}
+
+TEST(ignoresExecutionTimeBeyondHoldLimit) {
+  BatchTiming timing = scheduleBatch(5000, 1000, 250);
+  CHECK_EQ(timing.holdMs, 0u);
+  CHECK(timing.outOfRange);
+}
+
+TEST(holdsAcrossMillisWraparound) {
+  BatchTiming timing = scheduleBatch(20, 0xFFFFFFF0u, 250);
+  CHECK_EQ(timing.holdMs, 36u);
+  CHECK(!timing.outOfRange);
+}
@@ -0,0 +1,86 @@
+#include <manta/ControlLoop.h>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+namespace {
+
+// kp = 1.0，ki = 0.5/次，输出 0-4095
+const ControlLoopDescriptor DESCRIPTOR = {"hold", 0, 0, 1, false, 1000, 1 << 16, 1 << 15, 0, 0, 4095};
+
+ControlLoop makeLoop() {
+  ControlLoop loop;
+  initControlLoop(loop, DESCRIPTOR);
+  return loop;
+}
+
+}  // namespace
+
+TEST(disabledLoopTracksMeasurementOnly) {
+  ControlLoop loop = makeLoop();
+  CHECK(!stepControlLoop(loop, 800));
+  CHECK_EQ(loop.lastMeasurement, 800);
+  CHECK_EQ(loop.output, 0);
+}
+
+TEST(proportionalAndIntegralAction) {
+  ControlLoop loop = makeLoop();
+  enableControlLoop(loop, 0, 900);
+
+  // 误差100：P=100，I=50
+  CHECK(stepControlLoop(loop, 900));
+  CHECK_EQ(loop.output, 150);
+  // 积分继续累加
+  CHECK(stepControlLoop(loop, 900));
+  CHECK_EQ(loop.output, 200);
+}
+
+TEST(outputAndIntegralSaturate) {
+  ControlLoop loop = makeLoop();
+  enableControlLoop(loop, 0, 0);
+  for (int i = 0; i < 100; i++) stepControlLoop(loop, 0);
+  CHECK_EQ(loop.output, 4095);
+  CHECK_EQ(loop.integral, (int64_t)4095 << PID_FRACTION_BITS);
+
+  // 超调后积分不需要先“放空”
+  stepControlLoop(loop, 1100);
+  CHECK(loop.output < 4095);
+}
+
+TEST(enableIsBumpless) {
+  ControlLoop loop = makeLoop();
+  enableControlLoop(loop, 2000, 1000);
+  CHECK(!stepControlLoop(loop, 1000));
+  CHECK_EQ(loop.output, 2000);
+}
+
+TEST(paramsAreClamped) {
+  ControlLoop loop = makeLoop();
+  ControlLoopUpdate update = {LOOP_SET_SETPOINT | LOOP_SET_LIMITS, 20000, 0, 0, 0, 3000, 5000};
+  applyControlLoopParams(loop, update, 4095);
+  CHECK_EQ(loop.setpoint, SENSOR_ADC_MAX);
+  CHECK_EQ(loop.outMax, 4095);
+  CHECK_EQ(loop.outMin, 3000);
+  CHECK_EQ(loop.kp, 1 << 16);
+}
+
+TEST(decodesLoopFrame) {
+  const uint8_t data[FRAME_LOOP_SIZE] = {
+    2, LOOP_SET_GAINS | LOOP_ENABLE,
+    0x10, 0x27, 0, 0,          // 10000
+    0, 0, 1, 0,                // 65536
+    0xFF, 0xFF, 0xFF, 0xFF,    // -1
+    3, 0, 0, 0,
+    0x10, 0, 0xFF, 0x0F
+  };
+  ControlLoopUpdate update;
+  CHECK_EQ(decodeControlLoopFrame(data, update), 2);
+  CHECK_EQ(update.flags, LOOP_SET_GAINS | LOOP_ENABLE);
+  CHECK_EQ(update.setpoint, 10000);
+  CHECK_EQ(update.kp, 65536);
+  CHECK_EQ(update.ki, -1);
+  CHECK_EQ(update.kd, 3);
+  CHECK_EQ(update.outMin, 16);
+  CHECK_EQ(update.outMax, 4095);
+}
@@ -0,0 +1,52 @@
+#include <manta/DeadlineTable.h>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+TEST(expiresAtDeadline) {
+  DeadlineTable<4> table;
+  CHECK(table.empty());
+  table.arm(2, 1000, 500);
+  CHECK(table.armed(2));
+  CHECK_EQ(table.remaining(2, 1200), 300);
+  CHECK_EQ(table.popExpired(1499), -1);
+  CHECK_EQ(table.popExpired(1500), 2);
+  CHECK(!table.armed(2));
+  CHECK_EQ(table.popExpired(2000), -1);
+}
+
+TEST(zeroDurationCancels) {
+  DeadlineTable<4> table;
+  table.arm(1, 0, 100);
+  table.arm(1, 50, 0);
+  CHECK(!table.armed(1));
+  CHECK_EQ(table.remaining(1, 60), 0);
+}
+
+TEST(survivesMillisWraparound) {
+  DeadlineTable<4> table;
+  uint32_t now = 0xFFFFFF00UL;
+  table.arm(0, now, 0x200);
+  CHECK_EQ(table.popExpired(now + 0x100), -1);
+  CHECK_EQ(table.remaining(0, now + 0x100), 0x100);
+  CHECK_EQ(table.popExpired(now + 0x200), 0);
+}
+
+TEST(popsEveryExpiredEntry) {
+  DeadlineTable<32> table;
+  table.arm(0, 0, 10);
+  table.arm(31, 0, 10);
+  table.arm(5, 0, 1000);
+
+  int first = table.popExpired(20);
+  int second = table.popExpired(20);
+  CHECK(first != second);
+  CHECK(first == 0 || first == 31);
+  CHECK(second == 0 || second == 31);
+  CHECK_EQ(table.popExpired(20), -1);
+  CHECK(table.armed(5));
+
+  table.clear();
+  CHECK(table.empty());
+}
@@ -0,0 +1,178 @@
+#include <manta/DeviceBank.h>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+namespace {
+
+struct FakeDriver {
+  int duty[3] = {-1, -1, -1};
+  int digital[3] = {-1, -1, -1};
+  int writes = 0;
+
+  void begin(size_t i) {
+    duty[i] = 0;
+    digital[i] = 0;
+  }
+  void writeDuty(size_t i, uint16_t value) {
+    duty[i] = value;
+    writes++;
+  }
+  void writeDigital(size_t i, bool on) {
+    digital[i] = on ? 1 : 0;
+    writes++;
+  }
+};
+
+const DeviceDescriptor DEVICES[] = {
+  {"pump", 5, DEVICE_PWM, 490.0f, 4095},
+  {"limited", 6, DEVICE_PWM, 490.0f, 2048},
+  {"valve", 2, DEVICE_DIGITAL, 0.0f, 0},
+};
+
+}  // namespace
+
+TEST(powerCommandWritesScaledDuty) {
+  FakeDriver driver;
+  DeviceBank<3, FakeDriver> bank(DEVICES, driver);
+  bank.begin();
+
+  CHECK(bank.setPower(0, 50, 0, nullptr, 100));
+  CHECK_EQ(driver.duty[0], 2047);
+  CHECK_EQ(bank.state(0).currentValue, 2047);
+  CHECK(bank.state(0).isActive);
+  CHECK_EQ(bank.version(), 1);
+
+  // maxPower 限幅
+  CHECK(bank.setPower(1, 100, 0, nullptr, 100));
+  CHECK_EQ(driver.duty[1], 2048);
+
+  // 数字设备不支持功率命令
+  CHECK(!bank.setPower(2, 100, 0, nullptr, 100));
+  CHECK_EQ(bank.version(), 2);
+}
+
+TEST(timedCommandExpires) {
+  FakeDriver driver;
+  DeviceBank<3, FakeDriver> bank(DEVICES, driver);
+  bank.begin();
+
+  bank.setState(2, 1, 1500, 1000);
+  CHECK_EQ(driver.digital[2], 1);
+  CHECK_EQ(bank.remaining(2, 2000), 500);
+  CHECK_EQ(bank.expire(2499), -1);
+  CHECK_EQ(bank.expire(2500), 2);
+  CHECK_EQ(driver.digital[2], 0);
+  CHECK(!bank.state(2).isActive);
+  CHECK_EQ(bank.remaining(2, 2500), 0);
+}
+
+TEST(newCommandWithoutDurationCancelsTimer) {
+  FakeDriver driver;
+  DeviceBank<3, FakeDriver> bank(DEVICES, driver);
+  bank.begin();
+
+  bank.setPower(0, 80, 1000, nullptr, 0);
+  bank.setPower(0, 40, 0, nullptr, 10);
+  CHECK_EQ(bank.expire(5000), -1);
+  CHECK_EQ(bank.state(0).currentValue, 1638);
+}
+
+TEST(waveformRunsAndHoldsFinalValue) {
+  FakeDriver driver;
+  DeviceBank<3, FakeDriver> bank(DEVICES, driver);
+  bank.begin();
+
+  WaveformParams ramp;
+  makeWaveform(WAVE_RAMP, 1000, 100, 0, 1, ramp);
+  bank.setPower(0, 0, 0, &ramp, 0);
+  CHECK(bank.waveformActive(0));
+  CHECK_EQ(driver.duty[0], 0);
+
+  bank.updateWaveforms(500);
+  CHECK_EQ(driver.duty[0], 2047);
+
+  uint32_t version = bank.version();
+  bank.updateWaveforms(1000);
+  CHECK(!bank.waveformActive(0));
+  CHECK_EQ(driver.duty[0], 4095);
+  CHECK(bank.state(0).isActive);
+  CHECK_EQ(bank.version(), version + 1);
+
+  // 空闲时不写输出
+  int writes = driver.writes;
+  bank.updateWaveforms(1500);
+  CHECK_EQ(driver.writes, writes);
+}
+
+TEST(stopAllTurnsEverythingOff) {
+  FakeDriver driver;
+  DeviceBank<3, FakeDriver> bank(DEVICES, driver);
+  bank.begin();
+
+  WaveformParams sine;
+  makeWaveform(WAVE_SINE, 100, 50, 0, 0, sine);
+  bank.setPower(0, 0, 0, &sine, 0);
+  bank.setPower(1, 70, 5000, nullptr, 0);
+  bank.setState(2, 1, 0, 0);
+
+  bank.stopAll(10);
+  for (size_t i = 0; i < 3; i++) {
+    CHECK_EQ(bank.state(i).currentValue, 0);
+    CHECK(!bank.state(i).isActive);
+    CHECK(!bank.waveformActive(i));
+  }
+  CHECK_EQ(driver.duty[0], 0);
+  CHECK_EQ(driver.duty[1], 0);
+  CHECK_EQ(driver.digital[2], 0);
+  CHECK_EQ(bank.expire(10000), -1);
+}
+
+TEST(metricsAccumulateOnTime) {
+  FakeDriver driver;
+  DeviceBank<3, FakeDriver> bank(DEVICES, driver);
+  bank.begin();
+
+  bank.setPower(0, 50, 0, nullptr, 1000);
+  bank.setPower(0, 0, 0, nullptr, 3000);
+  bank.setState(2, 1, 0, 4000);
+
+  DeviceMetrics pump = bank.metrics(0, 5000);
+  CHECK_EQ(pump.onTimeMs, 2000);
+  CHECK_EQ(pump.dutyTimeMs, 999);
+  CHECK_EQ(pump.switchCount, 2);
+  CHECK_EQ(pump.lastChangeMs, 3000);
+
+  // 仍开启的设备补算到查询时刻
+  DeviceMetrics valve = bank.metrics(2, 5000);
+  CHECK_EQ(valve.onTimeMs, 1000);
+  CHECK_EQ(valve.dutyTimeMs, 1000);
+  CHECK_EQ(valve.switchCount, 1);
+}
+
+TEST(snapshotLayout) {
+  FakeDriver driver;
+  DeviceBank<3, FakeDriver> bank(DEVICES, driver);
+  bank.begin();
+  bank.setState(2, 1, 300, 100);
+
+  uint8_t out[11 + 7 * 3];
+  CHECK_EQ(bank.packSnapshot(out, 200), sizeof(out));
+  CHECK_EQ(readInt32LE(out), 1);
+  CHECK_EQ(readInt32LE(out + 4), 200);
+  CHECK_EQ(readUint16LE(out + 8), PWM_DUTY_MAX);
+  CHECK_EQ(out[10], 3);
+
+  const uint8_t* valve = out + 11 + 7 * 2;
+  CHECK_EQ(readUint16LE(valve), 1);
+  CHECK_EQ(valve[2], 1);
+  CHECK_EQ(readInt32LE(valve + 3), 200);
+}
+
+TEST(findByName) {
+  FakeDriver driver;
+  DeviceBank<3, FakeDriver> bank(DEVICES, driver);
+  CHECK_EQ(bank.find("valve"), 2);
+  CHECK_EQ(bank.find("missing"), -1);
+}
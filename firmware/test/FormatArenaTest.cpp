@@ -0,0 +1,41 @@
+#include <manta/FormatArena.h>
+
+#include <string.h>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+TEST(formatReturnsStableStrings) {
+  FormatArena<64> arena;
+  const char* a = arena.format("设备 %s", "valve_1");
+  const char* b = arena.format("%d%%", 42);
+  CHECK(strcmp(a, "设备 valve_1") == 0);
+  CHECK(strcmp(b, "42%") == 0);
+  CHECK_EQ(arena.mark(), strlen(a) + 1 + strlen(b) + 1);
+}
+
+TEST(formatTruncatesWhenFull) {
+  FormatArena<8> arena;
+  const char* text = arena.format("%s", "0123456789");
+  CHECK(strcmp(text, "0123456") == 0);
+  CHECK_EQ(arena.mark(), 8);
+  CHECK(strcmp(arena.format("x"), "") == 0);
+  CHECK(arena.alloc(1) == NULL);
+}
+
+TEST(rewindReleasesLaterAllocations) {
+  FormatArena<32> arena;
+  arena.format("keep");
+  size_t mark = arena.mark();
+  arena.format("drop this");
+  arena.rewind(mark);
+  CHECK_EQ(arena.mark(), mark);
+
+  char* p = arena.alloc(32 - mark);
+  CHECK(p != NULL);
+  CHECK(arena.alloc(1) == NULL);
+
+  arena.reset();
+  CHECK_EQ(arena.mark(), 0);
+}
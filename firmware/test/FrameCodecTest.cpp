@@ -0,0 +1,115 @@
+#include <manta/FrameCodec.h>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+namespace {
+
+template <size_t MaxSize>
+bool feed(FrameDecoder<MaxSize>& decoder, const uint8_t* bytes, size_t length) {
+  bool complete = false;
+  for (size_t i = 0; i < length; i++) {
+    complete = decoder.push(bytes[i]);
+  }
+  return complete;
+}
+
+}  // namespace
+
+TEST(crc16MatchesCcittFalseCheckValue) {
+  const uint8_t data[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  CHECK_EQ(crc16(data, sizeof(data)), 0x29B1);
+}
+
+TEST(cobsRoundTripsZerosAndLongRuns) {
+  uint8_t input[600];
+  for (size_t i = 0; i < sizeof(input); i++) {
+    input[i] = (i % 97 == 0) ? 0 : (uint8_t)(i & 0xFF) | 1;
+  }
+  uint8_t encoded[sizeof(input) + sizeof(input) / 254 + 1];
+  uint8_t decoded[sizeof(input) + 8];
+
+  size_t encodedLength = cobsEncode(input, sizeof(input), encoded);
+  for (size_t i = 0; i < encodedLength; i++) {
+    CHECK(encoded[i] != 0);
+  }
+  CHECK_EQ(cobsDecode(encoded, encodedLength, decoded), (int)sizeof(input));
+  CHECK(memcmp(input, decoded, sizeof(input)) == 0);
+}
+
+TEST(cobsRejectsTruncatedBlock) {
+  const uint8_t bad[] = {0x05, 0x11, 0x22};
+  uint8_t out[8];
+  CHECK_EQ(cobsDecode(bad, sizeof(bad), out), -1);
+}
+
+TEST(encodedFrameDecodes) {
+  FrameEncoder<256> encoder;
+  FrameDecoder<256> decoder;
+  const uint8_t data[] = {2, 0, 1, 0x10, 0, 0, 0};
+
+  size_t length = encoder.encode(0x01, 7, data, sizeof(data));
+  CHECK(length > 0);
+  CHECK(!feed(decoder, encoder.bytes(), length));
+  CHECK(decoder.push(0));
+  CHECK_EQ(decoder.type(), 0x01);
+  CHECK_EQ(decoder.seq(), 7);
+  CHECK_EQ(decoder.dataLength(), sizeof(data));
+  CHECK(memcmp(decoder.data(), data, sizeof(data)) == 0);
+  CHECK_EQ(decoder.errors(), 0);
+}
+
+TEST(decoderCountsCrcErrors) {
+  FrameEncoder<64> encoder;
+  FrameDecoder<64> decoder;
+  const uint8_t data[] = {9, 9, 9};
+
+  size_t length = encoder.encode(0x03, 1, data, sizeof(data));
+  uint8_t corrupted[64];
+  memcpy(corrupted, encoder.bytes(), length);
+  corrupted[2] ^= 0x40;
+  if (corrupted[2] == 0) corrupted[2] = 0x01;
+
+  feed(decoder, corrupted, length);
+  CHECK(!decoder.push(0));
+  CHECK_EQ(decoder.errors(), 1);
+}
+
+TEST(decoderDropsOversizedFrameAndRecovers) {
+  FrameDecoder<16> decoder;
+  for (int i = 0; i < 40; i++) decoder.push(0x55);
+  CHECK(!decoder.push(0));
+  CHECK_EQ(decoder.errors(), 1);
+
+  FrameEncoder<16> encoder;
+  size_t length = encoder.encode(0x03, 2, nullptr, 0);
+  feed(decoder, encoder.bytes(), length);
+  CHECK(decoder.push(0));
+  CHECK_EQ(decoder.seq(), 2);
+  CHECK_EQ(decoder.dataLength(), 0);
+}
+
+TEST(emptyFramesBetweenDelimitersAreIgnored) {
+  FrameDecoder<16> decoder;
+  CHECK(!decoder.push(0));
+  CHECK(!decoder.push(0));
+  CHECK_EQ(decoder.errors(), 0);
+}
+
+TEST(encoderRejectsOversizedData) {
+  FrameEncoder<16> encoder;
+  uint8_t data[16] = {0};
+  CHECK_EQ(encoder.encode(0x81, 0, data, FrameEncoder<16>::MAX_DATA + 1), 0);
+  CHECK(encoder.encode(0x81, 0, data, FrameEncoder<16>::MAX_DATA) > 0);
+}
+
+TEST(littleEndianHelpers) {
+  uint8_t buffer[6];
+  CHECK_EQ(writeUint32LE(buffer, 0x80000001UL), 4);
+  CHECK_EQ(buffer[0], 0x01);
+  CHECK_EQ(buffer[3], 0x80);
+  CHECK_EQ(readInt32LE(buffer), (int32_t)0x80000001UL);
+  writeUint16LE(buffer + 4, 0xBEEF);
+  CHECK_EQ(readUint16LE(buffer + 4), 0xBEEF);
+}
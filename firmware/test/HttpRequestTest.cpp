@@ -0,0 +1,41 @@
+#include <manta/HttpRequest.h>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+TEST(parsesContentLengthCaseInsensitive) {
+  HttpRequestHead head;
+  parseHeaderLine(head, "Content-Length: 42");
+  CHECK_EQ(head.contentLength, 42);
+  parseHeaderLine(head, "content-length:-3");
+  CHECK_EQ(head.contentLength, 0);
+}
+
+TEST(copiesIfNoneMatchWithoutLeadingSpace) {
+  HttpRequestHead head;
+  parseHeaderLine(head, "If-None-Match: \t\"1a-7-0\"");
+  CHECK(strcmp(head.ifNoneMatch, "\"1a-7-0\"") == 0);
+}
+
+TEST(truncatesLongHeaderValues) {
+  HttpRequestHead head;
+  char line[128] = "if-none-match: ";
+  memset(line + 15, 'x', 100);
+  line[115] = '\0';
+  parseHeaderLine(head, line);
+  CHECK_EQ(strlen(head.ifNoneMatch), sizeof(head.ifNoneMatch) - 1);
+}
+
+TEST(ignoresOtherHeaders) {
+  HttpRequestHead head;
+  parseHeaderLine(head, "Host: 192.168.4.1");
+  CHECK_EQ(head.contentLength, 0);
+  CHECK(head.ifNoneMatch[0] == '\0');
+}
+
+TEST(matchesMethodAndPathPrefix) {
+  CHECK(requestIs("POST /api/commands HTTP/1.1", "POST /api/commands"));
+  CHECK(requestIs("GET /api/status?x=1 HTTP/1.1", "GET /api/status"));
+  CHECK(!requestIs("GET /api/commands HTTP/1.1", "POST /api/commands"));
+}
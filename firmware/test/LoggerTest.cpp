@@ -0,0 +1,73 @@
+#include <manta/Logger.h>
+
+#include <string>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+namespace {
+
+struct FakeTransport {
+  bool online = true;
+  int posts = 0;
+  std::string lastBody;
+
+  bool post(const char* body, size_t length) {
+    if (!online) return false;
+    posts++;
+    lastBody.assign(body, length);
+    return true;
+  }
+};
+
+}  // namespace
+
+TEST(escapeJsonEscapesQuotesAndDropsControlBytes) {
+  char out[64];
+  size_t length = escapeJson(out, sizeof(out), "a\"b\\c\nd\x01");
+  CHECK(strcmp(out, "a\\\"b\\\\c\\nd") == 0);
+  CHECK_EQ(length, strlen(out));
+}
+
+TEST(escapeJsonStopsBeforeOverflow) {
+  char out[6];
+  escapeJson(out, sizeof(out), "\"\"\"\"");
+  CHECK(strcmp(out, "\\\"\\\"") == 0);
+}
+
+TEST(warningsAreSentImmediately) {
+  FakeTransport transport;
+  Logger<FakeTransport> logger(transport);
+  logger.log("warn", "a", "http", 10);
+  logger.log("error", "b", "http", 20);
+  CHECK_EQ(transport.posts, 2);
+  CHECK(transport.lastBody == "{\"timestamp\":20,\"level\":\"error\",\"message\":\"b\",\"category\":\"http\"}");
+}
+
+TEST(infoIsRateLimited) {
+  FakeTransport transport;
+  Logger<FakeTransport> logger(transport);
+  logger.log("info", "first", "x", 1000);
+  logger.log("info", "dropped", "x", 1500);
+  logger.log("info", "second", "x", 2000);
+  CHECK_EQ(transport.posts, 2);
+  CHECK(transport.lastBody.find("second") != std::string::npos);
+}
+
+TEST(failedLogIsRetried) {
+  FakeTransport transport;
+  transport.online = false;
+  Logger<FakeTransport> logger(transport);
+  logger.log("error", "lost?", "x", 5);
+  CHECK(logger.pending());
+
+  transport.online = true;
+  logger.retry();
+  CHECK(!logger.pending());
+  CHECK_EQ(transport.posts, 1);
+  CHECK(transport.lastBody.find("lost?") != std::string::npos);
+
+  logger.retry();
+  CHECK_EQ(transport.posts, 1);
+}
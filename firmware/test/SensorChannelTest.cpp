@@ -0,0 +1,97 @@
+#include <manta/SensorChannel.h>
+
+#include <string.h>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+namespace {
+
+const SensorDescriptor SENSORS[] = {
+  {"pressure_1", 14, 1, 4},
+  {"temp_1", 15, 3, 2},
+};
+
+}  // namespace
+
+TEST(dividerSkipsTicks) {
+  SensorChannel<8> channel;
+  int samples = 0;
+  for (int t = 0; t < 9; t++) {
+    if (channel.due(3)) samples++;
+  }
+  CHECK_EQ(samples, 3);
+}
+
+TEST(windowSummarisesSamples) {
+  SensorChannel<8> channel;
+  const uint16_t samples[] = {10, 30, 20, 40};
+  for (int i = 0; i < 4; i++) {
+    CHECK(channel.addSample(samples[i], 100 + i, 4));
+  }
+  CHECK_EQ(channel.latest(), 40);
+  CHECK_EQ(channel.pending(), 1);
+
+  const SensorWindow& w = channel.at(channel.readPosition());
+  CHECK_EQ(w.startMs, 100);
+  CHECK_EQ(w.min, 10);
+  CHECK_EQ(w.max, 40);
+  CHECK_EQ(w.mean, 25);
+}
+
+TEST(fullRingDropsWindows) {
+  SensorChannel<4> channel;
+  int dropped = 0;
+  for (int w = 0; w < 5; w++) {
+    if (!channel.addSample(1, w, 1)) dropped++;
+  }
+  // 环形缓冲区保留一个空位区分空与满
+  CHECK_EQ(channel.pending(), 3);
+  CHECK_EQ(dropped, 2);
+
+  channel.consumeTo(channel.writePosition());
+  CHECK_EQ(channel.pending(), 0);
+  CHECK(channel.addSample(1, 10, 1));
+}
+
+TEST(batchFormatsAllChannels) {
+  SensorChannel<8> channels[2];
+  for (int i = 0; i < 4; i++) channels[0].addSample(100, 1000 + i, 4);
+  channels[1].addSample(7, 2000, 2);
+  channels[1].addSample(9, 2001, 2);
+
+  char buffer[256];
+  uint8_t tails[2];
+  size_t length = formatSensorBatch(buffer, sizeof(buffer), 5000, 3, channels, SENSORS, 2, 64, tails);
+  CHECK(length > 0);
+  CHECK(strcmp(buffer, "{\"up\":5000,\"ov\":3,\"s\":[{\"id\":\"pressure_1\",\"d\":[[1000,100,100,100]]},"
+                       "{\"id\":\"temp_1\",\"d\":[[2000,7,9,8]]}]}") == 0);
+  CHECK_EQ(length, strlen(buffer));
+  CHECK_EQ(tails[0], channels[0].writePosition());
+  CHECK_EQ(tails[1], channels[1].writePosition());
+
+  // 未提交前窗口仍在缓冲区
+  CHECK_EQ(channels[0].pending(), 1);
+}
+
+TEST(batchLeavesWindowsThatDoNotFit) {
+  SensorChannel<32> channels[1];
+  for (int w = 0; w < 20; w++) channels[0].addSample(1, w, 1);
+
+  char buffer[128];
+  uint8_t tails[1];
+  size_t length = formatSensorBatch(buffer, sizeof(buffer), 0, 0, channels, SENSORS, 1, 16, tails);
+  CHECK(length > 0);
+  CHECK(length < sizeof(buffer));
+  channels[0].consumeTo(tails[0]);
+  CHECK(channels[0].pending() > 0);
+  CHECK(channels[0].pending() < 20);
+}
+
+TEST(emptyBatchIsNotUploaded) {
+  SensorChannel<8> channels[2];
+  char buffer[128];
+  uint8_t tails[2];
+  CHECK_EQ(formatSensorBatch(buffer, sizeof(buffer), 0, 0, channels, SENSORS, 2, 64, tails), 0);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdio.h>
+
+/**
+ * 最小单元测试框架：TEST 注册用例，CHECK/CHECK_EQ 失败时记录并继续
+ */
+
+namespace manta_test {
+
+typedef void (*TestFunction)();
+
+struct TestCase {
+  const char* name;
+  TestFunction function;
+  TestCase* next;
+};
+
+TestCase*& registry();
+int& failures();
+
+struct Registrar {
+  TestCase testCase;
+
+  Registrar(const char* name, TestFunction function) : testCase{name, function, nullptr} {
+    TestCase** tail = &registry();
+    while (*tail) tail = &(*tail)->next;
+    *tail = &testCase;
+  }
+};
+
+inline void fail(const char* file, int line, const char* expression) {
+  printf("  %s:%d: CHECK(%s) failed\n", file, line, expression);
+  failures()++;
+}
+
+}  // namespace manta_test
+
+#define TEST(name)                                                        \
+  static void name();                                                     \
+  static manta_test::Registrar name##Registrar(#name, name);              \
+  static void name()
+
+#define CHECK(expression)                                                 \
+  do {                                                                    \
+    if (!(expression)) manta_test::fail(__FILE__, __LINE__, #expression); \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                        \
+  do {                                                                    \
+    long long actualValue = (long long)(actual);                          \
+    long long expectedValue = (long long)(expected);                      \
+    if (actualValue != expectedValue) {                                   \
+      printf("  %s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__,  \
+             #actual, actualValue, expectedValue);                        \
+      manta_test::failures()++;                                           \
+    }                                                                     \
+  } while (0)
@@ -0,0 +1,27 @@
+#include "TestHarness.h"
+
+namespace manta_test {
+
+TestCase*& registry() {
+  static TestCase* head = nullptr;
+  return head;
+}
+
+int& failures() {
+  static int count = 0;
+  return count;
+}
+
+}  // namespace manta_test
+
+int main() {
+  int cases = 0;
+  for (manta_test::TestCase* t = manta_test::registry(); t; t = t->next) {
+    int before = manta_test::failures();
+    t->function();
+    printf("%s %s\n", manta_test::failures() == before ? "PASS" : "FAIL", t->name);
+    cases++;
+  }
+  printf("%d cases, %d failed checks\n", cases, manta_test::failures());
+  return manta_test::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <manta/Waveform.h>
+
+#include "TestHarness.h"
+
+using namespace manta;
+
+namespace {
+
+WaveformParams wave(int shape, uint32_t periodMs, int amplitude, int offset, unsigned int cycles = 0) {
+  WaveformParams params;
+  makeWaveform(shape, periodMs, amplitude, offset, cycles, params);
+  return params;
+}
+
+}  // namespace
+
+TEST(makeWaveformClampsParameters) {
+  WaveformParams params;
+  CHECK(!makeWaveform(7, 100, 50, 0, 0, params));
+  CHECK(makeWaveform(WAVE_SINE, 0, 150, 20, 3, params));
+  CHECK_EQ(params.periodMs, 1);
+  CHECK_EQ(params.amplitude, 100);
+  CHECK_EQ(params.offset, 0);
+  CHECK(makeWaveform(WAVE_RAMP, 10000000UL, 60, 70, 0, params));
+  CHECK_EQ(params.periodMs, WAVEFORM_MAX_PERIOD_MS);
+  CHECK_EQ(params.offset, 40);
+}
+
+TEST(rampClimbsFromOffset) {
+  WaveformParams ramp = wave(WAVE_RAMP, 1000, 50, 20);
+  CHECK_EQ(evaluateWaveform(ramp, 0), 200);
+  CHECK_EQ(evaluateWaveform(ramp, 500), 450);
+  CHECK(evaluateWaveform(ramp, 999) <= 700);
+}
+
+TEST(squareAndSineShapes) {
+  WaveformParams square = wave(WAVE_SQUARE, 100, 100, 0);
+  CHECK_EQ(evaluateWaveform(square, 10), 1000);
+  CHECK_EQ(evaluateWaveform(square, 60), 0);
+
+  WaveformParams sine = wave(WAVE_SINE, 1000, 100, 0);
+  CHECK_EQ(evaluateWaveform(sine, 0), 0);
+  CHECK_EQ(evaluateWaveform(sine, 500), 1000);
+  CHECK_EQ(evaluateWaveform(sine, 250), 500);
+}
+
+TEST(easeIsMonotonic) {
+  WaveformParams ease = wave(WAVE_EASE, 1000, 100, 0);
+  uint32_t previous = 0;
+  for (uint32_t t = 0; t < 1000; t += 10) {
+    uint32_t value = evaluateWaveform(ease, t);
+    CHECK(value >= previous);
+    previous = value;
+  }
+}
+
+TEST(finishedWaveformHoldsOrReturns) {
+  uint32_t finalPermille = 0;
+  WaveformParams ramp = wave(WAVE_RAMP, 100, 50, 10, 2);
+  CHECK(!waveformFinished(ramp, 199, finalPermille));
+  CHECK(waveformFinished(ramp, 200, finalPermille));
+  CHECK_EQ(finalPermille, 600);
+
+  WaveformParams sine = wave(WAVE_SINE, 100, 50, 10, 1);
+  CHECK(waveformFinished(sine, 100, finalPermille));
+  CHECK_EQ(finalPermille, 100);
+
+  WaveformParams endless = wave(WAVE_SINE, 100, 50, 10, 0);
+  CHECK(!waveformFinished(endless, 1000000, finalPermille));
+}
@@ -26,11 +26,13 @@ export default function ArduinoCodeGenerator({ devices, isOpen, onClose }: Ardui
     isGenerating,
     generatedCode,
     metadata,
+    boards,
     validation,
     error,
     isCopied,
     hasCode,
     generateArduinoCode,
+    selectBoard,
     copyCode,
     downloadCode,
     validateConfig,
@@ -57,6 +59,9 @@ export default function ArduinoCodeGenerator({ devices, isOpen, onClose }: Ardui
   // 验证配置
   const currentValidation = validation || validateConfig(devices);
 
+  // 当前显示的控制板（单控制板时不显示切换）
+  const currentBoardId: string = metadata?.boardId || 'main';
+
   return (
     <AnimatePresence>
       {isOpen && (
@@ -131,7 +136,7 @@ export default function ArduinoCodeGenerator({ devices, isOpen, onClose }: Ardui
                   <div className="space-y-1">
                     {devices.map(device => (
                       <div key={device.id} className="text-xs text-gray-600 ml-4">
-                        • {device.name} ({device.id}): 引脚{device.pin} {device.type.toUpperCase()}
+                        • {device.name} ({device.id}): {device.boardId ? `${device.boardId} ` : ''}引脚{device.pin} {device.type.toUpperCase()}
                       </div>
                     ))}
                   </div>
@@ -169,6 +174,25 @@ export default function ArduinoCodeGenerator({ devices, isOpen, onClose }: Ardui
               {/* 生成的代码 */}
               {hasCode && (
                 <div className="space-y-4">
+                  {boards.length > 1 && (
+                    <div className="flex flex-wrap gap-2">
+                      {boards.map(board => (
+                        <button
+                          key={board.boardId}
+                          type="button"
+                          onClick={() => selectBoard(board.boardId)}
+                          className={`px-3 py-1 text-sm rounded transition-colors ${
+                            board.boardId === currentBoardId
+                              ? 'bg-blue-600 text-white'
+                              : 'bg-gray-100 text-gray-700 hover:bg-gray-200'
+                          }`}
+                        >
+                          {board.boardId} · {board.host}{board.wifiMode === 'ap' ? ' (热点)' : ''} · {board.deviceCount}个设备
+                        </button>
+                      ))}
+                    </div>
+                  )}
+
                   <div className="flex items-center justify-between">
                     <h3 className="font-medium text-gray-900">生成的代码</h3>
                     <div className="flex space-x-2">
@@ -191,7 +215,7 @@ export default function ArduinoCodeGenerator({ devices, isOpen, onClose }: Ardui
                       </motion.button>
 
                       <motion.button
-                        onClick={() => downloadCode('FishControl_Generated.ino')}
+                        onClick={() => downloadCode(boards.length > 1 ? `FishControl_${currentBoardId}.ino` : 'FishControl_Generated.ino')}
                         whileTap={{ scale: 0.95 }}
                         className="flex items-center space-x-1 px-3 py-1 text-sm bg-blue-100 text-blue-700 rounded hover:bg-blue-200 transition-colors"
                       >
@@ -224,9 +248,10 @@ export default function ArduinoCodeGenerator({ devices, isOpen, onClose }: Ardui
                     <h4 className="font-medium text-green-900 mb-2">使用说明</h4>
                     <ol className="text-sm text-green-800 space-y-1 list-decimal list-inside">
                       <li>在Arduino IDE中安装 <code className="bg-green-100 px-1 rounded">ArduinoJson</code> 库</li>
+                      <li>将仓库中的 <code className="bg-green-100 px-1 rounded">firmware/MantaControl</code> 复制到Arduino的 libraries 目录</li>
                       <li>选择开发板：Arduino UNO R4 WiFi</li>
                       <li>将生成的代码复制到Arduino IDE中</li>
-                      <li>烧录到Arduino板</li>
+                      <li>烧录到Arduino板{boards.length > 1 ? '（每个控制板烧录各自的固件，先启动创建热点的主控制板）' : ''}</li>
                       <li>打开串口监视器查看运行状态</li>
                     </ol>
                   </div>
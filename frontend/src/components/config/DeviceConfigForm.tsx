@@ -1,16 +1,19 @@
 import { useState, useEffect } from 'react';
 import { motion } from 'framer-motion';
 import { XMarkIcon } from '@heroicons/react/24/outline';
-import type { DeviceConfig, DeviceGroup } from '../../types';
+import type { DeviceConfig, DeviceGroup, SensorChannelConfig } from '../../types';
+import { DEFAULT_SENSOR_CONFIG, DEFAULT_BOARD_ID } from '../../types';
 import { validateDeviceConfig } from '../../utils/deviceConfig';
 import PinSelector from './PinSelector';
 import DeviceTypeSelector from './DeviceTypeSelector';
 import IconSelector from './IconSelector';
 
 // 获取设备名称建议
-function getNameSuggestions(type: 'pwm' | 'digital'): string[] {
+function getNameSuggestions(type: DeviceConfig['type']): string[] {
   if (type === 'pwm') {
     return ['充气泵1', '充气泵2', '抽气泵1', '抽气泵2', '调速风扇', '水泵'];
+  } else if (type === 'sensor') {
+    return ['压力传感器1', '压力传感器2', '温度传感器', '流量传感器'];
   } else {
     return ['电磁阀1', '电磁阀2', '继电器1', '继电器2', '开关1', '开关2'];
   }
@@ -57,6 +60,14 @@ export default function DeviceConfigForm({
     setFormData(prev => ({ ...prev, [field]: value }));
   };
 
+  // 更新传感器采样配置字段
+  const updateSensorField = (field: keyof SensorChannelConfig, value: any) => {
+    setFormData(prev => ({
+      ...prev,
+      sensor: { ...DEFAULT_SENSOR_CONFIG, ...prev.sensor, [field]: value }
+    }));
+  };
+
   // 保存配置
   const handleSave = () => {
     if (validationResult.isValid) {
@@ -64,6 +75,10 @@ export default function DeviceConfigForm({
     }
   };
 
+  // 引脚只与同一控制板上的设备冲突
+  const boardId = formData.boardId || DEFAULT_BOARD_ID;
+  const boardDevices = devices.filter(d => (d.boardId || DEFAULT_BOARD_ID) === boardId);
+
   // 检查特定字段是否有错误
   const hasFieldError = (field: string) => {
     return validationResult.errors.some(error => 
@@ -148,14 +163,102 @@ export default function DeviceConfigForm({
             value={formData.type}
             onChange={(type) => {
               updateField('type', type);
+              if (type === 'sensor' && !formData.sensor) {
+                updateField('sensor', { ...DEFAULT_SENSOR_CONFIG });
+              }
             }}
           />
 
+          {/* 传感器采样配置 */}
+          {formData.type === 'sensor' && (
+            <div className="grid grid-cols-2 gap-3">
+              <div>
+                <label className="block text-sm font-medium text-gray-700 mb-2">
+                  采样率 (Hz)
+                </label>
+                <input
+                  type="number"
+                  min={1}
+                  max={10000}
+                  value={formData.sensor?.sampleRateHz ?? DEFAULT_SENSOR_CONFIG.sampleRateHz}
+                  onChange={(e) => updateSensorField('sampleRateHz', Number(e.target.value))}
+                  className={`
+                    w-full px-3 py-2 border rounded-lg focus:outline-none focus:ring-2 focus:ring-blue-500
+                    ${hasFieldError('采样率') ? 'border-red-300 bg-red-50' : 'border-gray-300'}
+                  `}
+                />
+              </div>
+              <div>
+                <label className="block text-sm font-medium text-gray-700 mb-2">
+                  窗口样本数
+                </label>
+                <input
+                  type="number"
+                  min={1}
+                  value={formData.sensor?.windowSamples ?? DEFAULT_SENSOR_CONFIG.windowSamples}
+                  onChange={(e) => updateSensorField('windowSamples', Number(e.target.value))}
+                  className={`
+                    w-full px-3 py-2 border rounded-lg focus:outline-none focus:ring-2 focus:ring-blue-500
+                    ${hasFieldError('窗口') ? 'border-red-300 bg-red-50' : 'border-gray-300'}
+                  `}
+                />
+              </div>
+              <div>
+                <label className="block text-sm font-medium text-gray-700 mb-2">
+                  换算系数
+                </label>
+                <input
+                  type="number"
+                  step="any"
+                  value={formData.sensor?.scale ?? 1}
+                  onChange={(e) => updateSensorField('scale', Number(e.target.value))}
+                  className="w-full px-3 py-2 border border-gray-300 rounded-lg focus:outline-none focus:ring-2 focus:ring-blue-500"
+                />
+              </div>
+              <div>
+                <label className="block text-sm font-medium text-gray-700 mb-2">
+                  单位
+                </label>
+                <input
+                  type="text"
+                  value={formData.sensor?.unit || ''}
+                  onChange={(e) => updateSensorField('unit', e.target.value || undefined)}
+                  className="w-full px-3 py-2 border border-gray-300 rounded-lg focus:outline-none focus:ring-2 focus:ring-blue-500"
+                  placeholder="如 kPa"
+                  maxLength={10}
+                />
+              </div>
+              <p className="col-span-2 text-xs text-gray-500">
+                每个窗口 {(((formData.sensor?.windowSamples ?? DEFAULT_SENSOR_CONFIG.windowSamples) * 1000) /
+                  (formData.sensor?.sampleRateHz || DEFAULT_SENSOR_CONFIG.sampleRateHz)).toFixed(1)}ms，
+                上报最小/最大/平均值；物理量 = ADC值 × 换算系数 + 偏移
+              </p>
+            </div>
+          )}
+
+          {/* 所在控制板 */}
+          <div>
+            <label className="block text-sm font-medium text-gray-700 mb-2">
+              控制板
+            </label>
+            <input
+              type="text"
+              value={formData.boardId || ''}
+              onChange={(e) => updateField('boardId', e.target.value.trim() || undefined)}
+              className="w-full px-3 py-2 border border-gray-300 rounded-lg focus:outline-none focus:ring-2 focus:ring-blue-500"
+              placeholder={DEFAULT_BOARD_ID}
+              maxLength={16}
+            />
+            <p className="text-xs text-gray-500 mt-1">
+              多控制板部署时填写设备所在的控制板，留空为主控制板；每个控制板生成一份固件
+            </p>
+          </div>
+
           {/* 引脚选择器 */}
           <PinSelector
             value={formData.pin}
             onChange={(pin) => updateField('pin', pin)}
-            devices={devices}
+            devices={boardDevices}
             excludeDeviceId={formData.id}
             hasError={hasFieldError('引脚')}
           />
@@ -3,7 +3,7 @@ import { ICON_OPTIONS } from './IconSelector';
 
 interface DeviceIconProps {
   iconId?: string;
-  type?: 'pwm' | 'digital'; // 兼容旧的type属性
+  type?: 'pwm' | 'digital' | 'sensor'; // 兼容旧的type属性
   className?: string;
   fallbackIcon?: React.ComponentType<{ className?: string }>;
 }
@@ -21,7 +21,7 @@ export default function DeviceIcon({
   // 如果提供了type但没有iconId，使用默认图标
   let finalIconId = iconId;
   if (!iconId && type) {
-    finalIconId = type === 'pwm' ? 'bolt' : 'cpu-chip';
+    finalIconId = type === 'pwm' ? 'bolt' : type === 'sensor' ? 'beaker' : 'cpu-chip';
   }
 
   // 查找对应的图标
@@ -2,13 +2,13 @@
 import { motion } from 'framer-motion';
 
 interface DeviceTypeSelectorProps {
-  value: 'pwm' | 'digital';
-  onChange: (type: 'pwm' | 'digital') => void;
+  value: 'pwm' | 'digital' | 'sensor';
+  onChange: (type: 'pwm' | 'digital' | 'sensor') => void;
 }
 
 /**
  * 设备类型选择器组件
- * 提供泵和阀两种设备类型的选择
+ * 提供泵、阀和传感器三种设备类型的选择
  */
 export default function DeviceTypeSelector({ value, onChange }: DeviceTypeSelectorProps) {
   const options = [
@@ -33,6 +33,17 @@ export default function DeviceTypeSelector({ value, onChange }: DeviceTypeSelect
       borderColor: 'border-green-200',
       textColor: 'text-green-700',
       iconBg: 'bg-green-100'
+    },
+    {
+      type: 'sensor' as const,
+      label: '传感器',
+      icon: '📈',
+      description: 'ADC定时采样的模拟传感器',
+      features: ['定时采样', '窗口最小/最大/均值', '批量上传'],
+      bgColor: 'bg-purple-50',
+      borderColor: 'border-purple-200',
+      textColor: 'text-purple-700',
+      iconBg: 'bg-purple-100'
     }
   ];
 
@@ -42,7 +53,7 @@ export default function DeviceTypeSelector({ value, onChange }: DeviceTypeSelect
         设备类型 *
       </label>
       
-      <div className="grid grid-cols-1 sm:grid-cols-2 gap-3">
+      <div className="grid grid-cols-1 sm:grid-cols-3 gap-3">
         {options.map((option) => {
           const isSelected = value === option.type;
           
@@ -122,6 +133,8 @@ export default function DeviceTypeSelector({ value, onChange }: DeviceTypeSelect
           <strong>PWM设备:</strong> 如充气泵、抽气泵等，支持功率调节 (0-100%)
           <br />
           <strong>Digital设备:</strong> 如电磁阀、球阀等，仅支持开关控制
+          <br />
+          <strong>传感器:</strong> 如压力、温度传感器，接在 A0-A5，只读不可控制
         </p>
       </div>
     </div>
@@ -7,6 +7,9 @@ import { taskExecutionService } from '../../services/TaskExecutionService';
 import { generateId } from '../../utils/task-orchestrator';
 import { useResponsive } from '../../hooks/useResponsive';
 
+// 快捷控制的执行优先级（程序默认为0）
+const QUICK_ACTION_PRIORITY = 10;
+
 interface DeviceControlState {
   value: number | boolean;
   durationSec: number; // 0.1s 精度
@@ -24,7 +27,8 @@ export default function ControlPanel() {
     if (configJson) {
       try {
         const cfg = JSON.parse(configJson);
-        if (Array.isArray(cfg.devices)) setDevices(cfg.devices);
+        // 传感器只读，不出现在控制面板
+        if (Array.isArray(cfg.devices)) setDevices(cfg.devices.filter((d: DeviceConfig) => d.type !== 'sensor'));
         if (Array.isArray(cfg.groups)) setGroups(cfg.groups);
       } catch {}
     }
@@ -88,7 +92,8 @@ export default function ControlPanel() {
     };
 
     try {
-      await taskExecutionService.startTask(task);
+      // 快捷控制优先于正在执行的程序，结束后设备回到程序
+      await taskExecutionService.startTask(task, undefined, QUICK_ACTION_PRIORITY);
     } catch (e) {
       alert('发送失败，请检查后端连接');
     }
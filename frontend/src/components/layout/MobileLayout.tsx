@@ -6,7 +6,7 @@ import DeviceConfigManager from '../config/DeviceConfigManager';
 import TaskEditor from '../task-orchestrator/TaskEditor';
 import ControlPanel from '../dashboard/ControlPanel';
 import SystemLogs from '../logs/SystemLogs';
-// 删除：避免多个Hook实例导致重复请求
+import { useGlobalState } from '../../contexts/GlobalStateContext';
 
 interface MobileLayoutProps {}
 
@@ -16,9 +16,7 @@ interface MobileLayoutProps {}
  */
 export default function MobileLayout({}: MobileLayoutProps) {
   const [currentPage, setCurrentPage] = useState('config'); // 默认显示设备配置
-  // 只在桌面端使用日志检测，避免重复请求
-  const hasNewLogs = false;
-  const markLogsAsRead = () => {};
+  const { hasNewLogs, markLogsAsRead } = useGlobalState();
 
   // 导航处理函数
   const handleNotificationClick = () => {
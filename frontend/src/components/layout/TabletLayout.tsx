@@ -6,7 +6,7 @@ import DeviceConfigManager from '../config/DeviceConfigManager';
 import TaskEditor from '../task-orchestrator/TaskEditor';
 import ControlPanel from '../dashboard/ControlPanel';
 import SystemLogs from '../logs/SystemLogs';
-// 删除：避免多个Hook实例导致重复请求
+import { useGlobalState } from '../../contexts/GlobalStateContext';
 
 interface TabletLayoutProps {}
 
@@ -19,9 +19,7 @@ export default function TabletLayout({}: TabletLayoutProps) {
   const [sidebarOpen, setSidebarOpen] = useState(true);
   const [isDragging, setIsDragging] = useState(false); // 是否正在拖拽
   const [dragStartTime, setDragStartTime] = useState(0); // 拖拽开始时间
-  // 只在桌面端使用日志检测，避免重复请求
-  const hasNewLogs = false;
-  const markLogsAsRead = () => {};
+  const { hasNewLogs, markLogsAsRead } = useGlobalState();
 
   // 导航处理函数
   const handleNotificationClick = () => {
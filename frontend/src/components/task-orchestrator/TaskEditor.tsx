@@ -3,7 +3,6 @@ import { motion, AnimatePresence } from 'framer-motion';
 import { PlusIcon, PlayIcon, StopIcon, ArrowUpTrayIcon, EyeIcon } from '@heroicons/react/24/outline';
 import { useResponsive } from '../../hooks/useResponsive';
 import { useTaskExecution } from '../../hooks/useTaskExecution';
-import { useNewLogDetection } from '../../hooks/useNewLogDetection';
 import type { DeviceConfig, DeviceGroup } from '../../types';
 import { DEFAULT_DEVICES, DEFAULT_DEVICE_GROUPS } from '../../types';
 import type { Task, Step } from '../../types/task-orchestrator';
@@ -40,8 +39,6 @@ function TaskEditorCore() {
     progress
   } = useTaskExecution();
 
-  const { setTaskExecutionStatus } = useNewLogDetection();
-
   const [devices, setDevices] = useState<DeviceConfig[]>(DEFAULT_DEVICES);
   const [groups, setGroups] = useState<DeviceGroup[]>(DEFAULT_DEVICE_GROUPS);
   const [currentTask, setCurrentTask] = useState<Task>(() => ({
@@ -154,16 +151,13 @@ function TaskEditorCore() {
     }
 
     try {
-      setTaskExecutionStatus(true); // 通知开始执行
       const success = await startTaskExecution(currentTask);
       if (!success && executionError) {
         alert(`任务启动失败: ${executionError}`);
-        setTaskExecutionStatus(false); // 执行失败，停止监控
       }
     } catch (error) {
       console.error('执行任务失败:', error);
       alert('任务启动失败，请检查网络连接');
-      setTaskExecutionStatus(false); // 执行失败，停止监控
     }
   };
 
@@ -171,14 +165,12 @@ function TaskEditorCore() {
   const stopTask = async () => {
     try {
       const success = await stopTaskExecution();
-      setTaskExecutionStatus(false); // 通知停止执行
       if (!success && executionError) {
         alert(`任务停止失败: ${executionError}`);
       }
     } catch (error) {
       console.error('停止任务失败:', error);
       alert('任务停止失败，请检查网络连接');
-      setTaskExecutionStatus(false); // 确保停止监控
     }
   };
 
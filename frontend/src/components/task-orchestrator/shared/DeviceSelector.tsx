@@ -26,6 +26,7 @@ export default function DeviceSelector({
 
   // 过滤设备
   const filteredDevices = devices.filter(device =>
+    device.type !== 'sensor' &&
     device.name.toLowerCase().includes(searchTerm.toLowerCase())
   );
 
@@ -1,5 +1,14 @@
 import React, { createContext, useContext, useEffect, useState } from 'react';
 import { taskExecutionService, type TaskExecutionStatus } from '../services/TaskExecutionService';
+import { logStreamService, type LogStreamFilter } from '../services/LogStreamService';
+
+/**
+ * 需要提示的日志：错误/警告，以及任务执行与设备控制日志
+ */
+const NOTIFY_LOG_FILTERS: LogStreamFilter[] = [
+  { level: ['error', 'warn'] },
+  { category: ['task_execution', 'device_control'] }
+];
 
 /**
  * 全局状态管理 - 避免重复请求
@@ -64,21 +73,6 @@ export function GlobalStateProvider({ children }: { children: React.ReactNode })
     }
   };
 
-  // 检查新日志
-  const checkNewLogs = async () => {
-    try {
-      const response = await taskExecutionService.getLogs({ limit: 1 });
-      if (response.success && response.logs.length > 0) {
-        const latestLogTime = response.logs[0].timestamp;
-        if (latestLogTime > state.lastLogCheck) {
-          setState(prev => ({ ...prev, hasNewLogs: true }));
-        }
-      }
-    } catch (error) {
-      console.error('Failed to check new logs:', error);
-    }
-  };
-
   // 标记日志已读
   const markLogsAsRead = () => {
     setState(prev => ({
@@ -106,17 +100,19 @@ export function GlobalStateProvider({ children }: { children: React.ReactNode })
     return () => clearInterval(interval);
   }, []);
 
-  // 自动检查新日志
+  // 订阅日志流，收到比上次已读更新的日志时提示（服务端推送，不再轮询）
   useEffect(() => {
-    // 只在任务执行时检查新日志
-    if (!state.isTaskExecuting) return;
-
-    const interval = setInterval(() => {
-      checkNewLogs();
-    }, 5000); // 每5秒检查新日志
-
-    return () => clearInterval(interval);
-  }, [state.isTaskExecuting, state.lastLogCheck]);
+    const unsubscribes = NOTIFY_LOG_FILTERS.map(filter =>
+      logStreamService.subscribe(filter, {
+        onEntries: entries => {
+          if (entries.length === 0) return;
+          const latest = entries[entries.length - 1].timestamp;
+          setState(prev => latest > prev.lastLogCheck && !prev.hasNewLogs ? { ...prev, hasNewLogs: true } : prev);
+        }
+      })
+    );
+    return () => unsubscribes.forEach(unsubscribe => unsubscribe());
+  }, []);
 
   const contextValue: GlobalStateContextType = {
     ...state,
@@ -1,7 +1,8 @@
 import { useState, useCallback } from 'react';
 import { codeGenerationService } from '../services/CodeGenerationService';
-import type { ValidationResult } from '../types/codeGeneration';
+import type { ValidationResult, BoardFirmware } from '../types/codeGeneration';
 import type { DeviceConfig } from '../types';
+import { DEFAULT_BOARD_ID } from '../types';
 
 /**
  * 代码生成Hook - 统一管理所有代码生成逻辑
@@ -11,6 +12,7 @@ export function useCodeGeneration() {
   const [isGenerating, setIsGenerating] = useState(false);
   const [generatedCode, setGeneratedCode] = useState<string>('');
   const [metadata, setMetadata] = useState<any>(null);
+  const [boards, setBoards] = useState<BoardFirmware[]>([]);
   const [validation, setValidation] = useState<ValidationResult | null>(null);
   const [error, setError] = useState<string | null>(null);
   const [isCopied, setIsCopied] = useState(false);
@@ -36,6 +38,7 @@ export function useCodeGeneration() {
       if (response.success && response.data) {
         setGeneratedCode(response.data.code);
         setMetadata(response.data.metadata);
+        setBoards(response.data.boards ?? []);
         return response.data;
       } else {
         throw new Error(response.error || '代码生成失败');
@@ -49,6 +52,16 @@ export function useCodeGeneration() {
     }
   }, []);
 
+  /**
+   * 切换显示的控制板固件（多控制板时）
+   */
+  const selectBoard = useCallback((boardId: string) => {
+    const board = boards.find(b => b.boardId === boardId);
+    if (!board) return;
+    setGeneratedCode(board.code);
+    setMetadata(board.metadata);
+  }, [boards]);
+
   /**
    * 复制代码到剪贴板
    */
@@ -99,17 +112,21 @@ export function useCodeGeneration() {
       errors.push('至少需要配置一个设备');
     }
 
-    // 检查引脚冲突
-    const usedPins = new Set<number>();
+    // 检查引脚冲突（同一控制板内）
+    const usedPins = new Set<string>();
     devices.forEach(device => {
-      if (usedPins.has(device.pin)) {
-        errors.push(`引脚 ${device.pin} 被多个设备使用`);
+      const boardId = device.boardId || DEFAULT_BOARD_ID;
+      const key = `${boardId}:${device.pin}`;
+      if (usedPins.has(key)) {
+        errors.push(boardId === DEFAULT_BOARD_ID
+          ? `引脚 ${device.pin} 被多个设备使用`
+          : `控制板 ${boardId} 的引脚 ${device.pin} 被多个设备使用`);
       }
-      usedPins.add(device.pin);
+      usedPins.add(key);
     });
 
-    // 检查UNO R4 WiFi的PWM引脚
-    const validPWMPins = [3, 5, 6, 9, 10, 11];
+    // 检查UNO R4 WiFi的PWM引脚（D2-D13 都接有GPT定时器输出，与后端的定时器表一致）
+    const validPWMPins = [2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13];
     devices.forEach(device => {
       if (device.type === 'pwm' && !validPWMPins.includes(device.pin)) {
         warnings.push(`引脚 ${device.pin} 可能不支持PWM (${device.name})`);
@@ -132,6 +149,7 @@ export function useCodeGeneration() {
   const reset = useCallback(() => {
     setGeneratedCode('');
     setMetadata(null);
+    setBoards([]);
     setValidation(null);
     setError(null);
     setIsGenerating(false);
@@ -142,6 +160,7 @@ export function useCodeGeneration() {
     isGenerating,
     generatedCode,
     metadata,
+    boards,
     validation,
     error,
     isCopied,
@@ -149,6 +168,7 @@ export function useCodeGeneration() {
 
     // 操作
     generateArduinoCode,
+    selectBoard,
     copyCode,
     downloadCode,
     validateConfig,
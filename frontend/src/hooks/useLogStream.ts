@@ -0,0 +1,38 @@
+import { useState, useEffect } from 'react';
+import { logStreamService, type LogStreamFilter } from '../services/LogStreamService';
+import type { LogEntry } from '../services/TaskExecutionService';
+
+/**
+ * 实时日志Hook
+ * 订阅服务端过滤后的日志流，新日志成批追加；过滤条件变化时重新订阅
+ * 返回的日志新的在前，最多保留 limit 条
+ */
+export function useLogStream(filter: LogStreamFilter, limit: number = 200) {
+  const [logs, setLogs] = useState<LogEntry[]>([]);
+  const [connected, setConnected] = useState(false);
+  const [hasGap, setHasGap] = useState(false);
+  const filterKey = JSON.stringify(filter);
+
+  useEffect(() => {
+    setLogs([]);
+    setHasGap(false);
+
+    return logStreamService.subscribe(JSON.parse(filterKey), {
+      onEntries: (entries, update) => {
+        if (update.gap) setHasGap(true);
+        const newest = entries.slice().reverse();
+        setLogs(prev => (update.replace ? newest : [...newest, ...prev]).slice(0, limit));
+      },
+      onConnectionChange: setConnected
+    }, limit);
+  }, [filterKey, limit]);
+
+  return {
+    logs,
+    connected,
+    hasGap,
+    clearGap: () => setHasGap(false)
+  };
+}
+
+export default useLogStream;
@@ -3,9 +3,39 @@ export interface ArduinoStatus {
   online: boolean;
   devices?: number;
   uptimeSec?: number;
+  version?: number;        // 固件状态版本
+  notModified?: boolean;   // 固件回复304，状态沿用上次结果
+  boot?: ArduinoBootTimings;
   responseTime?: number;
 }
 
+/**
+ * 固件启动阶段时间戳（ms，相对上电；0 表示尚未发生）
+ */
+export interface ArduinoBootTimings {
+  outputsMs: number;
+  apMs: number;
+  serverMs: number;
+  firstCommandMs: number;
+}
+
+/**
+ * 设备运行计数（固件累计，重启后清零）
+ */
+export interface ArduinoDeviceMetrics {
+  deviceId: string;
+  onTimeMs: number;               // 累计开启时间
+  dutyOnTimeMs: number;           // 占空比加权开启时间
+  switchCount: number;            // 开/关切换次数
+  lastChangeAgoMs: number | null; // 距最近一次输出变化
+}
+
+export interface ArduinoMetrics {
+  success: boolean;
+  uptimeMs: number;
+  devices: ArduinoDeviceMetrics[];
+}
+
 export class ArduinoService {
   private baseUrl: string;
   constructor(baseUrl: string = '/api') {
@@ -17,6 +47,12 @@ export class ArduinoService {
     if (!r.ok) throw new Error(`HTTP ${r.status}`);
     return r.json();
   }
+
+  async getMetrics(): Promise<ArduinoMetrics> {
+    const r = await fetch(`${this.baseUrl}/arduino/metrics`);
+    if (!r.ok) throw new Error(`HTTP ${r.status}`);
+    return r.json();
+  }
 }
 
 export const arduinoService = new ArduinoService();
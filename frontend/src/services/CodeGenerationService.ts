@@ -40,7 +40,7 @@ export class CodeGenerationService {
 
         try {
           const errorData = JSON.parse(responseText);
-          errorMessage = errorData.error || errorMessage;
+          errorMessage = errorData.message || errorData.error || errorMessage;
         } catch (parseError) {
           console.error('无法解析错误响应:', parseError);
           errorMessage = `${errorMessage} - 响应内容: ${responseText}`;
@@ -0,0 +1,162 @@
+import { io, type Socket } from 'socket.io-client';
+import type { LogEntry } from './TaskExecutionService';
+
+/**
+ * 前端日志流服务
+ * 通过 socket.io 订阅服务端过滤后的日志，服务端成批推送匹配的新日志；
+ * 记录每个订阅最后收到的位置（epoch + cursor），断线重连后带上位置重新订阅，只补发断开期间的日志
+ */
+export class LogStreamService {
+  private socket: Socket | null = null;
+  private subscriptions: Map<string, StreamSubscription> = new Map();
+  private heartbeatTimer: ReturnType<typeof setInterval> | null = null;
+  private nextId = 1;
+
+  /**
+   * 订阅日志，返回取消订阅函数
+   */
+  subscribe(filter: LogStreamFilter, handlers: LogStreamHandlers, backlog: number = 0): () => void {
+    const subscription: StreamSubscription = {
+      id: `logs_${this.nextId++}`,
+      filter,
+      backlog,
+      handlers,
+      position: null
+    };
+    this.subscriptions.set(subscription.id, subscription);
+
+    const socket = this.connect();
+    if (socket.connected) {
+      this.sendSubscribe(subscription);
+      handlers.onConnectionChange?.(true);
+    }
+
+    return () => {
+      this.subscriptions.delete(subscription.id);
+      if (this.socket?.connected) {
+        this.socket.emit('logUnsubscribe', { id: subscription.id });
+      }
+      if (this.subscriptions.size === 0) {
+        this.disconnect();
+      }
+    };
+  }
+
+  /**
+   * 建立连接（已连接时复用）
+   */
+  private connect(): Socket {
+    if (this.socket) return this.socket;
+
+    const socket = io({ transports: ['websocket', 'polling'] });
+
+    socket.on('connect', () => {
+      // 首次连接或重连：所有订阅带上最后的位置重新订阅
+      this.subscriptions.forEach(subscription => this.sendSubscribe(subscription));
+      this.subscriptions.forEach(subscription => subscription.handlers.onConnectionChange?.(true));
+    });
+
+    socket.on('disconnect', () => {
+      this.subscriptions.forEach(subscription => subscription.handlers.onConnectionChange?.(false));
+    });
+
+    socket.on('logSubscribed', (message: LogSubscribedMessage) => {
+      const subscription = this.subscriptions.get(message.id);
+      if (!subscription) return;
+      subscription.position = { epoch: message.epoch, cursor: message.cursor };
+      subscription.handlers.onEntries(message.entries, { replace: !message.resumed, gap: message.gap, dropped: 0 });
+    });
+
+    socket.on('logBatch', (message: LogBatchMessage) => {
+      const subscription = this.subscriptions.get(message.id);
+      if (!subscription) return;
+      subscription.position = { epoch: message.epoch, cursor: message.cursor };
+      subscription.handlers.onEntries(message.entries, { replace: false, gap: message.dropped > 0, dropped: message.dropped });
+    });
+
+    socket.on('logReset', (message: { id: string; epoch: string; cursor: number }) => {
+      const subscription = this.subscriptions.get(message.id);
+      if (!subscription) return;
+      subscription.position = { epoch: message.epoch, cursor: message.cursor };
+      subscription.handlers.onEntries([], { replace: true, gap: false, dropped: 0 });
+    });
+
+    socket.on('logSubscribeError', (message: { id: string; error: string }) => {
+      console.error(`Log subscription ${message.id} failed: ${message.error}`);
+    });
+
+    // 服务端会断开长时间无活动的连接
+    this.heartbeatTimer = setInterval(() => {
+      if (socket.connected) socket.emit('heartbeat');
+    }, 60000);
+
+    this.socket = socket;
+    return socket;
+  }
+
+  private disconnect(): void {
+    if (this.heartbeatTimer) {
+      clearInterval(this.heartbeatTimer);
+      this.heartbeatTimer = null;
+    }
+    this.socket?.disconnect();
+    this.socket = null;
+  }
+
+  private sendSubscribe(subscription: StreamSubscription): void {
+    this.socket?.emit('logSubscribe', {
+      id: subscription.id,
+      filter: subscription.filter,
+      resume: subscription.position ?? undefined,
+      backlog: subscription.backlog
+    });
+  }
+}
+
+// 导出单例实例
+export const logStreamService = new LogStreamService();
+
+// ==================== 类型定义 ====================
+
+export interface LogStreamFilter {
+  level?: LogEntry['level'] | LogEntry['level'][];
+  source?: LogEntry['source'] | LogEntry['source'][];
+  category?: string | string[];
+  search?: string;
+}
+
+export interface LogStreamUpdate {
+  replace: boolean;   // 收到的是最近的日志而不是续传，应替换已有列表
+  gap: boolean;       // 有日志未能送达（续传位置已失效或客户端跟不上）
+  dropped: number;
+}
+
+export interface LogStreamHandlers {
+  onEntries: (entries: LogEntry[], update: LogStreamUpdate) => void;   // 旧的在前
+  onConnectionChange?: (connected: boolean) => void;
+}
+
+interface StreamSubscription {
+  id: string;
+  filter: LogStreamFilter;
+  backlog: number;
+  handlers: LogStreamHandlers;
+  position: { epoch: string; cursor: number } | null;
+}
+
+interface LogSubscribedMessage {
+  id: string;
+  epoch: string;
+  cursor: number;
+  resumed: boolean;
+  gap: boolean;
+  entries: LogEntry[];
+}
+
+interface LogBatchMessage {
+  id: string;
+  epoch: string;
+  cursor: number;
+  entries: LogEntry[];
+  dropped: number;
+}
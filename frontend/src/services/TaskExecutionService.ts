@@ -13,8 +13,9 @@ export class TaskExecutionService {
 
   /**
    * 开始执行任务
+   * priority: 与正在执行的任务共用设备时，优先级更高的任务接管这些设备（默认0）
    */
-  async startTask(task: Task, estimatedDuration?: number): Promise<TaskExecutionResponse> {
+  async startTask(task: Task, estimatedDuration?: number, priority?: number): Promise<TaskExecutionResponse> {
     try {
       console.log('Starting task execution:', task.name);
       console.log('Task data:', JSON.stringify(task, null, 2));
@@ -26,7 +27,8 @@ export class TaskExecutionService {
         },
         body: JSON.stringify({
           task,
-          estimatedDuration
+          estimatedDuration,
+          priority
         })
       });
 
@@ -55,9 +57,9 @@ export class TaskExecutionService {
   }
 
   /**
-   * 停止任务执行
+   * 停止任务执行：指定 executionId 只停止该任务，否则停止所有任务并急停
    */
-  async stopTask(): Promise<TaskExecutionResponse> {
+  async stopTask(executionId?: string): Promise<TaskExecutionResponse> {
     try {
       console.log('Stopping task execution');
 
@@ -65,7 +67,8 @@ export class TaskExecutionService {
         method: 'POST',
         headers: {
           'Content-Type': 'application/json',
-        }
+        },
+        body: JSON.stringify({ executionId })
       });
 
       const responseText = await response.text();
@@ -92,6 +95,24 @@ export class TaskExecutionService {
     }
   }
 
+  /**
+   * 急停：让Arduino立即关闭所有输出（无论是否有任务在执行）
+   */
+  async emergencyStop(): Promise<TaskExecutionResponse> {
+    const response = await fetch(`${this.baseUrl}/task-execution/estop`, {
+      method: 'POST',
+      headers: {
+        'Content-Type': 'application/json',
+      }
+    });
+
+    const result: TaskExecutionResponse = await response.json();
+    if (!response.ok && !result.emergencyStop) {
+      throw new Error(result.error || `HTTP ${response.status}: ${response.statusText}`);
+    }
+    return result;
+  }
+
   /**
    * 获取执行状态
    */
@@ -166,12 +187,31 @@ export interface TaskExecutionResponse {
   message?: string;
   taskId?: string;
   taskName?: string;
+  executionId?: string;
+  conflicts?: DeviceConflict[];
   executedCommands?: number;
   totalCommands?: number;
   status?: TaskExecutionStatus;
+  emergencyStop?: EmergencyStopResult;
   error?: string;
 }
 
+export interface DeviceConflict {
+  deviceId: string;
+  executionId: string;
+  taskName: string;
+  priority: number;
+}
+
+export interface EmergencyStopResult {
+  acknowledged: boolean;
+  via: 'udp' | 'http';
+  latencyMs: number;
+  latencyBudgetMs: number;
+  withinBudget: boolean;
+  udpAttempts: number;
+}
+
 export interface TaskStatusResponse {
   success: boolean;
   status: TaskExecutionStatus;
@@ -205,6 +245,7 @@ export interface LogQueryResponse {
 
 export interface LogEntry {
   id: string;
+  seq?: number;
   timestamp: number;
   source: 'backend' | 'arduino' | 'frontend';
   level: 'error' | 'warn' | 'info' | 'debug';
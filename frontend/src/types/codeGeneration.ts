@@ -20,6 +20,8 @@ export interface GeneratedCodeResponse {
       name: string;
       type: string;
       pin: number;
+      groupId?: string;
+      boardId?: string;
     }>;
     metadata?: {
       pwmDevices: number;
@@ -29,12 +31,25 @@ export interface GeneratedCodeResponse {
         ssid: string;
         hasPassword: boolean;
       };
+      deviceOrder?: string[];
+      groupMasks?: Record<string, number>;
     };
     validation?: ValidationResult;
+    boards?: BoardFirmware[];   // 每个控制板一份固件，主控制板在前；code/metadata 为主控制板的
   };
   error?: string;
 }
 
+export interface BoardFirmware {
+  boardId: string;
+  host: string;
+  wifiMode: 'ap' | 'station';   // 主控制板创建热点，其他控制板加入
+  deviceCount: number;
+  code: string;
+  metadata: CodeMetadata;
+  validation: ValidationResult;
+}
+
 export interface CodeMetadata {
   deviceCount: number;
   pwmDevices: number;
@@ -44,6 +59,13 @@ export interface CodeMetadata {
     ssid: string;
     hasPassword: boolean;
   };
+  deviceOrder?: string[];               // 固件设备表顺序（位掩码第i位）
+  groupMasks?: Record<string, number>;  // 分组ID -> 设备位掩码
+  manifestHash?: number;                // 写入固件的清单哈希，控制板上报一致后后端才使用位掩码寻址
+  firmwareLibrary?: string;             // 草图依赖的固件库
+  boardId?: string;                     // 控制板ID
+  boardHost?: string;                   // 控制板IPv4地址
+  wifiMode?: 'ap' | 'station';
 }
 
 export interface GeneratedCode {
@@ -11,13 +11,33 @@ export interface DeviceGroup {
 export interface DeviceConfig {
   id: string;                    // 设备唯一ID
   name: string;                  // 用户自定义设备名称
-  type: 'pwm' | 'digital';       // 设备类型：PWM或数字设备
-  pin: number;                   // Arduino引脚号 (0-99)
+  type: 'pwm' | 'digital' | 'sensor'; // 设备类型：PWM、数字设备或传感器
+  pin: number;                   // Arduino引脚号 (0-99)，传感器为ADC引脚 A0-A5 (14-19)
   icon?: string;                 // 设备图标ID
   description?: string;          // 设备描述
   groupId?: string;              // 所属分组ID
+  boardId?: string;              // 所在控制板ID，未设置为主控制板 main；引脚在同一控制板内唯一
+  sensor?: SensorChannelConfig;  // 仅传感器：采样配置
 }
 
+// 未指定控制板的设备所在的控制板
+export const DEFAULT_BOARD_ID = 'main';
+
+// 传感器采样配置：固件按采样率定时采样，每 windowSamples 个样本上报一个 min/max/mean 窗口
+export interface SensorChannelConfig {
+  sampleRateHz: number;          // 采样率 (Hz)
+  windowSamples: number;         // 每个窗口的样本数
+  scale?: number;                // 物理量 = 原始ADC值 * scale + offset
+  offset?: number;
+  unit?: string;                 // 物理量单位，如 kPa
+}
+
+// 默认传感器采样配置
+export const DEFAULT_SENSOR_CONFIG: SensorChannelConfig = {
+  sampleRateHz: 1000,
+  windowSamples: 50
+};
+
 // 默认设备分组
 export const DEFAULT_DEVICE_GROUPS: DeviceGroup[] = [
   { id: 'inflate', name: '充气泵', color: '#3B82F6', icon: 'bolt', description: '用于充气的PWM设备' },
@@ -15,6 +15,19 @@ export interface TaskAction {
   value: number | boolean; // 功率值(0-100)或开关状态(true/false)
   duration: number;        // 持续时间（毫秒）
   name: string;           // 动作名称（前端显示用）
+  profile?: PwmProfile;    // 仅PWM动作：固件本地生成的波形
+}
+
+/**
+ * PWM波形配置
+ * 固件本地计算占空比 offset + amplitude * f(相位)，一条命令替代逐点下发
+ */
+export interface PwmProfile {
+  shape: 'ramp' | 'ease' | 'square' | 'sine';  // 线性斜坡、缓动斜坡、方波、正弦
+  periodMs: number;        // 单周期时长（斜坡为爬升时长）
+  amplitude: number;       // 幅值 0-100 (%)
+  offset: number;          // 基准值 0-100 (%)
+  cycles: number;          // 周期数，0表示持续到动作结束
 }
 
 /**
@@ -1,5 +1,5 @@
 import type { DeviceConfig, ConfigValidationResult } from '../types';
-import { DEFAULT_DEVICES } from '../types';
+import { DEFAULT_DEVICES, DEFAULT_SENSOR_CONFIG, DEFAULT_BOARD_ID } from '../types';
 
 /**
  * 验证设备配置
@@ -22,9 +22,10 @@ export function validateDeviceConfig(devices: DeviceConfig[]): ConfigValidationR
     warnings.push(`设备名称重复: ${duplicateNames.join(', ')}`);
   }
 
-  // 检查引脚冲突
-  const pins = devices.map(d => d.pin);
-  const duplicatePins = pins.filter((pin, index) => pins.indexOf(pin) !== index);
+  // 检查引脚冲突（引脚在同一控制板内唯一）
+  const pins = devices.map(d => `${d.boardId || DEFAULT_BOARD_ID}:${d.pin}`);
+  const duplicatePins = devices.filter((_, index) => pins.indexOf(pins[index]) !== index)
+    .map(d => d.boardId && d.boardId !== DEFAULT_BOARD_ID ? `${d.boardId}/${d.pin}` : String(d.pin));
   if (duplicatePins.length > 0) {
     errors.push(`引脚冲突: ${duplicatePins.join(', ')}`);
   }
@@ -46,6 +47,19 @@ export function validateDeviceConfig(devices: DeviceConfig[]): ConfigValidationR
     }
   });
 
+  // 检查传感器采样配置
+  devices.filter(d => d.type === 'sensor').forEach(device => {
+    if (device.pin < 14 || device.pin > 19) {
+      errors.push(`传感器 ${device.name} 的引脚 ${device.pin} 不是ADC引脚 (A0-A5 即 14-19)`);
+    }
+    if (!device.sensor || !(device.sensor.sampleRateHz > 0) || device.sensor.sampleRateHz > 10000) {
+      errors.push(`传感器 ${device.name} 的采样率必须在1-10000Hz之间`);
+    }
+    if (!device.sensor || !Number.isInteger(device.sensor.windowSamples) || device.sensor.windowSamples < 1) {
+      errors.push(`传感器 ${device.name} 的窗口样本数必须是正整数`);
+    }
+  });
+
   // 由于现在type就是信号类型，不需要额外检查匹配性
 
   return {
@@ -87,8 +101,8 @@ export function importDeviceConfig(jsonString: string): DeviceConfig[] {
       if (!device.name || typeof device.name !== 'string') {
         throw new Error(`设备 ${device.id} 缺少有效的名称`);
       }
-      if (!['pwm', 'digital'].includes(device.type)) {
-        throw new Error(`设备 ${device.id} 的类型必须是 'pwm' 或 'digital'`);
+      if (!['pwm', 'digital', 'sensor'].includes(device.type)) {
+        throw new Error(`设备 ${device.id} 的类型必须是 'pwm'、'digital' 或 'sensor'`);
       }
       if (typeof device.pin !== 'number' || device.pin < 0 || device.pin > 99) {
         throw new Error(`设备 ${device.id} 的引脚号必须是0-99之间的数字`);
@@ -100,7 +114,9 @@ export function importDeviceConfig(jsonString: string): DeviceConfig[] {
         type: device.type,
         pin: device.pin,
         icon: device.icon || 'bolt',
-        description: device.description || ''
+        description: device.description || '',
+        ...(typeof device.boardId === 'string' && device.boardId ? { boardId: device.boardId } : {}),
+        ...(device.type === 'sensor' ? { sensor: { ...DEFAULT_SENSOR_CONFIG, ...device.sensor } } : {})
       };
     });
 
@@ -120,8 +136,8 @@ export function getDefaultDeviceConfig(): DeviceConfig[] {
 /**
  * 生成新的设备ID
  */
-export function generateDeviceId(existingDevices: DeviceConfig[], type: 'pwm' | 'digital'): string {
-  const prefix = type === 'pwm' ? 'pwm' : 'digital';
+export function generateDeviceId(existingDevices: DeviceConfig[], type: DeviceConfig['type']): string {
+  const prefix = type;
   const existingIds = existingDevices
     .filter(d => d.id.startsWith(prefix))
     .map(d => {
@@ -170,18 +186,30 @@ export function getNextAvailablePin(devices: DeviceConfig[], preferredPins?: num
  */
 export function createNewDevice(
   existingDevices: DeviceConfig[],
-  type: 'pwm' | 'digital',
+  type: DeviceConfig['type'],
   name?: string
 ): DeviceConfig {
   const id = generateDeviceId(existingDevices, type);
-  const pin = getNextAvailablePin(existingDevices);
-  const defaultName = name || `${type === 'pwm' ? 'PWM设备' : 'Digital设备'}${id.replace(/\D/g, '')}`;
+  const typeLabels = { pwm: 'PWM设备', digital: 'Digital设备', sensor: '传感器' };
+  const defaultName = name || `${typeLabels[type]}${id.replace(/\D/g, '')}`;
+
+  if (type === 'sensor') {
+    return {
+      id,
+      name: defaultName,
+      type,
+      pin: getNextAvailablePin(existingDevices, [14, 15, 16, 17, 18, 19]),
+      icon: 'beaker',
+      description: '',
+      sensor: { ...DEFAULT_SENSOR_CONFIG }
+    };
+  }
 
   return {
     id,
     name: defaultName,
     type,
-    pin,
+    pin: getNextAvailablePin(existingDevices),
     icon: type === 'pwm' ? 'bolt' : 'cog',
     description: ''
   };
@@ -206,6 +206,43 @@ export function validateAction(
       });
     }
 
+    // 验证波形配置
+    if (taskAction.profile) {
+      const profile = taskAction.profile;
+      if (device.type !== 'pwm' || taskAction.actionType !== 'power') {
+        errors.push({
+          id: `action-${action.id}-profile-not-pwm`,
+          type: 'error',
+          message: '波形配置仅适用于PWM功率动作',
+          location: { stepIndex, actionId: action.id }
+        });
+      }
+      if (profile.periodMs <= 0) {
+        errors.push({
+          id: `action-${action.id}-invalid-period`,
+          type: 'error',
+          message: '波形周期必须大于0',
+          location: { stepIndex, actionId: action.id }
+        });
+      }
+      if (profile.offset < 0 || profile.amplitude < 0 || profile.offset + profile.amplitude > 100) {
+        errors.push({
+          id: `action-${action.id}-invalid-amplitude`,
+          type: 'error',
+          message: '波形基准值与幅值之和必须在0-100之间',
+          location: { stepIndex, actionId: action.id }
+        });
+      }
+      if (!Number.isInteger(profile.cycles) || profile.cycles < 0) {
+        errors.push({
+          id: `action-${action.id}-invalid-cycles`,
+          type: 'error',
+          message: '波形周期数必须是非负整数',
+          location: { stepIndex, actionId: action.id }
+        });
+      }
+    }
+
     // 验证持续时间
     if (taskAction.duration <= 0) {
       errors.push({